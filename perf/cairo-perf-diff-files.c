@@ -26,6 +26,7 @@
  */
 
 #include "cairo-perf.h"
+#include "cairo-stats.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,11 +36,20 @@
 #include <math.h>
 #include <assert.h>
 
+typedef enum {
+    FORMAT_TEXT,
+    FORMAT_JSON,
+    FORMAT_CSV
+} cairo_perf_report_format_t;
+
 typedef struct _cairo_perf_report_options {
     double min_change;
     int use_utf;
     int print_change_bars;
     int use_ticks;
+    cairo_perf_report_format_t format;
+    double alpha;
+    double fail_threshold; /* negative if not gating */
 } cairo_perf_report_options_t;
 
 typedef struct _cairo_perf_diff_files_args {
@@ -220,12 +230,184 @@ test_diff_print_multi (test_diff_t		   *diff,
     printf("\n");
 }
 
+#define CONFIDENCE 0.95
+
+static double *
+test_samples (const test_report_t		*test,
+	      const cairo_perf_report_options_t *options)
+{
+    double *values;
+    unsigned int i;
+
+    values = xmalloc (test->samples_count * sizeof (double));
+    for (i = 0; i < test->samples_count; i++) {
+	values[i] = test->samples[i];
+	if (! options->use_ticks)
+	    values[i] /= test->stats.ticks_per_ms;
+    }
+
+    return values;
+}
+
+static void
+test_diff_compute_significance (test_diff_t			  *diff,
+				const cairo_perf_report_options_t *options)
+{
+    const test_report_t *old = diff->tests[0];
+    const test_report_t *new = diff->tests[1];
+    double *old_values, *new_values;
+
+    diff->p_value = -1;
+    diff->ci_lo = diff->ci_hi = fabs (diff->change);
+    if (diff->change < 0)
+	diff->ci_lo = diff->ci_hi = 1. / diff->ci_lo;
+
+    if (old->samples_count < 2 || new->samples_count < 2)
+	return;
+
+    old_values = test_samples (old, options);
+    new_values = test_samples (new, options);
+
+    diff->p_value = _cairo_stats_mann_whitney (old_values, old->samples_count,
+					       new_values, new->samples_count);
+    _cairo_stats_bootstrap_median_ratio (old_values, old->samples_count,
+					 new_values, new->samples_count,
+					 CONFIDENCE,
+					 &diff->ci_lo, &diff->ci_hi);
+
+    free (new_values);
+    free (old_values);
+}
+
+/* A regression is a slowdown beyond the threshold which is also
+ * significant: the samples must differ at the chosen level and the
+ * whole confidence interval of the speedup must lie below 1. Reports
+ * without raw samples can only be judged by the threshold.
+ */
+static cairo_bool_t
+test_diff_is_regression (const test_diff_t		     *diff,
+			 const cairo_perf_report_options_t *options)
+{
+    if (options->fail_threshold < 0)
+	return FALSE;
+
+    if (diff->change > 0 || -diff->change - 1.0 < options->fail_threshold)
+	return FALSE;
+
+    if (diff->p_value < 0)
+	return TRUE;
+
+    return diff->p_value < options->alpha && diff->ci_hi < 1.0;
+}
+
+static double
+test_time_ms (const test_report_t *test, cairo_time_t ticks)
+{
+    return ticks / test->stats.ticks_per_ms;
+}
+
 static void
+print_json_string (const char *str)
+{
+    putchar ('"');
+    for (; *str; str++) {
+	if (*str == '"' || *str == '\\')
+	    printf ("\\%c", *str);
+	else if ((unsigned char) *str < 0x20)
+	    printf ("\\u%04x", *str);
+	else
+	    putchar (*str);
+    }
+    putchar ('"');
+}
+
+static void
+print_csv_string (const char *str)
+{
+    if (strpbrk (str, ",\"\n") == NULL) {
+	fputs (str, stdout);
+	return;
+    }
+
+    putchar ('"');
+    for (; *str; str++) {
+	if (*str == '"')
+	    putchar ('"');
+	putchar (*str);
+    }
+    putchar ('"');
+}
+
+static void
+test_diff_print_json (test_diff_t		  *diff,
+		      cairo_perf_report_options_t *options,
+		      cairo_bool_t		   first)
+{
+    const test_report_t *old = diff->tests[0];
+    const test_report_t *new = diff->tests[1];
+
+    printf ("%s    {\"backend\": ", first ? "" : ",\n");
+    print_json_string (old->backend);
+    printf (", \"content\": ");
+    print_json_string (old->content ? old->content : "");
+    printf (", \"name\": ");
+    print_json_string (old->name);
+    printf (", \"size\": %d,\n", old->size);
+    printf ("     \"old\": {\"min\": %f, \"median\": %f, \"stddev\": %f, \"samples\": %u},\n",
+	    test_time_ms (old, old->stats.min_ticks),
+	    test_time_ms (old, old->stats.median_ticks),
+	    old->stats.std_dev,
+	    old->samples_count);
+    printf ("     \"new\": {\"min\": %f, \"median\": %f, \"stddev\": %f, \"samples\": %u},\n",
+	    test_time_ms (new, new->stats.min_ticks),
+	    test_time_ms (new, new->stats.median_ticks),
+	    new->stats.std_dev,
+	    new->samples_count);
+    printf ("     \"change\": %f, ", diff->change);
+    if (diff->p_value < 0)
+	printf ("\"p_value\": null, \"ci\": null, ");
+    else
+	printf ("\"p_value\": %g, \"ci\": [%f, %f], ",
+		diff->p_value, diff->ci_lo, diff->ci_hi);
+    printf ("\"regression\": %s}",
+	    test_diff_is_regression (diff, options) ? "true" : "false");
+}
+
+static void
+test_diff_print_csv (test_diff_t		 *diff,
+		     cairo_perf_report_options_t *options)
+{
+    const test_report_t *old = diff->tests[0];
+    const test_report_t *new = diff->tests[1];
+
+    print_csv_string (old->backend);
+    putchar (',');
+    print_csv_string (old->content ? old->content : "");
+    putchar (',');
+    print_csv_string (old->name);
+    printf (",%d,%f,%f,%f,%f,%f,%f,%f,",
+	    old->size,
+	    test_time_ms (old, old->stats.min_ticks),
+	    test_time_ms (old, old->stats.median_ticks),
+	    old->stats.std_dev,
+	    test_time_ms (new, new->stats.min_ticks),
+	    test_time_ms (new, new->stats.median_ticks),
+	    new->stats.std_dev,
+	    diff->change);
+    if (diff->p_value >= 0)
+	printf ("%g,%f,%f,", diff->p_value, diff->ci_lo, diff->ci_hi);
+    else
+	printf (",,,");
+    printf ("%d\n", test_diff_is_regression (diff, options));
+}
+
+/* Returns the number of regressions */
+static int
 cairo_perf_reports_compare (cairo_perf_report_t 	*reports,
 			    int 			 num_reports,
 			    cairo_perf_report_options_t *options)
 {
-    int i;
+    int i, num_regressions = 0;
     test_report_t **tests, *min_test;
     test_diff_t *diff, *diffs;
     int num_diffs, max_diffs;
@@ -310,10 +492,13 @@ cairo_perf_reports_compare (cairo_perf_report_t 	*reports,
 	if (num_reports == 2) {
 	    double old_time, new_time;
 	    if (diff->num_tests == 1) {
-		printf ("Only in %s: %s %s\n",
-			diff->tests[0]->configuration,
-			diff->tests[0]->backend,
-			diff->tests[0]->name);
+		if (options->format == FORMAT_TEXT) {
+		    printf ("Only in %s: %s %s\n",
+			    diff->tests[0]->configuration,
+			    diff->tests[0]->backend,
+			    diff->tests[0]->name);
+		}
+		free (diff->tests);
 		continue;
 	    }
 	    old_time = diff->tests[0]->stats.min_ticks;
@@ -325,12 +510,16 @@ cairo_perf_reports_compare (cairo_perf_report_t 	*reports,
 	    diff->change = old_time / new_time;
 	    if (diff->change < 1.0)
 		diff->change = - 1.0 / diff->change;
+
+	    test_diff_compute_significance (diff, options);
+	    if (test_diff_is_regression (diff, options))
+		num_regressions++;
 	}
 
 	diff++;
 	num_diffs++;
     }
-    if (num_diffs == 0)
+    if (num_diffs == 0 && options->format == FORMAT_TEXT)
 	goto DONE;
 
     if (num_reports == 2)
@@ -345,6 +534,28 @@ cairo_perf_reports_compare (cairo_perf_report_t 	*reports,
 	    max_change = fabs (diffs[i].change);
     }
 
+    if (options->format == FORMAT_JSON) {
+	printf ("{\n  \"old\": ");
+	print_json_string (reports[0].configuration);
+	printf (",\n  \"new\": ");
+	print_json_string (reports[1].configuration);
+	printf (",\n  \"units\": \"ms\",\n  \"tests\": [\n");
+	for (i = 0; i < num_diffs; i++)
+	    test_diff_print_json (&diffs[i], options, i == 0);
+	printf ("\n  ],\n  \"regressions\": %d\n}\n", num_regressions);
+	goto DONE;
+    }
+
+    if (options->format == FORMAT_CSV) {
+	printf ("backend,content,name,size,"
+		"old_min,old_median,old_stddev,"
+		"new_min,new_median,new_stddev,"
+		"change,p_value,ci_low,ci_high,regression\n");
+	for (i = 0; i < num_diffs; i++)
+	    test_diff_print_csv (&diffs[i], options);
+	goto DONE;
+    }
+
     if (num_reports == 2)
 	printf ("old: %s\n"
 		"new: %s\n",
@@ -377,11 +588,19 @@ cairo_perf_reports_compare (cairo_perf_report_t 	*reports,
 	}
     }
 
+    if (num_regressions) {
+	printf ("\n%d significant slowdown%s beyond %.0f%%\n",
+		num_regressions, num_regressions > 1 ? "s" : "",
+		options->fail_threshold * 100);
+    }
+
  DONE:
     for (i = 0; i < num_diffs; i++)
 	free (diffs[i].tests);
     free (diffs);
     free (tests);
+
+    return num_regressions;
 }
 
 static void
@@ -410,6 +629,22 @@ usage (const char *argv0)
 	     "            The default threshold of 0.05 or 5%% ignores any\n"
 	     "            speedup or slowdown of 1.05 or less. A threshold\n"
 	     "            of 0 will cause all output to be reported.\n"
+	     "\n"
+	     "--format text|json|csv\n"
+	     "            Select the output format. JSON and CSV list every\n"
+	     "            test regardless of --min-change, along with the\n"
+	     "            significance of the change. Requires two reports.\n"
+	     "\n"
+	     "--alpha level\n"
+	     "            The significance level of the Mann-Whitney test\n"
+	     "            on the raw samples (default 0.05).\n"
+	     "\n"
+	     "--fail-on-slowdown threshold[%%]\n"
+	     "            Exit with status 2 if any test slowed down by more\n"
+	     "            than the threshold and the slowdown is significant,\n"
+	     "            i.e. the samples differ at the chosen level and the\n"
+	     "            95%% bootstrap confidence interval of the speedup lies\n"
+	     "            below 1. Requires two reports.\n"
 	);
     exit(1);
 }
@@ -448,6 +683,44 @@ parse_args (int 			   argc,
 		}
 	    }
 	}
+	else if (strcmp (argv[i], "--fail-on-slowdown") == 0) {
+	    char *end = NULL;
+	    i++;
+	    if (i >= argc)
+		usage (argv[0]);
+	    args->options.fail_threshold = strtod (argv[i], &end);
+	    if (*end) {
+		if (*end == '%') {
+		    args->options.fail_threshold /= 100;
+		} else {
+		    usage (argv[0]);
+		}
+	    }
+	    if (args->options.fail_threshold < 0)
+		usage (argv[0]);
+	}
+	else if (strcmp (argv[i], "--alpha") == 0) {
+	    char *end = NULL;
+	    i++;
+	    if (i >= argc)
+		usage (argv[0]);
+	    args->options.alpha = strtod (argv[i], &end);
+	    if (*end || args->options.alpha <= 0 || args->options.alpha >= 1)
+		usage (argv[0]);
+	}
+	else if (strcmp (argv[i], "--format") == 0) {
+	    i++;
+	    if (i >= argc)
+		usage (argv[0]);
+	    if (strcmp (argv[i], "text") == 0)
+		args->options.format = FORMAT_TEXT;
+	    else if (strcmp (argv[i], "json") == 0)
+		args->options.format = FORMAT_JSON;
+	    else if (strcmp (argv[i], "csv") == 0)
+		args->options.format = FORMAT_CSV;
+	    else
+		usage (argv[0]);
+	}
 	else {
 	    args->num_filenames++;
 	    args->filenames = xrealloc (args->filenames,
@@ -468,10 +741,15 @@ main (int	  argc,
 	    0.05,		/* min change */
 	    1,			/* use UTF-8? */
 	    1,			/* display change bars? */
+	    0,			/* use ticks? */
+	    FORMAT_TEXT,	/* format */
+	    0.05,		/* significance level */
+	    -1,			/* fail on slowdowns beyond */
 	}
     };
     cairo_perf_report_t *reports;
     test_report_t *t;
+    int num_regressions;
     int i;
 
     parse_args (argc, argv, &args);
@@ -479,15 +757,28 @@ main (int	  argc,
     if (args.num_filenames < 2)
 	usage (argv[0]);
 
+    if (args.num_filenames > 2 &&
+	(args.options.format != FORMAT_TEXT ||
+	 args.options.fail_threshold >= 0))
+    {
+	fprintf (stderr,
+		 "--format and --fail-on-slowdown compare exactly two reports.\n");
+	return 1;
+    }
+
     reports = xmalloc (args.num_filenames * sizeof (cairo_perf_report_t));
 
     for (i = 0; i < args.num_filenames; i++ ) {
 	cairo_perf_report_load (&reports[i], args.filenames[i], i, NULL);
-	printf ("[%d] %s\n", i, args.filenames[i]);
+	if (args.options.format == FORMAT_TEXT)
+	    printf ("[%d] %s\n", i, args.filenames[i]);
     }
-    printf ("\n");
+    if (args.options.format == FORMAT_TEXT)
+	printf ("\n");
 
-    cairo_perf_reports_compare (reports, args.num_filenames, &args.options);
+    num_regressions = cairo_perf_reports_compare (reports,
+						  args.num_filenames,
+						  &args.options);
 
     /* Pointless memory cleanup, (would be a great place for talloc) */
     free (args.filenames);
@@ -502,5 +793,5 @@ main (int	  argc,
     }
     free (reports);
 
-    return 0;
+    return num_regressions ? 2 : 0;
 }
@@ -0,0 +1,738 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * the authors not be used in advertising or publicity pertaining to
+ * distribution of the software without specific, written prior
+ * permission. The authors make no representations about the
+ * suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE AUTHORS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR
+ * IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* Memory accounting for cairo-perf-trace -m.
+ *
+ * Like util/malloc-stats.c, but built into the replay tool so that the
+ * statistics can be collected per trace: the allocator entry points
+ * are overridden here, forwarding to the glibc implementation, and
+ * whilst accounting is enabled every allocation is recorded against
+ * the address it was made from. The sites are only resolved to names,
+ * and from there to cairo subsystems, when the report is printed.
+ *
+ * The names are read from the symbol table of each library, as the
+ * dynamic symbols that backtrace_symbols() relies upon do not include
+ * cairo's hidden functions.
+ *
+ * Interposing the allocator slows down every replay, so the overrides
+ * are only built when CAIRO_PERF_MEMORY is defined; otherwise -m
+ * reports that accounting is unavailable.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "cairo-perf.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CAIRO_PERF_MEMORY && defined(__GLIBC__) && defined(__linux__)
+#define HAVE_MALLOC_ACCOUNTING 1
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#define HAVE_MALLOC_ACCOUNTING 0
+#endif
+
+#if HAVE_MALLOC_ACCOUNTING
+
+struct site {
+    const void *caller;
+    unsigned long count;
+    unsigned long long bytes;
+};
+
+/* Fixed size so that recording never needs to allocate itself; the
+ * last slot collects whatever does not fit. */
+#define NUM_SITES 8192
+static struct site sites[NUM_SITES];
+static int num_sites;
+
+/* The addresses of the blocks allocated whilst accounting, so that
+ * only those count against the live total when freed. Open addressing
+ * with linear probing; should it ever fill, further blocks are left
+ * out of the live total altogether. */
+#define NUM_BLOCKS (1 << 20)
+static void *blocks[NUM_BLOCKS];
+static unsigned long num_blocks;
+
+/* Guards all of the above and below, as cairo may allocate from
+ * several threads whilst replaying. */
+static pthread_mutex_t accounting_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int enabled;
+static unsigned long long allocated;
+static unsigned long count;
+static long long live, peak;
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+extern void __libc_free (void *ptr);
+
+static void
+site_add (const void *caller, size_t size)
+{
+    unsigned int i, n;
+
+    i = ((uintptr_t) caller >> 4) % (NUM_SITES - 1);
+    for (n = 0; n < NUM_SITES - 1; n++) {
+	if (sites[i].caller == caller)
+	    break;
+	if (sites[i].caller == NULL) {
+	    sites[i].caller = caller;
+	    num_sites++;
+	    break;
+	}
+	if (++i == NUM_SITES - 1)
+	    i = 0;
+    }
+    if (n == NUM_SITES - 1)
+	i = NUM_SITES - 1;
+
+    sites[i].count++;
+    sites[i].bytes += size;
+}
+
+static unsigned int
+block_hash (const void *ptr)
+{
+    return ((uint32_t) ((uintptr_t) ptr >> 4) * 2654435761u) & (NUM_BLOCKS - 1);
+}
+
+static cairo_bool_t
+block_add (void *ptr)
+{
+    unsigned int i;
+
+    /* keep a slot free so that every probe terminates */
+    if (num_blocks == NUM_BLOCKS - 1)
+	return FALSE;
+
+    i = block_hash (ptr);
+    while (blocks[i] != NULL)
+	i = (i + 1) & (NUM_BLOCKS - 1);
+
+    blocks[i] = ptr;
+    num_blocks++;
+    return TRUE;
+}
+
+static cairo_bool_t
+block_remove (void *ptr)
+{
+    unsigned int i, j, k;
+
+    i = block_hash (ptr);
+    while (blocks[i] != ptr) {
+	if (blocks[i] == NULL)
+	    return FALSE;
+	i = (i + 1) & (NUM_BLOCKS - 1);
+    }
+
+    /* Shift the following entries back into the hole, unless that
+     * would move them before their own slot. */
+    j = i;
+    for (;;) {
+	j = (j + 1) & (NUM_BLOCKS - 1);
+	if (blocks[j] == NULL)
+	    break;
+
+	k = block_hash (blocks[j]);
+	if (i < j ? (k <= i || k > j) : (k <= i && k > j)) {
+	    blocks[i] = blocks[j];
+	    i = j;
+	}
+    }
+    blocks[i] = NULL;
+    num_blocks--;
+
+    return TRUE;
+}
+
+static void
+account_alloc (void *ptr, size_t size, const void *caller)
+{
+    pthread_mutex_lock (&accounting_mutex);
+    if (enabled) {
+	allocated += size;
+	count++;
+	site_add (caller, size);
+
+	if (block_add (ptr)) {
+	    live += malloc_usable_size (ptr);
+	    if (live > peak)
+		peak = live;
+	}
+    }
+    pthread_mutex_unlock (&accounting_mutex);
+}
+
+/* Called before the block is released, whilst its address cannot yet
+ * be handed out again to another thread. */
+static void
+account_free (void *ptr)
+{
+    pthread_mutex_lock (&accounting_mutex);
+    if (enabled && block_remove (ptr))
+	live -= malloc_usable_size (ptr);
+    pthread_mutex_unlock (&accounting_mutex);
+}
+
+void *
+malloc (size_t size)
+{
+    void *ptr = __libc_malloc (size);
+    if (enabled && ptr != NULL)
+	account_alloc (ptr, size, __builtin_return_address (0));
+    return ptr;
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+    void *ptr = __libc_calloc (nmemb, size);
+    if (enabled && ptr != NULL)
+	account_alloc (ptr, nmemb * size, __builtin_return_address (0));
+    return ptr;
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+    /* should the realloc fail, the block is merely no longer tracked */
+    if (enabled && ptr != NULL)
+	account_free (ptr);
+    ptr = __libc_realloc (ptr, size);
+    if (enabled && ptr != NULL)
+	account_alloc (ptr, size, __builtin_return_address (0));
+    return ptr;
+}
+
+int
+posix_memalign (void **memptr, size_t alignment, size_t size)
+{
+    void *ptr;
+
+    if (alignment % sizeof (void *) != 0 ||
+	(alignment & (alignment - 1)) != 0)
+	return EINVAL;
+
+    ptr = __libc_memalign (alignment, size);
+    if (ptr == NULL)
+	return ENOMEM;
+    if (enabled)
+	account_alloc (ptr, size, __builtin_return_address (0));
+    *memptr = ptr;
+    return 0;
+}
+
+void
+free (void *ptr)
+{
+    if (enabled && ptr != NULL)
+	account_free (ptr);
+    __libc_free (ptr);
+}
+
+static unsigned long long
+read_peak_rss (void)
+{
+    unsigned long long kib = 0;
+    char line[256];
+    FILE *file;
+
+    file = fopen ("/proc/self/status", "r");
+    if (file == NULL)
+	return 0;
+
+    while (fgets (line, sizeof (line), file)) {
+	if (sscanf (line, "VmHWM: %llu kB", &kib) == 1)
+	    break;
+    }
+    fclose (file);
+
+    return kib * 1024;
+}
+
+static cairo_bool_t
+reset_peak_rss (void)
+{
+    FILE *file;
+    cairo_bool_t ret;
+
+    /* Linux 4.0 resets VmHWM to the current RSS on '5' */
+    file = fopen ("/proc/self/clear_refs", "w");
+    if (file == NULL)
+	return FALSE;
+
+    ret = fputs ("5", file) >= 0;
+    if (fclose (file))
+	ret = FALSE;
+
+    return ret;
+}
+
+cairo_bool_t
+cairo_perf_memory_start (void)
+{
+    pthread_mutex_lock (&accounting_mutex);
+    memset (sites, 0, sizeof (sites));
+    num_sites = 0;
+    memset (blocks, 0, sizeof (blocks));
+    num_blocks = 0;
+    allocated = 0;
+    count = 0;
+    live = peak = 0;
+    pthread_mutex_unlock (&accounting_mutex);
+
+    /* outside the lock, as fopen() allocates */
+    reset_peak_rss ();
+
+    pthread_mutex_lock (&accounting_mutex);
+    enabled = TRUE;
+    pthread_mutex_unlock (&accounting_mutex);
+
+    return TRUE;
+}
+
+void
+cairo_perf_memory_stop (cairo_perf_memory_t *stats)
+{
+    pthread_mutex_lock (&accounting_mutex);
+    enabled = FALSE;
+    stats->peak_heap = peak;
+    stats->allocated = allocated;
+    stats->count = count;
+    pthread_mutex_unlock (&accounting_mutex);
+
+    stats->peak_rss = read_peak_rss ();
+}
+
+/* The symbol table of a loaded library, or of the executable. */
+struct object {
+    ElfW(Addr) base;
+    const char *name;
+    void *map;
+    size_t size;
+    const ElfW(Sym) *syms;
+    unsigned long num_syms;
+    const char *strings;
+    size_t strings_size;
+};
+
+#if __ELF_NATIVE_CLASS == 64
+#define ELFCLASS_NATIVE ELFCLASS64
+#else
+#define ELFCLASS_NATIVE ELFCLASS32
+#endif
+
+#define MAX_OBJECTS 64
+static struct object objects[MAX_OBJECTS];
+static int num_objects;
+
+static void
+object_load_symbols (struct object *object, const char *filename)
+{
+    const ElfW(Ehdr) *ehdr;
+    const ElfW(Shdr) *shdrs;
+    struct stat st;
+    int fd, pass, n;
+
+    object->map = NULL;
+    object->syms = NULL;
+    object->num_syms = 0;
+
+    fd = open (filename, O_RDONLY);
+    if (fd == -1)
+	return;
+    if (fstat (fd, &st) == 0 && st.st_size >= (off_t) sizeof (ElfW(Ehdr))) {
+	object->size = st.st_size;
+	object->map = mmap (NULL, object->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (object->map == MAP_FAILED)
+	    object->map = NULL;
+    }
+    close (fd);
+    if (object->map == NULL)
+	return;
+
+    ehdr = object->map;
+    if (memcmp (ehdr->e_ident, ELFMAG, SELFMAG) != 0 ||
+	ehdr->e_ident[EI_CLASS] != ELFCLASS_NATIVE ||
+	ehdr->e_shentsize != sizeof (ElfW(Shdr)) ||
+	ehdr->e_shoff > object->size ||
+	ehdr->e_shnum > (object->size - ehdr->e_shoff) / sizeof (ElfW(Shdr)))
+    {
+	return;
+    }
+    shdrs = (const ElfW(Shdr) *) ((const char *) object->map + ehdr->e_shoff);
+
+    /* prefer the full symbol table, should the library not be stripped */
+    for (pass = 0; pass < 2 && object->syms == NULL; pass++) {
+	for (n = 0; n < ehdr->e_shnum; n++) {
+	    const ElfW(Shdr) *symtab = &shdrs[n], *strtab;
+
+	    if (symtab->sh_type != (pass == 0 ? SHT_SYMTAB : SHT_DYNSYM))
+		continue;
+	    if (symtab->sh_link >= ehdr->e_shnum)
+		continue;
+
+	    strtab = &shdrs[symtab->sh_link];
+	    if (symtab->sh_offset > object->size ||
+		symtab->sh_size > object->size - symtab->sh_offset ||
+		strtab->sh_offset > object->size ||
+		strtab->sh_size > object->size - strtab->sh_offset)
+	    {
+		continue;
+	    }
+
+	    object->syms = (const ElfW(Sym) *)
+		((const char *) object->map + symtab->sh_offset);
+	    object->num_syms = symtab->sh_size / sizeof (ElfW(Sym));
+	    object->strings = (const char *) object->map + strtab->sh_offset;
+	    object->strings_size = strtab->sh_size;
+	    break;
+	}
+    }
+}
+
+struct object_match {
+    ElfW(Addr) address;
+    ElfW(Addr) base;
+    const char *filename;
+};
+
+static int
+find_object (struct dl_phdr_info *info, size_t size, void *closure)
+{
+    struct object_match *match = closure;
+    int n;
+
+    for (n = 0; n < info->dlpi_phnum; n++) {
+	const ElfW(Phdr) *phdr = &info->dlpi_phdr[n];
+	ElfW(Addr) start = info->dlpi_addr + phdr->p_vaddr;
+
+	if (phdr->p_type == PT_LOAD &&
+	    match->address >= start &&
+	    match->address < start + phdr->p_memsz)
+	{
+	    match->base = info->dlpi_addr;
+	    match->filename = info->dlpi_name;
+	    return 1;
+	}
+    }
+
+    return 0;
+}
+
+static struct object *
+object_for_address (ElfW(Addr) address)
+{
+    struct object_match match;
+    struct object *object;
+    const char *name;
+    int n;
+
+    match.address = address;
+    match.filename = NULL;
+    if (! dl_iterate_phdr (find_object, &match))
+	return NULL;
+
+    for (n = 0; n < num_objects; n++) {
+	if (objects[n].base == match.base)
+	    return &objects[n];
+    }
+    if (num_objects == MAX_OBJECTS)
+	return NULL;
+
+    /* the executable is reported without a name */
+    if (match.filename == NULL || *match.filename == '\0') {
+	match.filename = "/proc/self/exe";
+	name = program_invocation_short_name;
+    } else {
+	name = strrchr (match.filename, '/');
+	name = name ? name + 1 : match.filename;
+    }
+
+    object = &objects[num_objects++];
+    object->base = match.base;
+    object->name = name;
+    object_load_symbols (object, match.filename);
+
+    return object;
+}
+
+static void
+unload_objects (void)
+{
+    int n;
+
+    for (n = 0; n < num_objects; n++) {
+	if (objects[n].map != NULL)
+	    munmap (objects[n].map, objects[n].size);
+    }
+    num_objects = 0;
+}
+
+struct site_name {
+    const char *library;
+    const char *symbol;
+    unsigned long offset;
+};
+
+static void
+resolve_site (const void *caller, struct site_name *name)
+{
+    /* the return address may already belong to the next function */
+    ElfW(Addr) address = (ElfW(Addr)) caller - 1;
+    struct object *object;
+    unsigned long n;
+
+    name->library = NULL;
+    name->symbol = NULL;
+    name->offset = (unsigned long) address;
+
+    object = object_for_address (address);
+    if (object == NULL)
+	return;
+
+    name->library = object->name;
+    name->offset = address - object->base;
+
+    for (n = 0; n < object->num_syms; n++) {
+	const ElfW(Sym) *sym = &object->syms[n];
+
+	/* the type is in the same bits for both ELF classes */
+	if (ELF64_ST_TYPE (sym->st_info) != STT_FUNC ||
+	    sym->st_shndx == SHN_UNDEF ||
+	    sym->st_name >= object->strings_size)
+	{
+	    continue;
+	}
+
+	if (name->offset >= sym->st_value &&
+	    name->offset < sym->st_value + sym->st_size)
+	{
+	    name->symbol = object->strings + sym->st_name;
+	    name->offset -= sym->st_value;
+	    return;
+	}
+    }
+}
+
+struct subsystem {
+    const char *pattern;
+    const char *name;
+};
+
+/* Matched against the start of the library name */
+static const struct subsystem library_subsystems[] = {
+    { "libfreetype.", "fonts" },
+    { "libfontconfig.", "fonts" },
+    { "libpixman-", "pixman" },
+    { "libcairo-script-interpreter.", "interpreter" },
+};
+
+/* Matched anywhere within the names of cairo's own functions */
+static const struct subsystem symbol_subsystems[] = {
+    { "_pdf_", "pdf" },
+    { "_ps_", "ps" },
+    { "_svg_", "svg" },
+    { "_type1", "font-subsets" },
+    { "_truetype", "font-subsets" },
+    { "_cff_", "font-subsets" },
+    { "subset", "font-subsets" },
+    { "recording", "recording" },
+    { "scaled_font", "fonts" },
+    { "scaled_glyph", "fonts" },
+    { "_ft_", "fonts" },
+    { "font", "fonts" },
+    { "clip", "clip" },
+    { "path", "paths" },
+    { "polygon", "tessellation" },
+    { "traps", "tessellation" },
+    { "bentley_ottmann", "tessellation" },
+    { "boxes", "tessellation" },
+    { "pattern", "patterns" },
+    { "image", "image" },
+};
+
+static const char *
+subsystem_for_site (const struct site_name *site)
+{
+    int n;
+
+    if (site->library != NULL) {
+	for (n = 0; n < ARRAY_LENGTH (library_subsystems); n++) {
+	    const char *pattern = library_subsystems[n].pattern;
+
+	    if (strncmp (site->library, pattern, strlen (pattern)) == 0)
+		return library_subsystems[n].name;
+	}
+    }
+
+    if (site->symbol != NULL && strstr (site->symbol, "cairo")) {
+	for (n = 0; n < ARRAY_LENGTH (symbol_subsystems); n++) {
+	    if (strstr (site->symbol, symbol_subsystems[n].pattern))
+		return symbol_subsystems[n].name;
+	}
+	return "cairo";
+    }
+
+    if (site->library != NULL && strncmp (site->library, "libcairo.", 9) == 0)
+	return "cairo";
+
+    return "other";
+}
+
+static int
+compare_sites (const void *a, const void *b)
+{
+    const struct site *sa = a, *sb = b;
+
+    if (sa->bytes != sb->bytes)
+	return sa->bytes < sb->bytes ? 1 : -1;
+    return sa->count < sb->count ? 1 : sa->count > sb->count ? -1 : 0;
+}
+
+struct subsystem_total {
+    const char *name;
+    unsigned long count;
+    unsigned long long bytes;
+};
+
+static int
+compare_totals (const void *a, const void *b)
+{
+    const struct subsystem_total *ta = a, *tb = b;
+
+    if (ta->bytes != tb->bytes)
+	return ta->bytes < tb->bytes ? 1 : -1;
+    return strcmp (ta->name, tb->name);
+}
+
+void
+cairo_perf_memory_print_sites (FILE *file, int max_sites)
+{
+    struct site *sorted;
+    struct site_name *names;
+    struct subsystem_total totals[ARRAY_LENGTH (library_subsystems) +
+				  ARRAY_LENGTH (symbol_subsystems) + 2];
+    int num_totals = 0;
+    int n, i, num;
+
+    sorted = xmalloc (NUM_SITES * sizeof (struct site));
+    num = 0;
+    pthread_mutex_lock (&accounting_mutex);
+    for (n = 0; n < NUM_SITES; n++) {
+	if (sites[n].count)
+	    sorted[num++] = sites[n];
+    }
+    pthread_mutex_unlock (&accounting_mutex);
+    qsort (sorted, num, sizeof (struct site), compare_sites);
+
+    names = xmalloc ((num + 1) * sizeof (struct site_name));
+    for (n = 0; n < num; n++)
+	resolve_site (sorted[n].caller, &names[n]);
+
+    for (n = 0; n < num; n++) {
+	const char *name;
+
+	if (sorted[n].caller == NULL)
+	    name = "other";
+	else
+	    name = subsystem_for_site (&names[n]);
+
+	for (i = 0; i < num_totals; i++) {
+	    if (strcmp (totals[i].name, name) == 0)
+		break;
+	}
+	if (i == num_totals) {
+	    totals[i].name = name;
+	    totals[i].count = 0;
+	    totals[i].bytes = 0;
+	    num_totals++;
+	}
+	totals[i].count += sorted[n].count;
+	totals[i].bytes += sorted[n].bytes;
+    }
+
+    qsort (totals, num_totals, sizeof (struct subsystem_total), compare_totals);
+    for (i = 0; i < num_totals; i++) {
+	fprintf (file, "        %-16s %10lu allocations %12llu bytes\n",
+		 totals[i].name, totals[i].count, totals[i].bytes);
+    }
+
+    for (n = 0; n < num && n < max_sites; n++) {
+	fprintf (file, "        %10lu %12llu  ",
+		 sorted[n].count, sorted[n].bytes);
+	if (sorted[n].caller == NULL)
+	    fprintf (file, "(other sites)\n");
+	else if (names[n].symbol != NULL)
+	    fprintf (file, "%s+0x%lx [%s]\n",
+		     names[n].symbol, names[n].offset, names[n].library);
+	else
+	    fprintf (file, "[%s+0x%lx]\n",
+		     names[n].library ? names[n].library : "?",
+		     names[n].offset);
+    }
+
+    /* the names point into the mapped symbol tables */
+    unload_objects ();
+
+    free (names);
+    free (sorted);
+}
+
+#else
+
+cairo_bool_t
+cairo_perf_memory_start (void)
+{
+    return FALSE;
+}
+
+void
+cairo_perf_memory_stop (cairo_perf_memory_t *stats)
+{
+    memset (stats, 0, sizeof (*stats));
+}
+
+void
+cairo_perf_memory_print_sites (FILE *file, int max_sites)
+{
+}
+
+#endif
@@ -48,11 +48,16 @@
 #include <sched.h>
 #endif
 
+#if CAIRO_HAS_REAL_PTHREAD
+#include <pthread.h>
+#endif
+
 #define CAIRO_PERF_ITERATIONS_DEFAULT		100
 #define CAIRO_PERF_LOW_STD_DEV			0.03
 #define CAIRO_PERF_STABLE_STD_DEV_COUNT		5
 #define CAIRO_PERF_ITERATION_MS_DEFAULT		2000
 #define CAIRO_PERF_ITERATION_MS_FAST		5
+#define CAIRO_PERF_SCALING_ROUNDS		3
 
 typedef struct _cairo_perf_case {
     CAIRO_PERF_RUN_DECL (*run);
@@ -162,6 +167,204 @@ cairo_perf_calibrate (cairo_perf_t	*perf,
     return loops;
 }
 
+#if CAIRO_HAS_REAL_PTHREAD
+/* Throughput scaling: the calibrated test is run on several threads at
+ * once, each with its own target surface and context. Everything else,
+ * the font caches, scaled fonts and the pattern and surface freelists,
+ * is shared inside cairo, so any loss of throughput as threads are
+ * added is contention in the library (or the backend).
+ */
+
+struct scaling_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    unsigned int ready;
+    cairo_bool_t go;
+};
+
+struct scaling_thread {
+    pthread_t thread;
+    struct scaling_pool *pool;
+    cairo_perf_t *perf;
+    cairo_perf_func_t perf_func;
+    unsigned int loops;
+
+    cairo_time_t elapsed;
+    cairo_status_t status;
+};
+
+static void
+scaling_thread_wait (struct scaling_pool *pool)
+{
+    pthread_mutex_lock (&pool->mutex);
+    pool->ready++;
+    pthread_cond_broadcast (&pool->cond);
+    while (! pool->go)
+	pthread_cond_wait (&pool->cond, &pool->mutex);
+    pthread_mutex_unlock (&pool->mutex);
+}
+
+static void *
+scaling_thread_run (void *closure)
+{
+    struct scaling_thread *thread = closure;
+    cairo_perf_t *perf = thread->perf;
+    const cairo_boilerplate_target_t *target = perf->target;
+    cairo_surface_t *surface;
+    void *target_closure;
+    cairo_t *cr;
+
+    surface = target->create_surface (NULL,
+				      target->content,
+				      perf->size, perf->size,
+				      perf->size, perf->size,
+				      CAIRO_BOILERPLATE_MODE_PERF,
+				      &target_closure);
+    if (surface == NULL) {
+	thread->status = CAIRO_STATUS_NO_MEMORY;
+	scaling_thread_wait (thread->pool);
+	return NULL;
+    }
+
+    /* the timer is per-thread, see cairo-perf.c */
+    cairo_perf_timer_set_synchronize (target->synchronize, target_closure);
+
+    cr = cairo_create (surface);
+
+    /* warm up the per-surface state before the threads are released */
+    cairo_save (cr);
+    thread->perf_func (cr, perf->size, perf->size, 1);
+    cairo_restore (cr);
+
+    scaling_thread_wait (thread->pool);
+
+    thread->elapsed = thread->perf_func (cr, perf->size, perf->size,
+					 thread->loops);
+
+    thread->status = cairo_status (cr);
+    cairo_destroy (cr);
+    cairo_surface_destroy (surface);
+
+    if (target->cleanup)
+	target->cleanup (target_closure);
+
+    return NULL;
+}
+
+/* Returns the longest time taken by the timed part of num_threads
+ * copies of the test released together, leaving out the setup before
+ * and the teardown after, as the test's own timer does. */
+static cairo_status_t
+scaling_threads (cairo_perf_t	   *perf,
+		 cairo_perf_func_t  perf_func,
+		 unsigned int	    loops,
+		 unsigned int	    num_threads,
+		 cairo_time_t	   *slowest)
+{
+    struct scaling_pool pool;
+    struct scaling_thread *threads;
+    cairo_status_t status;
+    unsigned int n, num_started;
+
+    threads = xcalloc (num_threads, sizeof (struct scaling_thread));
+
+    pthread_mutex_init (&pool.mutex, NULL);
+    pthread_cond_init (&pool.cond, NULL);
+    pool.ready = 0;
+    pool.go = FALSE;
+
+    for (num_started = 0; num_started < num_threads; num_started++) {
+	threads[num_started].pool = &pool;
+	threads[num_started].perf = perf;
+	threads[num_started].perf_func = perf_func;
+	threads[num_started].loops = loops;
+	if (pthread_create (&threads[num_started].thread, NULL,
+			    scaling_thread_run, &threads[num_started]))
+	    break;
+    }
+
+    pthread_mutex_lock (&pool.mutex);
+    while (pool.ready < num_started)
+	pthread_cond_wait (&pool.cond, &pool.mutex);
+    pool.go = TRUE;
+    pthread_cond_broadcast (&pool.cond);
+    pthread_mutex_unlock (&pool.mutex);
+
+    *slowest = 0;
+    for (n = 0; n < num_started; n++) {
+	pthread_join (threads[n].thread, NULL);
+	if (threads[n].elapsed > *slowest)
+	    *slowest = threads[n].elapsed;
+    }
+
+    pthread_cond_destroy (&pool.cond);
+    pthread_mutex_destroy (&pool.mutex);
+
+    status = CAIRO_STATUS_SUCCESS;
+    if (num_started < num_threads)
+	status = CAIRO_STATUS_NO_MEMORY;
+    for (n = 0; n < num_started; n++) {
+	if (threads[n].status && status == CAIRO_STATUS_SUCCESS)
+	    status = threads[n].status;
+    }
+
+    free (threads);
+    return status;
+}
+
+/* Reports ops/sec for 1, 2, 4, ... perf->num_threads concurrent copies
+ * of the test, taking the best of a few rounds for each, along with the
+ * speedup over a single thread and the efficiency (the speedup per
+ * thread); 100% efficiency is perfect scaling. */
+static void
+cairo_perf_run_scaling (cairo_perf_t	   *perf,
+			const char	   *name,
+			cairo_perf_func_t   perf_func,
+			unsigned int	    loops)
+{
+    double base = 0;
+    unsigned int num_threads;
+
+    for (num_threads = 1; ; num_threads *= 2) {
+	cairo_time_t slowest, best = 0;
+	cairo_status_t status;
+	double rate;
+	int round;
+
+	if (num_threads > perf->num_threads)
+	    num_threads = perf->num_threads;
+
+	for (round = 0; round < CAIRO_PERF_SCALING_ROUNDS; round++) {
+	    cairo_perf_yield ();
+	    status = scaling_threads (perf, perf_func, loops, num_threads,
+				      &slowest);
+	    if (status) {
+		fprintf (stderr, "Error: threaded run of %s on %d threads: %s\n",
+			 name, num_threads, cairo_status_to_string (status));
+		return;
+	    }
+	    if (round == 0 || slowest < best)
+		best = slowest;
+	}
+
+	rate = num_threads * loops / _cairo_time_to_s (best);
+	if (num_threads == 1)
+	    base = rate;
+
+	fprintf (perf->summary,
+		 "[%3d] %8s.%-5s %26s.%-3d x%-3d %12.1f ops/s %#6.2fx %#6.1f%%\n",
+		 perf->test_number, perf->target->name,
+		 _content_to_string (perf->target->content, 0),
+		 name, perf->size, num_threads,
+		 rate, rate / base, 100. * rate / base / num_threads);
+	fflush (perf->summary);
+
+	if (num_threads == perf->num_threads)
+	    break;
+    }
+}
+#endif
+
 void
 cairo_perf_run (cairo_perf_t	   *perf,
 		const char	   *name,
@@ -223,6 +426,8 @@ cairo_perf_run (cairo_perf_t	   *perf,
 	similar_iters = 1;
 
     for (similar = 0; similar < similar_iters; similar++) {
+	cairo_time_t fastest_time = 0;
+	unsigned int fastest = 0;
 	unsigned loops;
 
 	if (perf->summary) {
@@ -257,6 +462,15 @@ cairo_perf_run (cairo_perf_t	   *perf,
 	    else
 		cairo_save (perf->cr);
 	    times[i] = perf_func (perf->cr, perf->size, perf->size, loops) ;
+	    if (perf->counters) {
+		/* times[] is sorted in place by _cairo_stats_compute(),
+		 * so note the fastest iteration as it is taken */
+		cairo_perf_timer_counters (&perf->counts[i]);
+		if (i == 0 || times[i] < fastest_time) {
+		    fastest_time = times[i];
+		    fastest = i;
+		}
+	    }
 	    if (similar)
 		cairo_pattern_destroy (cairo_pop_group (perf->cr));
 	    else
@@ -308,9 +522,18 @@ cairo_perf_run (cairo_perf_t	   *perf,
 			 _cairo_time_to_s (stats.median_ticks) * 1000.0 / loops,
 			 stats.std_dev * 100.0, stats.iterations);
 	    }
+	    if (perf->counters) {
+		cairo_perf_counters_print (perf->summary,
+					   &perf->counts[fastest], loops);
+	    }
 	    fflush (perf->summary);
 	}
 
+#if CAIRO_HAS_REAL_PTHREAD
+	if (perf->num_threads > 1 && ! similar && perf->summary)
+	    cairo_perf_run_scaling (perf, name, perf_func, loops);
+#endif
+
 	perf->test_number++;
     }
 }
@@ -319,13 +542,17 @@ static void
 usage (const char *argv0)
 {
     fprintf (stderr,
-"Usage: %s [-flrv] [-i iterations] [test-names ...]\n"
+"Usage: %s [-eflrv] [-i iterations] [-j threads] [test-names ...]\n"
 "\n"
 "Run the cairo performance test suite over the given tests (all by default)\n"
 "The command-line arguments are interpreted as follows:\n"
 "\n"
+"  -e	events; also report the hardware counters (cycles, instructions,\n"
+"	cache and branch misses) per loop of the fastest iteration\n"
 "  -f	fast; faster, less accurate\n"
 "  -i	iterations; specify the number of iterations per test case\n"
+"  -j	threads; after each test case also report the throughput of 1, 2, 4,\n"
+"	... up to this many threads each running it on their own surface\n"
 "  -l	list only; just list selected test case names without executing\n"
 "  -r	raw; display each time measurement instead of summary statistics\n"
 "  -v	verbose; in raw mode also show the summaries\n"
@@ -363,13 +590,18 @@ parse_options (cairo_perf_t *perf,
     perf->names = NULL;
     perf->num_names = 0;
     perf->summary = stdout;
+    perf->num_threads = 1;
+    perf->counters = FALSE;
 
     while (1) {
-	c = _cairo_getopt (argc, argv, "fi:lrv");
+	c = _cairo_getopt (argc, argv, "efi:j:lrv");
 	if (c == -1)
 	    break;
 
 	switch (c) {
+	case 'e':
+	    perf->counters = TRUE;
+	    break;
 	case 'f':
 	    perf->fast_and_sloppy = TRUE;
 	    if (ms == NULL)
@@ -384,6 +616,14 @@ parse_options (cairo_perf_t *perf,
 		exit (1);
 	    }
 	    break;
+	case 'j':
+	    perf->num_threads = strtoul (optarg, &end, 10);
+	    if (*end != '\0' || perf->num_threads == 0) {
+		fprintf (stderr, "Invalid argument for -j (not a positive integer): %s\n",
+			 optarg);
+		exit (1);
+	    }
+	    break;
 	case 'l':
 	    perf->list_only = TRUE;
 	    break;
@@ -403,6 +643,13 @@ parse_options (cairo_perf_t *perf,
 	}
     }
 
+#if ! CAIRO_HAS_REAL_PTHREAD
+    if (perf->num_threads > 1) {
+	fprintf (stderr, "Throughput scaling (-j) requires pthreads. Sorry.\n");
+	exit (1);
+    }
+#endif
+
     if (verbose && perf->summary == NULL)
 	perf->summary = stderr;
 
@@ -453,6 +700,8 @@ cairo_perf_fini (cairo_perf_t *perf)
     cairo_boilerplate_fini ();
 
     free (perf->times);
+    free (perf->counts);
+    cairo_perf_counters_disable ();
     cairo_debug_reset_static_data ();
 #if HAVE_FCFINI
     FcFini ();
@@ -470,7 +719,8 @@ main (int   argc,
 
     parse_options (&perf, argc, argv);
 
-    if (check_cpu_affinity()) {
+    /* scaling runs want all the CPUs they can get */
+    if (perf.num_threads == 1 && check_cpu_affinity()) {
 	fputs(
 	    "NOTICE: cairo-perf and the X server should be bound to CPUs (either the same\n"
 	    "or separate) on SMP systems. Not doing so causes random results when the X\n"
@@ -485,6 +735,16 @@ main (int   argc,
 
     perf.targets = cairo_boilerplate_get_targets (&perf.num_targets, NULL);
     perf.times = xmalloc (perf.iterations * sizeof (cairo_time_t));
+    perf.counts = NULL;
+    if (perf.counters) {
+	if (cairo_perf_counters_enable ()) {
+	    perf.counts = xmalloc (perf.iterations * sizeof (cairo_perf_counters_t));
+	} else {
+	    fprintf (stderr,
+		     "WARNING: hardware counters are unavailable (see perf_event_paranoid).\n");
+	    perf.counters = FALSE;
+	}
+    }
 
     for (i = 0; i < perf.num_targets; i++) {
 	const cairo_boilerplate_target_t *target = perf.targets[i];
@@ -589,6 +849,7 @@ const cairo_perf_case_t perf_cases[] = {
     { FUNC(spiral), 512, 512 },
     { FUNC(wave), 500, 500 },
     { FUNC(fill_clip), 16, 512 },
+    { FUNC(recording), 512, 512 },
     { FUNC(tiger), 16, 1024 },
     { NULL }
 };
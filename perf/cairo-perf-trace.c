@@ -98,6 +98,10 @@ basename_no_ext (char *path)
 #include <fontconfig/fontconfig.h>
 #endif
 
+#if CAIRO_HAS_REAL_PTHREAD
+#include <pthread.h>
+#endif
+
 #define CAIRO_PERF_ITERATIONS_DEFAULT	15
 #define CAIRO_PERF_LOW_STD_DEV		0.05
 #define CAIRO_PERF_MIN_STD_DEV_COUNT	3
@@ -368,14 +372,25 @@ static void
 usage (const char *argv0)
 {
     fprintf (stderr,
-"Usage: %s [-clrsv] [-i iterations] [-t tile-size] [-x exclude-file] [test-names ... | traces ...]\n"
+"Usage: %s [-CceLlmrsv] [-i iterations] [-j threads] [-t tile-size] [-x exclude-file] [test-names ... | traces ...]\n"
 "\n"
 "Run the cairo performance test suite over the given tests (all by default)\n"
 "The command-line arguments are interpreted as follows:\n"
 "\n"
+"  -C	compile; scan each trace once and time only the execution of the\n"
+"   	resolved operators on every iteration\n"
 "  -c	use surface cache; keep a cache of surfaces to be reused\n"
+"  -e	events; also report the hardware counters (cycles, instructions,\n"
+"   	cache and branch misses) of the fastest replay, where available\n"
 "  -i	iterations; specify the number of iterations per test case\n"
+"  -j	threads; replay that many copies of each trace concurrently, each on\n"
+"   	its own thread and target, and report the throughput and latencies\n"
+"  -L	locks; after each trace show how often cairo's mutexes were\n"
+"   	contended (requires cairo built with CAIRO_MUTEX_STATS)\n"
 "  -l	list only; just list selected test case names without executing\n"
+"  -m	memory; replay each trace once and report its peak memory use,\n"
+"   	the bytes and number of allocations and the top allocation sites\n"
+"   	(requires cairo-perf-trace built with CAIRO_PERF_MEMORY)\n"
 "  -r	raw; display each time measurement instead of summary statistics\n"
 "  -s	sync; only sum the elapsed time of the indiviual operations\n"
 "  -t	tile size; draw to tiled surfaces\n"
@@ -452,6 +467,11 @@ parse_options (cairo_perf_t *perf,
     perf->observe = FALSE;
     perf->list_only = FALSE;
     perf->tile_size = 0;
+    perf->num_threads = 1;
+    perf->lock_stats = FALSE;
+    perf->compile = FALSE;
+    perf->memory = FALSE;
+    perf->counters = FALSE;
     perf->names = NULL;
     perf->num_names = 0;
     perf->summary = stdout;
@@ -460,14 +480,20 @@ parse_options (cairo_perf_t *perf,
     perf->num_exclude_names = 0;
 
     while (1) {
-	c = _cairo_getopt (argc, argv, "ci:lrst:vx:");
+	c = _cairo_getopt (argc, argv, "Ccei:j:Llmrst:vx:");
 	if (c == -1)
 	    break;
 
 	switch (c) {
+	case 'C':
+	    perf->compile = TRUE;
+	    break;
 	case 'c':
 	    use_surface_cache = 1;
 	    break;
+	case 'e':
+	    perf->counters = TRUE;
+	    break;
 	case 'i':
 	    perf->exact_iterations = TRUE;
 	    perf->iterations = strtoul (optarg, &end, 10);
@@ -477,9 +503,23 @@ parse_options (cairo_perf_t *perf,
 		exit (1);
 	    }
 	    break;
+	case 'j':
+	    perf->num_threads = strtoul (optarg, &end, 10);
+	    if (*end != '\0' || perf->num_threads == 0) {
+		fprintf (stderr, "Invalid argument for -j (not a positive integer): %s\n",
+			 optarg);
+		exit (1);
+	    }
+	    break;
+	case 'L':
+	    perf->lock_stats = TRUE;
+	    break;
 	case 'l':
 	    perf->list_only = TRUE;
 	    break;
+	case 'm':
+	    perf->memory = TRUE;
+	    break;
 	case 'r':
 	    perf->raw = TRUE;
 	    perf->summary = NULL;
@@ -519,6 +559,19 @@ parse_options (cairo_perf_t *perf,
 	exit (1);
     }
 
+    if (perf->num_threads > 1) {
+#if CAIRO_HAS_REAL_PTHREAD
+	if (perf->observe || perf->tile_size || use_surface_cache) {
+	    fprintf (stderr,
+		     "Can't mix threads with the observer, tiling or the surface cache. Sorry.\n");
+	    exit (1);
+	}
+#else
+	fprintf (stderr, "Threaded replay (-j) requires pthreads. Sorry.\n");
+	exit (1);
+#endif
+    }
+
     if (verbose && perf->summary == NULL)
 	perf->summary = stderr;
 #if HAVE_UNISTD_H
@@ -542,6 +595,8 @@ cairo_perf_fini (cairo_perf_t *perf)
     cairo_boilerplate_fini ();
 
     free (perf->times);
+    free (perf->counts);
+    cairo_perf_counters_disable ();
     cairo_debug_reset_static_data ();
 #if HAVE_FCFINI
     FcFini ();
@@ -638,6 +693,478 @@ _tiling_surface_create (void		 *closure,
     return observer;
 }
 
+#if CAIRO_HAS_REAL_PTHREAD
+/* Threaded replay: every thread replays its own copy of the trace onto
+ * its own target surface, so any interference between them comes from
+ * state shared inside cairo (font maps, caches, freed pools, ...).
+ */
+
+struct replay_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    unsigned int ready;
+    cairo_bool_t go;
+};
+
+struct replay_thread {
+    pthread_t thread;
+    struct replay_pool *pool;
+    const cairo_boilerplate_target_t *target;
+    const char *trace;
+
+    cairo_time_t elapsed;
+    cairo_status_t status;
+    unsigned int line_no;
+};
+
+static void
+replay_thread_wait (struct replay_pool *pool)
+{
+    pthread_mutex_lock (&pool->mutex);
+    pool->ready++;
+    pthread_cond_broadcast (&pool->cond);
+    while (! pool->go)
+	pthread_cond_wait (&pool->cond, &pool->mutex);
+    pthread_mutex_unlock (&pool->mutex);
+}
+
+static void *
+replay_thread_run (void *closure)
+{
+    struct replay_thread *thread = closure;
+    const cairo_boilerplate_target_t *target = thread->target;
+    struct trace args = { target };
+    const cairo_script_interpreter_hooks_t hooks = {
+	&args,
+	_similar_surface_create,
+	NULL, /* surface_destroy */
+	_context_create,
+	NULL, /* context_destroy */
+	NULL, /* show_page */
+	NULL, /* copy_page */
+	_source_image_create,
+    };
+    cairo_script_interpreter_t *csi;
+    cairo_time_t start;
+
+    args.surface = target->create_surface (NULL,
+					   CAIRO_CONTENT_COLOR_ALPHA,
+					   1, 1,
+					   1, 1,
+					   CAIRO_BOILERPLATE_MODE_PERF,
+					   &args.closure);
+    thread->status = cairo_surface_status (args.surface);
+    if (thread->status) {
+	cairo_surface_destroy (args.surface);
+	replay_thread_wait (thread->pool);
+	return NULL;
+    }
+    fill_surface (args.surface); /* remove any clear flags */
+
+    csi = cairo_script_interpreter_create ();
+    cairo_script_interpreter_install_hooks (csi, &hooks);
+
+    replay_thread_wait (thread->pool);
+
+    start = _cairo_time_get ();
+
+    cairo_script_interpreter_run (csi, thread->trace);
+    thread->line_no = cairo_script_interpreter_get_line_number (csi);
+    cairo_script_interpreter_finish (csi);
+
+    fill_surface (args.surface); /* queue a write to the sync'ed surface */
+    if (target->synchronize)
+	target->synchronize (args.closure);
+
+    thread->elapsed = _cairo_time_get_delta (start);
+
+    cairo_surface_destroy (args.surface);
+    if (target->cleanup)
+	target->cleanup (args.closure);
+
+    thread->status = cairo_script_interpreter_destroy (csi);
+    return NULL;
+}
+
+/* Replays num_threads copies of the trace at once. Returns the wall
+ * time from the moment all threads were released until the last one
+ * finished, and the latency of each replay in latency[].
+ */
+static cairo_status_t
+replay_threads (const cairo_boilerplate_target_t *target,
+		const char *trace,
+		struct replay_thread *threads,
+		unsigned int num_threads,
+		cairo_time_t *wall,
+		cairo_time_t *latency,
+		unsigned int *line_no)
+{
+    struct replay_pool pool;
+    cairo_status_t status;
+    cairo_time_t start;
+    unsigned int n, num_started;
+
+    pthread_mutex_init (&pool.mutex, NULL);
+    pthread_cond_init (&pool.cond, NULL);
+    pool.ready = 0;
+    pool.go = FALSE;
+
+    for (num_started = 0; num_started < num_threads; num_started++) {
+	threads[num_started].pool = &pool;
+	threads[num_started].target = target;
+	threads[num_started].trace = trace;
+	threads[num_started].elapsed = 0;
+	threads[num_started].line_no = 0;
+	if (pthread_create (&threads[num_started].thread, NULL,
+			    replay_thread_run, &threads[num_started]))
+	    break;
+    }
+
+    pthread_mutex_lock (&pool.mutex);
+    while (pool.ready < num_started)
+	pthread_cond_wait (&pool.cond, &pool.mutex);
+    start = _cairo_time_get ();
+    pool.go = TRUE;
+    pthread_cond_broadcast (&pool.cond);
+    pthread_mutex_unlock (&pool.mutex);
+
+    for (n = 0; n < num_started; n++)
+	pthread_join (threads[n].thread, NULL);
+    *wall = _cairo_time_get_delta (start);
+
+    pthread_cond_destroy (&pool.cond);
+    pthread_mutex_destroy (&pool.mutex);
+
+    if (num_started < num_threads)
+	return CAIRO_STATUS_NO_MEMORY;
+
+    status = CAIRO_STATUS_SUCCESS;
+    for (n = 0; n < num_threads; n++) {
+	latency[n] = threads[n].elapsed;
+	if (threads[n].status && status == CAIRO_STATUS_SUCCESS) {
+	    status = threads[n].status;
+	    *line_no = threads[n].line_no;
+	}
+    }
+
+    return status;
+}
+
+/* Runs rounds of num_threads concurrent replays until the wall times
+ * are stable or the iterations are exhausted, and returns the number of
+ * rounds, or -1 after reporting an error.
+ */
+static int
+replay_rounds (cairo_perf_t *perf,
+	       const cairo_boilerplate_target_t *target,
+	       const char *trace,
+	       unsigned int num_threads,
+	       cairo_time_t *wall,
+	       cairo_time_t *latency)
+{
+    struct replay_thread *threads;
+    cairo_stats_t stats;
+    cairo_status_t status;
+    unsigned int line_no = 0;
+    int low_std_dev_count = 0;
+    unsigned int i;
+
+    threads = xcalloc (num_threads, sizeof (struct replay_thread));
+
+    for (i = 0; i < perf->iterations && ! user_interrupt; i++) {
+	status = replay_threads (target, trace, threads, num_threads,
+				 &wall[i], &latency[i * num_threads],
+				 &line_no);
+	if (status) {
+	    if (perf->summary) {
+		fprintf (perf->summary, "Error during replay, line %d: %s\n",
+			 line_no,
+			 cairo_status_to_string (status));
+	    }
+	    free (threads);
+	    return -1;
+	}
+
+	if (perf->raw) {
+	    printf (" %lld", (long long) wall[i]);
+	    fflush (stdout);
+	} else if (! perf->exact_iterations) {
+	    if (i > CAIRO_PERF_MIN_STD_DEV_COUNT) {
+		_cairo_stats_compute (&stats, wall, i+1);
+
+		if (stats.std_dev <= CAIRO_PERF_LOW_STD_DEV) {
+		    if (++low_std_dev_count >= CAIRO_PERF_STABLE_STD_DEV_COUNT) {
+			i++;
+			break;
+		    }
+		} else {
+		    low_std_dev_count = 0;
+		}
+	    }
+	}
+    }
+
+    free (threads);
+    return i;
+}
+
+static int
+compare_time (const void *a, const void *b)
+{
+    cairo_time_t ta = *(const cairo_time_t *) a;
+    cairo_time_t tb = *(const cairo_time_t *) b;
+
+    return ta < tb ? -1 : ta > tb;
+}
+
+static double
+percentile_s (const cairo_time_t *sorted, int count, double p)
+{
+    int i = ceil (p * count) - 1;
+
+    if (i < 0)
+	i = 0;
+    if (i >= count)
+	i = count - 1;
+
+    return _cairo_time_to_s (sorted[i]);
+}
+
+static void
+cairo_perf_trace_threads (cairo_perf_t			   *perf,
+			  const cairo_boilerplate_target_t *target,
+			  const char			   *name,
+			  const char			   *trace)
+{
+    static cairo_bool_t first_run = TRUE;
+    unsigned int num_threads = perf->num_threads;
+    cairo_time_t *wall, *latency;
+    cairo_stats_t stats;
+    double baseline, median;
+    int count;
+
+    if (first_run) {
+	if (perf->raw) {
+	    printf ("[ # ] %s.%-s %s %s %s ...\n",
+		    "backend", "content", "test-threads", "ticks-per-ms", "wall-time(ticks)");
+	}
+
+	if (perf->summary) {
+	    fprintf (perf->summary,
+		     "[ # ] %8s %28s %7s %8s %9s %8s %8s %8s %10s %7s %5s\n",
+		     "backend", "test", "threads", "min(s)", "median(s)",
+		     "p50(s)", "p90(s)", "p99(s)",
+		     "replays/s", "scaling", "count");
+	}
+	first_run = FALSE;
+    }
+
+    if (perf->summary) {
+	fprintf (perf->summary,
+		 "[%3d] %8s %28s ",
+		 perf->test_number,
+		 perf->target->name,
+		 name);
+	fflush (perf->summary);
+    }
+
+    wall = xmalloc (perf->iterations * sizeof (cairo_time_t));
+    latency = xmalloc (perf->iterations * num_threads * sizeof (cairo_time_t));
+
+    /* The scaling efficiency compares against a lone replay */
+    if (perf->raw) {
+	printf ("[*] %s.%s %s.%d %g",
+		perf->target->name,
+		"rgba",
+		name,
+		1,
+		_cairo_time_to_double (_cairo_time_from_s (1)) / 1000.);
+	fflush (stdout);
+    }
+
+    count = replay_rounds (perf, target, trace, 1, wall, latency);
+    if (count <= 0)
+	goto out;
+    _cairo_stats_compute (&stats, wall, count);
+    baseline = _cairo_time_to_s (stats.median_ticks);
+
+    if (perf->raw) {
+	printf ("\n[*] %s.%s %s.%d %g",
+		perf->target->name,
+		"rgba",
+		name,
+		num_threads,
+		_cairo_time_to_double (_cairo_time_from_s (1)) / 1000.);
+	fflush (stdout);
+    }
+
+    count = replay_rounds (perf, target, trace, num_threads, wall, latency);
+    if (count <= 0)
+	goto out;
+
+    if (perf->summary) {
+	_cairo_stats_compute (&stats, wall, count);
+	median = _cairo_time_to_s (stats.median_ticks);
+
+	qsort (latency, count * num_threads, sizeof (cairo_time_t), compare_time);
+
+	fprintf (perf->summary,
+		 "%7d %#8.3f %#9.3f %#8.3f %#8.3f %#8.3f %#10.2f %#6.1f%% %5d\n",
+		 num_threads,
+		 _cairo_time_to_s (stats.min_ticks),
+		 median,
+		 percentile_s (latency, count * num_threads, .50),
+		 percentile_s (latency, count * num_threads, .90),
+		 percentile_s (latency, count * num_threads, .99),
+		 num_threads / median,
+		 100. * baseline / median,
+		 count);
+	fflush (perf->summary);
+    }
+
+out:
+    if (count == 0 && perf->summary)
+	fprintf (perf->summary, "\n");
+
+    user_interrupt = 0;
+    if (perf->raw) {
+	printf ("\n");
+	fflush (stdout);
+    }
+
+    free (latency);
+    free (wall);
+}
+#endif
+
+#define MEMORY_TOP_SITES 10
+
+/* A single replay with the allocator accounting enabled; the report
+ * includes the creation and destruction of the target.
+ */
+static void
+cairo_perf_trace_memory (cairo_perf_t			   *perf,
+			 const cairo_boilerplate_target_t *target,
+			 const char			   *name,
+			 const char			   *trace)
+{
+    static cairo_bool_t first_run = TRUE;
+    struct trace args = { target };
+    const cairo_script_interpreter_hooks_t hooks = {
+	&args,
+	perf->tile_size ? _tiling_surface_create : _similar_surface_create,
+	NULL, /* surface_destroy */
+	_context_create,
+	NULL, /* context_destroy */
+	NULL, /* show_page */
+	NULL, /* copy_page */
+	_source_image_create,
+    };
+    cairo_script_interpreter_t *csi;
+    cairo_perf_memory_t memory;
+    cairo_status_t status;
+    unsigned int line_no;
+
+    if (perf->summary == NULL)
+	return;
+
+    if (first_run) {
+	fprintf (perf->summary,
+		 "[ # ] %8s %28s %13s %14s %14s %10s\n",
+		 "backend", "test",
+		 "peak-rss(KiB)", "peak-heap(KiB)", "allocated(KiB)", "allocs");
+	first_run = FALSE;
+    }
+
+    fprintf (perf->summary,
+	     "[%3d] %8s %28s ",
+	     perf->test_number,
+	     perf->target->name,
+	     name);
+    fflush (perf->summary);
+
+    args.tile_size = perf->tile_size;
+    args.observe = FALSE;
+
+    if (! cairo_perf_memory_start ()) {
+	fprintf (perf->summary,
+		 "memory accounting is not available; it requires glibc on Linux\n"
+		 "and cairo-perf-trace built with CAIRO_PERF_MEMORY defined\n");
+	return;
+    }
+
+    args.surface = target->create_surface (NULL,
+					   CAIRO_CONTENT_COLOR_ALPHA,
+					   1, 1,
+					   1, 1,
+					   CAIRO_BOILERPLATE_MODE_PERF,
+					   &args.closure);
+    status = cairo_surface_status (args.surface);
+    if (status) {
+	cairo_surface_destroy (args.surface);
+	cairo_perf_memory_stop (&memory);
+	fprintf (perf->summary,
+		 "Error: Failed to create target surface: %s\n",
+		 target->name);
+	return;
+    }
+
+    csi = cairo_script_interpreter_create ();
+    cairo_script_interpreter_install_hooks (csi, &hooks);
+    cairo_script_interpreter_run (csi, trace);
+    line_no = cairo_script_interpreter_get_line_number (csi);
+    cairo_script_interpreter_finish (csi);
+
+    fill_surface (args.surface);
+    if (target->synchronize)
+	target->synchronize (args.closure);
+
+    scache_clear ();
+
+    cairo_surface_destroy (args.surface);
+    if (target->cleanup)
+	target->cleanup (args.closure);
+
+    status = cairo_script_interpreter_destroy (csi);
+
+    cairo_perf_memory_stop (&memory);
+
+    if (status) {
+	fprintf (perf->summary, "Error during replay, line %d: %s\n",
+		 line_no,
+		 cairo_status_to_string (status));
+	return;
+    }
+
+    fprintf (perf->summary,
+	     "%13llu %14llu %14llu %10lu\n",
+	     memory.peak_rss / 1024,
+	     memory.peak_heap / 1024,
+	     memory.allocated / 1024,
+	     memory.count);
+    cairo_perf_memory_print_sites (perf->summary, MEMORY_TOP_SITES);
+    fflush (perf->summary);
+}
+
+static cairo_status_t
+_write_summary (void *closure, const unsigned char *data, unsigned int length)
+{
+    if (fwrite (data, 1, length, closure) != length)
+	return CAIRO_STATUS_WRITE_ERROR;
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+cairo_perf_trace_lock_stats (cairo_perf_t *perf)
+{
+    if (! perf->lock_stats || perf->summary == NULL)
+	return;
+
+    cairo_debug_mutex_stats_write (_write_summary, perf->summary);
+    fflush (perf->summary);
+}
+
 static void
 cairo_perf_trace (cairo_perf_t			   *perf,
 		  const cairo_boilerplate_target_t *target,
@@ -648,7 +1175,10 @@ cairo_perf_trace (cairo_perf_t			   *perf,
     cairo_time_t *times, *paint, *mask, *fill, *stroke, *glyphs;
     cairo_stats_t stats = {0.0, 0.0};
     struct trace args = { target };
+    cairo_script_interpreter_t *compiled = NULL;
     int low_std_dev_count;
+    cairo_time_t fastest_time = 0;
+    int fastest = 0;
     char *trace_cpy, *name;
     const cairo_script_interpreter_hooks_t hooks = {
 	&args,
@@ -673,6 +1203,26 @@ cairo_perf_trace (cairo_perf_t			   *perf,
 	return;
     }
 
+    if (perf->memory) {
+	cairo_perf_trace_memory (perf, target, name, trace);
+	perf->test_number++;
+	free (trace_cpy);
+	return;
+    }
+
+    if (perf->lock_stats)
+	cairo_debug_mutex_stats_reset ();
+
+#if CAIRO_HAS_REAL_PTHREAD
+    if (perf->num_threads > 1) {
+	cairo_perf_trace_threads (perf, target, name, trace);
+	cairo_perf_trace_lock_stats (perf);
+	perf->test_number++;
+	free (trace_cpy);
+	return;
+    }
+#endif
+
     if (first_run) {
 	if (perf->raw) {
 	    printf ("[ # ] %s.%-s %s %s %s ...\n",
@@ -696,6 +1246,21 @@ cairo_perf_trace (cairo_perf_t			   *perf,
 	first_run = FALSE;
     }
 
+    if (perf->compile) {
+	cairo_status_t status;
+
+	compiled = cairo_script_interpreter_create ();
+	cairo_script_interpreter_install_hooks (compiled, &hooks);
+	status = cairo_script_interpreter_compile (compiled, trace);
+	if (status) {
+	    if (perf->summary) {
+		fprintf (perf->summary, "Error compiling %s: %s\n",
+			 name, cairo_status_to_string (status));
+	    }
+	    goto out;
+	}
+    }
+
     times = perf->times;
     paint = times + perf->iterations;
     mask = paint + perf->iterations;
@@ -728,6 +1293,8 @@ cairo_perf_trace (cairo_perf_t			   *perf,
 	    fprintf (stderr,
 		     "Error: Failed to create target surface: %s\n",
 		     target->name);
+	    if (compiled)
+		cairo_script_interpreter_destroy (compiled);
 	    return;
 	}
 
@@ -745,22 +1312,32 @@ cairo_perf_trace (cairo_perf_t			   *perf,
 	    }
 	}
 
-	csi = cairo_script_interpreter_create ();
-	cairo_script_interpreter_install_hooks (csi, &hooks);
+	if (compiled) {
+	    csi = compiled;
+	} else {
+	    csi = cairo_script_interpreter_create ();
+	    cairo_script_interpreter_install_hooks (csi, &hooks);
+	}
 
 	if (! perf->observe) {
 	    cairo_perf_yield ();
 	    cairo_perf_timer_start ();
 	}
 
-	cairo_script_interpreter_run (csi, trace);
-	line_no = cairo_script_interpreter_get_line_number (csi);
+	if (compiled) {
+	    /* Also releases everything the trace created, like finish. */
+	    status = cairo_script_interpreter_run_compiled (csi);
+	    line_no = 0;
+	} else {
+	    cairo_script_interpreter_run (csi, trace);
+	    line_no = cairo_script_interpreter_get_line_number (csi);
 
-	/* Finish before querying timings in case we are using an intermediate
-	 * target and so need to destroy all surfaces before rendering
-	 * commences.
-	 */
-	cairo_script_interpreter_finish (csi);
+	    /* Finish before querying timings in case we are using an
+	     * intermediate target and so need to destroy all surfaces
+	     * before rendering commences.
+	     */
+	    cairo_script_interpreter_finish (csi);
+	}
 
 	if (perf->observe) {
 	    cairo_device_t *observer = cairo_surface_get_device (args.surface);
@@ -774,6 +1351,15 @@ cairo_perf_trace (cairo_perf_t			   *perf,
 	    fill_surface (args.surface); /* queue a write to the sync'ed surface */
 	    cairo_perf_timer_stop ();
 	    times[i] = cairo_perf_timer_elapsed ();
+	    if (perf->counters) {
+		/* times[] is sorted in place by _cairo_stats_compute(),
+		 * so note the fastest replay as it is taken */
+		cairo_perf_timer_counters (&perf->counts[i]);
+		if (i == 0 || times[i] < fastest_time) {
+		    fastest_time = times[i];
+		    fastest = i;
+		}
+	    }
 	}
 
 	scache_clear ();
@@ -783,7 +1369,8 @@ cairo_perf_trace (cairo_perf_t			   *perf,
 	if (target->cleanup)
 	    target->cleanup (args.closure);
 
-	status = cairo_script_interpreter_destroy (csi);
+	if (! compiled)
+	    status = cairo_script_interpreter_destroy (csi);
 	if (status) {
 	    if (perf->summary) {
 		fprintf (perf->summary, "Error during replay, line %d: %s\n",
@@ -906,15 +1493,22 @@ cairo_perf_trace (cairo_perf_t			   *perf,
 		     stats.std_dev * 100.0,
 		     stats.iterations, i);
 	}
+	if (perf->counters && ! perf->observe && i > 0)
+	    cairo_perf_counters_print (perf->summary, &perf->counts[fastest], 1);
 	fflush (perf->summary);
     }
 
 out:
+    if (compiled)
+	cairo_script_interpreter_destroy (compiled);
+
     if (perf->raw) {
 	printf ("\n");
 	fflush (stdout);
     }
 
+    cairo_perf_trace_lock_stats (perf);
+
     perf->test_number++;
     free (trace_cpy);
 }
@@ -1006,6 +1600,16 @@ main (int   argc,
 
     perf.targets = cairo_boilerplate_get_targets (&perf.num_targets, NULL);
     perf.times = xmalloc (6 * perf.iterations * sizeof (cairo_time_t));
+    perf.counts = NULL;
+    if (perf.counters) {
+	if (cairo_perf_counters_enable ()) {
+	    perf.counts = xmalloc (perf.iterations * sizeof (cairo_perf_counters_t));
+	} else {
+	    fprintf (stderr,
+		     "WARNING: hardware counters are unavailable (see perf_event_paranoid).\n");
+	    perf.counters = FALSE;
+	}
+    }
 
     /* do we have a list of filenames? */
     perf.exact_names = have_trace_filenames (&perf);
@@ -36,6 +36,16 @@
 #include <unistd.h>
 #endif
 
+#if defined(__linux__) && HAVE_LINUX_PERF_EVENT_H && HAVE_SYS_SYSCALL_H
+#define HAVE_PERF_COUNTERS 1
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <string.h>
+#else
+#define HAVE_PERF_COUNTERS 0
+#endif
+
 #if defined(__OS2__)
 #define INCL_BASE
 #include <os2.h>
@@ -47,10 +57,21 @@
 #endif
 
 
-/* timers */
-static cairo_time_t timer;
-static cairo_perf_timer_synchronize_t cairo_perf_timer_synchronize = NULL;
-static void *cairo_perf_timer_synchronize_closure = NULL;
+/* timers
+ *
+ * cairo-perf-micro -j runs the same test function on several threads
+ * at once, each against its own target, so the timer state is kept per
+ * thread where the compiler lets us.
+ */
+#if CAIRO_HAS_REAL_PTHREAD && defined(__GNUC__)
+#define CAIRO_PERF_THREAD_LOCAL __thread
+#else
+#define CAIRO_PERF_THREAD_LOCAL
+#endif
+
+static CAIRO_PERF_THREAD_LOCAL cairo_time_t timer;
+static CAIRO_PERF_THREAD_LOCAL cairo_perf_timer_synchronize_t cairo_perf_timer_synchronize = NULL;
+static CAIRO_PERF_THREAD_LOCAL void *cairo_perf_timer_synchronize_closure = NULL;
 
 void
 cairo_perf_timer_set_synchronize (cairo_perf_timer_synchronize_t  synchronize,
@@ -60,9 +81,180 @@ cairo_perf_timer_set_synchronize (cairo_perf_timer_synchronize_t  synchronize,
     cairo_perf_timer_synchronize_closure = closure;
 }
 
+/* hardware counters
+ *
+ * The events are opened as a single group on the calling thread, so
+ * that they are always scheduled onto the PMU together and can be read
+ * with one syscall; events that the CPU (or hypervisor) does not
+ * provide are left out of the group and read as zero. Only user-space
+ * is counted, which is allowed at the default perf_event_paranoid level.
+ */
+#if HAVE_PERF_COUNTERS
+
+#define NUM_COUNTERS 4
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} counter_events[NUM_COUNTERS] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+static CAIRO_PERF_THREAD_LOCAL int counter_fd[NUM_COUNTERS] = { -1, -1, -1, -1 };
+/* position of each event in the group read, or -1 if unavailable */
+static CAIRO_PERF_THREAD_LOCAL int counter_index[NUM_COUNTERS];
+static CAIRO_PERF_THREAD_LOCAL int num_counters;
+static CAIRO_PERF_THREAD_LOCAL uint64_t counter_start[NUM_COUNTERS];
+static CAIRO_PERF_THREAD_LOCAL uint64_t counter_delta[NUM_COUNTERS];
+
+static int
+counter_open (int n, int group_fd)
+{
+    struct perf_event_attr attr;
+
+    memset (&attr, 0, sizeof (attr));
+    attr.size = sizeof (attr);
+    attr.type = counter_events[n].type;
+    attr.config = counter_events[n].config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.disabled = group_fd == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return syscall (__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static cairo_bool_t
+counters_read (uint64_t *values)
+{
+    uint64_t buf[1 + NUM_COUNTERS];
+    int n;
+
+    if (read (counter_fd[0], buf, sizeof (buf)) < (ssize_t) ((1 + num_counters) * sizeof (uint64_t)))
+	return FALSE;
+
+    for (n = 0; n < NUM_COUNTERS; n++)
+	values[n] = counter_index[n] < 0 ? 0 : buf[1 + counter_index[n]];
+
+    return TRUE;
+}
+
+cairo_bool_t
+cairo_perf_counters_enable (void)
+{
+    int n;
+
+    if (counter_fd[0] != -1)
+	return TRUE;
+
+    /* the leader, without which there is nothing to read */
+    counter_fd[0] = counter_open (0, -1);
+    if (counter_fd[0] == -1)
+	return FALSE;
+    counter_index[0] = 0;
+    num_counters = 1;
+
+    for (n = 1; n < NUM_COUNTERS; n++) {
+	counter_fd[n] = counter_open (n, counter_fd[0]);
+	counter_index[n] = counter_fd[n] == -1 ? -1 : num_counters++;
+    }
+
+    ioctl (counter_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    memset (counter_delta, 0, sizeof (counter_delta));
+    return TRUE;
+}
+
+void
+cairo_perf_counters_disable (void)
+{
+    int n;
+
+    for (n = NUM_COUNTERS; n--; ) {
+	if (counter_fd[n] != -1)
+	    close (counter_fd[n]);
+	counter_fd[n] = -1;
+    }
+}
+
+void
+cairo_perf_timer_counters (cairo_perf_counters_t *counters)
+{
+    counters->cycles = counter_delta[0];
+    counters->instructions = counter_delta[1];
+    counters->cache_misses = counter_delta[2];
+    counters->branch_misses = counter_delta[3];
+}
+
+static void
+counters_start (void)
+{
+    if (counter_fd[0] != -1 && ! counters_read (counter_start))
+	memset (counter_start, 0, sizeof (counter_start));
+}
+
+static void
+counters_stop (void)
+{
+    uint64_t now[NUM_COUNTERS];
+    int n;
+
+    if (counter_fd[0] == -1)
+	return;
+
+    if (! counters_read (now)) {
+	memset (counter_delta, 0, sizeof (counter_delta));
+	return;
+    }
+
+    for (n = 0; n < NUM_COUNTERS; n++)
+	counter_delta[n] = now[n] - counter_start[n];
+}
+
+#else
+
+cairo_bool_t
+cairo_perf_counters_enable (void)
+{
+    return FALSE;
+}
+
+void
+cairo_perf_counters_disable (void)
+{
+}
+
+void
+cairo_perf_timer_counters (cairo_perf_counters_t *counters)
+{
+    memset (counters, 0, sizeof (*counters));
+}
+
+#define counters_start()
+#define counters_stop()
+
+#endif
+
+void
+cairo_perf_counters_print (FILE				*file,
+			   const cairo_perf_counters_t	*counters,
+			   double			 ops)
+{
+    fprintf (file,
+	     "      %#12.1f cycles %#12.1f instructions (%#5.2f IPC) %#10.2f cache-misses %#10.2f branch-misses\n",
+	     counters->cycles / ops,
+	     counters->instructions / ops,
+	     counters->cycles ? counters->instructions / (double) counters->cycles : 0.,
+	     counters->cache_misses / ops,
+	     counters->branch_misses / ops);
+}
+
 void
 cairo_perf_timer_start (void)
 {
+    counters_start ();
     timer = _cairo_time_get ();
 }
 
@@ -73,6 +265,7 @@ cairo_perf_timer_stop (void)
 	cairo_perf_timer_synchronize (cairo_perf_timer_synchronize_closure);
 
     timer = _cairo_time_get_delta (timer);
+    counters_stop ();
 }
 
 cairo_time_t
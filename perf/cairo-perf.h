@@ -67,6 +67,29 @@ cairo_perf_timer_set_synchronize (cairo_perf_timer_synchronize_t  synchronize,
 cairo_time_t
 cairo_perf_timer_elapsed (void);
 
+/* hardware counters, sampled along with the timer where available */
+
+typedef struct _cairo_perf_counters {
+    unsigned long long cycles;
+    unsigned long long instructions;
+    unsigned long long cache_misses;
+    unsigned long long branch_misses;
+} cairo_perf_counters_t;
+
+cairo_bool_t
+cairo_perf_counters_enable (void);
+
+void
+cairo_perf_counters_disable (void);
+
+void
+cairo_perf_timer_counters (cairo_perf_counters_t *counters);
+
+void
+cairo_perf_counters_print (FILE				*file,
+			   const cairo_perf_counters_t	*counters,
+			   double			 ops);
+
 /* yield */
 
 void
@@ -93,9 +116,15 @@ typedef struct _cairo_perf {
     cairo_bool_t fast_and_sloppy;
 
     unsigned int tile_size;
+    unsigned int num_threads;
+    cairo_bool_t lock_stats;
+    cairo_bool_t compile;
+    cairo_bool_t memory;
+    cairo_bool_t counters;
 
     /* Stuff used internally */
     cairo_time_t *times;
+    cairo_perf_counters_t *counts;
     const cairo_boilerplate_target_t **targets;
     int num_targets;
     const cairo_boilerplate_target_t *target;
@@ -156,6 +185,11 @@ typedef struct _test_diff {
     double min;
     double max;
     double change;
+
+    /* Only computed when comparing the raw samples of two reports;
+     * p_value is negative if there were too few samples. */
+    double p_value;
+    double ci_lo, ci_hi; /* of the ratio of the old and new medians */
 } test_diff_t;
 
 typedef struct _cairo_perf_report {
@@ -190,6 +224,24 @@ int
 test_report_cmp_name (const void *a,
 		      const void *b);
 
+/* memory accounting, only available with glibc */
+
+typedef struct _cairo_perf_memory {
+    unsigned long long peak_rss;
+    unsigned long long peak_heap;
+    unsigned long long allocated;
+    unsigned long count;
+} cairo_perf_memory_t;
+
+cairo_bool_t
+cairo_perf_memory_start (void);
+
+void
+cairo_perf_memory_stop (cairo_perf_memory_t *stats);
+
+void
+cairo_perf_memory_print_sites (FILE *file, int max_sites);
+
 #define CAIRO_PERF_ENABLED_DECL(func) cairo_bool_t (func ## _enabled) (cairo_perf_t *perf)
 #define CAIRO_PERF_RUN_DECL(func) void (func) (cairo_perf_t *perf, cairo_t *cr, int width, int height)
 
@@ -245,6 +297,7 @@ CAIRO_PERF_DECL (pixel);
 CAIRO_PERF_DECL (a1_pixel);
 CAIRO_PERF_DECL (sierpinski);
 CAIRO_PERF_DECL (fill_clip);
+CAIRO_PERF_DECL (recording);
 CAIRO_PERF_DECL (tiger);
 
 #endif
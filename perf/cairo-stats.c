@@ -100,6 +100,159 @@ _cairo_stats_compute (cairo_stats_t *stats,
     stats->std_dev = sqrt(s / num_valid);
 }
 
+typedef struct _ranked {
+    double value;
+    int sample; /* 0 for the first set, 1 for the second */
+} ranked_t;
+
+static int
+ranked_cmp (const void *a, const void *b)
+{
+    const ranked_t *ra = a, *rb = b;
+
+    if (ra->value < rb->value)
+	return -1;
+    if (ra->value > rb->value)
+	return 1;
+    return 0;
+}
+
+/* The two-sided Mann-Whitney U test, using the normal approximation
+ * with a correction for ties, which is adequate for the dozens of
+ * samples of a typical run. Returns the probability of seeing a
+ * difference at least this large if both sets of samples were drawn
+ * from the same distribution.
+ */
+double
+_cairo_stats_mann_whitney (const double *a, int num_a,
+			   const double *b, int num_b)
+{
+    ranked_t *ranked;
+    double rank_sum, ties, u, mean, var, z;
+    int n, i, j;
+
+    if (num_a == 0 || num_b == 0)
+	return 1.;
+
+    n = num_a + num_b;
+    ranked = xmalloc (n * sizeof (ranked_t));
+    for (i = 0; i < num_a; i++) {
+	ranked[i].value = a[i];
+	ranked[i].sample = 0;
+    }
+    for (i = 0; i < num_b; i++) {
+	ranked[num_a + i].value = b[i];
+	ranked[num_a + i].sample = 1;
+    }
+    qsort (ranked, n, sizeof (ranked_t), ranked_cmp);
+
+    rank_sum = 0;
+    ties = 0;
+    for (i = 0; i < n; i = j) {
+	double rank, t;
+	int k;
+
+	for (j = i + 1; j < n && ranked[j].value == ranked[i].value; j++)
+	    ;
+
+	/* tied values share the average of their ranks (1-based) */
+	rank = (i + 1 + j) / 2.;
+	for (k = i; k < j; k++) {
+	    if (ranked[k].sample == 0)
+		rank_sum += rank;
+	}
+
+	t = j - i;
+	ties += t * t * t - t;
+    }
+    free (ranked);
+
+    u = rank_sum - num_a * (num_a + 1) / 2.;
+    mean = num_a * (double) num_b / 2.;
+    var = num_a * (double) num_b / 12. * ((n + 1) - ties / (n * (n - 1.)));
+    if (var <= 0)
+	return 1.;
+
+    /* with a continuity correction */
+    z = fabs (u - mean);
+    z = z > .5 ? (z - .5) / sqrt (var) : 0;
+
+    return erfc (z / M_SQRT2);
+}
+
+static uint32_t
+bootstrap_random (uint32_t *state)
+{
+    /* xorshift32, reproducible across runs and platforms */
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static int
+double_cmp (const void *a, const void *b)
+{
+    double da = *(const double *) a, db = *(const double *) b;
+
+    if (da < db)
+	return -1;
+    if (da > db)
+	return 1;
+    return 0;
+}
+
+static double
+bootstrap_median (const double *values, int num_values,
+		  double *scratch, uint32_t *state)
+{
+    int i;
+
+    for (i = 0; i < num_values; i++)
+	scratch[i] = values[bootstrap_random (state) % num_values];
+    qsort (scratch, num_values, sizeof (double), double_cmp);
+
+    return scratch[num_values / 2];
+}
+
+#define BOOTSTRAP_RESAMPLES 1000
+
+/* Computes a bootstrap confidence interval for the ratio of the medians
+ * of a and b, i.e. the speedup of b over a when the values are times.
+ */
+void
+_cairo_stats_bootstrap_median_ratio (const double *a, int num_a,
+				     const double *b, int num_b,
+				     double confidence,
+				     double *lo, double *hi)
+{
+    uint32_t state = 0x2545f491;
+    double *ratios, *scratch;
+    int i, k;
+
+    if (num_a == 0 || num_b == 0) {
+	*lo = *hi = 1.;
+	return;
+    }
+
+    ratios = xmalloc (BOOTSTRAP_RESAMPLES * sizeof (double));
+    scratch = xmalloc (MAX (num_a, num_b) * sizeof (double));
+    for (i = 0; i < BOOTSTRAP_RESAMPLES; i++) {
+	double median_a = bootstrap_median (a, num_a, scratch, &state);
+	double median_b = bootstrap_median (b, num_b, scratch, &state);
+
+	ratios[i] = median_b > 0 ? median_a / median_b : 1.;
+    }
+    qsort (ratios, BOOTSTRAP_RESAMPLES, sizeof (double), double_cmp);
+
+    k = (1. - confidence) / 2. * BOOTSTRAP_RESAMPLES;
+    *lo = ratios[k];
+    *hi = ratios[BOOTSTRAP_RESAMPLES - 1 - k];
+
+    free (scratch);
+    free (ratios);
+}
+
 cairo_bool_t
 _cairo_histogram_init (cairo_histogram_t *h,
 		       int width, int height)
@@ -33,6 +33,16 @@ _cairo_stats_compute (cairo_stats_t *stats,
 		      cairo_time_t  *values,
 		      int	     num_values);
 
+double
+_cairo_stats_mann_whitney (const double *a, int num_a,
+			   const double *b, int num_b);
+
+void
+_cairo_stats_bootstrap_median_ratio (const double *a, int num_a,
+				     const double *b, int num_b,
+				     double confidence,
+				     double *lo, double *hi);
+
 cairo_bool_t
 _cairo_histogram_init (cairo_histogram_t *h,
 		       int width, int height);
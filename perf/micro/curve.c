@@ -26,33 +26,33 @@
 
 #include "cairo-perf.h"
 
-static uint32_t state;
-
 static double
-uniform_random (double minval, double maxval)
+uniform_random (uint32_t *state, double minval, double maxval)
 {
     static uint32_t const poly = 0x9a795537U;
     uint32_t n = 32;
     while (n-->0)
-	state = 2*state < state ? (2*state ^ poly) : 2*state;
-    return minval + state * (maxval - minval) / 4294967296.0;
+	*state = 2 * *state < *state ? (2 * *state ^ poly) : 2 * *state;
+    return minval + *state * (maxval - minval) / 4294967296.0;
 }
 
 static cairo_time_t
 do_curve_stroke (cairo_t *cr, int width, int height, int loops)
 {
-    state = 0xc0ffee;
+    uint32_t state = 0xc0ffee;
     cairo_set_line_width (cr, 2.);
     cairo_perf_timer_start ();
 
     while (loops--) {
-	double x1 = uniform_random (0, width);
-	double x2 = uniform_random (0, width);
-	double x3 = uniform_random (0, width);
-	double y1 = uniform_random (0, height);
-	double y2 = uniform_random (0, height);
-	double y3 = uniform_random (0, height);
-	cairo_move_to (cr, uniform_random (0, width), uniform_random (0, height));
+	double x1 = uniform_random (&state, 0, width);
+	double x2 = uniform_random (&state, 0, width);
+	double x3 = uniform_random (&state, 0, width);
+	double y1 = uniform_random (&state, 0, height);
+	double y2 = uniform_random (&state, 0, height);
+	double y3 = uniform_random (&state, 0, height);
+	cairo_move_to (cr,
+		       uniform_random (&state, 0, width),
+		       uniform_random (&state, 0, height));
 	cairo_curve_to (cr, x1, y1, x2, y2, x3, y3);
 	cairo_stroke(cr);
     }
@@ -65,22 +65,22 @@ do_curve_stroke (cairo_t *cr, int width, int height, int loops)
 static cairo_time_t
 do_curve_fill (cairo_t *cr, int width, int height, int loops)
 {
-    state = 0xc0ffee;
+    uint32_t state = 0xc0ffee;
     cairo_perf_timer_start ();
 
     while (loops--) {
-	double x0 = uniform_random (0, width);
-	double x1 = uniform_random (0, width);
-	double x2 = uniform_random (0, width);
-	double x3 = uniform_random (0, width);
-	double xm = uniform_random (0, width);
-	double xn = uniform_random (0, width);
-	double y0 = uniform_random (0, height);
-	double y1 = uniform_random (0, height);
-	double y2 = uniform_random (0, height);
-	double y3 = uniform_random (0, height);
-	double ym = uniform_random (0, height);
-	double yn = uniform_random (0, height);
+	double x0 = uniform_random (&state, 0, width);
+	double x1 = uniform_random (&state, 0, width);
+	double x2 = uniform_random (&state, 0, width);
+	double x3 = uniform_random (&state, 0, width);
+	double xm = uniform_random (&state, 0, width);
+	double xn = uniform_random (&state, 0, width);
+	double y0 = uniform_random (&state, 0, height);
+	double y1 = uniform_random (&state, 0, height);
+	double y2 = uniform_random (&state, 0, height);
+	double y3 = uniform_random (&state, 0, height);
+	double ym = uniform_random (&state, 0, height);
+	double yn = uniform_random (&state, 0, height);
 
 	cairo_move_to (cr, xm, ym);
 	cairo_curve_to (cr, x1, y1, x2, y2, xn, yn);
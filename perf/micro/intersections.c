@@ -28,21 +28,21 @@
 
 #define NUM_SEGMENTS 256
 
-static unsigned state;
 static double
-uniform_random (double minval, double maxval)
+uniform_random (uint32_t *state, double minval, double maxval)
 {
     static unsigned const poly = 0x9a795537U;
     unsigned n = 32;
     while (n-->0)
-	state = 2*state < state ? (2*state ^ poly) : 2*state;
-    return minval + state * (maxval - minval) / 4294967296.0;
+	*state = 2 * *state < *state ? (2 * *state ^ poly) : 2 * *state;
+    return minval + *state * (maxval - minval) / 4294967296.0;
 }
 
 static cairo_time_t
 draw_random (cairo_t *cr, cairo_fill_rule_t fill_rule,
 	     int width, int height, int loops)
 {
+    uint32_t state = 0x12345678;
     double x[NUM_SEGMENTS];
     double y[NUM_SEGMENTS];
     int i;
@@ -52,11 +52,10 @@ draw_random (cairo_t *cr, cairo_fill_rule_t fill_rule,
     cairo_paint (cr);
 
     for (i = 0; i < NUM_SEGMENTS; i++) {
-         x[i] = uniform_random (0, width);
-         y[i] = uniform_random (0, height);
+         x[i] = uniform_random (&state, 0, width);
+         y[i] = uniform_random (&state, 0, height);
     }
 
-    state = 0x12345678;
     cairo_translate (cr, 1, 1);
     cairo_set_fill_rule (cr, fill_rule);
     cairo_set_source_rgb (cr, 1, 0, 0);
@@ -81,6 +80,7 @@ static cairo_time_t
 draw_random_curve (cairo_t *cr, cairo_fill_rule_t fill_rule,
 		   int width, int height, int loops)
 {
+    uint32_t state = 0x12345678;
     double x[3*NUM_SEGMENTS];
     double y[3*NUM_SEGMENTS];
     int i;
@@ -90,11 +90,10 @@ draw_random_curve (cairo_t *cr, cairo_fill_rule_t fill_rule,
     cairo_paint (cr);
 
     for (i = 0; i < 3*NUM_SEGMENTS; i++) {
-         x[i] = uniform_random (0, width);
-         y[i] = uniform_random (0, height);
+         x[i] = uniform_random (&state, 0, width);
+         y[i] = uniform_random (&state, 0, height);
     }
 
-    state = 0x12345678;
     cairo_translate (cr, 1, 1);
     cairo_set_fill_rule (cr, fill_rule);
     cairo_set_source_rgb (cr, 1, 0, 0);
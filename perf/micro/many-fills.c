@@ -33,28 +33,26 @@
 
 #include "cairo-perf.h"
 
-static uint32_t state;
-
 static double
-uniform_random (double minval, double maxval)
+uniform_random (uint32_t *state, double minval, double maxval)
 {
     static uint32_t const poly = 0x9a795537U;
     uint32_t n = 32;
     while (n-->0)
-	state = 2*state < state ? (2*state ^ poly) : 2*state;
-    return minval + state * (maxval - minval) / 4294967296.0;
+	*state = 2 * *state < *state ? (2 * *state ^ poly) : 2 * *state;
+    return minval + *state * (maxval - minval) / 4294967296.0;
 }
 
 static cairo_time_t
 do_many_fills_ha (cairo_t *cr, int width, int height, int loops)
 {
+    uint32_t state = 0xc0ffee;
     int count;
 
-    state = 0xc0ffee;
     for (count = 0; count < 1000; count++) {
-	double y = floor (uniform_random (0, height));
-	double x = floor (uniform_random (0, width));
-	cairo_rectangle (cr, x, y, ceil (uniform_random (0, width)) - x, 1);
+	double y = floor (uniform_random (&state, 0, height));
+	double x = floor (uniform_random (&state, 0, width));
+	cairo_rectangle (cr, x, y, ceil (uniform_random (&state, 0, width)) - x, 1);
     }
 
     cairo_perf_timer_start ();
@@ -72,13 +70,13 @@ do_many_fills_ha (cairo_t *cr, int width, int height, int loops)
 static cairo_time_t
 do_many_fills_h (cairo_t *cr, int width, int height, int loops)
 {
+    uint32_t state = 0xc0ffee;
     int count;
 
-    state = 0xc0ffee;
     for (count = 0; count < 1000; count++) {
-	double y = uniform_random (0, height);
-	double x = uniform_random (0, width);
-	cairo_rectangle (cr, x, y, uniform_random (0, width) - x, 1);
+	double y = uniform_random (&state, 0, height);
+	double x = uniform_random (&state, 0, width);
+	cairo_rectangle (cr, x, y, uniform_random (&state, 0, width) - x, 1);
     }
 
     cairo_perf_timer_start ();
@@ -96,13 +94,13 @@ do_many_fills_h (cairo_t *cr, int width, int height, int loops)
 static cairo_time_t
 do_many_fills_va (cairo_t *cr, int width, int height, int loops)
 {
+    uint32_t state = 0xc0ffee;
     int count;
 
-    state = 0xc0ffee;
     for (count = 0; count < 1000; count++) {
-	double x = floor (uniform_random (0, width));
-	double y = floor (uniform_random (0, height));
-	cairo_rectangle (cr, x, y, 1, ceil (uniform_random (0, height) - y));
+	double x = floor (uniform_random (&state, 0, width));
+	double y = floor (uniform_random (&state, 0, height));
+	cairo_rectangle (cr, x, y, 1, ceil (uniform_random (&state, 0, height) - y));
     }
 
     cairo_perf_timer_start ();
@@ -120,13 +118,13 @@ do_many_fills_va (cairo_t *cr, int width, int height, int loops)
 static cairo_time_t
 do_many_fills_v (cairo_t *cr, int width, int height, int loops)
 {
+    uint32_t state = 0xc0ffee;
     int count;
 
-    state = 0xc0ffee;
     for (count = 0; count < 1000; count++) {
-	double x = uniform_random (0, width);
-	double y = uniform_random (0, height);
-	cairo_rectangle (cr, x, y, 1, uniform_random (0, height) - y);
+	double x = uniform_random (&state, 0, width);
+	double y = uniform_random (&state, 0, height);
+	cairo_rectangle (cr, x, y, 1, uniform_random (&state, 0, height) - y);
     }
 
     cairo_perf_timer_start ();
@@ -144,17 +142,17 @@ do_many_fills_v (cairo_t *cr, int width, int height, int loops)
 static cairo_time_t
 do_many_fills (cairo_t *cr, int width, int height, int loops)
 {
+    uint32_t state = 0xc0ffee;
     int count;
 
     /* lots and lots of overlapping stroke-like fills */
-    state = 0xc0ffee;
     for (count = 0; count < 1000; count++) {
 	cairo_save (cr);
 	cairo_translate (cr,
-			 uniform_random (0, width),
-			 uniform_random (0, height));
-	cairo_rotate (cr, uniform_random (-M_PI,M_PI));
-	cairo_rectangle (cr, 0, 0, uniform_random (0, width), 1);
+			 uniform_random (&state, 0, width),
+			 uniform_random (&state, 0, height));
+	cairo_rotate (cr, uniform_random (&state, -M_PI,M_PI));
+	cairo_rectangle (cr, 0, 0, uniform_random (&state, 0, width), 1);
 	cairo_restore (cr);
     }
 
@@ -26,28 +26,26 @@
 
 #include "cairo-perf.h"
 
-static uint32_t state;
-
 static double
-uniform_random (double minval, double maxval)
+uniform_random (uint32_t *state, double minval, double maxval)
 {
     static uint32_t const poly = 0x9a795537U;
     uint32_t n = 32;
     while (n-->0)
-	state = 2*state < state ? (2*state ^ poly) : 2*state;
-    return minval + state * (maxval - minval) / 4294967296.0;
+	*state = 2 * *state < *state ? (2 * *state ^ poly) : 2 * *state;
+    return minval + *state * (maxval - minval) / 4294967296.0;
 }
 
 static cairo_time_t
 do_many_strokes_ha (cairo_t *cr, int width, int height, int loops)
 {
+    uint32_t state = 0xc0ffee;
     int count;
 
-    state = 0xc0ffee;
     for (count = 0; count < 1000; count++) {
-	double h = floor (uniform_random (0, height)) + .5;
-	cairo_move_to (cr, floor (uniform_random (0, width)), h);
-	cairo_line_to (cr, ceil (uniform_random (0, width)), h);
+	double h = floor (uniform_random (&state, 0, height)) + .5;
+	cairo_move_to (cr, floor (uniform_random (&state, 0, width)), h);
+	cairo_line_to (cr, ceil (uniform_random (&state, 0, width)), h);
     }
 
     cairo_set_line_width (cr, 1.);
@@ -67,13 +65,13 @@ do_many_strokes_ha (cairo_t *cr, int width, int height, int loops)
 static cairo_time_t
 do_many_strokes_h (cairo_t *cr, int width, int height, int loops)
 {
+    uint32_t state = 0xc0ffee;
     int count;
 
-    state = 0xc0ffee;
     for (count = 0; count < 1000; count++) {
-	double h = uniform_random (0, height);
-	cairo_move_to (cr, uniform_random (0, width), h);
-	cairo_line_to (cr, uniform_random (0, width), h);
+	double h = uniform_random (&state, 0, height);
+	cairo_move_to (cr, uniform_random (&state, 0, width), h);
+	cairo_line_to (cr, uniform_random (&state, 0, width), h);
     }
 
     cairo_set_line_width (cr, 1.);
@@ -93,13 +91,13 @@ do_many_strokes_h (cairo_t *cr, int width, int height, int loops)
 static cairo_time_t
 do_many_strokes_va (cairo_t *cr, int width, int height, int loops)
 {
+    uint32_t state = 0xc0ffee;
     int count;
 
-    state = 0xc0ffee;
     for (count = 0; count < 1000; count++) {
-	double v = floor (uniform_random (0, width)) + .5;
-	cairo_move_to (cr, v, floor (uniform_random (0, height)));
-	cairo_line_to (cr, v, ceil (uniform_random (0, height)));
+	double v = floor (uniform_random (&state, 0, width)) + .5;
+	cairo_move_to (cr, v, floor (uniform_random (&state, 0, height)));
+	cairo_line_to (cr, v, ceil (uniform_random (&state, 0, height)));
     }
 
     cairo_set_line_width (cr, 1.);
@@ -119,13 +117,13 @@ do_many_strokes_va (cairo_t *cr, int width, int height, int loops)
 static cairo_time_t
 do_many_strokes_v (cairo_t *cr, int width, int height, int loops)
 {
+    uint32_t state = 0xc0ffee;
     int count;
 
-    state = 0xc0ffee;
     for (count = 0; count < 1000; count++) {
-	double v = uniform_random (0, width);
-	cairo_move_to (cr, v, uniform_random (0, height));
-	cairo_line_to (cr, v, uniform_random (0, height));
+	double v = uniform_random (&state, 0, width);
+	cairo_move_to (cr, v, uniform_random (&state, 0, height));
+	cairo_line_to (cr, v, uniform_random (&state, 0, height));
     }
 
     cairo_set_line_width (cr, 1.);
@@ -145,14 +143,14 @@ do_many_strokes_v (cairo_t *cr, int width, int height, int loops)
 static cairo_time_t
 do_many_strokes (cairo_t *cr, int width, int height, int loops)
 {
+    uint32_t state = 0xc0ffee;
     int count;
 
     /* lots and lots of overlapping strokes */
-    state = 0xc0ffee;
     for (count = 0; count < 1000; count++) {
 	cairo_line_to (cr,
-		       uniform_random (0, width),
-		       uniform_random (0, height));
+		       uniform_random (&state, 0, width),
+		       uniform_random (&state, 0, height));
     }
 
     cairo_set_line_width (cr, 1.);
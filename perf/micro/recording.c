@@ -0,0 +1,178 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Measures the cost of recording many small commands into a recording
+ * surface and throwing them away again, and of replaying them, which
+ * is dominated by the allocation and the memory layout of the commands.
+ */
+
+#include "cairo-perf.h"
+
+#define NUM_COMMANDS 10000
+
+static double
+uniform_random (uint32_t *state, double minval, double maxval)
+{
+    static uint32_t const poly = 0x9a795537U;
+    uint32_t n = 32;
+    while (n-->0)
+	*state = 2 * *state < *state ? (2 * *state ^ poly) : 2 * *state;
+    return minval + *state * (maxval - minval) / 4294967296.0;
+}
+
+static void
+record_fills (cairo_t *cr, int width, int height)
+{
+    uint32_t state = 0xc0ffee;
+    int n;
+
+    for (n = 0; n < NUM_COMMANDS; n++) {
+	cairo_rectangle (cr,
+			 uniform_random (&state, 0, width),
+			 uniform_random (&state, 0, height),
+			 uniform_random (&state, 1, 10),
+			 uniform_random (&state, 1, 10));
+	cairo_fill (cr);
+    }
+}
+
+static void
+record_strokes (cairo_t *cr, int width, int height)
+{
+    uint32_t state = 0xc0ffee;
+    int n;
+
+    for (n = 0; n < NUM_COMMANDS; n++) {
+	cairo_move_to (cr,
+		       uniform_random (&state, 0, width),
+		       uniform_random (&state, 0, height));
+	cairo_line_to (cr,
+		       uniform_random (&state, 0, width),
+		       uniform_random (&state, 0, height));
+	cairo_stroke (cr);
+    }
+}
+
+static void
+record_glyphs (cairo_t *cr, int width, int height)
+{
+    uint32_t state = 0xc0ffee;
+    cairo_glyph_t glyphs[8];
+    int n, i;
+
+    for (n = 0; n < NUM_COMMANDS; n++) {
+	double x = uniform_random (&state, 0, width);
+	double y = uniform_random (&state, 0, height);
+
+	for (i = 0; i < 8; i++) {
+	    glyphs[i].index = 36 + (n + i) % 26;
+	    glyphs[i].x = x + 8 * i;
+	    glyphs[i].y = y;
+	}
+	cairo_show_glyphs (cr, glyphs, 8);
+    }
+}
+
+static cairo_time_t
+do_recording (cairo_t *cr, int width, int height, int loops,
+	      void (*record) (cairo_t *cr, int width, int height))
+{
+    cairo_perf_timer_start ();
+
+    while (loops--) {
+	cairo_surface_t *recording;
+	cairo_t *rec;
+
+	recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA,
+						    NULL);
+	rec = cairo_create (recording);
+	cairo_set_font_size (rec, 8);
+	record (rec, width, height);
+	cairo_destroy (rec);
+	cairo_surface_destroy (recording);
+    }
+
+    cairo_perf_timer_stop ();
+
+    return cairo_perf_timer_elapsed ();
+}
+
+static cairo_time_t
+do_recording_fill (cairo_t *cr, int width, int height, int loops)
+{
+    return do_recording (cr, width, height, loops, record_fills);
+}
+
+static cairo_time_t
+do_recording_stroke (cairo_t *cr, int width, int height, int loops)
+{
+    return do_recording (cr, width, height, loops, record_strokes);
+}
+
+static cairo_time_t
+do_recording_glyphs (cairo_t *cr, int width, int height, int loops)
+{
+    return do_recording (cr, width, height, loops, record_glyphs);
+}
+
+static cairo_time_t
+do_recording_replay (cairo_t *cr, int width, int height, int loops)
+{
+    cairo_surface_t *recording;
+    cairo_t *rec;
+
+    recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA,
+						NULL);
+    rec = cairo_create (recording);
+    record_fills (rec, width, height);
+    cairo_destroy (rec);
+
+    cairo_set_source_surface (cr, recording, 0, 0);
+
+    cairo_perf_timer_start ();
+
+    while (loops--)
+	cairo_paint (cr);
+
+    cairo_perf_timer_stop ();
+
+    cairo_surface_destroy (recording);
+
+    return cairo_perf_timer_elapsed ();
+}
+
+cairo_bool_t
+recording_enabled (cairo_perf_t *perf)
+{
+    return cairo_perf_can_run (perf, "recording", NULL);
+}
+
+void
+recording (cairo_perf_t *perf, cairo_t *cr, int width, int height)
+{
+    cairo_perf_run (perf, "recording-fill", do_recording_fill, NULL);
+    cairo_perf_run (perf, "recording-stroke", do_recording_stroke, NULL);
+    cairo_perf_run (perf, "recording-glyphs", do_recording_glyphs, NULL);
+    cairo_perf_run (perf, "recording-replay", do_recording_replay, NULL);
+}
@@ -42,6 +42,7 @@
 #include "cairo-error-private.h"
 #include "cairo-combsort-inline.h"
 #include "cairo-list-private.h"
+#include "cairo-surface-observer-stage-private.h"
 #include "cairo-traps-private.h"
 
 #include <setjmp.h>
@@ -753,6 +754,7 @@ _cairo_bentley_ottmann_tessellate_boxes (const cairo_boxes_t *in,
     rectangle_t *stack_rectangles_chain[CAIRO_STACK_ARRAY_LENGTH (rectangle_t *) ];
     rectangle_t **rectangles_chain = NULL;
     const struct _cairo_boxes_chunk *chunk;
+    cairo_observer_stage_t stage;
     cairo_status_t status;
     int i, j, y_min, y_max;
 
@@ -826,6 +828,7 @@ _cairo_bentley_ottmann_tessellate_boxes (const cairo_boxes_t *in,
 	rectangles_ptrs = (rectangle_t **) (rectangles + in->num_boxes);
     }
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_TESSELLATE);
     j = 0;
     for (chunk = &in->chunks; chunk != NULL; chunk = chunk->next) {
 	const cairo_box_t *box = chunk->base;
@@ -886,6 +889,7 @@ _cairo_bentley_ottmann_tessellate_boxes (const cairo_boxes_t *in,
     status = _cairo_bentley_ottmann_tessellate_rectangular (rectangles_ptrs+2, j,
 							    fill_rule,
 							    FALSE, out);
+    _cairo_observer_stage_leave (stage);
     if (rectangles != stack_rectangles)
 	free (rectangles);
 
@@ -41,6 +41,7 @@
 #include "cairo-boxes-private.h"
 #include "cairo-combsort-inline.h"
 #include "cairo-error-private.h"
+#include "cairo-surface-observer-stage-private.h"
 #include "cairo-traps-private.h"
 
 typedef struct _cairo_bo_edge cairo_bo_edge_t;
@@ -449,6 +450,7 @@ _cairo_bentley_ottmann_tessellate_rectilinear_polygon_to_boxes (const cairo_poly
     cairo_bo_event_t **event_ptrs;
     cairo_bo_edge_t stack_edges[ARRAY_LENGTH (stack_events)];
     cairo_bo_edge_t *edges;
+    cairo_observer_stage_t stage;
     int num_events;
     int i, j;
 
@@ -473,6 +475,7 @@ _cairo_bentley_ottmann_tessellate_rectilinear_polygon_to_boxes (const cairo_poly
 	edges = (cairo_bo_edge_t *) (event_ptrs + num_events + 1);
     }
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_TESSELLATE);
     for (i = j = 0; i < polygon->num_edges; i++) {
 	edges[i].edge = polygon->edges[i];
 	edges[i].deferred_trap.right = NULL;
@@ -497,6 +500,7 @@ _cairo_bentley_ottmann_tessellate_rectilinear_polygon_to_boxes (const cairo_poly
     status = _cairo_bentley_ottmann_tessellate_rectilinear (event_ptrs, j,
 							    fill_rule,
 							    FALSE, boxes);
+    _cairo_observer_stage_leave (stage);
     if (events != stack_events)
 	free (events);
 
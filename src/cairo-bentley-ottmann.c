@@ -42,6 +42,7 @@
 #include "cairo-error-private.h"
 #include "cairo-freelist-private.h"
 #include "cairo-line-inline.h"
+#include "cairo-surface-observer-stage-private.h"
 #include "cairo-traps-private.h"
 
 #define DEBUG_PRINT_STATE 0
@@ -1474,6 +1475,7 @@ _cairo_bentley_ottmann_tessellate_polygon (cairo_traps_t	 *traps,
     cairo_bo_start_event_t *stack_event_y[64];
     cairo_bo_start_event_t **event_y = NULL;
     int i, num_events, y, ymin, ymax;
+    cairo_observer_stage_t stage;
     cairo_status_t status;
 
     num_events = polygon->num_edges;
@@ -1504,6 +1506,7 @@ _cairo_bentley_ottmann_tessellate_polygon (cairo_traps_t	 *traps,
 	event_ptrs = (cairo_bo_event_t **) (events + num_events);
     }
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_TESSELLATE);
     for (i = 0; i < num_events; i++) {
 	events[i].type = CAIRO_BO_EVENT_TYPE_START;
 	events[i].point.y = polygon->edges[i].top;
@@ -1551,6 +1554,7 @@ _cairo_bentley_ottmann_tessellate_polygon (cairo_traps_t	 *traps,
     status = _cairo_bentley_ottmann_tessellate_bo_edges (event_ptrs, num_events,
 							 fill_rule, traps,
 							 &intersections);
+    _cairo_observer_stage_leave (stage);
 #if DEBUG_TRAPS
     dump_traps (traps, "bo-polygon-out.txt");
 #endif
@@ -135,6 +135,7 @@ typedef struct _cairo_cff_font {
     /* Font Data */
     unsigned char       *data;
     unsigned long        data_length;
+    cairo_bool_t         data_is_cached; /* see _cairo_font_table_cache_get() */
     unsigned char       *current_ptr;
     unsigned char       *data_end;
     cff_header_t        *header;
@@ -2619,9 +2620,9 @@ cairo_cff_font_create_set_widths (cairo_cff_font_t *font)
     cairo_int_status_t status;
 
     size = sizeof (tt_hhea_t);
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                                 TT_TAG_hhea, 0,
-                                                 (unsigned char*) &hhea, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   TT_TAG_hhea, 0,
+					   (unsigned char*) &hhea, &size);
     if (unlikely (status))
         return status;
     num_hmetrics = be16_to_cpu (hhea.num_hmetrics);
@@ -2631,21 +2632,21 @@ cairo_cff_font_create_set_widths (cairo_cff_font_t *font)
         long_entry_size = 2 * sizeof (int16_t);
         short_entry_size = sizeof (int16_t);
         if (glyph_index < num_hmetrics) {
-            status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                                         TT_TAG_hmtx,
-                                                         glyph_index * long_entry_size,
-                                                         (unsigned char *) &short_entry,
-							 &short_entry_size);
+            status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+						   TT_TAG_hmtx,
+						   glyph_index * long_entry_size,
+						   (unsigned char *) &short_entry,
+						   &short_entry_size);
             if (unlikely (status))
                 return status;
         }
         else
         {
-            status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                                         TT_TAG_hmtx,
-                                                         (num_hmetrics - 1) * long_entry_size,
-                                                         (unsigned char *) &short_entry,
-							 &short_entry_size);
+            status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+						   TT_TAG_hmtx,
+						   (num_hmetrics - 1) * long_entry_size,
+						   (unsigned char *) &short_entry,
+						   &short_entry_size);
             if (unlikely (status))
                 return status;
         }
@@ -2674,6 +2675,17 @@ check_fontdata_is_cff (const unsigned char *data, long length)
     return FALSE;
 }
 
+static void
+cairo_cff_font_release_data (cairo_cff_font_t *font)
+{
+    if (font->data_is_cached)
+	_cairo_font_table_cache_release (font->data);
+    else
+	free (font->data);
+    font->data = NULL;
+    font->data_is_cached = FALSE;
+}
+
 static cairo_int_status_t
 _cairo_cff_font_load_opentype_cff (cairo_cff_font_t  *font)
 {
@@ -2681,36 +2693,42 @@ _cairo_cff_font_load_opentype_cff (cairo_cff_font_t  *font)
     cairo_status_t status;
     tt_head_t head;
     tt_hhea_t hhea;
+    const unsigned char *data;
     unsigned long size, data_length;
 
     if (!backend->load_truetype_table)
 	return CAIRO_INT_STATUS_UNSUPPORTED;
 
-    data_length = 0;
-    status = backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                           TT_TAG_CFF, 0, NULL, &data_length);
+    /* The table is parsed in place, the parser only ever reads it */
+    status = _cairo_font_table_cache_get (font->scaled_font_subset->scaled_font,
+					  TT_TAG_CFF, &data, &data_length);
     if (status)
         return status;
 
+    font->is_opentype = TRUE;
+    font->data = (unsigned char *) data;
+    font->data_length = data_length;
+    font->data_is_cached = TRUE;
+
     size = sizeof (tt_head_t);
-    status = backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                           TT_TAG_head, 0,
-                                           (unsigned char *) &head, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   TT_TAG_head, 0,
+					   (unsigned char *) &head, &size);
     if (unlikely (status))
-        return status;
+        goto FAIL;
 
     size = sizeof (tt_hhea_t);
-    status = backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                           TT_TAG_hhea, 0,
-                                           (unsigned char *) &hhea, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   TT_TAG_hhea, 0,
+					   (unsigned char *) &hhea, &size);
     if (unlikely (status))
-        return status;
+        goto FAIL;
 
     size = 0;
-    status = backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                           TT_TAG_hmtx, 0, NULL, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   TT_TAG_hmtx, 0, NULL, &size);
     if (unlikely (status))
-        return status;
+        goto FAIL;
 
     font->x_min = (int16_t) be16_to_cpu (head.x_min);
     font->y_min = (int16_t) be16_to_cpu (head.y_min);
@@ -2727,24 +2745,18 @@ _cairo_cff_font_load_opentype_cff (cairo_cff_font_t  *font)
 					     &font->ps_name,
 					     &font->font_name);
     if (_cairo_status_is_error (status))
-	return status;
-
-    font->is_opentype = TRUE;
-    font->data_length = data_length;
-    font->data = malloc (data_length);
-    if (unlikely (font->data == NULL))
-        return _cairo_error (CAIRO_STATUS_NO_MEMORY);
-
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-						 TT_TAG_CFF, 0, font->data,
-						 &font->data_length);
-    if (unlikely (status))
-        return status;
+	goto FAIL;
 
-    if (!check_fontdata_is_cff (font->data, data_length))
-	return CAIRO_INT_STATUS_UNSUPPORTED;
+    if (!check_fontdata_is_cff (font->data, data_length)) {
+	status = CAIRO_INT_STATUS_UNSUPPORTED;
+	goto FAIL;
+    }
 
     return CAIRO_STATUS_SUCCESS;
+
+FAIL:
+    cairo_cff_font_release_data (font);
+    return status;
 }
 
 static cairo_int_status_t
@@ -2874,7 +2886,7 @@ fail2:
     free (font->ps_name);
     _cairo_array_fini (&font->output);
 fail1:
-    free (font->data);
+    cairo_cff_font_release_data (font);
     free (font->font_name);
     free (font);
 
@@ -2940,7 +2952,7 @@ cairo_cff_font_destroy (cairo_cff_font_t *font)
 	free (font->fd_nominal_width);
     }
 
-    free (font->data);
+    cairo_cff_font_release_data (font);
 
     free (font);
 }
@@ -3044,26 +3056,22 @@ _cairo_cff_scaled_font_is_cid_cff (cairo_scaled_font_t *scaled_font)
     cairo_array_t index;
     int size;
     cairo_bool_t is_cid = FALSE;
+    cairo_bool_t data_is_cached = FALSE;
 
     backend = scaled_font->backend;
     data = NULL;
     data_length = 0;
     status = CAIRO_INT_STATUS_UNSUPPORTED;
-    /* Try to load an OpenType/CFF font */
-    if (backend->load_truetype_table &&
-	(status = backend->load_truetype_table (scaled_font, TT_TAG_CFF,
-						0, NULL, &data_length)) == CAIRO_INT_STATUS_SUCCESS)
-    {
-	data = malloc (data_length);
-	if (unlikely (data == NULL)) {
-	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
-	    return FALSE;
+    /* Try to load an OpenType/CFF font, which is read in place */
+    if (backend->load_truetype_table) {
+	const unsigned char *table;
+
+	status = _cairo_font_table_cache_get (scaled_font, TT_TAG_CFF,
+					      &table, &data_length);
+	if (status == CAIRO_INT_STATUS_SUCCESS) {
+	    data = (unsigned char *) table;
+	    data_is_cached = TRUE;
 	}
-
-	status = backend->load_truetype_table (scaled_font, TT_TAG_CFF,
-					   0, data, &data_length);
-	if (unlikely (status))
-	    goto fail1;
     }
     /* Try to load a CFF font */
     if (status == CAIRO_INT_STATUS_UNSUPPORTED &&
@@ -3131,7 +3139,10 @@ fail2:
     cff_index_fini (&index);
 
 fail1:
-    free (data);
+    if (data_is_cached)
+	_cairo_font_table_cache_release (data);
+    else
+	free (data);
 
     return is_cid;
 }
@@ -3184,6 +3195,7 @@ _cairo_cff_font_fallback_create (cairo_scaled_font_subset_t  *scaled_font_subset
 
     font->data_length = 0;
     font->data = NULL;
+    font->data_is_cached = FALSE;
     font->data_end = NULL;
 
     status = cff_dict_init (&font->top_dict);
@@ -40,6 +40,7 @@
 #include "cairo-compositor-private.h"
 #include "cairo-damage-private.h"
 #include "cairo-error-private.h"
+#include "cairo-surface-observer-stage-private.h"
 
 cairo_int_status_t
 _cairo_compositor_paint (const cairo_compositor_t	*compositor,
@@ -49,6 +50,7 @@ _cairo_compositor_paint (const cairo_compositor_t	*compositor,
 			 const cairo_clip_t		*clip)
 {
     cairo_composite_rectangles_t extents;
+    cairo_observer_stage_t stage;
     cairo_int_status_t status;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
@@ -58,6 +60,7 @@ _cairo_compositor_paint (const cairo_compositor_t	*compositor,
     if (unlikely (status))
 	return status;
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_COMPOSITE);
     do {
 	while (compositor->paint == NULL)
 	    compositor = compositor->delegate;
@@ -66,6 +69,7 @@ _cairo_compositor_paint (const cairo_compositor_t	*compositor,
 
 	compositor = compositor->delegate;
     } while (status == CAIRO_INT_STATUS_UNSUPPORTED);
+    _cairo_observer_stage_leave (stage);
 
     if (status == CAIRO_INT_STATUS_SUCCESS && surface->damage) {
 	TRACE ((stderr, "%s: applying damage (%d,%d)x(%d, %d)\n",
@@ -90,6 +94,7 @@ _cairo_compositor_mask (const cairo_compositor_t	*compositor,
 			const cairo_clip_t		*clip)
 {
     cairo_composite_rectangles_t extents;
+    cairo_observer_stage_t stage;
     cairo_int_status_t status;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
@@ -99,6 +104,7 @@ _cairo_compositor_mask (const cairo_compositor_t	*compositor,
     if (unlikely (status))
 	return status;
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_COMPOSITE);
     do {
 	while (compositor->mask == NULL)
 	    compositor = compositor->delegate;
@@ -107,6 +113,7 @@ _cairo_compositor_mask (const cairo_compositor_t	*compositor,
 
 	compositor = compositor->delegate;
     } while (status == CAIRO_INT_STATUS_UNSUPPORTED);
+    _cairo_observer_stage_leave (stage);
 
     if (status == CAIRO_INT_STATUS_SUCCESS && surface->damage) {
 	TRACE ((stderr, "%s: applying damage (%d,%d)x(%d, %d)\n",
@@ -136,6 +143,7 @@ _cairo_compositor_stroke (const cairo_compositor_t	*compositor,
 			  const cairo_clip_t		*clip)
 {
     cairo_composite_rectangles_t extents;
+    cairo_observer_stage_t stage;
     cairo_int_status_t status;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
@@ -150,6 +158,7 @@ _cairo_compositor_stroke (const cairo_compositor_t	*compositor,
     if (unlikely (status))
 	return status;
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_COMPOSITE);
     do {
 	while (compositor->stroke == NULL)
 	    compositor = compositor->delegate;
@@ -160,6 +169,7 @@ _cairo_compositor_stroke (const cairo_compositor_t	*compositor,
 
 	compositor = compositor->delegate;
     } while (status == CAIRO_INT_STATUS_UNSUPPORTED);
+    _cairo_observer_stage_leave (stage);
 
     if (status == CAIRO_INT_STATUS_SUCCESS && surface->damage) {
 	TRACE ((stderr, "%s: applying damage (%d,%d)x(%d, %d)\n",
@@ -187,6 +197,7 @@ _cairo_compositor_fill (const cairo_compositor_t	*compositor,
 			const cairo_clip_t		*clip)
 {
     cairo_composite_rectangles_t extents;
+    cairo_observer_stage_t stage;
     cairo_int_status_t status;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
@@ -196,6 +207,7 @@ _cairo_compositor_fill (const cairo_compositor_t	*compositor,
     if (unlikely (status))
 	return status;
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_COMPOSITE);
     do {
 	while (compositor->fill == NULL)
 	    compositor = compositor->delegate;
@@ -205,6 +217,7 @@ _cairo_compositor_fill (const cairo_compositor_t	*compositor,
 
 	compositor = compositor->delegate;
     } while (status == CAIRO_INT_STATUS_UNSUPPORTED);
+    _cairo_observer_stage_leave (stage);
 
     if (status == CAIRO_INT_STATUS_SUCCESS && surface->damage) {
 	TRACE ((stderr, "%s: applying damage (%d,%d)x(%d, %d)\n",
@@ -232,6 +245,7 @@ _cairo_compositor_glyphs (const cairo_compositor_t		*compositor,
 {
     cairo_composite_rectangles_t extents;
     cairo_bool_t overlap;
+    cairo_observer_stage_t stage;
     cairo_int_status_t status;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
@@ -243,6 +257,7 @@ _cairo_compositor_glyphs (const cairo_compositor_t		*compositor,
     if (unlikely (status))
 	return status;
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_COMPOSITE);
     do {
 	while (compositor->glyphs == NULL)
 	    compositor = compositor->delegate;
@@ -252,6 +267,7 @@ _cairo_compositor_glyphs (const cairo_compositor_t		*compositor,
 
 	compositor = compositor->delegate;
     } while (status == CAIRO_INT_STATUS_UNSUPPORTED);
+    _cairo_observer_stage_leave (stage);
 
     if (status == CAIRO_INT_STATUS_SUCCESS && surface->damage) {
 	TRACE ((stderr, "%s: applying damage (%d,%d)x(%d, %d)\n",
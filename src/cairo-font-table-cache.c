@@ -0,0 +1,364 @@
+/* cairo - a vector graphics library with display and print output
+ *
+ * Copyright © 2026 The cairo authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it either under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * (the "LGPL") or, at your option, under the terms of the Mozilla
+ * Public License Version 1.1 (the "MPL"). If you do not alter this
+ * notice, a recipient may use your version of this file under either
+ * the MPL or the LGPL.
+ *
+ * You should have received a copy of the LGPL along with this library
+ * in the file COPYING-LGPL-2.1; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA 02110-1335, USA
+ * You should have received a copy of the MPL along with this library
+ * in the file COPYING-MPL-1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY
+ * OF ANY KIND, either express or implied. See the LGPL or the MPL for
+ * the specific language governing rights and limitations.
+ *
+ * The Original Code is the cairo graphics library.
+ *
+ * The Initial Developer of the Original Code is the cairo authors.
+ */
+
+/* The TrueType/OpenType tables read by the font subsetters.
+ *
+ * Every PDF or PS document embedding a font subsets it afresh, and the
+ * subsetters read the same tables of the font again each time, the
+ * glyf table even glyph by glyph. Instead the tables are read whole,
+ * once, and kept upon the font face, so that they are shared by all the
+ * documents using it.
+ *
+ * The tables of all font faces together are limited to
+ * MAX_FONT_TABLE_CACHE_SIZE, beyond which the least recently used are
+ * dropped. Each table is reference counted, so one that is dropped
+ * whilst a subsetter is still reading it is only freed once released.
+ */
+
+#include "cairoint.h"
+
+#if CAIRO_HAS_FONT_SUBSET
+
+#include "cairo-array-private.h"
+#include "cairo-error-private.h"
+#include "cairo-list-inline.h"
+#include "cairo-scaled-font-subsets-private.h"
+
+#define MAX_FONT_TABLE_CACHE_SIZE (32 * 1024 * 1024)
+
+typedef struct _cairo_font_table {
+    cairo_list_t link;		/* in _cairo_font_tables_lru */
+    cairo_array_t *tables;	/* of the font face, NULL once dropped */
+    int ref_count;
+
+    unsigned long tag;
+    cairo_int_status_t status;	/* UNSUPPORTED if the font has no such table */
+    unsigned long length;
+    unsigned char *data;
+} cairo_font_table_t;
+
+/* All protected by _cairo_font_table_cache_mutex, as are the table
+ * arrays and the reference counts. The most recently used table is
+ * first. */
+static cairo_list_t _cairo_font_tables_lru = {
+    &_cairo_font_tables_lru, &_cairo_font_tables_lru
+};
+static unsigned long _cairo_font_tables_size;
+
+/* The array of tables attached to the font face */
+static const cairo_user_data_key_t _cairo_font_tables_key;
+
+/* Set upon a scaled font once the backend has handed it a table, as
+ * some backends withhold the tables from some of the scaled fonts of a
+ * face; until then the backend is asked each time. */
+static const cairo_user_data_key_t _cairo_font_tables_allowed_key;
+
+static void
+_cairo_font_table_destroy_locked (cairo_font_table_t *table)
+{
+    assert (table->ref_count > 0);
+    if (--table->ref_count == 0)
+	free (table);
+}
+
+static void
+_cairo_font_table_drop_locked (cairo_font_table_t *table)
+{
+    cairo_list_del (&table->link);
+    _cairo_font_tables_size -= table->length;
+    table->tables = NULL;
+    _cairo_font_table_destroy_locked (table);
+}
+
+static void
+_cairo_font_tables_destroy (void *closure)
+{
+    cairo_array_t *tables = closure;
+    cairo_font_table_t **table;
+    unsigned int i;
+
+    CAIRO_MUTEX_LOCK (_cairo_font_table_cache_mutex);
+    for (i = 0; i < _cairo_array_num_elements (tables); i++) {
+	table = _cairo_array_index (tables, i);
+	_cairo_font_table_drop_locked (*table);
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_font_table_cache_mutex);
+
+    _cairo_array_fini (tables);
+    free (tables);
+}
+
+static void
+_cairo_font_tables_remove_locked (cairo_font_table_t *table)
+{
+    cairo_array_t *tables = table->tables;
+    cairo_font_table_t **elements;
+    unsigned int i, last;
+
+    elements = _cairo_array_index (tables, 0);
+    last = _cairo_array_num_elements (tables) - 1;
+    for (i = 0; elements[i] != table; i++)
+	;
+    elements[i] = elements[last];
+    _cairo_array_truncate (tables, last);
+
+    _cairo_font_table_drop_locked (table);
+}
+
+static cairo_font_table_t *
+_cairo_font_tables_lookup_locked (cairo_font_face_t *font_face,
+				  unsigned long      tag)
+{
+    cairo_array_t *tables;
+    cairo_font_table_t *table;
+    unsigned int i;
+
+    tables = cairo_font_face_get_user_data (font_face, &_cairo_font_tables_key);
+    if (tables == NULL)
+	return NULL;
+
+    for (i = 0; i < _cairo_array_num_elements (tables); i++) {
+	table = *(cairo_font_table_t **) _cairo_array_index (tables, i);
+	if (table->tag == tag) {
+	    cairo_list_move (&table->link, &_cairo_font_tables_lru);
+	    table->ref_count++;
+	    return table;
+	}
+    }
+
+    return NULL;
+}
+
+static cairo_status_t
+_cairo_font_tables_add_locked (cairo_font_face_t  *font_face,
+			       cairo_font_table_t *table)
+{
+    cairo_array_t *tables;
+    cairo_status_t status;
+
+    /* not worth throwing everything else out for */
+    if (table->length > MAX_FONT_TABLE_CACHE_SIZE / 2)
+	return CAIRO_STATUS_SUCCESS;
+
+    tables = cairo_font_face_get_user_data (font_face, &_cairo_font_tables_key);
+    if (tables == NULL) {
+	tables = _cairo_malloc (sizeof (cairo_array_t));
+	if (unlikely (tables == NULL))
+	    return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+	_cairo_array_init (tables, sizeof (cairo_font_table_t *));
+	status = cairo_font_face_set_user_data (font_face,
+						&_cairo_font_tables_key,
+						tables,
+						_cairo_font_tables_destroy);
+	if (unlikely (status)) {
+	    free (tables);
+	    return status;
+	}
+    }
+
+    status = _cairo_array_append (tables, &table);
+    if (unlikely (status))
+	return status;
+
+    while (_cairo_font_tables_size + table->length > MAX_FONT_TABLE_CACHE_SIZE) {
+	_cairo_font_tables_remove_locked (cairo_list_last_entry (&_cairo_font_tables_lru,
+								 cairo_font_table_t,
+								 link));
+    }
+
+    table->tables = tables;
+    table->ref_count++;
+    cairo_list_add (&table->link, &_cairo_font_tables_lru);
+    _cairo_font_tables_size += table->length;
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+/* Reads the table through the backend, returning a table that is not
+ * yet in the cache, or an error. */
+static cairo_int_status_t
+_cairo_font_table_read (cairo_scaled_font_t  *scaled_font,
+			unsigned long	      tag,
+			cairo_bool_t	      allowed,
+			cairo_font_table_t  **table_out)
+{
+    const cairo_scaled_font_backend_t *backend = scaled_font->backend;
+    cairo_font_table_t *table;
+    cairo_int_status_t status;
+    unsigned long length;
+
+    length = 0;
+    status = backend->load_truetype_table (scaled_font, tag, 0, NULL, &length);
+    if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
+	/* only known to be missing from the font once the backend has
+	 * shown it hands out the tables of this scaled font */
+	if (! allowed)
+	    return status;
+	length = 0;
+    } else if (unlikely (status)) {
+	return status;
+    }
+
+    table = _cairo_malloc_ab_plus_c (length, 1, sizeof (cairo_font_table_t));
+    if (unlikely (table == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    cairo_list_init (&table->link);
+    table->tables = NULL;
+    table->ref_count = 1;
+    table->tag = tag;
+    table->status = status;
+    table->length = length;
+    table->data = (unsigned char *) (table + 1);
+
+    if (status == CAIRO_INT_STATUS_SUCCESS && length != 0) {
+	status = backend->load_truetype_table (scaled_font, tag, 0,
+					       table->data, &table->length);
+	if (unlikely (status)) {
+	    free (table);
+	    return status;
+	}
+    }
+
+    *table_out = table;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+cairo_int_status_t
+_cairo_font_table_cache_get (cairo_scaled_font_t	 *scaled_font,
+			     unsigned long		  tag,
+			     const unsigned char	**data,
+			     unsigned long		 *length)
+{
+    cairo_font_face_t *font_face = scaled_font->font_face;
+    cairo_font_table_t *table, *cached;
+    cairo_int_status_t status;
+    cairo_bool_t allowed;
+
+    if (scaled_font->backend->load_truetype_table == NULL)
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    CAIRO_MUTEX_LOCK (_cairo_font_table_cache_mutex);
+    table = NULL;
+    allowed = cairo_scaled_font_get_user_data (scaled_font,
+					       &_cairo_font_tables_allowed_key) != NULL;
+    if (allowed)
+	table = _cairo_font_tables_lookup_locked (font_face, tag);
+    CAIRO_MUTEX_UNLOCK (_cairo_font_table_cache_mutex);
+
+    if (table == NULL) {
+	/* Read the table without holding the lock, as the backend takes
+	 * its own; another thread may do the same, in which case the
+	 * first copy to be added is kept.
+	 */
+	status = _cairo_font_table_read (scaled_font, tag, allowed, &table);
+	if (unlikely (status))
+	    return status;
+
+	CAIRO_MUTEX_LOCK (_cairo_font_table_cache_mutex);
+	if (table->status == CAIRO_INT_STATUS_SUCCESS && ! allowed) {
+	    /* failing to set the mark merely costs asking again */
+	    cairo_scaled_font_set_user_data (scaled_font,
+					     &_cairo_font_tables_allowed_key,
+					     (void *) &_cairo_font_tables_allowed_key,
+					     NULL);
+	}
+
+	status = CAIRO_STATUS_SUCCESS;
+	cached = _cairo_font_tables_lookup_locked (font_face, tag);
+	if (cached != NULL) {
+	    _cairo_font_table_destroy_locked (table);
+	    table = cached;
+	} else {
+	    status = _cairo_font_tables_add_locked (font_face, table);
+	    if (unlikely (status))
+		_cairo_font_table_destroy_locked (table);
+	}
+	CAIRO_MUTEX_UNLOCK (_cairo_font_table_cache_mutex);
+
+	if (unlikely (status))
+	    return status;
+    }
+
+    if (table->status) {
+	status = table->status;
+	_cairo_font_table_cache_release (table->data);
+	return status;
+    }
+
+    *data = table->data;
+    *length = table->length;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+void
+_cairo_font_table_cache_release (const unsigned char *data)
+{
+    cairo_font_table_t *table = (cairo_font_table_t *) data - 1;
+
+    CAIRO_MUTEX_LOCK (_cairo_font_table_cache_mutex);
+    _cairo_font_table_destroy_locked (table);
+    CAIRO_MUTEX_UNLOCK (_cairo_font_table_cache_mutex);
+}
+
+cairo_int_status_t
+_cairo_font_table_cache_load (cairo_scaled_font_t	*scaled_font,
+			      unsigned long		 tag,
+			      long			 offset,
+			      unsigned char		*buffer,
+			      unsigned long		*length)
+{
+    const unsigned char *data;
+    unsigned long size;
+    cairo_int_status_t status;
+
+    status = _cairo_font_table_cache_get (scaled_font, tag, &data, &size);
+    if (unlikely (status))
+	return status;
+
+    if (buffer == NULL) {
+	*length = size;
+    } else if (offset < 0 ||
+	       (unsigned long) offset > size ||
+	       *length > size - offset)
+    {
+	status = CAIRO_INT_STATUS_UNSUPPORTED;
+    } else {
+	memcpy (buffer, data + offset, *length);
+    }
+
+    _cairo_font_table_cache_release (data);
+    return status;
+}
+
+#endif /* CAIRO_HAS_FONT_SUBSET */
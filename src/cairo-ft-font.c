@@ -72,6 +72,14 @@
 #define access(p, m) 0
 #endif
 
+#if HAVE_MMAP && HAVE_UNISTD_H
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#undef HAVE_MMAP
+#endif
+
 /* Fontconfig version older than 2.6 didn't have these options */
 #ifndef FC_LCD_FILTER
 #define FC_LCD_FILTER	"lcdfilter"
@@ -97,9 +105,10 @@
 #define DOUBLE_TO_16_16(d) ((FT_Fixed)((d) * 65536.0))
 #define DOUBLE_FROM_16_16(t) ((double)(t) / 65536.0)
 
-/* This is the max number of FT_face objects we keep open at once
+/* This is the default for the max number of FT_face objects we keep
+ * open at once, see cairo_ft_set_max_open_faces().
  */
-#define MAX_OPEN_FACES 10
+#define MAX_OPEN_FACES 32
 
 /**
  * SECTION:cairo-ft
@@ -159,6 +168,13 @@ struct _cairo_ft_unscaled_font {
     char *filename;
     int id;
 
+    /* the font file, if kept mapped, see cairo_ft_set_map_font_files() */
+    unsigned char *file_data;
+    size_t file_size;
+
+    /* when the face was last locked, for choosing which face to close */
+    unsigned int last_use;
+
     /* We temporarily scale the unscaled font as needed */
     cairo_bool_t have_scale;
     cairo_matrix_t current_scale;
@@ -172,6 +188,14 @@ struct _cairo_ft_unscaled_font {
     int lock_count;
 
     cairo_ft_font_face_t *faces;	/* Linked list of faces for this font */
+
+    /* Idle clones of the face for loading glyphs without holding the
+     * mutex, see _cairo_ft_unscaled_font_lease_clone(). A clone is a
+     * bare unscaled font that only carries its own face and scale.
+     * Both the list and the count are protected by the font map. */
+    cairo_ft_unscaled_font_t *clones;
+    cairo_ft_unscaled_font_t *next_clone;
+    int num_clones;		/* including leased */
 };
 
 static int
@@ -185,6 +209,7 @@ typedef struct _cairo_ft_options {
     cairo_font_options_t base;
     unsigned int load_flags; /* flags for FT_Load_Glyph */
     unsigned int synth_flags;
+    cairo_bool_t subpixel_positions;
 } cairo_ft_options_t;
 
 struct _cairo_ft_font_face {
@@ -231,9 +256,9 @@ _ft_to_cairo_error (FT_Error error)
  * We maintain a hash table to map file/id => #cairo_ft_unscaled_font_t.
  * The hash table itself isn't limited in size. However, we limit the
  * number of FT_Face objects we keep around; when we've exceeded that
- * limit and need to create a new FT_Face, we dump the FT_Face from a
- * random #cairo_ft_unscaled_font_t which has an unlocked FT_Face, (if
- * there are any).
+ * limit and need to create a new FT_Face, we dump the FT_Face from the
+ * least recently used #cairo_ft_unscaled_font_t which has an unlocked
+ * FT_Face, (if there are any).
  */
 
 typedef struct _cairo_ft_unscaled_font_map {
@@ -244,6 +269,15 @@ typedef struct _cairo_ft_unscaled_font_map {
 
 static cairo_ft_unscaled_font_map_t *cairo_ft_unscaled_font_map = NULL;
 
+/* Protected by the font map mutex, see cairo_ft_set_max_face_clones(),
+ * cairo_ft_set_max_open_faces() and cairo_ft_set_map_font_files() */
+static int cairo_ft_max_face_clones = 0;
+static int cairo_ft_max_open_faces = MAX_OPEN_FACES;
+static cairo_bool_t cairo_ft_map_font_files = FALSE;
+
+/* Ticks on every face lock, giving the order for LRU */
+static cairo_atomic_int_t cairo_ft_face_clock;
+
 
 static FT_Face
 _cairo_ft_unscaled_font_lock_face (cairo_ft_unscaled_font_t *unscaled);
@@ -268,6 +302,127 @@ _font_map_release_face_lock_held (cairo_ft_unscaled_font_map_t *font_map,
     }
 }
 
+static void
+_font_map_release_clones_lock_held (cairo_ft_unscaled_font_map_t *font_map,
+				    cairo_ft_unscaled_font_t *unscaled)
+{
+    /* Only called once the last reference is gone, when no glyph
+     * can be loading and so every clone is back on the idle list. */
+    while (unscaled->clones) {
+	cairo_ft_unscaled_font_t *clone = unscaled->clones;
+
+	unscaled->clones = clone->next_clone;
+	FT_Done_Face (clone->face);
+	free (clone);
+	unscaled->num_clones--;
+    }
+    assert (unscaled->num_clones == 0);
+}
+
+#if HAVE_MMAP
+static void
+_cairo_ft_unscaled_font_map_file (cairo_ft_unscaled_font_t *unscaled)
+{
+    struct stat st;
+    void *data;
+    int fd;
+
+    fd = open (unscaled->filename, O_RDONLY);
+    if (fd == -1)
+	return;
+
+    if (fstat (fd, &st) == 0 && st.st_size > 0) {
+	data = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data != MAP_FAILED) {
+	    unscaled->file_data = data;
+	    unscaled->file_size = st.st_size;
+	}
+    }
+
+    close (fd);
+}
+#endif
+
+/* Opens a new face on the font file of an unscaled font. If the file is
+ * kept mapped, reopening a face after it was closed only has to parse
+ * the font again, without going back to the file system. */
+static FT_Error
+_font_map_open_face_lock_held (cairo_ft_unscaled_font_map_t *font_map,
+			       cairo_ft_unscaled_font_t *unscaled,
+			       FT_Face *face)
+{
+    assert (! unscaled->from_face);
+
+#if HAVE_MMAP
+    if (unscaled->file_data == NULL && cairo_ft_map_font_files)
+	_cairo_ft_unscaled_font_map_file (unscaled);
+    if (unscaled->file_data != NULL) {
+	return FT_New_Memory_Face (font_map->ft_library,
+				   unscaled->file_data,
+				   unscaled->file_size,
+				   unscaled->id,
+				   face);
+    }
+#endif
+
+    return FT_New_Face (font_map->ft_library,
+			unscaled->filename,
+			unscaled->id,
+			face);
+}
+
+static cairo_bool_t
+_has_unlocked_face (const void *entry)
+{
+    const cairo_ft_unscaled_font_t *unscaled = entry;
+
+    return (!unscaled->from_face && unscaled->lock_count == 0 && unscaled->face);
+}
+
+struct _lru_face {
+    unsigned int now;
+    unsigned int age;
+    cairo_ft_unscaled_font_t *unscaled;
+};
+
+static void
+_find_lru_face (void *entry, void *closure)
+{
+    cairo_ft_unscaled_font_t *unscaled = entry;
+    struct _lru_face *lru = closure;
+    unsigned int age;
+
+    if (! _has_unlocked_face (unscaled))
+	return;
+
+    /* unsigned, so that this survives the clock wrapping */
+    age = lru->now - unscaled->last_use;
+    if (lru->unscaled == NULL || age > lru->age) {
+	lru->unscaled = unscaled;
+	lru->age = age;
+    }
+}
+
+/* Closes the least recently used unlocked faces until fewer than
+ * max_faces are open, or only locked faces remain. */
+static void
+_font_map_trim_faces_lock_held (cairo_ft_unscaled_font_map_t *font_map,
+				int max_faces)
+{
+    while (font_map->num_open_faces > max_faces) {
+	struct _lru_face lru;
+
+	lru.now = _cairo_atomic_int_get (&cairo_ft_face_clock);
+	lru.age = 0;
+	lru.unscaled = NULL;
+	_cairo_hash_table_foreach (font_map->hash_table, _find_lru_face, &lru);
+	if (lru.unscaled == NULL)
+	    break;
+
+	_font_map_release_face_lock_held (font_map, lru.unscaled);
+    }
+}
+
 static cairo_status_t
 _cairo_ft_unscaled_font_map_create (void)
 {
@@ -316,6 +471,7 @@ _cairo_ft_unscaled_font_map_pluck_entry (void *entry, void *closure)
 
     if (! unscaled->from_face)
 	_font_map_release_face_lock_held (font_map, unscaled);
+    _font_map_release_clones_lock_held (font_map, unscaled);
 
     _cairo_ft_unscaled_font_fini (unscaled);
     free (unscaled);
@@ -441,6 +597,14 @@ _cairo_ft_unscaled_font_init (cairo_ft_unscaled_font_t *unscaled,
 
     unscaled->faces = NULL;
 
+    unscaled->clones = NULL;
+    unscaled->next_clone = NULL;
+    unscaled->num_clones = 0;
+
+    unscaled->file_data = NULL;
+    unscaled->file_size = 0;
+    unscaled->last_use = 0;
+
     return CAIRO_STATUS_SUCCESS;
 }
 
@@ -460,6 +624,12 @@ _cairo_ft_unscaled_font_fini (cairo_ft_unscaled_font_t *unscaled)
 {
     assert (unscaled->face == NULL);
 
+#if HAVE_MMAP
+    if (unscaled->file_data != NULL)
+	munmap (unscaled->file_data, unscaled->file_size);
+    unscaled->file_data = NULL;
+#endif
+
     free (unscaled->filename);
     unscaled->filename = NULL;
 
@@ -628,6 +798,7 @@ _cairo_ft_unscaled_font_destroy (void *abstract_font)
 	}
     } else {
 	_font_map_release_face_lock_held (font_map, unscaled);
+	_font_map_release_clones_lock_held (font_map, unscaled);
     }
     unscaled->face = NULL;
 
@@ -637,16 +808,8 @@ _cairo_ft_unscaled_font_destroy (void *abstract_font)
     return TRUE;
 }
 
-static cairo_bool_t
-_has_unlocked_face (const void *entry)
-{
-    const cairo_ft_unscaled_font_t *unscaled = entry;
-
-    return (!unscaled->from_face && unscaled->lock_count == 0 && unscaled->face);
-}
-
 /* Ensures that an unscaled font has a face object. If we exceed
- * MAX_OPEN_FACES, try to close some.
+ * the max number of open faces, try to close some.
  *
  * This differs from _cairo_ft_scaled_font_lock_face in that it doesn't
  * set the scale on the face, but just returns it at the last scale.
@@ -661,6 +824,9 @@ _cairo_ft_unscaled_font_lock_face (cairo_ft_unscaled_font_t *unscaled)
     CAIRO_MUTEX_LOCK (unscaled->mutex);
     unscaled->lock_count++;
 
+    _cairo_atomic_int_inc (&cairo_ft_face_clock);
+    unscaled->last_use = _cairo_atomic_int_get (&cairo_ft_face_clock);
+
     if (unscaled->face)
 	return unscaled->face;
 
@@ -668,30 +834,17 @@ _cairo_ft_unscaled_font_lock_face (cairo_ft_unscaled_font_t *unscaled)
      * returned it above. */
     assert (!unscaled->from_face);
 
+    /* Faces are opened under the font map lock as FT_New_Face is not
+     * safe against concurrent use of the FT_Library. */
     font_map = _cairo_ft_unscaled_font_map_lock ();
-    {
-	assert (font_map != NULL);
-
-	while (font_map->num_open_faces >= MAX_OPEN_FACES)
-	{
-	    cairo_ft_unscaled_font_t *entry;
-
-	    entry = _cairo_hash_table_random_entry (font_map->hash_table,
-						    _has_unlocked_face);
-	    if (entry == NULL)
-		break;
+    assert (font_map != NULL);
 
-	    _font_map_release_face_lock_held (font_map, entry);
-	}
-    }
-    _cairo_ft_unscaled_font_map_unlock ();
+    _font_map_trim_faces_lock_held (font_map, cairo_ft_max_open_faces - 1);
 
-    error = FT_New_Face (font_map->ft_library,
-			 unscaled->filename,
-			 unscaled->id,
-			 &face);
+    error = _font_map_open_face_lock_held (font_map, unscaled, &face);
     if (error)
     {
+	_cairo_ft_unscaled_font_map_unlock ();
 	unscaled->lock_count--;
 	CAIRO_MUTEX_UNLOCK (unscaled->mutex);
 	_cairo_error_throw (_ft_to_cairo_error (error));
@@ -701,6 +854,7 @@ _cairo_ft_unscaled_font_lock_face (cairo_ft_unscaled_font_t *unscaled)
     unscaled->face = face;
 
     font_map->num_open_faces++;
+    _cairo_ft_unscaled_font_map_unlock ();
 
     return face;
 }
@@ -718,6 +872,73 @@ _cairo_ft_unscaled_font_unlock_face (cairo_ft_unscaled_font_t *unscaled)
     CAIRO_MUTEX_UNLOCK (unscaled->mutex);
 }
 
+/* Returns a private clone of the unscaled font, with a face of its own
+ * opened from the same file, for loading and rendering glyphs without
+ * holding unscaled->mutex, or %NULL if the caller should lock the
+ * shared face as usual. Clones are pooled on the unscaled font and
+ * only created when no idle one is available, so there are never more
+ * than there have been concurrent glyph loads, nor more than
+ * cairo_ft_set_max_face_clones() allows.
+ *
+ * Faces provided by the user are never cloned, since we cannot know how
+ * they were set up; the FT_Library we share with the clones is only
+ * used under the font map mutex for creating and destroying faces.
+ * Clones of a mapped font file share the mapping.
+ */
+static cairo_ft_unscaled_font_t *
+_cairo_ft_unscaled_font_lease_clone (cairo_ft_unscaled_font_t *unscaled)
+{
+    cairo_ft_unscaled_font_map_t *font_map;
+    cairo_ft_unscaled_font_t *clone;
+    FT_Error error;
+
+    if (unscaled->from_face)
+	return NULL;
+
+    /* Not unscaled->mutex, which is held for as long as another thread
+     * loads a glyph through the shared face. */
+    font_map = _cairo_ft_unscaled_font_map_lock ();
+    assert (font_map != NULL);
+
+    clone = unscaled->clones;
+    if (clone != NULL) {
+	unscaled->clones = clone->next_clone;
+	goto UNLOCK;
+    }
+
+    if (unscaled->num_clones >= cairo_ft_max_face_clones)
+	goto UNLOCK;
+
+    clone = calloc (1, sizeof (cairo_ft_unscaled_font_t));
+    if (unlikely (clone == NULL))
+	goto UNLOCK;
+
+    error = _font_map_open_face_lock_held (font_map, unscaled, &clone->face);
+    if (error) {
+	free (clone);
+	clone = NULL;
+	goto UNLOCK;
+    }
+
+    clone->from_face = TRUE;
+    clone->id = unscaled->id;
+    unscaled->num_clones++;
+
+UNLOCK:
+    _cairo_ft_unscaled_font_map_unlock ();
+    return clone;
+}
+
+static void
+_cairo_ft_unscaled_font_release_clone (cairo_ft_unscaled_font_t *unscaled,
+				       cairo_ft_unscaled_font_t *clone)
+{
+    _cairo_ft_unscaled_font_map_lock ();
+    clone->next_clone = unscaled->clones;
+    unscaled->clones = clone;
+    _cairo_ft_unscaled_font_map_unlock ();
+}
+
 
 static cairo_status_t
 _compute_transform (cairo_ft_font_transform_t *sf,
@@ -1689,6 +1910,7 @@ _get_pattern_ft_options (FcPattern *pattern, cairo_ft_options_t *ret)
     _cairo_font_options_init_default (&ft_options.base);
     ft_options.load_flags = FT_LOAD_DEFAULT;
     ft_options.synth_flags = 0;
+    ft_options.subpixel_positions = FALSE;
 
 #ifndef FC_EMBEDDED_BITMAP
 #define FC_EMBEDDED_BITMAP "embeddedbitmap"
@@ -1905,6 +2127,7 @@ _cairo_ft_options_merge (cairo_ft_options_t *options,
 
     options->load_flags = load_flags | load_target;
     options->synth_flags = other->synth_flags;
+    options->subpixel_positions = other->subpixel_positions;
 }
 
 static cairo_status_t
@@ -1947,6 +2170,16 @@ _cairo_ft_font_face_scaled_font_create (void		    *abstract_font_face,
     if (unlikely (status))
 	goto CLEANUP_SCALED_FONT;
 
+    /* Without hinted metrics the glyphs are laid out at fractional
+     * positions, so if asked to, render them at the nearest quarter
+     * pixel rather than rounding them to whole pixels.
+     */
+    scaled_font->base.subpixel_positions =
+	scaled_font->ft_options.subpixel_positions &&
+	scaled_font->base.options.hint_metrics == CAIRO_HINT_METRICS_OFF &&
+	scaled_font->ft_options.base.antialias != CAIRO_ANTIALIAS_NONE &&
+	FT_IS_SCALABLE (face);
+
     status = _cairo_ft_unscaled_font_set_scale (unscaled,
 				                &scaled_font->base.scale);
     if (unlikely (status)) {
@@ -2187,17 +2420,16 @@ _decompose_glyph_outline (FT_Face		  face,
  * Translate glyph to match its metrics.
  */
 static void
-_cairo_ft_scaled_glyph_vertical_layout_bearing_fix (void        *abstract_font,
+_cairo_ft_scaled_glyph_vertical_layout_bearing_fix (cairo_ft_unscaled_font_t *unscaled,
 						    FT_GlyphSlot glyph)
 {
-    cairo_ft_scaled_font_t *scaled_font = abstract_font;
     FT_Vector vector;
 
     vector.x = glyph->metrics.vertBearingX - glyph->metrics.horiBearingX;
     vector.y = -glyph->metrics.vertBearingY - glyph->metrics.horiBearingY;
 
     if (glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
-	FT_Vector_Transform (&vector, &scaled_font->unscaled->Current_Shape);
+	FT_Vector_Transform (&vector, &unscaled->Current_Shape);
 	FT_Outline_Translate(&glyph->outline, vector.x, vector.y);
     } else if (glyph->format == FT_GLYPH_FORMAT_BITMAP) {
 	glyph->bitmap_left += vector.x / 64;
@@ -2213,6 +2445,7 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
     cairo_text_extents_t    fs_metrics;
     cairo_ft_scaled_font_t *scaled_font = abstract_font;
     cairo_ft_unscaled_font_t *unscaled = scaled_font->unscaled;
+    cairo_ft_unscaled_font_t *clone = NULL;
     FT_GlyphSlot glyph;
     FT_Face face;
     FT_Error error;
@@ -2222,11 +2455,20 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
     cairo_bool_t vertical_layout = FALSE;
     cairo_status_t status;
 
-    face = _cairo_ft_unscaled_font_lock_face (unscaled);
-    if (!face)
-	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+    /* The LCD filter is set on the FT_Library for the duration of the
+     * render, so subpixel glyphs are still rendered one at a time. */
+    if (scaled_font->ft_options.base.antialias != CAIRO_ANTIALIAS_SUBPIXEL)
+	clone = _cairo_ft_unscaled_font_lease_clone (unscaled);
+    if (clone != NULL) {
+	unscaled = clone;
+	face = clone->face;
+    } else {
+	face = _cairo_ft_unscaled_font_lock_face (unscaled);
+	if (!face)
+	    return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+    }
 
-    status = _cairo_ft_unscaled_font_set_scale (scaled_font->unscaled,
+    status = _cairo_ft_unscaled_font_set_scale (unscaled,
 				                &scaled_font->base.scale);
     if (unlikely (status))
 	goto FAIL;
@@ -2262,7 +2504,8 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
 #endif
 
     error = FT_Load_Glyph (face,
-			   _cairo_scaled_glyph_index(scaled_glyph),
+			   _cairo_scaled_glyph_index(scaled_glyph) &
+			   CAIRO_SCALED_GLYPH_INDEX_MASK,
 			   load_flags);
     /* XXX ignoring all other errors for now.  They are not fatal, typically
      * just a glyph-not-found. */
@@ -2287,7 +2530,7 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
 #endif
 
     if (vertical_layout)
-	_cairo_ft_scaled_glyph_vertical_layout_bearing_fix (scaled_font, glyph);
+	_cairo_ft_scaled_glyph_vertical_layout_bearing_fix (unscaled, glyph);
 
     if (info & CAIRO_SCALED_GLYPH_INFO_METRICS) {
 
@@ -2388,11 +2631,21 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
 
     if ((info & CAIRO_SCALED_GLYPH_INFO_SURFACE) != 0) {
 	cairo_image_surface_t	*surface;
+	int phase = _cairo_scaled_glyph_phase (scaled_glyph);
 
 	if (glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
+	    /* Render subpixel-positioned glyphs shifted right by their
+	     * phase; the outline is reloaded below if a path is wanted. */
+	    if (phase)
+		FT_Outline_Translate (&glyph->outline,
+				      phase * 64 / CAIRO_SCALED_GLYPH_PHASES, 0);
 	    status = _render_glyph_outline (face, &scaled_font->ft_options.base,
 					    &surface);
 	} else {
+	    /* Bitmaps cannot be shifted by a fraction of a pixel, so
+	     * snap them to the nearest one instead. */
+	    if (phase >= CAIRO_SCALED_GLYPH_PHASES / 2 && ! unscaled->have_shape)
+		glyph->bitmap_left++;
 	    status = _render_glyph_bitmap (face, &scaled_font->ft_options.base,
 					   &surface);
 	    if (likely (status == CAIRO_STATUS_SUCCESS) &&
@@ -2421,7 +2674,8 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
 	 */
 	if ((info & CAIRO_SCALED_GLYPH_INFO_SURFACE) != 0) {
 	    error = FT_Load_Glyph (face,
-				   _cairo_scaled_glyph_index(scaled_glyph),
+				   _cairo_scaled_glyph_index(scaled_glyph) &
+				   CAIRO_SCALED_GLYPH_INDEX_MASK,
 				   load_flags | FT_LOAD_NO_BITMAP);
 	    /* XXX ignoring all other errors for now.  They are not fatal, typically
 	     * just a glyph-not-found. */
@@ -2438,7 +2692,7 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
 		FT_GlyphSlot_Oblique (glyph);
 #endif
 	    if (vertical_layout)
-		_cairo_ft_scaled_glyph_vertical_layout_bearing_fix (scaled_font, glyph);
+		_cairo_ft_scaled_glyph_vertical_layout_bearing_fix (unscaled, glyph);
 
 	}
 	if (glyph->format == FT_GLYPH_FORMAT_OUTLINE)
@@ -2455,7 +2709,10 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
 				      path);
     }
  FAIL:
-    _cairo_ft_unscaled_font_unlock_face (unscaled);
+    if (clone != NULL)
+	_cairo_ft_unscaled_font_release_clone (scaled_font->unscaled, clone);
+    else
+	_cairo_ft_unscaled_font_unlock_face (unscaled);
 
     return status;
 }
@@ -2962,6 +3219,7 @@ _cairo_ft_font_face_create (cairo_ft_unscaled_font_t *unscaled,
     {
 	if (font_face->ft_options.load_flags == ft_options->load_flags &&
 	    font_face->ft_options.synth_flags == ft_options->synth_flags &&
+	    font_face->ft_options.subpixel_positions == ft_options->subpixel_positions &&
 	    cairo_font_options_equal (&font_face->ft_options.base, &ft_options->base))
 	{
 	    if (font_face->base.status) {
@@ -3382,6 +3640,7 @@ cairo_ft_font_face_create_for_ft_face (FT_Face         face,
 
     ft_options.load_flags = load_flags;
     ft_options.synth_flags = 0;
+    ft_options.subpixel_positions = FALSE;
     _cairo_font_options_init_default (&ft_options.base);
 
     font_face = _cairo_ft_font_face_create (unscaled, &ft_options);
@@ -3458,6 +3717,217 @@ cairo_ft_font_face_get_synthesize (cairo_font_face_t *font_face)
     return ft->ft_options.synth_flags;
 }
 
+/**
+ * cairo_ft_font_face_set_subpixel_positions:
+ * @font_face: The #cairo_ft_font_face_t object to modify
+ * @subpixel_positions: whether to render glyphs at subpixel positions
+ *
+ * Without hinted metrics (see #cairo_hint_metrics_t), glyphs are laid
+ * out at fractional positions but are still rendered at the nearest
+ * whole pixel. If @subpixel_positions is %TRUE, antialiased glyphs of
+ * a scalable @font_face are instead rendered by the image, xlib and
+ * xcb backends at the nearest quarter pixel horizontally. Each glyph
+ * is then cached up to four times, once for each position within a
+ * pixel.
+ *
+ * This only affects the scaled fonts created from @font_face
+ * afterwards.
+ *
+ * Since: 1.16
+ **/
+void
+cairo_ft_font_face_set_subpixel_positions (cairo_font_face_t *font_face,
+					   cairo_bool_t	      subpixel_positions)
+{
+    cairo_ft_font_face_t *ft;
+
+    if (font_face->backend->type != CAIRO_FONT_TYPE_FT)
+	return;
+
+    ft = (cairo_ft_font_face_t *) font_face;
+    ft->ft_options.subpixel_positions = subpixel_positions;
+}
+
+/**
+ * cairo_ft_font_face_get_subpixel_positions:
+ * @font_face: The #cairo_ft_font_face_t object to query
+ *
+ * See cairo_ft_font_face_set_subpixel_positions().
+ *
+ * Returns: whether glyphs are rendered at subpixel positions.
+ *
+ * Since: 1.16
+ **/
+cairo_bool_t
+cairo_ft_font_face_get_subpixel_positions (cairo_font_face_t *font_face)
+{
+    cairo_ft_font_face_t *ft;
+
+    if (font_face->backend->type != CAIRO_FONT_TYPE_FT)
+	return FALSE;
+
+    ft = (cairo_ft_font_face_t *) font_face;
+    return ft->ft_options.subpixel_positions;
+}
+
+/**
+ * cairo_ft_set_max_face_clones:
+ * @max_clones: the number of additional faces to allow per font file
+ *
+ * Sets how many additional #FT_Face objects cairo may open on each font
+ * file so that glyphs from one typeface can be loaded and rendered on
+ * several threads at once. With the default of 0, threads rendering
+ * uncached glyphs from the same font file take turns on a single face.
+ *
+ * Clones are only opened when glyphs are being loaded concurrently and
+ * are kept until the font is destroyed; a typical value is the number of
+ * threads drawing text. Faces passed to
+ * cairo_ft_font_face_create_for_ft_face() are never cloned, and glyphs
+ * rendered with %CAIRO_ANTIALIAS_SUBPIXEL are still rendered one at a
+ * time.
+ *
+ * Since: 1.16
+ **/
+void
+cairo_ft_set_max_face_clones (int max_clones)
+{
+    if (max_clones < 0)
+	max_clones = 0;
+
+    CAIRO_MUTEX_INITIALIZE ();
+
+    CAIRO_MUTEX_LOCK (_cairo_ft_unscaled_font_map_mutex);
+    cairo_ft_max_face_clones = max_clones;
+    CAIRO_MUTEX_UNLOCK (_cairo_ft_unscaled_font_map_mutex);
+}
+
+/**
+ * cairo_ft_get_max_face_clones:
+ *
+ * See cairo_ft_set_max_face_clones().
+ *
+ * Returns: the number of additional faces allowed per font file.
+ *
+ * Since: 1.16
+ **/
+int
+cairo_ft_get_max_face_clones (void)
+{
+    int max_clones;
+
+    CAIRO_MUTEX_INITIALIZE ();
+
+    CAIRO_MUTEX_LOCK (_cairo_ft_unscaled_font_map_mutex);
+    max_clones = cairo_ft_max_face_clones;
+    CAIRO_MUTEX_UNLOCK (_cairo_ft_unscaled_font_map_mutex);
+
+    return max_clones;
+}
+
+/**
+ * cairo_ft_set_max_open_faces:
+ * @max_faces: the number of #FT_Face objects to keep open
+ *
+ * Sets how many #FT_Face objects cairo keeps open for the font files
+ * it has loaded, not counting faces passed to
+ * cairo_ft_font_face_create_for_ft_face() or the clones allowed by
+ * cairo_ft_set_max_face_clones(). When a face has to be opened with the
+ * limit reached, the least recently used face that is not in use is
+ * closed first. The default is 32; documents using many fonts at once
+ * render faster with a larger limit, as closed faces have to be parsed
+ * again when next used.
+ *
+ * Lowering the limit closes faces that are not in use straight away.
+ *
+ * Since: 1.16
+ **/
+void
+cairo_ft_set_max_open_faces (int max_faces)
+{
+    if (max_faces < 1)
+	max_faces = 1;
+
+    CAIRO_MUTEX_INITIALIZE ();
+
+    CAIRO_MUTEX_LOCK (_cairo_ft_unscaled_font_map_mutex);
+    cairo_ft_max_open_faces = max_faces;
+    if (cairo_ft_unscaled_font_map != NULL)
+	_font_map_trim_faces_lock_held (cairo_ft_unscaled_font_map, max_faces);
+    CAIRO_MUTEX_UNLOCK (_cairo_ft_unscaled_font_map_mutex);
+}
+
+/**
+ * cairo_ft_get_max_open_faces:
+ *
+ * See cairo_ft_set_max_open_faces().
+ *
+ * Returns: the number of #FT_Face objects cairo keeps open.
+ *
+ * Since: 1.16
+ **/
+int
+cairo_ft_get_max_open_faces (void)
+{
+    int max_faces;
+
+    CAIRO_MUTEX_INITIALIZE ();
+
+    CAIRO_MUTEX_LOCK (_cairo_ft_unscaled_font_map_mutex);
+    max_faces = cairo_ft_max_open_faces;
+    CAIRO_MUTEX_UNLOCK (_cairo_ft_unscaled_font_map_mutex);
+
+    return max_faces;
+}
+
+/**
+ * cairo_ft_set_map_font_files:
+ * @map: whether to keep font files mapped
+ *
+ * Sets whether cairo keeps each font file it opens mapped into memory
+ * for as long as the font is alive, so that a face closed to stay
+ * within cairo_ft_set_max_open_faces() is reopened from memory rather
+ * than from the file system. The mapping is shared with the clones of
+ * cairo_ft_set_max_face_clones().
+ *
+ * This only affects font files opened afterwards, and has no effect on
+ * platforms without mmap(). As with any mapped file, a font file must
+ * not be truncated whilst cairo is using it. The default is %FALSE.
+ *
+ * Since: 1.16
+ **/
+void
+cairo_ft_set_map_font_files (cairo_bool_t map)
+{
+    CAIRO_MUTEX_INITIALIZE ();
+
+    CAIRO_MUTEX_LOCK (_cairo_ft_unscaled_font_map_mutex);
+    cairo_ft_map_font_files = map;
+    CAIRO_MUTEX_UNLOCK (_cairo_ft_unscaled_font_map_mutex);
+}
+
+/**
+ * cairo_ft_get_map_font_files:
+ *
+ * See cairo_ft_set_map_font_files().
+ *
+ * Returns: whether cairo keeps font files mapped.
+ *
+ * Since: 1.16
+ **/
+cairo_bool_t
+cairo_ft_get_map_font_files (void)
+{
+    cairo_bool_t map;
+
+    CAIRO_MUTEX_INITIALIZE ();
+
+    CAIRO_MUTEX_LOCK (_cairo_ft_unscaled_font_map_mutex);
+    map = cairo_ft_map_font_files;
+    CAIRO_MUTEX_UNLOCK (_cairo_ft_unscaled_font_map_mutex);
+
+    return map;
+}
+
 /**
  * cairo_ft_scaled_font_lock_face:
  * @scaled_font: A #cairo_scaled_font_t from the FreeType font backend. Such an
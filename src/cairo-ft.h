@@ -91,6 +91,31 @@ cairo_ft_font_face_unset_synthesize (cairo_font_face_t *font_face,
 cairo_public unsigned int
 cairo_ft_font_face_get_synthesize (cairo_font_face_t *font_face);
 
+cairo_public void
+cairo_ft_font_face_set_subpixel_positions (cairo_font_face_t *font_face,
+					   cairo_bool_t	      subpixel_positions);
+
+cairo_public cairo_bool_t
+cairo_ft_font_face_get_subpixel_positions (cairo_font_face_t *font_face);
+
+cairo_public void
+cairo_ft_set_max_face_clones (int max_clones);
+
+cairo_public int
+cairo_ft_get_max_face_clones (void);
+
+cairo_public void
+cairo_ft_set_max_open_faces (int max_faces);
+
+cairo_public int
+cairo_ft_get_max_open_faces (void);
+
+cairo_public void
+cairo_ft_set_map_font_files (cairo_bool_t map);
+
+cairo_public cairo_bool_t
+cairo_ft_get_map_font_files (void);
+
 
 cairo_public FT_Face
 cairo_ft_scaled_font_lock_face (cairo_scaled_font_t *scaled_font);
@@ -49,6 +49,7 @@
 #include "cairo-spans-compositor-private.h"
 
 #include "cairo-region-private.h"
+#include "cairo-surface-observer-stage-private.h"
 #include "cairo-traps-private.h"
 #include "cairo-tristrip-private.h"
 
@@ -597,6 +598,9 @@ _pixman_image_add_traps (pixman_image_t *image,
 {
     cairo_trapezoid_t *t = traps->traps;
     int num_traps = traps->num_traps;
+    cairo_observer_stage_t stage;
+
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_RASTERISE);
     while (num_traps--) {
 	pixman_trapezoid_t trap;
 
@@ -633,6 +637,7 @@ _pixman_image_add_traps (pixman_image_t *image,
 	pixman_rasterize_trapezoid (image, &trap, -dst_x, -dst_y);
 	t++;
     }
+    _cairo_observer_stage_leave (stage);
 }
 
 static cairo_int_status_t
@@ -711,8 +716,10 @@ _pixman_image_add_tristrip (pixman_image_t *image,
 {
     pixman_triangle_t tri;
     pixman_point_fixed_t *p[3] = {&tri.p1, &tri.p2, &tri.p3 };
+    cairo_observer_stage_t stage;
     int n;
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_RASTERISE);
     set_point (p[0], &strip->points[0]);
     set_point (p[1], &strip->points[1]);
     set_point (p[2], &strip->points[2]);
@@ -721,6 +728,7 @@ _pixman_image_add_tristrip (pixman_image_t *image,
 	set_point (p[n%3], &strip->points[n]);
 	pixman_add_triangles (image, -dst_x, -dst_y, 1, &tri);
     }
+    _cairo_observer_stage_leave (stage);
 }
 
 static cairo_int_status_t
@@ -808,6 +816,157 @@ check_composite_glyphs (const cairo_composite_rectangles_t *extents,
     return CAIRO_STATUS_SUCCESS;
 }
 
+/* Runs of at least this many glyphs are accumulated into an a8 mask
+ * directly from the glyph surfaces, see composite_glyph_run(). */
+#define GLYPH_RUN_MIN_GLYPHS 64
+
+/* Saturating add of four packed 8-bit alpha values. */
+static inline uint32_t
+add_a8x4 (uint32_t a, uint32_t b)
+{
+    uint32_t sum, carry;
+
+    sum = ((a & 0x7f7f7f7f) + (b & 0x7f7f7f7f)) ^ ((a ^ b) & 0x80808080);
+    carry = ((a & b) | ((a | b) & ~sum)) & 0x80808080;
+
+    return sum | ((carry >> 7) * 0xff);
+}
+
+static void
+add_a8_span (uint8_t *dst, const uint8_t *src, int len)
+{
+    while (len >= 4) {
+	uint32_t d, s;
+
+	memcpy (&d, dst, 4);
+	memcpy (&s, src, 4);
+	d = add_a8x4 (d, s);
+	memcpy (dst, &d, 4);
+
+	dst += 4;
+	src += 4;
+	len -= 4;
+    }
+
+    while (len--) {
+	unsigned int v = *dst + *src++;
+	*dst++ = v > 255 ? 255 : v;
+    }
+}
+
+/* Composites a long run of a8 glyphs by adding each glyph surface into
+ * a single mask a word at a time and then compositing that mask once,
+ * instead of setting up a pixman composite per glyph. Returns
+ * UNSUPPORTED, having drawn nothing, if a glyph is not a8.
+ */
+static cairo_int_status_t
+composite_glyph_run (void				*_dst,
+		     cairo_operator_t			 op,
+		     cairo_surface_t			*_src,
+		     int				 src_x,
+		     int				 src_y,
+		     int				 dst_x,
+		     int				 dst_y,
+		     cairo_composite_glyphs_info_t	*info)
+{
+    cairo_scaled_glyph_t *glyph_cache[64];
+    cairo_scaled_glyph_t *scaled_glyph;
+    const int width = info->extents.width;
+    const int height = info->extents.height;
+    pixman_image_t *mask;
+    uint8_t *mask_data;
+    int mask_stride;
+    cairo_status_t status;
+    int i;
+
+    TRACE ((stderr, "%s\n", __FUNCTION__));
+
+    mask = pixman_image_create_bits (PIXMAN_a8, width, height, NULL, 0);
+    if (unlikely (mask == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    mask_data = (uint8_t *) pixman_image_get_data (mask);
+    mask_stride = pixman_image_get_stride (mask);
+
+    memset (glyph_cache, 0, sizeof (glyph_cache));
+
+    for (i = 0; i < info->num_glyphs; i++) {
+	cairo_image_surface_t *glyph_surface;
+	unsigned long glyph_index;
+	int cache_index;
+	int x, y, x1, y1, x2, y2;
+
+	glyph_index = _cairo_scaled_glyph_position (info->font,
+						    info->glyphs[i].index,
+						    info->glyphs[i].x, &x);
+	cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
+	scaled_glyph = glyph_cache[cache_index];
+	if (scaled_glyph == NULL ||
+	    _cairo_scaled_glyph_index (scaled_glyph) != glyph_index)
+	{
+	    status = _cairo_scaled_glyph_lookup (info->font, glyph_index,
+						 CAIRO_SCALED_GLYPH_INFO_SURFACE,
+						 &scaled_glyph);
+	    if (unlikely (status)) {
+		pixman_image_unref (mask);
+		return status;
+	    }
+
+	    glyph_cache[cache_index] = scaled_glyph;
+	}
+
+	glyph_surface = scaled_glyph->surface;
+	if (glyph_surface->width == 0 || glyph_surface->height == 0)
+	    continue;
+
+	if (glyph_surface->format != CAIRO_FORMAT_A8) {
+	    pixman_image_unref (mask);
+	    return CAIRO_INT_STATUS_UNSUPPORTED;
+	}
+
+	/* XXX: FRAGILE: We're ignoring device_transform scaling here. A bug? */
+	x -= _cairo_lround (glyph_surface->base.device_transform.x0);
+	y = _cairo_lround (info->glyphs[i].y -
+			   glyph_surface->base.device_transform.y0);
+	x -= info->extents.x;
+	y -= info->extents.y;
+
+	x1 = MAX (x, 0);
+	y1 = MAX (y, 0);
+	x2 = MIN (x + glyph_surface->width, width);
+	y2 = MIN (y + glyph_surface->height, height);
+	for (; y1 < y2; y1++) {
+	    add_a8_span (mask_data + y1 * mask_stride + x1,
+			 glyph_surface->data + (y1 - y) * glyph_surface->stride + (x1 - x),
+			 x2 - x1);
+	}
+    }
+
+    pixman_image_composite32 (_pixman_operator (op),
+			      ((cairo_image_source_t *)_src)->pixman_image,
+			      mask,
+			      to_pixman_image (_dst),
+			      info->extents.x + src_x, info->extents.y + src_y,
+			      0, 0,
+			      info->extents.x - dst_x, info->extents.y - dst_y,
+			      width, height);
+    pixman_image_unref (mask);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+/* Whether accumulating the glyphs into one mask draws the same as
+ * compositing them one by one: either a mask was asked for, or the
+ * glyphs do not overlap, which is only left unchecked for ADD.
+ */
+static inline cairo_bool_t
+can_composite_glyph_run (cairo_operator_t op,
+			 const cairo_composite_glyphs_info_t *info)
+{
+    return info->num_glyphs >= GLYPH_RUN_MIN_GLYPHS &&
+	(info->use_mask || op != CAIRO_OPERATOR_ADD);
+}
+
 #if HAS_PIXMAN_GLYPHS
 static pixman_glyph_cache_t *global_glyph_cache;
 
@@ -854,6 +1013,15 @@ composite_glyphs (void				*_dst,
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
 
+    /* dense text bypasses the shared glyph cache and its lock */
+    if (can_composite_glyph_run (op, info)) {
+	status = composite_glyph_run (_dst, op, _src,
+				      src_x, src_y, dst_x, dst_y, info);
+	if (status != CAIRO_INT_STATUS_UNSUPPORTED)
+	    return status;
+	status = CAIRO_INT_STATUS_SUCCESS;
+    }
+
     CAIRO_MUTEX_LOCK (_cairo_glyph_cache_mutex);
 
     glyph_cache = get_glyph_cache();
@@ -874,9 +1042,13 @@ composite_glyphs (void				*_dst,
 
     pg = pglyphs;
     for (i = 0; i < info->num_glyphs; i++) {
-	unsigned long index = info->glyphs[i].index;
+	unsigned long index;
 	const void *glyph;
 
+	index = _cairo_scaled_glyph_position (info->font,
+					      info->glyphs[i].index,
+					      info->glyphs[i].x,
+					      &pg->x);
 	glyph = pixman_glyph_cache_lookup (glyph_cache, info->font, (void *)index);
 	if (!glyph) {
 	    cairo_scaled_glyph_t *scaled_glyph;
@@ -905,7 +1077,6 @@ composite_glyphs (void				*_dst,
 	    }
 	}
 
-	pg->x = _cairo_lround (info->glyphs[i].x);
 	pg->y = _cairo_lround (info->glyphs[i].y);
 	pg->glyph = glyph;
 	pg++;
@@ -963,13 +1134,17 @@ composite_one_glyph (void				*_dst,
 {
     cairo_image_surface_t *glyph_surface;
     cairo_scaled_glyph_t *scaled_glyph;
+    unsigned long glyph_index;
     cairo_status_t status;
     int x, y;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
 
+    glyph_index = _cairo_scaled_glyph_position (info->font,
+						info->glyphs[0].index,
+						info->glyphs[0].x, &x);
     status = _cairo_scaled_glyph_lookup (info->font,
-					 info->glyphs[0].index,
+					 glyph_index,
 					 CAIRO_SCALED_GLYPH_INFO_SURFACE,
 					 &scaled_glyph);
 
@@ -980,10 +1155,10 @@ composite_one_glyph (void				*_dst,
     if (glyph_surface->width == 0 || glyph_surface->height == 0)
 	return CAIRO_INT_STATUS_NOTHING_TO_DO;
 
-    /* round glyph locations to the nearest pixel */
+    /* round glyph locations to the nearest pixel, or to the phase the
+     * glyph was rendered at */
     /* XXX: FRAGILE: We're ignoring device_transform scaling here. A bug? */
-    x = _cairo_lround (info->glyphs[0].x -
-		       glyph_surface->base.device_transform.x0);
+    x -= _cairo_lround (glyph_surface->base.device_transform.x0);
     y = _cairo_lround (info->glyphs[0].y -
 		       glyph_surface->base.device_transform.y0);
 
@@ -1016,8 +1191,9 @@ composite_glyphs_via_mask (void				*_dst,
     uint8_t buf[2048];
     pixman_image_t *mask;
     pixman_format_code_t format;
+    unsigned long glyph_index;
     cairo_status_t status;
-    int i;
+    int i, x, y;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
 
@@ -1030,8 +1206,11 @@ composite_glyphs_via_mask (void				*_dst,
      * mask formats.
      */
 
+    glyph_index = _cairo_scaled_glyph_position (info->font,
+						info->glyphs[0].index,
+						info->glyphs[0].x, &x);
     status = _cairo_scaled_glyph_lookup (info->font,
-					 info->glyphs[0].index,
+					 glyph_index,
 					 CAIRO_SCALED_GLYPH_INFO_SURFACE,
 					 &scaled_glyph);
     if (unlikely (status)) {
@@ -1040,7 +1219,7 @@ composite_glyphs_via_mask (void				*_dst,
     }
 
     memset (glyph_cache, 0, sizeof (glyph_cache));
-    glyph_cache[info->glyphs[0].index % ARRAY_LENGTH (glyph_cache)] = scaled_glyph;
+    glyph_cache[glyph_index % ARRAY_LENGTH (glyph_cache)] = scaled_glyph;
 
     format = PIXMAN_a8;
     i = (info->extents.width + 3) & ~3;
@@ -1068,11 +1247,13 @@ composite_glyphs_via_mask (void				*_dst,
 
     status = CAIRO_STATUS_SUCCESS;
     for (i = 0; i < info->num_glyphs; i++) {
-	unsigned long glyph_index = info->glyphs[i].index;
-	int cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
 	cairo_image_surface_t *glyph_surface;
-	int x, y;
+	int cache_index;
 
+	glyph_index = _cairo_scaled_glyph_position (info->font,
+						    info->glyphs[i].index,
+						    info->glyphs[i].x, &x);
+	cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
 	scaled_glyph = glyph_cache[cache_index];
 	if (scaled_glyph == NULL ||
 	    _cairo_scaled_glyph_index (scaled_glyph) != glyph_index)
@@ -1118,10 +1299,10 @@ composite_glyphs_via_mask (void				*_dst,
 		mask = ca_mask;
 	    }
 
-	    /* round glyph locations to the nearest pixel */
+	    /* round glyph locations to the nearest pixel, or to the
+	     * phase the glyph was rendered at */
 	    /* XXX: FRAGILE: We're ignoring device_transform scaling here. A bug? */
-	    x = _cairo_lround (info->glyphs[i].x -
-			       glyph_surface->base.device_transform.x0);
+	    x -= _cairo_lround (glyph_surface->base.device_transform.x0);
 	    y = _cairo_lround (info->glyphs[i].y -
 			       glyph_surface->base.device_transform.y0);
 
@@ -1174,7 +1355,7 @@ composite_glyphs (void				*_dst,
 {
     cairo_scaled_glyph_t *glyph_cache[64];
     pixman_image_t *dst, *src;
-    cairo_status_t status;
+    cairo_int_status_t status;
     int i;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
@@ -1182,6 +1363,13 @@ composite_glyphs (void				*_dst,
     if (info->num_glyphs == 1)
 	return composite_one_glyph(_dst, op, _src, src_x, src_y, dst_x, dst_y, info);
 
+    if (can_composite_glyph_run (op, info)) {
+	status = composite_glyph_run (_dst, op, _src,
+				      src_x, src_y, dst_x, dst_y, info);
+	if (status != CAIRO_INT_STATUS_UNSUPPORTED)
+	    return status;
+    }
+
     if (info->use_mask)
 	return composite_glyphs_via_mask(_dst, op, _src, src_x, src_y, dst_x, dst_y, info);
 
@@ -1196,9 +1384,13 @@ composite_glyphs (void				*_dst,
 	int x, y;
 	cairo_image_surface_t *glyph_surface;
 	cairo_scaled_glyph_t *scaled_glyph;
-	unsigned long glyph_index = info->glyphs[i].index;
-	int cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
+	unsigned long glyph_index;
+	int cache_index;
 
+	glyph_index = _cairo_scaled_glyph_position (info->font,
+						    info->glyphs[i].index,
+						    info->glyphs[i].x, &x);
+	cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
 	scaled_glyph = glyph_cache[cache_index];
 	if (scaled_glyph == NULL ||
 	    _cairo_scaled_glyph_index (scaled_glyph) != glyph_index)
@@ -1215,10 +1407,10 @@ composite_glyphs (void				*_dst,
 
 	glyph_surface = scaled_glyph->surface;
 	if (glyph_surface->width && glyph_surface->height) {
-	    /* round glyph locations to the nearest pixel */
+	    /* round glyph locations to the nearest pixel, or to the
+	     * phase the glyph was rendered at */
 	    /* XXX: FRAGILE: We're ignoring device_transform scaling here. A bug? */
-	    x = _cairo_lround (info->glyphs[i].x -
-			       glyph_surface->base.device_transform.x0);
+	    x -= _cairo_lround (glyph_surface->base.device_transform.x0);
 	    y = _cairo_lround (info->glyphs[i].y -
 			       glyph_surface->base.device_transform.y0);
 
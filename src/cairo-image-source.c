@@ -1512,6 +1512,9 @@ _pixman_image_for_pattern (cairo_image_surface_t *dst,
 			   const cairo_rectangle_int_t *sample,
 			   int *tx, int *ty)
 {
+    cairo_observer_stage_t stage;
+    pixman_image_t *image;
+
     *tx = *ty = 0;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
@@ -1519,33 +1522,42 @@ _pixman_image_for_pattern (cairo_image_surface_t *dst,
     if (pattern == NULL)
 	return _pixman_white_image ();
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_SOURCE);
     switch (pattern->type) {
     default:
 	ASSERT_NOT_REACHED;
     case CAIRO_PATTERN_TYPE_SOLID:
-	return _pixman_image_for_color (&((const cairo_solid_pattern_t *) pattern)->color);
+	image = _pixman_image_for_color (&((const cairo_solid_pattern_t *) pattern)->color);
+	break;
 
     case CAIRO_PATTERN_TYPE_RADIAL:
     case CAIRO_PATTERN_TYPE_LINEAR:
-	return _pixman_image_for_gradient ((const cairo_gradient_pattern_t *) pattern,
-					   extents, tx, ty);
+	image = _pixman_image_for_gradient ((const cairo_gradient_pattern_t *) pattern,
+					    extents, tx, ty);
+	break;
 
     case CAIRO_PATTERN_TYPE_MESH:
-	return _pixman_image_for_mesh ((const cairo_mesh_pattern_t *) pattern,
-					   extents, tx, ty);
+	image = _pixman_image_for_mesh ((const cairo_mesh_pattern_t *) pattern,
+					extents, tx, ty);
+	break;
 
     case CAIRO_PATTERN_TYPE_SURFACE:
-	return _pixman_image_for_surface (dst,
-					  (const cairo_surface_pattern_t *) pattern,
-					  is_mask, extents, sample,
-					  tx, ty);
+	image = _pixman_image_for_surface (dst,
+					   (const cairo_surface_pattern_t *) pattern,
+					   is_mask, extents, sample,
+					   tx, ty);
+	break;
 
     case CAIRO_PATTERN_TYPE_RASTER_SOURCE:
-	return _pixman_image_for_raster (dst,
-					 (const cairo_raster_source_pattern_t *) pattern,
-					 is_mask, extents, sample,
-					 tx, ty);
+	image = _pixman_image_for_raster (dst,
+					  (const cairo_raster_source_pattern_t *) pattern,
+					  is_mask, extents, sample,
+					  tx, ty);
+	break;
     }
+    _cairo_observer_stage_leave (stage);
+
+    return image;
 }
 
 static cairo_status_t
@@ -191,4 +191,34 @@ typedef cairo_recursive_mutex_impl_t cairo_recursive_mutex_t;
 
 #endif /* CAIRO_MUTEX_DEBUG */
 
+/* Contention statistics
+ *
+ * When built with -DCAIRO_MUTEX_STATS=1 every CAIRO_MUTEX_LOCK counts
+ * the acquisitions, the contended acquisitions and the time spent
+ * waiting, keyed by the spelling of the mutex at the call site (e.g.
+ * "_cairo_scaled_font_map_mutex" or "scaled_font->mutex"). The results
+ * are reported by cairo_debug_mutex_stats_write().
+ */
+
+#if CAIRO_MUTEX_STATS
+
+# if ! CAIRO_MUTEX_IMPL_PTHREAD
+#  error "CAIRO_MUTEX_STATS requires the pthread mutex implementation"
+# endif
+
+typedef struct _cairo_mutex_stats cairo_mutex_stats_t;
+
+cairo_private void
+_cairo_mutex_stats_lock (cairo_mutex_impl_t *mutex,
+			 const char *name,
+			 cairo_mutex_stats_t **stats);
+
+# undef CAIRO_MUTEX_LOCK
+# define CAIRO_MUTEX_LOCK(mutex) do {					\
+    static cairo_mutex_stats_t *_cairo_mutex_stats_site;		\
+    _cairo_mutex_stats_lock (&(mutex), #mutex, &_cairo_mutex_stats_site); \
+} while (0)
+
+#endif /* CAIRO_MUTEX_STATS */
+
 #endif
@@ -34,6 +34,14 @@
 #include "cairoint.h"
 
 #include "cairo-mutex-private.h"
+#include "cairo-output-stream-private.h"
+
+#if CAIRO_MUTEX_STATS
+#include "cairo-atomic-private.h"
+#include "cairo-time-private.h"
+
+#include <pthread.h>
+#endif
 
 #define CAIRO_MUTEX_DECLARE(mutex) cairo_mutex_t mutex = CAIRO_MUTEX_NIL_INITIALIZER;
 #include "cairo-mutex-list-private.h"
@@ -80,3 +88,188 @@ void _cairo_mutex_finalize (void)
 #undef   CAIRO_MUTEX_DECLARE
 }
 #endif
+
+#if CAIRO_MUTEX_STATS
+
+#if ! (HAVE_CXX11_ATOMIC_PRIMITIVES || HAVE_INTEL_ATOMIC_PRIMITIVES)
+# error "CAIRO_MUTEX_STATS requires compiler atomic primitives"
+#endif
+
+/* Enough for every distinct spelling of a mutex at its lock sites */
+#define MUTEX_STATS_SIZE 256
+
+struct _cairo_mutex_stats {
+    const char *name;
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t wait; /* in cairo_time_t ticks */
+};
+
+static cairo_mutex_stats_t _cairo_mutex_stats[MUTEX_STATS_SIZE];
+
+static cairo_mutex_stats_t *
+_cairo_mutex_stats_lookup (const char *name)
+{
+    unsigned long hash = 5381;
+    const char *c;
+    unsigned int n;
+
+    for (c = name; *c; c++)
+	hash = hash * 33 + *c;
+
+    /* open addressing, entries are claimed but never released */
+    for (n = 0; n < MUTEX_STATS_SIZE; n++) {
+	cairo_mutex_stats_t *stats;
+	const char *other;
+
+	stats = &_cairo_mutex_stats[(hash + n) & (MUTEX_STATS_SIZE - 1)];
+	other = _cairo_atomic_ptr_get ((void **) &stats->name);
+	if (other == NULL) {
+	    if (_cairo_atomic_ptr_cmpxchg ((void **) &stats->name,
+					   NULL, (void *) name))
+		return stats;
+
+	    other = _cairo_atomic_ptr_get ((void **) &stats->name);
+	}
+
+	if (other == name || strcmp (other, name) == 0)
+	    return stats;
+    }
+
+    return NULL;
+}
+
+void
+_cairo_mutex_stats_lock (cairo_mutex_impl_t *mutex,
+			 const char *name,
+			 cairo_mutex_stats_t **site)
+{
+    cairo_mutex_stats_t *stats;
+    cairo_time_t start;
+
+    stats = *site;
+    if (stats == NULL)
+	*site = stats = _cairo_mutex_stats_lookup (name);
+
+    if (pthread_mutex_trylock (mutex) == 0) {
+	if (stats != NULL)
+	    __sync_fetch_and_add (&stats->acquisitions, 1);
+	return;
+    }
+
+    start = _cairo_time_get ();
+    pthread_mutex_lock (mutex);
+    if (stats != NULL) {
+	__sync_fetch_and_add (&stats->wait, _cairo_time_get_delta (start));
+	__sync_fetch_and_add (&stats->contended, 1);
+	__sync_fetch_and_add (&stats->acquisitions, 1);
+    }
+}
+
+static int
+_cairo_mutex_stats_compare (const void *a, const void *b)
+{
+    const cairo_mutex_stats_t *sa = *(const cairo_mutex_stats_t **) a;
+    const cairo_mutex_stats_t *sb = *(const cairo_mutex_stats_t **) b;
+
+    if (sa->wait != sb->wait)
+	return sa->wait < sb->wait ? 1 : -1;
+    if (sa->contended != sb->contended)
+	return sa->contended < sb->contended ? 1 : -1;
+    return strcmp (sa->name, sb->name);
+}
+
+#endif /* CAIRO_MUTEX_STATS */
+
+/**
+ * cairo_debug_mutex_stats_reset:
+ *
+ * Clears the lock statistics gathered so far, see
+ * cairo_debug_mutex_stats_write(). Statistics are only gathered if
+ * cairo was built with CAIRO_MUTEX_STATS defined, otherwise this
+ * function does nothing.
+ *
+ * Since: 1.16
+ **/
+void
+cairo_debug_mutex_stats_reset (void)
+{
+#if CAIRO_MUTEX_STATS
+    unsigned int n;
+
+    for (n = 0; n < MUTEX_STATS_SIZE; n++) {
+	cairo_mutex_stats_t *stats = &_cairo_mutex_stats[n];
+
+	__sync_fetch_and_and (&stats->acquisitions, 0);
+	__sync_fetch_and_and (&stats->contended, 0);
+	__sync_fetch_and_and (&stats->wait, 0);
+    }
+#endif
+}
+
+/**
+ * cairo_debug_mutex_stats_write:
+ * @write_func: a #cairo_write_func_t
+ * @closure: closure data for the write function
+ *
+ * Writes a table of the mutexes acquired since the program started, or
+ * since the last call to cairo_debug_mutex_stats_reset(). Each line
+ * holds the name of a mutex, as it is spelt where it is locked, the
+ * number of times it was acquired, the number of those acquisitions
+ * which had to wait for another thread to release it, and the total
+ * time spent waiting in milliseconds. The most contended mutexes come
+ * first.
+ *
+ * Statistics are only gathered if cairo was built with
+ * CAIRO_MUTEX_STATS defined, otherwise nothing is written.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS, or %CAIRO_STATUS_WRITE_ERROR if
+ * an I/O error occurs while writing.
+ *
+ * Since: 1.16
+ **/
+cairo_status_t
+cairo_debug_mutex_stats_write (cairo_write_func_t	 write_func,
+			       void			*closure)
+{
+#if CAIRO_MUTEX_STATS
+    cairo_mutex_stats_t *sorted[MUTEX_STATS_SIZE];
+    cairo_output_stream_t *stream;
+    unsigned int n, count;
+    char buf[256];
+
+    count = 0;
+    for (n = 0; n < MUTEX_STATS_SIZE; n++) {
+	cairo_mutex_stats_t *stats = &_cairo_mutex_stats[n];
+
+	if (_cairo_atomic_ptr_get ((void **) &stats->name) != NULL &&
+	    stats->acquisitions != 0)
+	{
+	    sorted[count++] = stats;
+	}
+    }
+    if (count == 0)
+	return CAIRO_STATUS_SUCCESS;
+
+    qsort (sorted, count, sizeof (sorted[0]), _cairo_mutex_stats_compare);
+
+    stream = _cairo_output_stream_create (write_func, NULL, closure);
+
+    snprintf (buf, sizeof (buf), "%-48s %12s %12s %12s\n",
+	      "mutex", "acquired", "contended", "wait(ms)");
+    _cairo_output_stream_write (stream, buf, strlen (buf));
+
+    for (n = 0; n < count; n++) {
+	snprintf (buf, sizeof (buf), "%-48s %12llu %12llu %12.3f\n",
+		  sorted[n]->name,
+		  (unsigned long long) sorted[n]->acquisitions,
+		  (unsigned long long) sorted[n]->contended,
+		  1000. * _cairo_time_to_s (sorted[n]->wait));
+	_cairo_output_stream_write (stream, buf, strlen (buf));
+    }
+
+    return _cairo_output_stream_destroy (stream);
+#else
+    return CAIRO_STATUS_SUCCESS;
+#endif
+}
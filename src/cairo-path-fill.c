@@ -40,6 +40,7 @@
 #include "cairo-error-private.h"
 #include "cairo-path-fixed-private.h"
 #include "cairo-region-private.h"
+#include "cairo-surface-observer-stage-private.h"
 #include "cairo-traps-private.h"
 
 typedef struct cairo_filler {
@@ -127,6 +128,7 @@ _cairo_path_fixed_fill_to_polygon (const cairo_path_fixed_t *path,
 				   double tolerance,
 				   cairo_polygon_t *polygon)
 {
+    cairo_observer_stage_t stage;
     cairo_filler_t filler;
     cairo_status_t status;
 
@@ -144,16 +146,18 @@ _cairo_path_fixed_fill_to_polygon (const cairo_path_fixed_t *path,
     filler.current_point.y = 0;
     filler.last_move_to = filler.current_point;
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_PATH);
     status = _cairo_path_fixed_interpret (path,
 					  _cairo_filler_move_to,
 					  _cairo_filler_line_to,
 					  _cairo_filler_curve_to,
 					  _cairo_filler_close,
 					  &filler);
-    if (unlikely (status))
-	return status;
+    if (likely (status == CAIRO_STATUS_SUCCESS))
+	status = _cairo_filler_close (&filler);
+    _cairo_observer_stage_leave (stage);
 
-    return _cairo_filler_close (&filler);
+    return status;
 }
 
 typedef struct cairo_filler_rectilinear_aligned {
@@ -47,6 +47,7 @@
 #include "cairo-error-private.h"
 #include "cairo-path-fixed-private.h"
 #include "cairo-slope-private.h"
+#include "cairo-surface-observer-stage-private.h"
 
 #define DEBUG 0
 
@@ -1249,6 +1250,7 @@ _cairo_path_fixed_stroke_to_polygon (const cairo_path_fixed_t	*path,
 				     double		 tolerance,
 				     cairo_polygon_t *polygon)
 {
+    cairo_observer_stage_t stage;
     struct stroker stroker;
     cairo_status_t status;
 
@@ -1337,6 +1339,7 @@ _cairo_path_fixed_stroke_to_polygon (const cairo_path_fixed_t	*path,
     stroker.contour_tolerance = tolerance;
     stroker.polygon = polygon;
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_PATH);
     status = _cairo_path_fixed_interpret (path,
 					  move_to,
 					  line_to,
@@ -1346,6 +1349,7 @@ _cairo_path_fixed_stroke_to_polygon (const cairo_path_fixed_t	*path,
     /* Cap the start and end of the final sub path as needed */
     if (likely (status == CAIRO_STATUS_SUCCESS))
 	add_caps (&stroker);
+    _cairo_observer_stage_leave (stage);
 
     _cairo_contour_fini (&stroker.cw.contour);
     _cairo_contour_fini (&stroker.ccw.contour);
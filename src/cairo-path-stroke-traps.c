@@ -43,6 +43,7 @@
 #include "cairo-path-fixed-private.h"
 #include "cairo-slope-private.h"
 #include "cairo-stroke-dash-private.h"
+#include "cairo-surface-observer-stage-private.h"
 #include "cairo-traps-private.h"
 
 #include <float.h>
@@ -1117,6 +1118,7 @@ _cairo_path_fixed_stroke_to_traps (const cairo_path_fixed_t	*path,
 				   double			 tolerance,
 				   cairo_traps_t		*traps)
 {
+    cairo_observer_stage_t stage;
     struct stroker stroker;
     cairo_status_t status;
 
@@ -1126,6 +1128,7 @@ _cairo_path_fixed_stroke_to_traps (const cairo_path_fixed_t	*path,
     if (unlikely (status))
 	return status;
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_PATH);
     if (stroker.dash.dashed)
 	status = _cairo_path_fixed_interpret (path,
 					      move_to_dashed,
@@ -1142,6 +1145,7 @@ _cairo_path_fixed_stroke_to_traps (const cairo_path_fixed_t	*path,
 					      &stroker);
     assert(status == CAIRO_STATUS_SUCCESS);
     add_caps (&stroker);
+    _cairo_observer_stage_leave (stage);
 
     stroker_fini (&stroker);
 
@@ -45,6 +45,7 @@
 #include "cairo-path-fixed-private.h"
 #include "cairo-slope-private.h"
 #include "cairo-stroke-dash-private.h"
+#include "cairo-surface-observer-stage-private.h"
 #include "cairo-traps-private.h"
 
 typedef struct cairo_stroker {
@@ -1417,6 +1418,7 @@ _cairo_path_fixed_stroke_dashed_to_polygon (const cairo_path_fixed_t	*path,
 					    double		 tolerance,
 					    cairo_polygon_t *polygon)
 {
+    cairo_observer_stage_t stage;
     cairo_stroker_t stroker;
     cairo_status_t status;
 
@@ -1429,6 +1431,7 @@ _cairo_path_fixed_stroke_dashed_to_polygon (const cairo_path_fixed_t	*path,
     stroker.add_external_edge = _cairo_polygon_add_external_edge,
     stroker.closure = polygon;
 
+    stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_PATH);
     status = _cairo_path_fixed_interpret (path,
 					  _cairo_stroker_move_to,
 					  stroker.dash.dashed ?
@@ -1445,6 +1448,7 @@ _cairo_path_fixed_stroke_dashed_to_polygon (const cairo_path_fixed_t	*path,
     status = _cairo_stroker_add_caps (&stroker);
 
 BAIL:
+    _cairo_observer_stage_leave (stage);
     _cairo_stroker_fini (&stroker);
 
     return status;
@@ -164,6 +164,7 @@ struct _cairo_pdf_surface {
 
     cairo_scaled_font_subsets_t *font_subsets;
     cairo_array_t fonts;
+    int font_subset_interval;
 
     cairo_pdf_resource_t next_available_resource;
     cairo_pdf_resource_t pages_resource;
@@ -256,6 +256,9 @@ _cairo_pdf_surface_write_page (cairo_pdf_surface_t *surface);
 static cairo_int_status_t
 _cairo_pdf_surface_emit_font_subsets (cairo_pdf_surface_t *surface);
 
+static cairo_int_status_t
+_cairo_pdf_surface_close_font_subsets (cairo_pdf_surface_t *surface);
+
 static cairo_bool_t
 _cairo_pdf_source_surface_equal (const void *key_a, const void *key_b);
 
@@ -401,6 +404,7 @@ _cairo_pdf_surface_create_for_stream_internal (cairo_output_stream_t	*output,
     }
 
     _cairo_scaled_font_subsets_enable_latin_subset (surface->font_subsets, TRUE);
+    surface->font_subset_interval = 0;
 
     surface->next_available_resource.id = 1;
     surface->pages_resource = _cairo_pdf_surface_new_object (surface);
@@ -706,6 +710,38 @@ cairo_pdf_surface_set_size (cairo_surface_t	*surface,
 	status = _cairo_surface_set_error (surface, status);
 }
 
+/**
+ * cairo_pdf_surface_set_font_subset_interval:
+ * @surface: a PDF #cairo_surface_t
+ * @num_pages: the number of pages after which the fonts used so far
+ * are written out, or 0 to write them out when the surface is finished
+ *
+ * By default, the fonts used in a PDF document are subset and written
+ * out when the surface is finished, so that each glyph is written
+ * just once. With a non-zero @num_pages, the font subsets are instead
+ * written out after every @num_pages pages, and the glyphs used on
+ * the following pages go into new subsets. This lets a long document
+ * be consumed as its pages are completed and bounds the memory used to
+ * track its glyphs, at the cost of a larger file when the same glyphs
+ * are used throughout.
+ *
+ * This function may be called at any time, and applies from the next
+ * page completed with cairo_show_page() or cairo_copy_page().
+ *
+ * Since: 1.16
+ **/
+void
+cairo_pdf_surface_set_font_subset_interval (cairo_surface_t	*surface,
+					    int			 num_pages)
+{
+    cairo_pdf_surface_t *pdf_surface = NULL; /* hide compiler warning */
+
+    if (! _extract_pdf_surface (surface, &pdf_surface))
+	return;
+
+    pdf_surface->font_subset_interval = MAX (num_pages, 0);
+}
+
 static void
 _cairo_pdf_surface_clear (cairo_pdf_surface_t *surface)
 {
@@ -4615,6 +4651,14 @@ _cairo_pdf_surface_show_page (void *abstract_surface)
 
     _cairo_pdf_surface_clear (surface);
 
+    if (surface->font_subset_interval > 0 &&
+	_cairo_array_num_elements (&surface->pages) % surface->font_subset_interval == 0)
+    {
+	status = _cairo_pdf_surface_close_font_subsets (surface);
+	if (unlikely (status))
+	    return status;
+    }
+
     return CAIRO_STATUS_SUCCESS;
 }
 
@@ -5183,53 +5227,6 @@ _cairo_pdf_surface_emit_cff_font (cairo_pdf_surface_t		*surface,
     return status;
 }
 
-static cairo_int_status_t
-_cairo_pdf_surface_emit_cff_font_subset (cairo_pdf_surface_t	     *surface,
-                                         cairo_scaled_font_subset_t  *font_subset)
-{
-    cairo_int_status_t status;
-    cairo_cff_subset_t subset;
-    char name[64];
-
-    snprintf (name, sizeof name, "CairoFont-%d-%d",
-              font_subset->font_id, font_subset->subset_id);
-    status = _cairo_cff_subset_init (&subset, name, font_subset);
-    if (unlikely (status))
-        return status;
-
-    status = _cairo_pdf_surface_emit_cff_font (surface, font_subset, &subset);
-
-    _cairo_cff_subset_fini (&subset);
-
-    return status;
-}
-
-static cairo_int_status_t
-_cairo_pdf_surface_emit_cff_fallback_font (cairo_pdf_surface_t	       *surface,
-                                           cairo_scaled_font_subset_t  *font_subset)
-{
-    cairo_int_status_t status;
-    cairo_cff_subset_t subset;
-    char name[64];
-
-    /* CFF fallback subsetting does not work with 8-bit glyphs unless
-     * they are a latin subset */
-    if (!font_subset->is_composite && !font_subset->is_latin)
-	return CAIRO_INT_STATUS_UNSUPPORTED;
-
-    snprintf (name, sizeof name, "CairoFont-%d-%d",
-              font_subset->font_id, font_subset->subset_id);
-    status = _cairo_cff_fallback_init (&subset, name, font_subset);
-    if (unlikely (status))
-        return status;
-
-    status = _cairo_pdf_surface_emit_cff_font (surface, font_subset, &subset);
-
-    _cairo_cff_fallback_fini (&subset);
-
-    return status;
-}
-
 static cairo_int_status_t
 _cairo_pdf_surface_emit_type1_font (cairo_pdf_surface_t		*surface,
                                     cairo_scaled_font_subset_t	*font_subset,
@@ -5372,63 +5369,15 @@ _cairo_pdf_surface_emit_type1_font (cairo_pdf_surface_t		*surface,
     return _cairo_array_append (&surface->fonts, &font);
 }
 
-static cairo_int_status_t
-_cairo_pdf_surface_emit_type1_font_subset (cairo_pdf_surface_t		*surface,
-					   cairo_scaled_font_subset_t	*font_subset)
-{
-    cairo_int_status_t status;
-    cairo_type1_subset_t subset;
-    char name[64];
-
-    /* 16-bit glyphs not compatible with Type 1 fonts */
-    if (font_subset->is_composite && !font_subset->is_latin)
-	return CAIRO_INT_STATUS_UNSUPPORTED;
-
-    snprintf (name, sizeof name, "CairoFont-%d-%d",
-	      font_subset->font_id, font_subset->subset_id);
-    status = _cairo_type1_subset_init (&subset, name, font_subset, FALSE);
-    if (unlikely (status))
-	return status;
-
-    status = _cairo_pdf_surface_emit_type1_font (surface, font_subset, &subset);
-
-    _cairo_type1_subset_fini (&subset);
-    return status;
-}
-
-static cairo_int_status_t
-_cairo_pdf_surface_emit_type1_fallback_font (cairo_pdf_surface_t	*surface,
-                                             cairo_scaled_font_subset_t	*font_subset)
-{
-    cairo_int_status_t status;
-    cairo_type1_subset_t subset;
-    char name[64];
-
-    /* 16-bit glyphs not compatible with Type 1 fonts */
-    if (font_subset->is_composite && !font_subset->is_latin)
-	return CAIRO_INT_STATUS_UNSUPPORTED;
-
-    snprintf (name, sizeof name, "CairoFont-%d-%d",
-	      font_subset->font_id, font_subset->subset_id);
-    status = _cairo_type1_fallback_init_binary (&subset, name, font_subset);
-    if (unlikely (status))
-	return status;
-
-    status = _cairo_pdf_surface_emit_type1_font (surface, font_subset, &subset);
-
-    _cairo_type1_fallback_fini (&subset);
-    return status;
-}
-
 static cairo_int_status_t
 _cairo_pdf_surface_emit_truetype_font_subset (cairo_pdf_surface_t		*surface,
-					      cairo_scaled_font_subset_t	*font_subset)
+					      cairo_scaled_font_subset_t	*font_subset,
+					      cairo_truetype_subset_t		*subset)
 {
     cairo_pdf_resource_t stream, descriptor, cidfont_dict;
     cairo_pdf_resource_t subset_resource, to_unicode_stream;
     cairo_int_status_t status;
     cairo_pdf_font_t font;
-    cairo_truetype_subset_t subset;
     unsigned int i, last_glyph;
     char tag[10];
 
@@ -5438,44 +5387,32 @@ _cairo_pdf_surface_emit_truetype_font_subset (cairo_pdf_surface_t		*surface,
     if (subset_resource.id == 0)
 	return CAIRO_STATUS_SUCCESS;
 
-    status = _cairo_truetype_subset_init_pdf (&subset, font_subset);
-    if (unlikely (status))
-	return status;
-
-    _create_font_subset_tag (font_subset, subset.ps_name, tag);
+    _create_font_subset_tag (font_subset, subset->ps_name, tag);
 
     status = _cairo_pdf_surface_open_stream (surface,
 					     NULL,
 					     TRUE,
 					     "   /Length1 %lu\n",
-					     subset.data_length);
-    if (unlikely (status)) {
-	_cairo_truetype_subset_fini (&subset);
+					     subset->data_length);
+    if (unlikely (status))
 	return status;
-    }
 
     stream = surface->pdf_stream.self;
     _cairo_output_stream_write (surface->output,
-				subset.data, subset.data_length);
+				subset->data, subset->data_length);
     status = _cairo_pdf_surface_close_stream (surface);
-    if (unlikely (status)) {
-	_cairo_truetype_subset_fini (&subset);
+    if (unlikely (status))
 	return status;
-    }
 
     status = _cairo_pdf_surface_emit_to_unicode_stream (surface,
 	                                                font_subset,
 							&to_unicode_stream);
-    if (_cairo_int_status_is_error (status)) {
-	_cairo_truetype_subset_fini (&subset);
+    if (_cairo_int_status_is_error (status))
 	return status;
-    }
 
     descriptor = _cairo_pdf_surface_new_object (surface);
-    if (descriptor.id == 0) {
-	_cairo_truetype_subset_fini (&subset);
+    if (descriptor.id == 0)
 	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
-    }
 
     _cairo_output_stream_printf (surface->output,
 				 "%d 0 obj\n"
@@ -5483,12 +5420,12 @@ _cairo_pdf_surface_emit_truetype_font_subset (cairo_pdf_surface_t		*surface,
 				 "   /FontName /%s+%s\n",
 				 descriptor.id,
 				 tag,
-				 subset.ps_name);
+				 subset->ps_name);
 
-    if (subset.family_name_utf8) {
+    if (subset->family_name_utf8) {
 	char *pdf_str;
 
-	status = _utf8_to_pdf_string (subset.family_name_utf8, &pdf_str);
+	status = _utf8_to_pdf_string (subset->family_name_utf8, &pdf_str);
 	if (unlikely (status))
 	    return status;
 
@@ -5511,13 +5448,13 @@ _cairo_pdf_surface_emit_truetype_font_subset (cairo_pdf_surface_t		*surface,
 				 ">>\n"
 				 "endobj\n",
 				 font_subset->is_latin ? 32 : 4,
-				 (long)(subset.x_min*PDF_UNITS_PER_EM),
-				 (long)(subset.y_min*PDF_UNITS_PER_EM),
-                                 (long)(subset.x_max*PDF_UNITS_PER_EM),
-				 (long)(subset.y_max*PDF_UNITS_PER_EM),
-				 (long)(subset.ascent*PDF_UNITS_PER_EM),
-				 (long)(subset.descent*PDF_UNITS_PER_EM),
-				 (long)(subset.y_max*PDF_UNITS_PER_EM),
+				 (long)(subset->x_min*PDF_UNITS_PER_EM),
+				 (long)(subset->y_min*PDF_UNITS_PER_EM),
+                                 (long)(subset->x_max*PDF_UNITS_PER_EM),
+				 (long)(subset->y_max*PDF_UNITS_PER_EM),
+				 (long)(subset->ascent*PDF_UNITS_PER_EM),
+				 (long)(subset->descent*PDF_UNITS_PER_EM),
+				 (long)(subset->y_max*PDF_UNITS_PER_EM),
 				 stream.id);
 
     if (font_subset->is_latin) {
@@ -5540,7 +5477,7 @@ _cairo_pdf_surface_emit_truetype_font_subset (cairo_pdf_surface_t		*surface,
 				     "   /Widths [",
 				     subset_resource.id,
 				     tag,
-				     subset.ps_name,
+				     subset->ps_name,
 				     last_glyph,
 				     descriptor.id);
 
@@ -5549,7 +5486,7 @@ _cairo_pdf_surface_emit_truetype_font_subset (cairo_pdf_surface_t		*surface,
 	    if (glyph > 0) {
 		_cairo_output_stream_printf (surface->output,
 					     " %ld",
-					     (long)(subset.widths[glyph]*PDF_UNITS_PER_EM));
+					     (long)(subset->widths[glyph]*PDF_UNITS_PER_EM));
 	    } else {
 		_cairo_output_stream_printf (surface->output, " 0");
 	    }
@@ -5568,10 +5505,8 @@ _cairo_pdf_surface_emit_truetype_font_subset (cairo_pdf_surface_t		*surface,
 				     "endobj\n");
     } else {
 	cidfont_dict = _cairo_pdf_surface_new_object (surface);
-	if (cidfont_dict.id == 0) {
-	    _cairo_truetype_subset_fini (&subset);
+	if (cidfont_dict.id == 0)
 	    return _cairo_error (CAIRO_STATUS_NO_MEMORY);
-	}
 
 	_cairo_output_stream_printf (surface->output,
 				     "%d 0 obj\n"
@@ -5587,13 +5522,13 @@ _cairo_pdf_surface_emit_truetype_font_subset (cairo_pdf_surface_t		*surface,
 				     "   /W [0 [",
 				     cidfont_dict.id,
 				     tag,
-				     subset.ps_name,
+				     subset->ps_name,
 				     descriptor.id);
 
 	for (i = 0; i < font_subset->num_glyphs; i++)
 	    _cairo_output_stream_printf (surface->output,
 					 " %ld",
-					 (long)(subset.widths[i]*PDF_UNITS_PER_EM));
+					 (long)(subset->widths[i]*PDF_UNITS_PER_EM));
 
 	_cairo_output_stream_printf (surface->output,
 				     " ]]\n"
@@ -5610,7 +5545,7 @@ _cairo_pdf_surface_emit_truetype_font_subset (cairo_pdf_surface_t		*surface,
 				     "   /DescendantFonts [ %d 0 R]\n",
 				     subset_resource.id,
 				     tag,
-				     subset.ps_name,
+				     subset->ps_name,
 				     cidfont_dict.id);
 
 	if (to_unicode_stream.id != 0)
@@ -5628,8 +5563,6 @@ _cairo_pdf_surface_emit_truetype_font_subset (cairo_pdf_surface_t		*surface,
     font.subset_resource = subset_resource;
     status = _cairo_array_append (&surface->fonts, &font);
 
-    _cairo_truetype_subset_fini (&subset);
-
     return status;
 }
 
@@ -5900,37 +5833,155 @@ _cairo_pdf_surface_emit_type3_font_subset (cairo_pdf_surface_t		*surface,
     return _cairo_array_append (&surface->fonts, &font);
 }
 
-static cairo_int_status_t
-_cairo_pdf_surface_emit_unscaled_font_subset (cairo_scaled_font_subset_t *font_subset,
-                                              void			 *closure)
+typedef enum {
+    CAIRO_PDF_FONT_SUBSET_CFF,
+    CAIRO_PDF_FONT_SUBSET_TRUETYPE,
+    CAIRO_PDF_FONT_SUBSET_TYPE1,
+    CAIRO_PDF_FONT_SUBSET_CFF_FALLBACK,
+    CAIRO_PDF_FONT_SUBSET_TYPE1_FALLBACK
+} cairo_pdf_font_subset_type_t;
+
+/* An unscaled font subset ready to be written, see
+ * _cairo_scaled_font_subsets_foreach_unscaled_parallel() */
+typedef struct _cairo_pdf_prepared_font_subset {
+    cairo_int_status_t status;
+    cairo_pdf_font_subset_type_t type;
+    union {
+	cairo_cff_subset_t cff;
+	cairo_truetype_subset_t truetype;
+	cairo_type1_subset_t type1;
+    } u;
+} cairo_pdf_prepared_font_subset_t;
+
+static void
+_cairo_pdf_surface_prepare_unscaled_font_subset (cairo_scaled_font_subset_t *font_subset,
+						 void			    *prepared_subset,
+						 void			    *closure)
 {
+    cairo_pdf_prepared_font_subset_t *prepared = prepared_subset;
     cairo_pdf_surface_t *surface = closure;
+    cairo_pdf_resource_t subset_resource;
     cairo_int_status_t status;
+    char name[64];
 
-    status = _cairo_pdf_surface_emit_cff_font_subset (surface, font_subset);
-    if (status != CAIRO_INT_STATUS_UNSUPPORTED)
-	return status;
+    /* no page uses this subset, so do not build it only to drop it */
+    subset_resource = _cairo_pdf_surface_get_font_resource (surface,
+							    font_subset->font_id,
+							    font_subset->subset_id);
+    if (subset_resource.id == 0) {
+	prepared->status = CAIRO_INT_STATUS_NOTHING_TO_DO;
+	return;
+    }
 
-    status = _cairo_pdf_surface_emit_truetype_font_subset (surface, font_subset);
-    if (status != CAIRO_INT_STATUS_UNSUPPORTED)
-	return status;
+    snprintf (name, sizeof name, "CairoFont-%d-%d",
+              font_subset->font_id, font_subset->subset_id);
 
-    status = _cairo_pdf_surface_emit_type1_font_subset (surface, font_subset);
+    prepared->type = CAIRO_PDF_FONT_SUBSET_CFF;
+    status = _cairo_cff_subset_init (&prepared->u.cff, name, font_subset);
     if (status != CAIRO_INT_STATUS_UNSUPPORTED)
-	return status;
+	goto DONE;
 
-    status = _cairo_pdf_surface_emit_cff_fallback_font (surface, font_subset);
+    prepared->type = CAIRO_PDF_FONT_SUBSET_TRUETYPE;
+    status = _cairo_truetype_subset_init_pdf (&prepared->u.truetype,
+					      font_subset);
     if (status != CAIRO_INT_STATUS_UNSUPPORTED)
-	return status;
+	goto DONE;
 
-    status = _cairo_pdf_surface_emit_type1_fallback_font (surface, font_subset);
-    if (status != CAIRO_INT_STATUS_UNSUPPORTED)
-	return status;
+    /* 16-bit glyphs not compatible with Type 1 fonts */
+    if (! font_subset->is_composite || font_subset->is_latin) {
+	prepared->type = CAIRO_PDF_FONT_SUBSET_TYPE1;
+	status = _cairo_type1_subset_init (&prepared->u.type1, name,
+					   font_subset, FALSE);
+	if (status != CAIRO_INT_STATUS_UNSUPPORTED)
+	    goto DONE;
+    }
+
+    /* CFF fallback subsetting does not work with 8-bit glyphs unless
+     * they are a latin subset */
+    if (font_subset->is_composite || font_subset->is_latin) {
+	prepared->type = CAIRO_PDF_FONT_SUBSET_CFF_FALLBACK;
+	status = _cairo_cff_fallback_init (&prepared->u.cff, name,
+					   font_subset);
+	if (status != CAIRO_INT_STATUS_UNSUPPORTED)
+	    goto DONE;
+    }
+
+    if (! font_subset->is_composite || font_subset->is_latin) {
+	prepared->type = CAIRO_PDF_FONT_SUBSET_TYPE1_FALLBACK;
+	status = _cairo_type1_fallback_init_binary (&prepared->u.type1, name,
+						    font_subset);
+	if (status != CAIRO_INT_STATUS_UNSUPPORTED)
+	    goto DONE;
+    }
+
+    ASSERT_NOT_REACHED;
+
+DONE:
+    prepared->status = status;
+}
+
+static cairo_int_status_t
+_cairo_pdf_surface_emit_unscaled_font_subset (cairo_scaled_font_subset_t *font_subset,
+					      void			 *prepared_subset,
+                                              void			 *closure)
+{
+    cairo_pdf_prepared_font_subset_t *prepared = prepared_subset;
+    cairo_pdf_surface_t *surface = closure;
+
+    if (unlikely (prepared->status)) {
+	/* unused, or no subsetter and already asserted upon */
+	if (prepared->status == CAIRO_INT_STATUS_NOTHING_TO_DO ||
+	    prepared->status == CAIRO_INT_STATUS_UNSUPPORTED)
+	    return CAIRO_INT_STATUS_SUCCESS;
+
+	return prepared->status;
+    }
+
+    switch (prepared->type) {
+    case CAIRO_PDF_FONT_SUBSET_CFF:
+    case CAIRO_PDF_FONT_SUBSET_CFF_FALLBACK:
+	return _cairo_pdf_surface_emit_cff_font (surface, font_subset,
+						 &prepared->u.cff);
+    case CAIRO_PDF_FONT_SUBSET_TRUETYPE:
+	return _cairo_pdf_surface_emit_truetype_font_subset (surface, font_subset,
+							     &prepared->u.truetype);
+    case CAIRO_PDF_FONT_SUBSET_TYPE1:
+    case CAIRO_PDF_FONT_SUBSET_TYPE1_FALLBACK:
+	return _cairo_pdf_surface_emit_type1_font (surface, font_subset,
+						   &prepared->u.type1);
+    }
 
     ASSERT_NOT_REACHED;
     return CAIRO_INT_STATUS_SUCCESS;
 }
 
+static void
+_cairo_pdf_surface_release_unscaled_font_subset (void *prepared_subset)
+{
+    cairo_pdf_prepared_font_subset_t *prepared = prepared_subset;
+
+    if (prepared->status)
+	return;
+
+    switch (prepared->type) {
+    case CAIRO_PDF_FONT_SUBSET_CFF:
+	_cairo_cff_subset_fini (&prepared->u.cff);
+	break;
+    case CAIRO_PDF_FONT_SUBSET_TRUETYPE:
+	_cairo_truetype_subset_fini (&prepared->u.truetype);
+	break;
+    case CAIRO_PDF_FONT_SUBSET_TYPE1:
+	_cairo_type1_subset_fini (&prepared->u.type1);
+	break;
+    case CAIRO_PDF_FONT_SUBSET_CFF_FALLBACK:
+	_cairo_cff_fallback_fini (&prepared->u.cff);
+	break;
+    case CAIRO_PDF_FONT_SUBSET_TYPE1_FALLBACK:
+	_cairo_type1_fallback_fini (&prepared->u.type1);
+	break;
+    }
+}
+
 static cairo_int_status_t
 _cairo_pdf_surface_emit_scaled_font_subset (cairo_scaled_font_subset_t *font_subset,
                                             void		       *closure)
@@ -5947,7 +5998,7 @@ _cairo_pdf_surface_emit_scaled_font_subset (cairo_scaled_font_subset_t *font_sub
 }
 
 static cairo_int_status_t
-_cairo_pdf_surface_emit_font_subsets (cairo_pdf_surface_t *surface)
+_cairo_pdf_surface_write_font_subsets (cairo_pdf_surface_t *surface)
 {
     cairo_int_status_t status;
 
@@ -5955,25 +6006,54 @@ _cairo_pdf_surface_emit_font_subsets (cairo_pdf_surface_t *surface)
 						      _cairo_pdf_surface_analyze_user_font_subset,
 						      surface);
     if (unlikely (status))
-	goto BAIL;
+	return status;
 
-    status = _cairo_scaled_font_subsets_foreach_unscaled (surface->font_subsets,
-                                                          _cairo_pdf_surface_emit_unscaled_font_subset,
-                                                          surface);
+    status = _cairo_scaled_font_subsets_foreach_unscaled_parallel (surface->font_subsets,
+								   sizeof (cairo_pdf_prepared_font_subset_t),
+								   _cairo_pdf_surface_prepare_unscaled_font_subset,
+								   _cairo_pdf_surface_emit_unscaled_font_subset,
+								   _cairo_pdf_surface_release_unscaled_font_subset,
+								   surface);
     if (unlikely (status))
-	goto BAIL;
+	return status;
 
     status = _cairo_scaled_font_subsets_foreach_scaled (surface->font_subsets,
                                                         _cairo_pdf_surface_emit_scaled_font_subset,
                                                         surface);
     if (unlikely (status))
-	goto BAIL;
+	return status;
 
     status = _cairo_scaled_font_subsets_foreach_user (surface->font_subsets,
 						      _cairo_pdf_surface_emit_scaled_font_subset,
 						      surface);
 
-BAIL:
+    return status;
+}
+
+static cairo_int_status_t
+_cairo_pdf_surface_close_font_subsets (cairo_pdf_surface_t *surface)
+{
+    cairo_int_status_t status;
+
+    status = _cairo_pdf_surface_write_font_subsets (surface);
+    if (unlikely (status))
+	return status;
+
+    /* The pages written so far refer to the closed subsets by their
+     * font resources, which are not needed any more. */
+    _cairo_scaled_font_subsets_close (surface->font_subsets);
+    _cairo_array_truncate (&surface->fonts, 0);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_int_status_t
+_cairo_pdf_surface_emit_font_subsets (cairo_pdf_surface_t *surface)
+{
+    cairo_int_status_t status;
+
+    status = _cairo_pdf_surface_write_font_subsets (surface);
+
     _cairo_scaled_font_subsets_destroy (surface->font_subsets);
     surface->font_subsets = NULL;
 
@@ -85,6 +85,10 @@ cairo_pdf_surface_set_size (cairo_surface_t	*surface,
 			    double		 width_in_points,
 			    double		 height_in_points);
 
+cairo_public void
+cairo_pdf_surface_set_font_subset_interval (cairo_surface_t	*surface,
+					    int			 num_pages);
+
 CAIRO_END_DECLS
 
 #else  /* CAIRO_HAS_PDF_SURFACE */
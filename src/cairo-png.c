@@ -39,7 +39,7 @@
 #include "cairoint.h"
 
 #include "cairo-error-private.h"
-#include "cairo-image-surface-private.h"
+#include "cairo-image-surface-inline.h"
 #include "cairo-output-stream-private.h"
 
 #include <stdio.h>
@@ -516,6 +516,19 @@ stdio_read_func (void *closure, unsigned char *data, unsigned int size)
     return CAIRO_STATUS_SUCCESS;
 }
 
+static cairo_status_t
+stdio_open_error (void)
+{
+    switch (errno) {
+    case ENOMEM:
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+    case ENOENT:
+	return _cairo_error (CAIRO_STATUS_FILE_NOT_FOUND);
+    default:
+	return _cairo_error (CAIRO_STATUS_READ_ERROR);
+    }
+}
+
 static void
 stream_read_func (png_structp png, png_bytep data, png_size_t size)
 {
@@ -531,11 +544,18 @@ stream_read_func (png_structp png, png_bytep data, png_size_t size)
 	png_error (png, NULL);
     }
 
-    _cairo_output_stream_write (png_closure->png_data, data, size);
+    if (png_closure->png_data != NULL)
+	_cairo_output_stream_write (png_closure->png_data, data, size);
 }
 
+/* Decodes the PNG into a freshly allocated image surface, or if @target
+ * is non-NULL, directly into the pixels of @target at (@x, @y) in
+ * which case a new reference to @target is returned upon success.
+ */
 static cairo_surface_t *
-read_png (struct png_read_closure_t *png_closure)
+read_png (struct png_read_closure_t *png_closure,
+	  cairo_image_surface_t *target,
+	  int x, int y)
 {
     cairo_surface_t *surface;
     png_struct *png = NULL;
@@ -550,7 +570,10 @@ read_png (struct png_read_closure_t *png_closure)
     unsigned char *mime_data;
     unsigned long mime_data_length;
 
-    png_closure->png_data = _cairo_memory_stream_create ();
+    /* The original PNG is only retained as mime-data on new surfaces */
+    png_closure->png_data = NULL;
+    if (target == NULL)
+	png_closure->png_data = _cairo_memory_stream_create ();
 
     /* XXX: Perhaps we'll want some other error handlers? */
     png = png_create_read_struct (PNG_LIBPNG_VER_STRING,
@@ -652,6 +675,38 @@ read_png (struct png_read_closure_t *png_closure)
 	    break;
     }
 
+    if (target != NULL) {
+	if (x < 0 || y < 0 ||
+	    x > target->width || png_width > (png_uint_32) (target->width - x) ||
+	    y > target->height || png_height > (png_uint_32) (target->height - y))
+	{
+	    surface = _cairo_surface_create_in_error (_cairo_error (CAIRO_STATUS_INVALID_SIZE));
+	    goto BAIL;
+	}
+
+	row_pointers = _cairo_malloc_ab (png_height, sizeof (char *));
+	if (unlikely (row_pointers == NULL)) {
+	    surface = _cairo_surface_create_in_error (_cairo_error (CAIRO_STATUS_NO_MEMORY));
+	    goto BAIL;
+	}
+
+	for (i = 0; i < png_height; i++)
+	    row_pointers[i] = target->data + (y + i) * target->stride + 4 * x;
+
+	png_read_image (png, row_pointers);
+	png_read_end (png, info);
+
+	if (unlikely (status)) {
+	    surface = _cairo_surface_create_in_error (status);
+	    goto BAIL;
+	}
+
+	cairo_surface_mark_dirty_rectangle (&target->base,
+					    x, y, png_width, png_height);
+	surface = cairo_surface_reference (&target->base);
+	goto BAIL;
+    }
+
     stride = cairo_format_stride_for_width (format, png_width);
     if (stride < 0) {
 	surface = _cairo_surface_create_in_error (_cairo_error (CAIRO_STATUS_INVALID_STRIDE));
@@ -758,25 +813,12 @@ cairo_image_surface_create_from_png (const char *filename)
     cairo_surface_t *surface;
 
     png_closure.closure = fopen (filename, "rb");
-    if (png_closure.closure == NULL) {
-	cairo_status_t status;
-	switch (errno) {
-	case ENOMEM:
-	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
-	    break;
-	case ENOENT:
-	    status = _cairo_error (CAIRO_STATUS_FILE_NOT_FOUND);
-	    break;
-	default:
-	    status = _cairo_error (CAIRO_STATUS_READ_ERROR);
-	    break;
-	}
-	return _cairo_surface_create_in_error (status);
-    }
+    if (png_closure.closure == NULL)
+	return _cairo_surface_create_in_error (stdio_open_error ());
 
     png_closure.read_func = stdio_read_func;
 
-    surface = read_png (&png_closure);
+    surface = read_png (&png_closure, NULL, 0, 0);
 
     fclose (png_closure.closure);
 
@@ -815,5 +857,132 @@ cairo_image_surface_create_from_png_stream (cairo_read_func_t	read_func,
     png_closure.read_func = read_func;
     png_closure.closure = closure;
 
-    return read_png (&png_closure);
+    return read_png (&png_closure, NULL, 0, 0);
+}
+
+static cairo_status_t
+load_png (struct png_read_closure_t *png_closure,
+	  cairo_surface_t *surface,
+	  int x, int y)
+{
+    cairo_image_surface_t *image;
+    cairo_surface_t *result;
+    cairo_status_t status;
+
+    if (unlikely (surface->status))
+	return surface->status;
+    if (unlikely (surface->finished))
+	return _cairo_error (CAIRO_STATUS_SURFACE_FINISHED);
+    if (! _cairo_surface_is_image (surface))
+	return _cairo_error (CAIRO_STATUS_SURFACE_TYPE_MISMATCH);
+
+    image = (cairo_image_surface_t *) surface;
+    if (image->format != CAIRO_FORMAT_ARGB32 &&
+	image->format != CAIRO_FORMAT_RGB24)
+    {
+	return _cairo_error (CAIRO_STATUS_INVALID_FORMAT);
+    }
+
+    cairo_surface_flush (surface);
+
+    result = read_png (png_closure, image, x, y);
+    status = result->status;
+    cairo_surface_destroy (result);
+
+    return status;
+}
+
+/**
+ * cairo_image_surface_load_png:
+ * @surface: an image surface to decode into
+ * @x: the X coordinate of the top-left corner of the image in @surface
+ * @y: the Y coordinate of the top-left corner of the image in @surface
+ * @filename: name of PNG file to load
+ *
+ * Decodes the given PNG file directly into the pixel data of an
+ * existing image surface, placing its top-left corner at (@x, @y).
+ * Unlike cairo_image_surface_create_from_png() no intermediate image
+ * is allocated, so this can be used to decode very large images into
+ * memory owned by the application, for instance a file mapping wrapped
+ * by cairo_image_surface_create_for_data().
+ *
+ * @surface must be of format %CAIRO_FORMAT_ARGB32 or
+ * %CAIRO_FORMAT_RGB24 and large enough to hold the whole image at the
+ * given position. The pixels are replaced, not composited; when loading
+ * an image with an alpha channel into a %CAIRO_FORMAT_RGB24 surface, the
+ * result is as if the image had been painted over black. The original
+ * PNG data is not attached to @surface as mime data. If an error occurs
+ * whilst decoding, the affected area of @surface may be partially
+ * overwritten.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS on success, otherwise one of
+ * the following values:
+ *
+ *	%CAIRO_STATUS_NO_MEMORY
+ *	%CAIRO_STATUS_FILE_NOT_FOUND
+ *	%CAIRO_STATUS_READ_ERROR
+ *	%CAIRO_STATUS_SURFACE_TYPE_MISMATCH
+ *	%CAIRO_STATUS_INVALID_FORMAT
+ *	%CAIRO_STATUS_INVALID_SIZE
+ *
+ * Since: 1.16
+ **/
+cairo_status_t
+cairo_image_surface_load_png (cairo_surface_t	*surface,
+			      int		 x,
+			      int		 y,
+			      const char	*filename)
+{
+    struct png_read_closure_t png_closure;
+    cairo_status_t status;
+
+    png_closure.closure = fopen (filename, "rb");
+    if (png_closure.closure == NULL)
+	return stdio_open_error ();
+
+    png_closure.read_func = stdio_read_func;
+
+    status = load_png (&png_closure, surface, x, y);
+
+    fclose (png_closure.closure);
+
+    return status;
+}
+
+/**
+ * cairo_image_surface_load_png_stream:
+ * @surface: an image surface to decode into
+ * @x: the X coordinate of the top-left corner of the image in @surface
+ * @y: the Y coordinate of the top-left corner of the image in @surface
+ * @read_func: function called to read the data of the file
+ * @closure: data to pass to @read_func.
+ *
+ * Decodes PNG data read incrementally via the @read_func function
+ * directly into the pixel data of an existing image surface. See
+ * cairo_image_surface_load_png() for the requirements upon @surface.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS on success, otherwise one of
+ * the following values:
+ *
+ *	%CAIRO_STATUS_NO_MEMORY
+ *	%CAIRO_STATUS_READ_ERROR
+ *	%CAIRO_STATUS_SURFACE_TYPE_MISMATCH
+ *	%CAIRO_STATUS_INVALID_FORMAT
+ *	%CAIRO_STATUS_INVALID_SIZE
+ *
+ * Since: 1.16
+ **/
+cairo_status_t
+cairo_image_surface_load_png_stream (cairo_surface_t	*surface,
+				     int		 x,
+				     int		 y,
+				     cairo_read_func_t	 read_func,
+				     void		*closure)
+{
+    struct png_read_closure_t png_closure;
+
+    png_closure.read_func = read_func;
+    png_closure.closure = closure;
+
+    return load_png (&png_closure, surface, x, y);
 }
@@ -390,90 +390,39 @@ _cairo_ps_surface_emit_header (cairo_ps_surface_t *surface)
 }
 
 static cairo_status_t
-_cairo_ps_surface_emit_type1_font_subset (cairo_ps_surface_t		*surface,
-					  cairo_scaled_font_subset_t	*font_subset)
-
-
+_cairo_ps_surface_emit_type1_font (cairo_ps_surface_t		*surface,
+				   cairo_scaled_font_subset_t	*font_subset,
+				   cairo_type1_subset_t		*subset)
 {
-    cairo_type1_subset_t subset;
-    cairo_status_t status;
     int length;
-    char name[64];
-
-    snprintf (name, sizeof name, "f-%d-%d",
-	      font_subset->font_id, font_subset->subset_id);
-    status = _cairo_type1_subset_init (&subset, name, font_subset, TRUE);
-    if (unlikely (status))
-	return status;
 
     /* FIXME: Figure out document structure convention for fonts */
 
 #if DEBUG_PS
     _cairo_output_stream_printf (surface->final_stream,
-				 "%% _cairo_ps_surface_emit_type1_font_subset\n");
-#endif
-
-    _cairo_output_stream_printf (surface->final_stream,
-				 "%%%%BeginResource: font %s\n",
-				 subset.base_font);
-    length = subset.header_length + subset.data_length + subset.trailer_length;
-    _cairo_output_stream_write (surface->final_stream, subset.data, length);
-    _cairo_output_stream_printf (surface->final_stream,
-				 "%%%%EndResource\n");
-
-    _cairo_type1_subset_fini (&subset);
-
-    return CAIRO_STATUS_SUCCESS;
-}
-
-
-static cairo_status_t
-_cairo_ps_surface_emit_type1_font_fallback (cairo_ps_surface_t		*surface,
-                                            cairo_scaled_font_subset_t	*font_subset)
-{
-    cairo_type1_subset_t subset;
-    cairo_status_t status;
-    int length;
-    char name[64];
-
-    snprintf (name, sizeof name, "f-%d-%d",
-	      font_subset->font_id, font_subset->subset_id);
-    status = _cairo_type1_fallback_init_hex (&subset, name, font_subset);
-    if (unlikely (status))
-	return status;
-
-#if DEBUG_PS
-    _cairo_output_stream_printf (surface->final_stream,
-				 "%% _cairo_ps_surface_emit_type1_font_fallback\n");
+				 "%% _cairo_ps_surface_emit_type1_font\n");
 #endif
 
     _cairo_output_stream_printf (surface->final_stream,
 				 "%%%%BeginResource: font %s\n",
-				 subset.base_font);
-    length = subset.header_length + subset.data_length + subset.trailer_length;
-    _cairo_output_stream_write (surface->final_stream, subset.data, length);
+				 subset->base_font);
+    length = subset->header_length + subset->data_length + subset->trailer_length;
+    _cairo_output_stream_write (surface->final_stream, subset->data, length);
     _cairo_output_stream_printf (surface->final_stream,
 				 "%%%%EndResource\n");
 
-    _cairo_type1_fallback_fini (&subset);
-
     return CAIRO_STATUS_SUCCESS;
 }
 
 static cairo_status_t
 _cairo_ps_surface_emit_truetype_font_subset (cairo_ps_surface_t		*surface,
-					     cairo_scaled_font_subset_t	*font_subset)
+					     cairo_scaled_font_subset_t	*font_subset,
+					     cairo_truetype_subset_t	*subset)
 
 
 {
-    cairo_truetype_subset_t subset;
-    cairo_status_t status;
     unsigned int i, begin, end;
 
-    status = _cairo_truetype_subset_init_ps (&subset, font_subset);
-    if (unlikely (status))
-	return status;
-
     /* FIXME: Figure out document structure convention for fonts */
 
 #if DEBUG_PS
@@ -483,7 +432,7 @@ _cairo_ps_surface_emit_truetype_font_subset (cairo_ps_surface_t		*surface,
 
     _cairo_output_stream_printf (surface->final_stream,
 				 "%%%%BeginResource: font %s\n",
-				 subset.ps_name);
+				 subset->ps_name);
     _cairo_output_stream_printf (surface->final_stream,
 				 "11 dict begin\n"
 				 "/FontType 42 def\n"
@@ -493,7 +442,7 @@ _cairo_ps_surface_emit_truetype_font_subset (cairo_ps_surface_t		*surface,
 				 "/FontBBox [ 0 0 0 0 ] def\n"
 				 "/Encoding 256 array def\n"
 				 "0 1 255 { Encoding exch /.notdef put } for\n",
-				 subset.ps_name);
+				 subset->ps_name);
 
     /* FIXME: Figure out how subset->x_max etc maps to the /FontBBox */
 
@@ -546,18 +495,18 @@ _cairo_ps_surface_emit_truetype_font_subset (cairo_ps_surface_t		*surface,
 				 "/sfnts [\n");
     begin = 0;
     end = 0;
-    for (i = 0; i < subset.num_string_offsets; i++) {
-        end = subset.string_offsets[i];
+    for (i = 0; i < subset->num_string_offsets; i++) {
+        end = subset->string_offsets[i];
         _cairo_output_stream_printf (surface->final_stream,"<");
         _cairo_output_stream_write_hex_string (surface->final_stream,
-                                               subset.data + begin, end - begin);
+                                               subset->data + begin, end - begin);
         _cairo_output_stream_printf (surface->final_stream,"00>\n");
         begin = end;
     }
-    if (subset.data_length > end) {
+    if (subset->data_length > end) {
         _cairo_output_stream_printf (surface->final_stream,"<");
         _cairo_output_stream_write_hex_string (surface->final_stream,
-                                               subset.data + end, subset.data_length - end);
+                                               subset->data + end, subset->data_length - end);
         _cairo_output_stream_printf (surface->final_stream,"00>\n");
     }
 
@@ -568,8 +517,6 @@ _cairo_ps_surface_emit_truetype_font_subset (cairo_ps_surface_t		*surface,
 				 font_subset->subset_id);
     _cairo_output_stream_printf (surface->final_stream,
 				 "%%%%EndResource\n");
-    _cairo_truetype_subset_fini (&subset);
-
 
     return CAIRO_STATUS_SUCCESS;
 }
@@ -754,31 +701,112 @@ _cairo_ps_surface_emit_type3_font_subset (cairo_ps_surface_t		*surface,
     return CAIRO_STATUS_SUCCESS;
 }
 
-static cairo_int_status_t
-_cairo_ps_surface_emit_unscaled_font_subset (cairo_scaled_font_subset_t	*font_subset,
-				            void			*closure)
+typedef enum {
+    CAIRO_PS_FONT_SUBSET_TYPE1,
+    CAIRO_PS_FONT_SUBSET_TRUETYPE,
+    CAIRO_PS_FONT_SUBSET_TYPE1_FALLBACK
+} cairo_ps_font_subset_type_t;
+
+/* An unscaled font subset ready to be written, see
+ * _cairo_scaled_font_subsets_foreach_unscaled_parallel() */
+typedef struct _cairo_ps_prepared_font_subset {
+    cairo_int_status_t status;
+    cairo_ps_font_subset_type_t type;
+    union {
+	cairo_truetype_subset_t truetype;
+	cairo_type1_subset_t type1;
+    } u;
+} cairo_ps_prepared_font_subset_t;
+
+static void
+_cairo_ps_surface_prepare_unscaled_font_subset (cairo_scaled_font_subset_t	*font_subset,
+						void				*prepared_subset,
+						void				*closure)
 {
-    cairo_ps_surface_t *surface = closure;
+    cairo_ps_prepared_font_subset_t *prepared = prepared_subset;
     cairo_int_status_t status;
+    char name[64];
 
     status = _cairo_scaled_font_subset_create_glyph_names (font_subset);
     if (_cairo_int_status_is_error (status))
-	return status;
+	goto DONE;
+
+    snprintf (name, sizeof name, "f-%d-%d",
+	      font_subset->font_id, font_subset->subset_id);
 
-    status = _cairo_ps_surface_emit_type1_font_subset (surface, font_subset);
+    prepared->type = CAIRO_PS_FONT_SUBSET_TYPE1;
+    status = _cairo_type1_subset_init (&prepared->u.type1, name,
+				       font_subset, TRUE);
     if (status != CAIRO_INT_STATUS_UNSUPPORTED)
-	return status;
+	goto DONE;
 
-    status = _cairo_ps_surface_emit_truetype_font_subset (surface, font_subset);
+    prepared->type = CAIRO_PS_FONT_SUBSET_TRUETYPE;
+    status = _cairo_truetype_subset_init_ps (&prepared->u.truetype,
+					     font_subset);
     if (status != CAIRO_INT_STATUS_UNSUPPORTED)
-	return status;
+	goto DONE;
 
-    status = _cairo_ps_surface_emit_type1_font_fallback (surface, font_subset);
+    prepared->type = CAIRO_PS_FONT_SUBSET_TYPE1_FALLBACK;
+    status = _cairo_type1_fallback_init_hex (&prepared->u.type1, name,
+					     font_subset);
     if (status != CAIRO_INT_STATUS_UNSUPPORTED)
-	return status;
+	goto DONE;
 
     ASSERT_NOT_REACHED;
-    return CAIRO_STATUS_SUCCESS;
+
+DONE:
+    prepared->status = status;
+}
+
+static cairo_int_status_t
+_cairo_ps_surface_emit_unscaled_font_subset (cairo_scaled_font_subset_t	*font_subset,
+					     void			*prepared_subset,
+				             void			*closure)
+{
+    cairo_ps_prepared_font_subset_t *prepared = prepared_subset;
+    cairo_ps_surface_t *surface = closure;
+
+    if (unlikely (prepared->status)) {
+	/* no subsetter, already asserted upon */
+	if (prepared->status == CAIRO_INT_STATUS_UNSUPPORTED)
+	    return CAIRO_INT_STATUS_SUCCESS;
+
+	return prepared->status;
+    }
+
+    switch (prepared->type) {
+    case CAIRO_PS_FONT_SUBSET_TYPE1:
+    case CAIRO_PS_FONT_SUBSET_TYPE1_FALLBACK:
+	return _cairo_ps_surface_emit_type1_font (surface, font_subset,
+						  &prepared->u.type1);
+    case CAIRO_PS_FONT_SUBSET_TRUETYPE:
+	return _cairo_ps_surface_emit_truetype_font_subset (surface, font_subset,
+							    &prepared->u.truetype);
+    }
+
+    ASSERT_NOT_REACHED;
+    return CAIRO_INT_STATUS_SUCCESS;
+}
+
+static void
+_cairo_ps_surface_release_unscaled_font_subset (void *prepared_subset)
+{
+    cairo_ps_prepared_font_subset_t *prepared = prepared_subset;
+
+    if (prepared->status)
+	return;
+
+    switch (prepared->type) {
+    case CAIRO_PS_FONT_SUBSET_TYPE1:
+	_cairo_type1_subset_fini (&prepared->u.type1);
+	break;
+    case CAIRO_PS_FONT_SUBSET_TRUETYPE:
+	_cairo_truetype_subset_fini (&prepared->u.truetype);
+	break;
+    case CAIRO_PS_FONT_SUBSET_TYPE1_FALLBACK:
+	_cairo_type1_fallback_fini (&prepared->u.type1);
+	break;
+    }
 }
 
 static cairo_int_status_t
@@ -816,9 +844,12 @@ _cairo_ps_surface_emit_font_subsets (cairo_ps_surface_t *surface)
     if (unlikely (status))
 	return status;
 
-    status = _cairo_scaled_font_subsets_foreach_unscaled (surface->font_subsets,
-                                                          _cairo_ps_surface_emit_unscaled_font_subset,
-                                                          surface);
+    status = _cairo_scaled_font_subsets_foreach_unscaled_parallel (surface->font_subsets,
+								   sizeof (cairo_ps_prepared_font_subset_t),
+								   _cairo_ps_surface_prepare_unscaled_font_subset,
+								   _cairo_ps_surface_emit_unscaled_font_subset,
+								   _cairo_ps_surface_release_unscaled_font_subset,
+								   surface);
     if (unlikely (status))
 	return status;
 
@@ -65,7 +65,6 @@ typedef struct _cairo_command_header {
     cairo_clip_t		*clip;
 
     int index;
-    struct _cairo_command_header *chain;
 } cairo_command_header_t;
 
 typedef struct _cairo_command_paint {
@@ -133,16 +132,28 @@ typedef struct _cairo_recording_surface {
     cairo_bool_t unbounded;
 
     cairo_array_t commands;
+    /* Commands and their glyph and text arrays are carved out of these
+     * chunks, which are only released when the surface is finished. */
+    struct _cairo_recording_arena_chunk *arena;
     unsigned int *indices;
     unsigned int num_indices;
     cairo_bool_t optimize_clears;
     cairo_bool_t has_bilevel_alpha;
     cairo_bool_t has_only_op_over;
 
+    /* Spatial index over the extents of commands [0, num_indexed) */
     struct bbtree {
-	cairo_box_t extents;
-	struct bbtree *left, *right;
-	cairo_command_header_t *chain;
+	struct bbtree_node {
+	    cairo_box_t extents;
+	    /* a leaf references count entries of leaves[] from first,
+	     * otherwise first is the right child (the left child follows
+	     * its parent) and count is 0 */
+	    unsigned int first;
+	    unsigned int count;
+	} *nodes;
+	unsigned int *leaves;
+	unsigned int num_nodes;
+	unsigned int num_indexed;
     } bbtree;
 } cairo_recording_surface_t;
 
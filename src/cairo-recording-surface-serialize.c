@@ -0,0 +1,1673 @@
+/* cairo - a vector graphics library with display and print output
+ *
+ * Copyright © 2026 The cairo authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it either under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * (the "LGPL") or, at your option, under the terms of the Mozilla
+ * Public License Version 1.1 (the "MPL"). If you do not alter this
+ * notice, a recipient may use your version of this file under either
+ * the MPL or the LGPL.
+ *
+ * You should have received a copy of the LGPL along with this library
+ * in the file COPYING-LGPL-2.1; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA 02110-1335, USA
+ * You should have received a copy of the MPL along with this library
+ * in the file COPYING-MPL-1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY
+ * OF ANY KIND, either express or implied. See the LGPL or the MPL for
+ * the specific language governing rights and limitations.
+ *
+ * The Original Code is the cairo graphics library.
+ *
+ * The Initial Developer of the Original Code is the cairo authors.
+ */
+
+/* A compact binary form of a recording surface.
+ *
+ * The stream is a flat sequence of fixed layout records in host byte
+ * order: a header (magic, version and a byte-order marker) followed by
+ * the recording itself, which is its content, extents and the list of
+ * commands. Every command stores its operator, its clip (the clip boxes
+ * followed by the clip paths, oldest first) and the arguments of the
+ * drawing operation. Paths are kept in fixed point, exactly as they are
+ * held by the recording surface, so a round trip is lossless.
+ *
+ * Source surfaces are stored as pixel data, except for recording
+ * surfaces which are nested recursively. Text is stored with a toy font
+ * description; glyphs shown with any other kind of font are replaced by
+ * a fill of their outlines.
+ *
+ * Loading is a single linear pass over the buffer which reconstructs a
+ * new recording surface, so the data may simply be a read-only mapping
+ * of a file previously written with
+ * cairo_recording_surface_write_to_stream().
+ */
+
+#include "cairoint.h"
+
+#include "cairo-array-private.h"
+#include "cairo-clip-inline.h"
+#include "cairo-error-private.h"
+#include "cairo-image-surface-private.h"
+#include "cairo-output-stream-private.h"
+#include "cairo-pattern-private.h"
+#include "cairo-recording-surface-inline.h"
+#include "cairo-recording-surface-private.h"
+#include "cairo-scaled-font-private.h"
+#include "cairo-surface-snapshot-inline.h"
+#include "cairo-surface-wrapper-private.h"
+
+#define RECORDING_MAGIC "CAIROREC"
+#define RECORDING_MAGIC_LENGTH 8
+#define RECORDING_VERSION 1
+#define RECORDING_BYTE_ORDER 0x01020304
+/* bounds the recursion through nested recording surfaces */
+#define RECORDING_MAX_DEPTH 64
+
+enum {
+    PATH_OP_MOVE_TO,
+    PATH_OP_LINE_TO,
+    PATH_OP_CURVE_TO,
+    PATH_OP_CLOSE_PATH,
+    PATH_OP_END
+};
+
+enum {
+    SOURCE_IMAGE,
+    SOURCE_RECORDING
+};
+
+/* Writing */
+
+static void
+_write_uint32 (cairo_output_stream_t *stream, uint32_t v)
+{
+    _cairo_output_stream_write (stream, &v, sizeof (v));
+}
+
+static void
+_write_int32 (cairo_output_stream_t *stream, int32_t v)
+{
+    _cairo_output_stream_write (stream, &v, sizeof (v));
+}
+
+static void
+_write_double (cairo_output_stream_t *stream, double v)
+{
+    _cairo_output_stream_write (stream, &v, sizeof (v));
+}
+
+static void
+_write_matrix (cairo_output_stream_t *stream, const cairo_matrix_t *m)
+{
+    _write_double (stream, m->xx);
+    _write_double (stream, m->yx);
+    _write_double (stream, m->xy);
+    _write_double (stream, m->yy);
+    _write_double (stream, m->x0);
+    _write_double (stream, m->y0);
+}
+
+static void
+_write_string (cairo_output_stream_t *stream, const char *str, int len)
+{
+    if (str == NULL)
+	len = 0;
+    else if (len < 0)
+	len = strlen (str);
+
+    _write_uint32 (stream, len);
+    _cairo_output_stream_write (stream, str, len);
+}
+
+static cairo_status_t
+_write_path_move_to (void *closure, const cairo_point_t *point)
+{
+    cairo_output_stream_t *stream = closure;
+
+    _write_uint32 (stream, PATH_OP_MOVE_TO);
+    _write_int32 (stream, point->x);
+    _write_int32 (stream, point->y);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_write_path_line_to (void *closure, const cairo_point_t *point)
+{
+    cairo_output_stream_t *stream = closure;
+
+    _write_uint32 (stream, PATH_OP_LINE_TO);
+    _write_int32 (stream, point->x);
+    _write_int32 (stream, point->y);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_write_path_curve_to (void *closure,
+		      const cairo_point_t *p0,
+		      const cairo_point_t *p1,
+		      const cairo_point_t *p2)
+{
+    cairo_output_stream_t *stream = closure;
+
+    _write_uint32 (stream, PATH_OP_CURVE_TO);
+    _write_int32 (stream, p0->x);
+    _write_int32 (stream, p0->y);
+    _write_int32 (stream, p1->x);
+    _write_int32 (stream, p1->y);
+    _write_int32 (stream, p2->x);
+    _write_int32 (stream, p2->y);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_write_path_close_path (void *closure)
+{
+    cairo_output_stream_t *stream = closure;
+
+    _write_uint32 (stream, PATH_OP_CLOSE_PATH);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+_write_path (cairo_output_stream_t *stream, const cairo_path_fixed_t *path)
+{
+    cairo_status_t status;
+
+    status = _cairo_path_fixed_interpret (path,
+					  _write_path_move_to,
+					  _write_path_line_to,
+					  _write_path_curve_to,
+					  _write_path_close_path,
+					  stream);
+    assert (status == CAIRO_STATUS_SUCCESS);
+
+    _write_uint32 (stream, PATH_OP_END);
+}
+
+static void
+_write_clip_path (cairo_output_stream_t *stream,
+		  const cairo_clip_path_t *clip_path)
+{
+    /* the chain is newest first, emit the oldest path first */
+    if (clip_path == NULL)
+	return;
+
+    _write_clip_path (stream, clip_path->prev);
+
+    _write_uint32 (stream, clip_path->fill_rule);
+    _write_double (stream, clip_path->tolerance);
+    _write_uint32 (stream, clip_path->antialias);
+    _write_path (stream, &clip_path->path);
+}
+
+static void
+_write_clip (cairo_output_stream_t *stream, const cairo_clip_t *clip)
+{
+    const cairo_clip_path_t *clip_path;
+    int num_paths, i;
+
+    if (clip == NULL) {
+	_write_uint32 (stream, FALSE);
+	return;
+    }
+
+    _write_uint32 (stream, TRUE);
+
+    _write_uint32 (stream, clip->num_boxes);
+    for (i = 0; i < clip->num_boxes; i++) {
+	_write_int32 (stream, clip->boxes[i].p1.x);
+	_write_int32 (stream, clip->boxes[i].p1.y);
+	_write_int32 (stream, clip->boxes[i].p2.x);
+	_write_int32 (stream, clip->boxes[i].p2.y);
+    }
+
+    num_paths = 0;
+    for (clip_path = clip->path; clip_path != NULL; clip_path = clip_path->prev)
+	num_paths++;
+    _write_uint32 (stream, num_paths);
+    _write_clip_path (stream, clip->path);
+}
+
+static cairo_status_t
+_write_recording (cairo_output_stream_t *stream,
+		  cairo_recording_surface_t *surface,
+		  int depth);
+
+static cairo_status_t
+_write_image (cairo_output_stream_t *stream, cairo_surface_t *surface)
+{
+    cairo_image_surface_t *image, *coerced;
+    void *image_extra;
+    cairo_status_t status;
+    int row_length, y;
+
+    status = _cairo_surface_acquire_source_image (surface, &image, &image_extra);
+    if (unlikely (status))
+	return status;
+
+    coerced = image;
+    if (image->format == CAIRO_FORMAT_INVALID) {
+	coerced = _cairo_image_surface_coerce (image);
+	status = coerced->base.status;
+	if (unlikely (status))
+	    goto BAIL;
+    }
+
+    _write_uint32 (stream, SOURCE_IMAGE);
+    _write_uint32 (stream, coerced->format);
+    _write_int32 (stream, coerced->width);
+    _write_int32 (stream, coerced->height);
+
+    row_length = (coerced->width * _cairo_format_bits_per_pixel (coerced->format) + 7) / 8;
+    for (y = 0; y < coerced->height; y++)
+	_cairo_output_stream_write (stream,
+				    coerced->data + y * coerced->stride,
+				    row_length);
+
+    if (coerced != image)
+	cairo_surface_destroy (&coerced->base);
+BAIL:
+    _cairo_surface_release_source_image (surface, image, image_extra);
+    return status;
+}
+
+static cairo_status_t
+_write_source_surface (cairo_output_stream_t *stream,
+		       cairo_surface_t *surface,
+		       int depth)
+{
+    cairo_status_t status;
+
+    _write_double (stream, surface->device_transform.xx);
+    _write_double (stream, surface->device_transform.yy);
+    _write_double (stream, surface->device_transform.x0);
+    _write_double (stream, surface->device_transform.y0);
+
+    if (_cairo_surface_is_snapshot (surface))
+	surface = _cairo_surface_snapshot_get_target (surface);
+    else
+	surface = cairo_surface_reference (surface);
+
+    if (_cairo_surface_is_recording (surface)) {
+	_write_uint32 (stream, SOURCE_RECORDING);
+	status = _write_recording (stream,
+				   (cairo_recording_surface_t *) surface,
+				   depth + 1);
+    } else {
+	status = _write_image (stream, surface);
+    }
+
+    cairo_surface_destroy (surface);
+    return status;
+}
+
+static void
+_write_gradient (cairo_output_stream_t *stream,
+		 const cairo_gradient_pattern_t *gradient)
+{
+    unsigned int i;
+
+    _write_uint32 (stream, gradient->n_stops);
+    for (i = 0; i < gradient->n_stops; i++) {
+	_write_double (stream, gradient->stops[i].offset);
+	_write_double (stream, gradient->stops[i].color.red);
+	_write_double (stream, gradient->stops[i].color.green);
+	_write_double (stream, gradient->stops[i].color.blue);
+	_write_double (stream, gradient->stops[i].color.alpha);
+    }
+}
+
+static void
+_write_mesh (cairo_output_stream_t *stream,
+	     const cairo_mesh_pattern_t *mesh)
+{
+    const cairo_mesh_patch_t *patch;
+    unsigned int i, n;
+    int j, k;
+
+    n = _cairo_array_num_elements (&mesh->patches);
+    patch = _cairo_array_index_const (&mesh->patches, 0);
+
+    _write_uint32 (stream, n);
+    for (i = 0; i < n; i++) {
+	for (j = 0; j < 4; j++) {
+	    for (k = 0; k < 4; k++) {
+		_write_double (stream, patch[i].points[j][k].x);
+		_write_double (stream, patch[i].points[j][k].y);
+	    }
+	}
+	for (j = 0; j < 4; j++) {
+	    _write_double (stream, patch[i].colors[j].red);
+	    _write_double (stream, patch[i].colors[j].green);
+	    _write_double (stream, patch[i].colors[j].blue);
+	    _write_double (stream, patch[i].colors[j].alpha);
+	}
+    }
+}
+
+static cairo_status_t
+_write_pattern (cairo_output_stream_t *stream,
+		cairo_recording_surface_t *surface,
+		const cairo_pattern_t *pattern,
+		int depth)
+{
+    cairo_surface_t *source;
+    cairo_pattern_type_t type;
+    cairo_status_t status;
+
+    /* raster sources are sampled once and stored as their pixels */
+    type = pattern->type;
+    if (type == CAIRO_PATTERN_TYPE_RASTER_SOURCE)
+	type = CAIRO_PATTERN_TYPE_SURFACE;
+
+    _write_uint32 (stream, type);
+    _write_uint32 (stream, pattern->filter);
+    _write_uint32 (stream, pattern->extend);
+    _write_uint32 (stream, pattern->has_component_alpha);
+    _write_matrix (stream, &pattern->matrix);
+    _write_double (stream, pattern->opacity);
+
+    switch (pattern->type) {
+    case CAIRO_PATTERN_TYPE_SOLID: {
+	const cairo_solid_pattern_t *solid = (cairo_solid_pattern_t *) pattern;
+
+	_write_double (stream, solid->color.red);
+	_write_double (stream, solid->color.green);
+	_write_double (stream, solid->color.blue);
+	_write_double (stream, solid->color.alpha);
+	return CAIRO_STATUS_SUCCESS;
+    }
+
+    case CAIRO_PATTERN_TYPE_SURFACE:
+	return _write_source_surface (stream,
+				      ((cairo_surface_pattern_t *) pattern)->surface,
+				      depth);
+
+    case CAIRO_PATTERN_TYPE_RASTER_SOURCE:
+	source = _cairo_raster_source_pattern_acquire (pattern,
+						       &surface->base,
+						       NULL);
+	if (unlikely (source == NULL))
+	    return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	if (unlikely (source->status))
+	    return source->status;
+
+	status = _write_source_surface (stream, source, depth);
+	_cairo_raster_source_pattern_release (pattern, source);
+	return status;
+
+    case CAIRO_PATTERN_TYPE_LINEAR: {
+	const cairo_linear_pattern_t *linear = (cairo_linear_pattern_t *) pattern;
+
+	_write_double (stream, linear->pd1.x);
+	_write_double (stream, linear->pd1.y);
+	_write_double (stream, linear->pd2.x);
+	_write_double (stream, linear->pd2.y);
+	_write_gradient (stream, &linear->base);
+	return CAIRO_STATUS_SUCCESS;
+    }
+
+    case CAIRO_PATTERN_TYPE_RADIAL: {
+	const cairo_radial_pattern_t *radial = (cairo_radial_pattern_t *) pattern;
+
+	_write_double (stream, radial->cd1.center.x);
+	_write_double (stream, radial->cd1.center.y);
+	_write_double (stream, radial->cd1.radius);
+	_write_double (stream, radial->cd2.center.x);
+	_write_double (stream, radial->cd2.center.y);
+	_write_double (stream, radial->cd2.radius);
+	_write_gradient (stream, &radial->base);
+	return CAIRO_STATUS_SUCCESS;
+    }
+
+    case CAIRO_PATTERN_TYPE_MESH:
+	_write_mesh (stream, (cairo_mesh_pattern_t *) pattern);
+	return CAIRO_STATUS_SUCCESS;
+    }
+
+    ASSERT_NOT_REACHED;
+    return _cairo_error (CAIRO_STATUS_PATTERN_TYPE_MISMATCH);
+}
+
+static void
+_write_stroke_style (cairo_output_stream_t *stream,
+		     const cairo_stroke_style_t *style)
+{
+    unsigned int i;
+
+    _write_double (stream, style->line_width);
+    _write_uint32 (stream, style->line_cap);
+    _write_uint32 (stream, style->line_join);
+    _write_double (stream, style->miter_limit);
+    _write_uint32 (stream, style->num_dashes);
+    for (i = 0; i < style->num_dashes; i++)
+	_write_double (stream, style->dash[i]);
+    _write_double (stream, style->dash_offset);
+}
+
+static cairo_font_face_t *
+_toy_font_face (cairo_scaled_font_t *scaled_font)
+{
+    cairo_font_face_t *font_face;
+
+    font_face = scaled_font->original_font_face;
+    if (font_face == NULL)
+	font_face = scaled_font->font_face;
+
+    if (cairo_font_face_get_type (font_face) != CAIRO_FONT_TYPE_TOY)
+	return NULL;
+
+    return font_face;
+}
+
+static cairo_status_t
+_write_glyphs_as_fill (cairo_output_stream_t *stream,
+		       cairo_recording_surface_t *surface,
+		       const cairo_command_show_text_glyphs_t *command,
+		       int depth)
+{
+    cairo_path_fixed_t path;
+    cairo_status_t status;
+
+    _cairo_path_fixed_init (&path);
+    status = _cairo_scaled_font_glyph_path (command->scaled_font,
+					    command->glyphs,
+					    command->num_glyphs,
+					    &path);
+    if (unlikely (status))
+	goto BAIL;
+
+    status = _write_pattern (stream, surface, &command->source.base, depth);
+    if (unlikely (status))
+	goto BAIL;
+
+    _write_path (stream, &path);
+    _write_uint32 (stream, CAIRO_FILL_RULE_WINDING);
+    _write_double (stream, CAIRO_GSTATE_TOLERANCE_DEFAULT);
+    _write_uint32 (stream, command->scaled_font->options.antialias);
+
+BAIL:
+    _cairo_path_fixed_fini (&path);
+    return status;
+}
+
+static cairo_status_t
+_write_show_text_glyphs (cairo_output_stream_t *stream,
+			 cairo_recording_surface_t *surface,
+			 const cairo_command_show_text_glyphs_t *command,
+			 cairo_font_face_t *toy_face,
+			 int depth)
+{
+    cairo_scaled_font_t *scaled_font = command->scaled_font;
+    cairo_status_t status;
+    unsigned int i;
+    int j;
+
+    status = _write_pattern (stream, surface, &command->source.base, depth);
+    if (unlikely (status))
+	return status;
+
+    _write_string (stream, command->utf8, command->utf8_len);
+
+    _write_uint32 (stream, command->num_glyphs);
+    for (i = 0; i < command->num_glyphs; i++) {
+	uint64_t index = command->glyphs[i].index;
+
+	_cairo_output_stream_write (stream, &index, sizeof (index));
+	_write_double (stream, command->glyphs[i].x);
+	_write_double (stream, command->glyphs[i].y);
+    }
+
+    _write_uint32 (stream, command->num_clusters);
+    for (j = 0; j < command->num_clusters; j++) {
+	_write_int32 (stream, command->clusters[j].num_bytes);
+	_write_int32 (stream, command->clusters[j].num_glyphs);
+    }
+    _write_uint32 (stream, command->cluster_flags);
+
+    _write_string (stream, cairo_toy_font_face_get_family (toy_face), -1);
+    _write_uint32 (stream, cairo_toy_font_face_get_slant (toy_face));
+    _write_uint32 (stream, cairo_toy_font_face_get_weight (toy_face));
+    _write_matrix (stream, &scaled_font->font_matrix);
+    _write_matrix (stream, &scaled_font->ctm);
+    _write_uint32 (stream, scaled_font->options.antialias);
+    _write_uint32 (stream, scaled_font->options.subpixel_order);
+    _write_uint32 (stream, scaled_font->options.lcd_filter);
+    _write_uint32 (stream, scaled_font->options.hint_style);
+    _write_uint32 (stream, scaled_font->options.hint_metrics);
+    _write_uint32 (stream, scaled_font->options.round_glyph_positions);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_write_command (cairo_output_stream_t *stream,
+		cairo_recording_surface_t *surface,
+		const cairo_command_t *command,
+		int depth)
+{
+    cairo_font_face_t *toy_face = NULL;
+    cairo_command_type_t type;
+    cairo_status_t status;
+
+    type = command->header.type;
+    if (type == CAIRO_COMMAND_SHOW_TEXT_GLYPHS) {
+	toy_face = _toy_font_face (command->show_text_glyphs.scaled_font);
+	if (toy_face == NULL)
+	    type = CAIRO_COMMAND_FILL;
+    }
+
+    _write_uint32 (stream, type);
+    _write_uint32 (stream, command->header.op);
+    _write_clip (stream, command->header.clip);
+
+    switch (command->header.type) {
+    case CAIRO_COMMAND_PAINT:
+	return _write_pattern (stream, surface,
+			       &command->paint.source.base, depth);
+
+    case CAIRO_COMMAND_MASK:
+	status = _write_pattern (stream, surface,
+				 &command->mask.source.base, depth);
+	if (unlikely (status))
+	    return status;
+
+	return _write_pattern (stream, surface,
+			       &command->mask.mask.base, depth);
+
+    case CAIRO_COMMAND_STROKE:
+	status = _write_pattern (stream, surface,
+				 &command->stroke.source.base, depth);
+	if (unlikely (status))
+	    return status;
+
+	_write_path (stream, &command->stroke.path);
+	_write_stroke_style (stream, &command->stroke.style);
+	_write_matrix (stream, &command->stroke.ctm);
+	_write_matrix (stream, &command->stroke.ctm_inverse);
+	_write_double (stream, command->stroke.tolerance);
+	_write_uint32 (stream, command->stroke.antialias);
+	return CAIRO_STATUS_SUCCESS;
+
+    case CAIRO_COMMAND_FILL:
+	status = _write_pattern (stream, surface,
+				 &command->fill.source.base, depth);
+	if (unlikely (status))
+	    return status;
+
+	_write_path (stream, &command->fill.path);
+	_write_uint32 (stream, command->fill.fill_rule);
+	_write_double (stream, command->fill.tolerance);
+	_write_uint32 (stream, command->fill.antialias);
+	return CAIRO_STATUS_SUCCESS;
+
+    case CAIRO_COMMAND_SHOW_TEXT_GLYPHS:
+	if (toy_face == NULL)
+	    return _write_glyphs_as_fill (stream, surface,
+					  &command->show_text_glyphs, depth);
+
+	return _write_show_text_glyphs (stream, surface,
+					&command->show_text_glyphs,
+					toy_face, depth);
+    }
+
+    ASSERT_NOT_REACHED;
+    return _cairo_error (CAIRO_STATUS_INVALID_STATUS);
+}
+
+static cairo_status_t
+_write_recording (cairo_output_stream_t *stream,
+		  cairo_recording_surface_t *surface,
+		  int depth)
+{
+    cairo_command_t **elements;
+    unsigned int i, num_elements;
+    cairo_status_t status;
+
+    if (unlikely (depth > RECORDING_MAX_DEPTH))
+	return _cairo_error (CAIRO_STATUS_INVALID_SIZE);
+
+    if (unlikely (surface->base.status))
+	return surface->base.status;
+
+    if (unlikely (surface->base.finished))
+	return _cairo_error (CAIRO_STATUS_SURFACE_FINISHED);
+
+    _write_uint32 (stream, surface->base.content);
+    _write_uint32 (stream, surface->unbounded);
+    _write_double (stream, surface->extents_pixels.x);
+    _write_double (stream, surface->extents_pixels.y);
+    _write_double (stream, surface->extents_pixels.width);
+    _write_double (stream, surface->extents_pixels.height);
+
+    num_elements = surface->commands.num_elements;
+    elements = _cairo_array_index (&surface->commands, 0);
+
+    _write_uint32 (stream, num_elements);
+    for (i = 0; i < num_elements; i++) {
+	status = _write_command (stream, surface, elements[i], depth);
+	if (unlikely (status))
+	    return status;
+    }
+
+    return _cairo_output_stream_get_status (stream);
+}
+
+/**
+ * cairo_recording_surface_write_to_stream:
+ * @surface: a #cairo_recording_surface_t
+ * @write_func: a #cairo_write_func_t
+ * @closure: closure data for the write function
+ *
+ * Writes the commands recorded so far by @surface in a compact binary
+ * form to the given stream. The data can be turned back into a
+ * recording surface with cairo_recording_surface_create_from_data()
+ * by the same version of cairo on a machine with the same byte order.
+ *
+ * Source surfaces, other than recording surfaces, are stored as their
+ * pixels and any attached mime data is dropped. Text drawn with a font
+ * that was not created by cairo_select_font_face() or
+ * cairo_toy_font_face_create() is stored as the outlines of its glyphs.
+ *
+ * Text drawn with such a toy font is stored as its glyph indices along
+ * with the family, slant and weight of the font, which are resolved to
+ * a font again when the data is loaded. The glyph indices only select
+ * the same glyphs if that resolves to the same font file, so such text
+ * is only reproduced faithfully on a machine with the same fonts and
+ * font configuration.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS if the recording was written
+ * successfully, %CAIRO_STATUS_SURFACE_TYPE_MISMATCH if @surface is not
+ * a recording surface, or %CAIRO_STATUS_WRITE_ERROR if an I/O error
+ * occurs while writing.
+ *
+ * Since: 1.16
+ **/
+cairo_status_t
+cairo_recording_surface_write_to_stream (cairo_surface_t	*surface,
+					 cairo_write_func_t	 write_func,
+					 void			*closure)
+{
+    cairo_output_stream_t *stream;
+    cairo_status_t status, status2;
+
+    if (unlikely (surface->status))
+	return surface->status;
+
+    if (unlikely (! _cairo_surface_is_recording (surface)))
+	return _cairo_error (CAIRO_STATUS_SURFACE_TYPE_MISMATCH);
+
+    stream = _cairo_output_stream_create (write_func, NULL, closure);
+    status = _cairo_output_stream_get_status (stream);
+    if (unlikely (status))
+	return _cairo_output_stream_destroy (stream);
+
+    _cairo_output_stream_write (stream,
+				RECORDING_MAGIC, RECORDING_MAGIC_LENGTH);
+    _write_uint32 (stream, RECORDING_VERSION);
+    _write_uint32 (stream, RECORDING_BYTE_ORDER);
+
+    status = _write_recording (stream,
+			       (cairo_recording_surface_t *) surface,
+			       0);
+
+    status2 = _cairo_output_stream_destroy (stream);
+    if (status == CAIRO_STATUS_SUCCESS)
+	status = status2;
+
+    return status;
+}
+
+/* Reading */
+
+typedef struct _cairo_recording_reader {
+    const unsigned char *data;
+    const unsigned char *end;
+    cairo_status_t status;
+} cairo_recording_reader_t;
+
+static cairo_status_t
+_read_error (cairo_recording_reader_t *reader)
+{
+    if (reader->status == CAIRO_STATUS_SUCCESS)
+	reader->status = _cairo_error (CAIRO_STATUS_READ_ERROR);
+    return reader->status;
+}
+
+static const unsigned char *
+_read_bytes (cairo_recording_reader_t *reader, size_t length)
+{
+    const unsigned char *data;
+
+    if (unlikely (reader->status))
+	return NULL;
+
+    if (unlikely ((size_t) (reader->end - reader->data) < length)) {
+	_read_error (reader);
+	return NULL;
+    }
+
+    data = reader->data;
+    reader->data += length;
+    return data;
+}
+
+/* Checks that there is enough data left for count records of the given
+ * size, before anything is allocated for them. */
+static cairo_bool_t
+_read_has_records (cairo_recording_reader_t *reader,
+		   uint32_t count,
+		   size_t size)
+{
+    if (unlikely (reader->status))
+	return FALSE;
+
+    if (unlikely ((size_t) (reader->end - reader->data) / size < count)) {
+	_read_error (reader);
+	return FALSE;
+    }
+
+    return TRUE;
+}
+
+static uint32_t
+_read_uint32 (cairo_recording_reader_t *reader)
+{
+    const unsigned char *data;
+    uint32_t v = 0;
+
+    data = _read_bytes (reader, sizeof (v));
+    if (likely (data != NULL))
+	memcpy (&v, data, sizeof (v));
+    return v;
+}
+
+static int32_t
+_read_int32 (cairo_recording_reader_t *reader)
+{
+    const unsigned char *data;
+    int32_t v = 0;
+
+    data = _read_bytes (reader, sizeof (v));
+    if (likely (data != NULL))
+	memcpy (&v, data, sizeof (v));
+    return v;
+}
+
+static double
+_read_double (cairo_recording_reader_t *reader)
+{
+    const unsigned char *data;
+    double v = 0.;
+
+    data = _read_bytes (reader, sizeof (v));
+    if (likely (data != NULL))
+	memcpy (&v, data, sizeof (v));
+    return v;
+}
+
+/* Reads an enumeration value and checks that it lies in [0, max]. */
+static uint32_t
+_read_enum (cairo_recording_reader_t *reader, uint32_t max)
+{
+    uint32_t v;
+
+    v = _read_uint32 (reader);
+    if (unlikely (v > max)) {
+	_read_error (reader);
+	return 0;
+    }
+
+    return v;
+}
+
+static void
+_read_matrix (cairo_recording_reader_t *reader, cairo_matrix_t *m)
+{
+    m->xx = _read_double (reader);
+    m->yx = _read_double (reader);
+    m->xy = _read_double (reader);
+    m->yy = _read_double (reader);
+    m->x0 = _read_double (reader);
+    m->y0 = _read_double (reader);
+}
+
+/* Returns a nul-terminated copy of the string, or NULL if it is empty. */
+static char *
+_read_string (cairo_recording_reader_t *reader, int *length_out)
+{
+    const unsigned char *data;
+    uint32_t length;
+    char *str;
+
+    length = _read_uint32 (reader);
+    if (length_out)
+	*length_out = 0;
+    if (length == 0 || unlikely (length > INT_MAX - 1))
+	return NULL;
+
+    data = _read_bytes (reader, length);
+    if (unlikely (data == NULL))
+	return NULL;
+
+    str = _cairo_malloc (length + 1);
+    if (unlikely (str == NULL)) {
+	reader->status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	return NULL;
+    }
+
+    memcpy (str, data, length);
+    str[length] = '\0';
+    if (length_out)
+	*length_out = length;
+    return str;
+}
+
+static cairo_status_t
+_read_path (cairo_recording_reader_t *reader, cairo_path_fixed_t *path)
+{
+    cairo_fixed_t x[3], y[3];
+    cairo_status_t status;
+    int i;
+
+    _cairo_path_fixed_init (path);
+
+    while (reader->status == CAIRO_STATUS_SUCCESS) {
+	switch (_read_enum (reader, PATH_OP_END)) {
+	case PATH_OP_MOVE_TO:
+	    x[0] = _read_int32 (reader);
+	    y[0] = _read_int32 (reader);
+	    status = _cairo_path_fixed_move_to (path, x[0], y[0]);
+	    break;
+
+	case PATH_OP_LINE_TO:
+	    x[0] = _read_int32 (reader);
+	    y[0] = _read_int32 (reader);
+	    status = _cairo_path_fixed_line_to (path, x[0], y[0]);
+	    break;
+
+	case PATH_OP_CURVE_TO:
+	    for (i = 0; i < 3; i++) {
+		x[i] = _read_int32 (reader);
+		y[i] = _read_int32 (reader);
+	    }
+	    status = _cairo_path_fixed_curve_to (path,
+						 x[0], y[0],
+						 x[1], y[1],
+						 x[2], y[2]);
+	    break;
+
+	case PATH_OP_CLOSE_PATH:
+	    status = _cairo_path_fixed_close_path (path);
+	    break;
+
+	case PATH_OP_END:
+	default:
+	    return reader->status;
+	}
+
+	if (unlikely (status))
+	    reader->status = status;
+    }
+
+    return reader->status;
+}
+
+static cairo_clip_t *
+_read_clip (cairo_recording_reader_t *reader)
+{
+    cairo_clip_t *clip = NULL;
+    cairo_path_fixed_t path;
+    cairo_fill_rule_t fill_rule;
+    cairo_antialias_t antialias;
+    double tolerance;
+    uint32_t num_boxes, num_paths, i;
+
+    if (! _read_uint32 (reader))
+	return NULL;
+
+    num_boxes = _read_uint32 (reader);
+    if (num_boxes) {
+	cairo_box_t stack_boxes[CAIRO_STACK_ARRAY_LENGTH (cairo_box_t)];
+	cairo_box_t *boxes = stack_boxes;
+	cairo_boxes_t clip_boxes;
+
+	if (! _read_has_records (reader, num_boxes, 4 * sizeof (int32_t)))
+	    return NULL;
+
+	if (num_boxes > ARRAY_LENGTH (stack_boxes)) {
+	    boxes = _cairo_malloc_ab (num_boxes, sizeof (cairo_box_t));
+	    if (unlikely (boxes == NULL)) {
+		reader->status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+		return NULL;
+	    }
+	}
+
+	for (i = 0; i < num_boxes; i++) {
+	    boxes[i].p1.x = _read_int32 (reader);
+	    boxes[i].p1.y = _read_int32 (reader);
+	    boxes[i].p2.x = _read_int32 (reader);
+	    boxes[i].p2.y = _read_int32 (reader);
+	}
+
+	_cairo_boxes_init_for_array (&clip_boxes, boxes, num_boxes);
+	clip = _cairo_clip_intersect_boxes (clip, &clip_boxes);
+
+	if (boxes != stack_boxes)
+	    free (boxes);
+    }
+
+    num_paths = _read_uint32 (reader);
+    for (i = 0; i < num_paths && reader->status == CAIRO_STATUS_SUCCESS; i++) {
+	fill_rule = _read_enum (reader, CAIRO_FILL_RULE_EVEN_ODD);
+	tolerance = _read_double (reader);
+	antialias = _read_enum (reader, CAIRO_ANTIALIAS_BEST);
+
+	if (_read_path (reader, &path) == CAIRO_STATUS_SUCCESS)
+	    clip = _cairo_clip_intersect_path (clip, &path,
+					       fill_rule, tolerance, antialias);
+	_cairo_path_fixed_fini (&path);
+    }
+
+    if (unlikely (reader->status)) {
+	_cairo_clip_destroy (clip);
+	return NULL;
+    }
+
+    return clip;
+}
+
+static cairo_surface_t *
+_read_recording (cairo_recording_reader_t *reader, int depth);
+
+static cairo_surface_t *
+_read_image (cairo_recording_reader_t *reader)
+{
+    cairo_surface_t *image;
+    const unsigned char *data;
+    cairo_format_t format;
+    int width, height, row_length, stride, y;
+
+    format = _read_enum (reader, CAIRO_FORMAT_RGB30);
+    width = _read_int32 (reader);
+    height = _read_int32 (reader);
+    if (unlikely (reader->status))
+	return NULL;
+
+    stride = cairo_format_stride_for_width (format, width);
+    if (unlikely (stride < 0 || height < 0)) {
+	_read_error (reader);
+	return NULL;
+    }
+
+    row_length = (width * _cairo_format_bits_per_pixel (format) + 7) / 8;
+    if (row_length == 0) {
+	/* only an empty image has no pixels to a row */
+	if (unlikely (width != 0)) {
+	    _read_error (reader);
+	    return NULL;
+	}
+    } else if (! _read_has_records (reader, height, row_length))
+	return NULL;
+
+    image = cairo_image_surface_create (format, width, height);
+    if (unlikely (image->status)) {
+	reader->status = image->status;
+	cairo_surface_destroy (image);
+	return NULL;
+    }
+
+    for (y = 0; y < height; y++) {
+	data = _read_bytes (reader, row_length);
+	memcpy (((cairo_image_surface_t *) image)->data +
+		y * ((cairo_image_surface_t *) image)->stride,
+		data, row_length);
+    }
+    cairo_surface_mark_dirty (image);
+
+    return image;
+}
+
+static cairo_surface_t *
+_read_source_surface (cairo_recording_reader_t *reader, int depth)
+{
+    cairo_surface_t *surface;
+    double x_scale, y_scale, x_offset, y_offset;
+
+    x_scale = _read_double (reader);
+    y_scale = _read_double (reader);
+    x_offset = _read_double (reader);
+    y_offset = _read_double (reader);
+
+    switch (_read_enum (reader, SOURCE_RECORDING)) {
+    case SOURCE_IMAGE:
+	surface = _read_image (reader);
+	break;
+    case SOURCE_RECORDING:
+	surface = _read_recording (reader, depth + 1);
+	break;
+    default:
+	surface = NULL;
+	break;
+    }
+
+    if (unlikely (surface == NULL))
+	return NULL;
+
+    if (x_scale != 1. || y_scale != 1.)
+	cairo_surface_set_device_scale (surface, x_scale, y_scale);
+    if (x_offset != 0. || y_offset != 0.)
+	cairo_surface_set_device_offset (surface, x_offset, y_offset);
+
+    return surface;
+}
+
+static void
+_read_gradient (cairo_recording_reader_t *reader, cairo_pattern_t *pattern)
+{
+    uint32_t n_stops, i;
+    double offset, red, green, blue, alpha;
+
+    n_stops = _read_uint32 (reader);
+    if (! _read_has_records (reader, n_stops, 5 * sizeof (double)))
+	return;
+
+    for (i = 0; i < n_stops; i++) {
+	offset = _read_double (reader);
+	red = _read_double (reader);
+	green = _read_double (reader);
+	blue = _read_double (reader);
+	alpha = _read_double (reader);
+	cairo_pattern_add_color_stop_rgba (pattern,
+					   offset, red, green, blue, alpha);
+    }
+}
+
+static void
+_read_mesh (cairo_recording_reader_t *reader, cairo_pattern_t *pattern)
+{
+    cairo_mesh_pattern_t *mesh = (cairo_mesh_pattern_t *) pattern;
+    cairo_mesh_patch_t patch;
+    double red, green, blue, alpha;
+    uint32_t num_patches, i;
+    cairo_status_t status;
+    int j, k;
+
+    num_patches = _read_uint32 (reader);
+    if (! _read_has_records (reader, num_patches, 48 * sizeof (double)))
+	return;
+
+    for (i = 0; i < num_patches; i++) {
+	for (j = 0; j < 4; j++) {
+	    for (k = 0; k < 4; k++) {
+		patch.points[j][k].x = _read_double (reader);
+		patch.points[j][k].y = _read_double (reader);
+	    }
+	}
+	for (j = 0; j < 4; j++) {
+	    red = _read_double (reader);
+	    green = _read_double (reader);
+	    blue = _read_double (reader);
+	    alpha = _read_double (reader);
+	    _cairo_color_init_rgba (&patch.colors[j], red, green, blue, alpha);
+	}
+
+	status = _cairo_array_append (&mesh->patches, &patch);
+	if (unlikely (status)) {
+	    reader->status = status;
+	    return;
+	}
+    }
+}
+
+static cairo_pattern_t *
+_read_pattern (cairo_recording_reader_t *reader, int depth)
+{
+    cairo_pattern_t *pattern = NULL;
+    cairo_pattern_type_t type;
+    cairo_filter_t filter;
+    cairo_extend_t extend;
+    cairo_bool_t has_component_alpha;
+    cairo_matrix_t matrix;
+    double opacity;
+    double v[6];
+    int i;
+
+    type = _read_enum (reader, CAIRO_PATTERN_TYPE_MESH);
+    filter = _read_enum (reader, CAIRO_FILTER_GAUSSIAN);
+    extend = _read_enum (reader, CAIRO_EXTEND_PAD);
+    has_component_alpha = _read_uint32 (reader) != 0;
+    _read_matrix (reader, &matrix);
+    opacity = _read_double (reader);
+    if (unlikely (reader->status))
+	return NULL;
+
+    switch (type) {
+    case CAIRO_PATTERN_TYPE_SOLID:
+	for (i = 0; i < 4; i++)
+	    v[i] = _read_double (reader);
+	pattern = cairo_pattern_create_rgba (v[0], v[1], v[2], v[3]);
+	break;
+
+    case CAIRO_PATTERN_TYPE_SURFACE: {
+	cairo_surface_t *surface;
+
+	surface = _read_source_surface (reader, depth);
+	if (unlikely (surface == NULL))
+	    return NULL;
+
+	pattern = cairo_pattern_create_for_surface (surface);
+	cairo_surface_destroy (surface);
+	break;
+    }
+
+    case CAIRO_PATTERN_TYPE_LINEAR:
+	for (i = 0; i < 4; i++)
+	    v[i] = _read_double (reader);
+	pattern = cairo_pattern_create_linear (v[0], v[1], v[2], v[3]);
+	_read_gradient (reader, pattern);
+	break;
+
+    case CAIRO_PATTERN_TYPE_RADIAL:
+	for (i = 0; i < 6; i++)
+	    v[i] = _read_double (reader);
+	pattern = cairo_pattern_create_radial (v[0], v[1], v[2],
+					       v[3], v[4], v[5]);
+	_read_gradient (reader, pattern);
+	break;
+
+    case CAIRO_PATTERN_TYPE_MESH:
+	pattern = cairo_pattern_create_mesh ();
+	_read_mesh (reader, pattern);
+	break;
+
+    case CAIRO_PATTERN_TYPE_RASTER_SOURCE:
+    default:
+	_read_error (reader);
+	return NULL;
+    }
+
+    if (unlikely (reader->status == CAIRO_STATUS_SUCCESS && pattern->status))
+	reader->status = pattern->status;
+    if (unlikely (reader->status)) {
+	cairo_pattern_destroy (pattern);
+	return NULL;
+    }
+
+    pattern->filter = filter;
+    pattern->extend = extend;
+    pattern->has_component_alpha = has_component_alpha;
+    pattern->matrix = matrix;
+    pattern->opacity = opacity;
+
+    return pattern;
+}
+
+static void
+_read_stroke_style (cairo_recording_reader_t *reader,
+		    cairo_stroke_style_t *style)
+{
+    uint32_t i;
+
+    _cairo_stroke_style_init (style);
+
+    style->line_width = _read_double (reader);
+    style->line_cap = _read_enum (reader, CAIRO_LINE_CAP_SQUARE);
+    style->line_join = _read_enum (reader, CAIRO_LINE_JOIN_BEVEL);
+    style->miter_limit = _read_double (reader);
+    style->num_dashes = _read_uint32 (reader);
+    if (style->num_dashes) {
+	if (! _read_has_records (reader, style->num_dashes, sizeof (double))) {
+	    style->num_dashes = 0;
+	    return;
+	}
+
+	style->dash = _cairo_malloc_ab (style->num_dashes, sizeof (double));
+	if (unlikely (style->dash == NULL)) {
+	    style->num_dashes = 0;
+	    reader->status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	    return;
+	}
+
+	for (i = 0; i < style->num_dashes; i++)
+	    style->dash[i] = _read_double (reader);
+    }
+    style->dash_offset = _read_double (reader);
+}
+
+static cairo_scaled_font_t *
+_read_scaled_font (cairo_recording_reader_t *reader)
+{
+    cairo_font_face_t *font_face;
+    cairo_scaled_font_t *scaled_font;
+    cairo_font_options_t options;
+    cairo_font_slant_t slant;
+    cairo_font_weight_t weight;
+    cairo_matrix_t font_matrix, ctm;
+    char *family;
+
+    family = _read_string (reader, NULL);
+    slant = _read_enum (reader, CAIRO_FONT_SLANT_OBLIQUE);
+    weight = _read_enum (reader, CAIRO_FONT_WEIGHT_BOLD);
+    _read_matrix (reader, &font_matrix);
+    _read_matrix (reader, &ctm);
+
+    _cairo_font_options_init_default (&options);
+    options.antialias = _read_enum (reader, CAIRO_ANTIALIAS_BEST);
+    options.subpixel_order = _read_enum (reader, CAIRO_SUBPIXEL_ORDER_VBGR);
+    options.lcd_filter = _read_enum (reader, CAIRO_LCD_FILTER_FIR5);
+    options.hint_style = _read_enum (reader, CAIRO_HINT_STYLE_FULL);
+    options.hint_metrics = _read_enum (reader, CAIRO_HINT_METRICS_ON);
+    options.round_glyph_positions = _read_enum (reader, CAIRO_ROUND_GLYPH_POS_OFF);
+
+    if (unlikely (reader->status)) {
+	free (family);
+	return NULL;
+    }
+
+    font_face = cairo_toy_font_face_create (family ? family : "",
+					    slant, weight);
+    free (family);
+
+    scaled_font = cairo_scaled_font_create (font_face,
+					    &font_matrix, &ctm, &options);
+    cairo_font_face_destroy (font_face);
+
+    if (unlikely (scaled_font->status)) {
+	reader->status = scaled_font->status;
+	cairo_scaled_font_destroy (scaled_font);
+	return NULL;
+    }
+
+    return scaled_font;
+}
+
+static cairo_status_t
+_read_show_text_glyphs (cairo_recording_reader_t *reader,
+			cairo_surface_wrapper_t *wrapper,
+			cairo_operator_t op,
+			const cairo_pattern_t *source,
+			const cairo_clip_t *clip)
+{
+    cairo_scaled_font_t *scaled_font = NULL;
+    cairo_glyph_t *glyphs = NULL;
+    cairo_text_cluster_t *clusters = NULL;
+    cairo_text_cluster_flags_t cluster_flags;
+    uint32_t num_glyphs, num_clusters, i;
+    char *utf8;
+    int utf8_len;
+
+    utf8 = _read_string (reader, &utf8_len);
+
+    num_glyphs = _read_uint32 (reader);
+    if (! _read_has_records (reader, num_glyphs,
+			     sizeof (uint64_t) + 2 * sizeof (double)) ||
+	unlikely (num_glyphs > INT_MAX))
+	goto BAIL;
+
+    if (num_glyphs) {
+	glyphs = _cairo_malloc_ab (num_glyphs, sizeof (cairo_glyph_t));
+	if (unlikely (glyphs == NULL)) {
+	    reader->status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	    goto BAIL;
+	}
+    }
+
+    for (i = 0; i < num_glyphs; i++) {
+	uint64_t index = 0;
+	const unsigned char *data;
+
+	data = _read_bytes (reader, sizeof (index));
+	if (likely (data != NULL))
+	    memcpy (&index, data, sizeof (index));
+	glyphs[i].index = index;
+	glyphs[i].x = _read_double (reader);
+	glyphs[i].y = _read_double (reader);
+    }
+
+    num_clusters = _read_uint32 (reader);
+    if (! _read_has_records (reader, num_clusters, 2 * sizeof (int32_t)) ||
+	unlikely (num_clusters > INT_MAX))
+	goto BAIL;
+
+    if (num_clusters) {
+	clusters = _cairo_malloc_ab (num_clusters, sizeof (cairo_text_cluster_t));
+	if (unlikely (clusters == NULL)) {
+	    reader->status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	    goto BAIL;
+	}
+    }
+
+    for (i = 0; i < num_clusters; i++) {
+	clusters[i].num_bytes = _read_int32 (reader);
+	clusters[i].num_glyphs = _read_int32 (reader);
+    }
+    cluster_flags = _read_enum (reader, CAIRO_TEXT_CLUSTER_FLAG_BACKWARD);
+
+    scaled_font = _read_scaled_font (reader);
+    if (unlikely (scaled_font == NULL))
+	goto BAIL;
+
+    reader->status = _cairo_surface_wrapper_show_text_glyphs (wrapper, op, source,
+							      utf8, utf8_len,
+							      glyphs, num_glyphs,
+							      clusters, num_clusters,
+							      cluster_flags,
+							      scaled_font,
+							      clip);
+
+BAIL:
+    if (scaled_font != NULL)
+	cairo_scaled_font_destroy (scaled_font);
+    free (clusters);
+    free (glyphs);
+    free (utf8);
+    return reader->status;
+}
+
+static cairo_status_t
+_read_command (cairo_recording_reader_t *reader,
+	       cairo_surface_wrapper_t *wrapper,
+	       int depth)
+{
+    cairo_command_type_t type;
+    cairo_operator_t op;
+    cairo_clip_t *clip;
+    cairo_pattern_t *source, *mask;
+    cairo_path_fixed_t path;
+    cairo_stroke_style_t style;
+    cairo_matrix_t ctm, ctm_inverse;
+    cairo_fill_rule_t fill_rule;
+    cairo_antialias_t antialias;
+    double tolerance;
+
+    type = _read_enum (reader, CAIRO_COMMAND_SHOW_TEXT_GLYPHS);
+    op = _read_enum (reader, CAIRO_OPERATOR_HSL_LUMINOSITY);
+    clip = _read_clip (reader);
+    if (unlikely (reader->status))
+	return reader->status;
+
+    source = _read_pattern (reader, depth);
+    if (unlikely (source == NULL))
+	goto BAIL;
+
+    switch (type) {
+    case CAIRO_COMMAND_PAINT:
+	reader->status = _cairo_surface_wrapper_paint (wrapper, op, source, clip);
+	break;
+
+    case CAIRO_COMMAND_MASK:
+	mask = _read_pattern (reader, depth);
+	if (unlikely (mask == NULL))
+	    break;
+
+	reader->status = _cairo_surface_wrapper_mask (wrapper, op, source, mask, clip);
+	cairo_pattern_destroy (mask);
+	break;
+
+    case CAIRO_COMMAND_STROKE:
+	if (_read_path (reader, &path) == CAIRO_STATUS_SUCCESS) {
+	    _read_stroke_style (reader, &style);
+	    _read_matrix (reader, &ctm);
+	    _read_matrix (reader, &ctm_inverse);
+	    tolerance = _read_double (reader);
+	    antialias = _read_enum (reader, CAIRO_ANTIALIAS_BEST);
+	    if (reader->status == CAIRO_STATUS_SUCCESS) {
+		reader->status = _cairo_surface_wrapper_stroke (wrapper, op, source,
+								&path, &style,
+								&ctm, &ctm_inverse,
+								tolerance, antialias,
+								clip);
+	    }
+	    _cairo_stroke_style_fini (&style);
+	}
+	_cairo_path_fixed_fini (&path);
+	break;
+
+    case CAIRO_COMMAND_FILL:
+	if (_read_path (reader, &path) == CAIRO_STATUS_SUCCESS) {
+	    fill_rule = _read_enum (reader, CAIRO_FILL_RULE_EVEN_ODD);
+	    tolerance = _read_double (reader);
+	    antialias = _read_enum (reader, CAIRO_ANTIALIAS_BEST);
+	    if (reader->status == CAIRO_STATUS_SUCCESS) {
+		reader->status = _cairo_surface_wrapper_fill (wrapper, op, source,
+							      &path, fill_rule,
+							      tolerance, antialias,
+							      clip);
+	    }
+	}
+	_cairo_path_fixed_fini (&path);
+	break;
+
+    case CAIRO_COMMAND_SHOW_TEXT_GLYPHS:
+	_read_show_text_glyphs (reader, wrapper, op, source, clip);
+	break;
+    }
+
+    cairo_pattern_destroy (source);
+BAIL:
+    _cairo_clip_destroy (clip);
+    return reader->status;
+}
+
+typedef struct _cairo_recording_header {
+    cairo_content_t content;
+    cairo_bool_t unbounded;
+    cairo_rectangle_t extents;
+    uint32_t num_commands;
+} cairo_recording_header_t;
+
+static cairo_status_t
+_read_recording_header (cairo_recording_reader_t *reader,
+			cairo_recording_header_t *header)
+{
+    header->content = _read_uint32 (reader);
+    header->unbounded = _read_uint32 (reader);
+    header->extents.x = _read_double (reader);
+    header->extents.y = _read_double (reader);
+    header->extents.width = _read_double (reader);
+    header->extents.height = _read_double (reader);
+    header->num_commands = _read_uint32 (reader);
+    if (unlikely (reader->status))
+	return reader->status;
+
+    if (unlikely (! CAIRO_CONTENT_VALID (header->content)))
+	return _read_error (reader);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_read_commands (cairo_recording_reader_t *reader,
+		cairo_surface_wrapper_t *wrapper,
+		uint32_t num_commands,
+		int depth)
+{
+    uint32_t i;
+
+    for (i = 0; i < num_commands; i++) {
+	if (unlikely (_read_command (reader, wrapper, depth)))
+	    break;
+    }
+
+    return reader->status;
+}
+
+static cairo_surface_t *
+_read_recording (cairo_recording_reader_t *reader, int depth)
+{
+    cairo_recording_header_t header;
+    cairo_surface_wrapper_t wrapper;
+    cairo_surface_t *surface;
+
+    if (unlikely (depth > RECORDING_MAX_DEPTH)) {
+	_read_error (reader);
+	return NULL;
+    }
+
+    if (unlikely (_read_recording_header (reader, &header)))
+	return NULL;
+
+    surface = cairo_recording_surface_create (header.content,
+					      header.unbounded ? NULL : &header.extents);
+    if (unlikely (surface->status)) {
+	reader->status = surface->status;
+	cairo_surface_destroy (surface);
+	return NULL;
+    }
+
+    _cairo_surface_wrapper_init (&wrapper, surface);
+    _read_commands (reader, &wrapper, header.num_commands, depth);
+    _cairo_surface_wrapper_fini (&wrapper);
+    if (unlikely (reader->status)) {
+	cairo_surface_destroy (surface);
+	return NULL;
+    }
+
+    return surface;
+}
+
+static void
+_read_preamble (cairo_recording_reader_t *reader,
+		const unsigned char *data,
+		unsigned long length)
+{
+    const unsigned char *magic;
+
+    reader->data = data;
+    reader->end = data + length;
+    reader->status = CAIRO_STATUS_SUCCESS;
+
+    if (data == NULL)
+	_read_error (reader);
+
+    magic = _read_bytes (reader, RECORDING_MAGIC_LENGTH);
+    if (magic != NULL &&
+	memcmp (magic, RECORDING_MAGIC, RECORDING_MAGIC_LENGTH) != 0)
+	_read_error (reader);
+
+    if (_read_uint32 (reader) != RECORDING_VERSION)
+	_read_error (reader);
+
+    if (_read_uint32 (reader) != RECORDING_BYTE_ORDER)
+	_read_error (reader);
+}
+
+/**
+ * cairo_recording_surface_create_from_data:
+ * @data: the data written by cairo_recording_surface_write_to_stream()
+ * @length: the length of @data in bytes
+ *
+ * Creates a new recording surface holding the commands stored in
+ * @data. The data is decoded in a single pass and is not referenced
+ * after this function returns, so it may for instance be a read-only
+ * memory mapping of a file which is unmapped straight afterwards.
+ *
+ * To draw the commands just once, cairo_recording_surface_replay_data()
+ * avoids building the recording surface. Text drawn with toy fonts
+ * depends upon the fonts installed, see
+ * cairo_recording_surface_write_to_stream().
+ *
+ * Return value: a pointer to the newly created surface. The caller
+ * owns the surface and should call cairo_surface_destroy() when done
+ * with it.
+ *
+ * This function always returns a valid pointer, but it will return a
+ * pointer to a "nil" surface if an error such as out of memory occurs,
+ * or %CAIRO_STATUS_READ_ERROR if @data is truncated or was not written
+ * by a compatible version of cairo on a machine with the same byte
+ * order. You can use cairo_surface_status() to check for this.
+ *
+ * Since: 1.16
+ **/
+cairo_surface_t *
+cairo_recording_surface_create_from_data (const unsigned char	*data,
+					  unsigned long		 length)
+{
+    cairo_recording_reader_t reader;
+    cairo_surface_t *surface;
+
+    _read_preamble (&reader, data, length);
+
+    surface = _read_recording (&reader, 0);
+    if (unlikely (surface == NULL))
+	return _cairo_surface_create_in_error (reader.status);
+
+    return surface;
+}
+
+/**
+ * cairo_recording_surface_replay_data:
+ * @data: the data written by cairo_recording_surface_write_to_stream()
+ * @length: the length of @data in bytes
+ * @target: the surface to draw upon
+ *
+ * Draws the commands stored in @data onto @target, as replaying the
+ * recording surface they were written from would, straight from @data
+ * as each command is decoded, without creating a recording surface or
+ * keeping the commands. The device offset and scale of @target apply
+ * to the commands, which are clipped to the extents of the recording
+ * if it was bounded.
+ * Only recording surfaces used as sources are recreated, and only for
+ * as long as the command using them.
+ *
+ * This suits drawing a recording once, for instance from a read-only
+ * memory mapping of a file; when it is drawn repeatedly,
+ * cairo_recording_surface_create_from_data() decodes it only once.
+ *
+ * If @data is truncated or corrupt, the commands before the error are
+ * still drawn. Text drawn with toy fonts depends upon the fonts
+ * installed, see cairo_recording_surface_write_to_stream().
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS if all of the commands were
+ * drawn, %CAIRO_STATUS_READ_ERROR if @data is truncated or was not
+ * written by a compatible version of cairo on a machine with the same
+ * byte order, or the error status of @target.
+ *
+ * Since: 1.16
+ **/
+cairo_status_t
+cairo_recording_surface_replay_data (const unsigned char	*data,
+				     unsigned long		 length,
+				     cairo_surface_t		*target)
+{
+    cairo_recording_reader_t reader;
+    cairo_recording_header_t header;
+    cairo_surface_wrapper_t wrapper;
+
+    if (unlikely (target->status))
+	return target->status;
+
+    if (unlikely (target->finished))
+	return _cairo_error (CAIRO_STATUS_SURFACE_FINISHED);
+
+    _read_preamble (&reader, data, length);
+    if (unlikely (_read_recording_header (&reader, &header)))
+	return reader.status;
+
+    _cairo_surface_wrapper_init (&wrapper, target);
+    if (! header.unbounded) {
+	cairo_rectangle_int_t extents;
+
+	/* rounded as by cairo_recording_surface_create() */
+	extents.x = floor (header.extents.x);
+	extents.y = floor (header.extents.y);
+	extents.width = ceil (header.extents.x + header.extents.width) - extents.x;
+	extents.height = ceil (header.extents.y + header.extents.height) - extents.y;
+	_cairo_surface_wrapper_intersect_extents (&wrapper, &extents);
+    }
+
+    _read_commands (&reader, &wrapper, header.num_commands, 0);
+    _cairo_surface_wrapper_fini (&wrapper);
+
+    return reader.status;
+}
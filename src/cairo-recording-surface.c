@@ -88,9 +88,14 @@
 #include "cairo-image-surface-private.h"
 #include "cairo-recording-surface-inline.h"
 #include "cairo-surface-snapshot-inline.h"
+#include "cairo-surface-subsurface-private.h"
 #include "cairo-surface-wrapper-private.h"
 #include "cairo-traps-private.h"
 
+#if CAIRO_HAS_REAL_PTHREAD
+#include <pthread.h>
+#endif
+
 typedef enum {
     CAIRO_RECORDING_REPLAY,
     CAIRO_RECORDING_CREATE_REGIONS
@@ -117,135 +122,198 @@ static const cairo_surface_backend_t cairo_recording_surface_backend;
  * according to the intended replay target).
  */
 
-static int bbtree_left_or_right (struct bbtree *bbt,
-				 const cairo_box_t *box)
-{
-    int left, right;
-
-    if (bbt->left) {
-	cairo_box_t *e = &bbt->left->extents;
-	cairo_box_t b;
+/* Commands, and the text and glyph arrays they carry, are allocated
+ * from an arena of chunks owned by the surface rather than individually.
+ * Recording is then a pointer bump in the common case, consecutive
+ * commands are adjacent in memory for replay, and the whole lot is
+ * released at once when the surface is finished. Nothing is returned to
+ * the arena before then, the space of a command that failed to be
+ * recorded is simply reclaimed along with everything else.
+ */
+#define ARENA_ALIGN 16
+#define ARENA_MIN_CHUNK 4096
+#define ARENA_MAX_CHUNK (256 * 1024)
+
+struct _cairo_recording_arena_chunk {
+    struct _cairo_recording_arena_chunk *next;
+    size_t size;
+    size_t used;
+};
 
-	b.p1.x = MIN (e->p1.x, box->p1.x);
-	b.p1.y = MIN (e->p1.y, box->p1.y);
-	b.p2.x = MAX (e->p2.x, box->p2.x);
-	b.p2.y = MAX (e->p2.y, box->p2.y);
+#define ARENA_HEADER_SIZE \
+    ((sizeof (struct _cairo_recording_arena_chunk) + ARENA_ALIGN - 1) & -ARENA_ALIGN)
 
-	left = _cairo_fixed_integer_part (b.p2.x - b.p1.x) * _cairo_fixed_integer_part (b.p2.y - b.p1.y);
-	left -= _cairo_fixed_integer_part (e->p2.x - e->p1.x) * _cairo_fixed_integer_part (e->p2.y - e->p1.y);
-    } else
-	left = 0;
+static void
+_cairo_recording_surface_init_arena (cairo_recording_surface_t *surface)
+{
+    surface->arena = NULL;
+}
 
-    if (bbt->right) {
-	cairo_box_t *e = &bbt->right->extents;
-	cairo_box_t b;
+static void
+_cairo_recording_surface_fini_arena (cairo_recording_surface_t *surface)
+{
+    struct _cairo_recording_arena_chunk *chunk, *next;
 
-	b.p1.x = MIN (e->p1.x, box->p1.x);
-	b.p1.y = MIN (e->p1.y, box->p1.y);
-	b.p2.x = MAX (e->p2.x, box->p2.x);
-	b.p2.y = MAX (e->p2.y, box->p2.y);
+    for (chunk = surface->arena; chunk != NULL; chunk = next) {
+	next = chunk->next;
+	free (chunk);
+    }
+    surface->arena = NULL;
+}
 
-	right = _cairo_fixed_integer_part (b.p2.x - b.p1.x) * _cairo_fixed_integer_part (b.p2.y - b.p1.y);
-	right -= _cairo_fixed_integer_part (e->p2.x - e->p1.x) * _cairo_fixed_integer_part (e->p2.y - e->p1.y);
-    } else
-	right = 0;
+static void *
+_cairo_recording_surface_arena_alloc (cairo_recording_surface_t *surface,
+				      size_t size)
+{
+    struct _cairo_recording_arena_chunk *chunk = surface->arena;
+    size_t chunk_size;
+    void *ptr;
+
+    size = (size + ARENA_ALIGN - 1) & -ARENA_ALIGN;
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+	/* grow geometrically so that the number of chunks stays small */
+	chunk_size = ARENA_MIN_CHUNK;
+	if (chunk != NULL && chunk->size < ARENA_MAX_CHUNK)
+	    chunk_size = 2 * chunk->size;
+	else if (chunk != NULL)
+	    chunk_size = chunk->size;
+	if (chunk_size < size)
+	    chunk_size = size;
+
+	chunk = _cairo_malloc (ARENA_HEADER_SIZE + chunk_size);
+	if (unlikely (chunk == NULL))
+	    return NULL;
+
+	chunk->size = chunk_size;
+	chunk->used = 0;
+
+	/* keep filling the current chunk after an outsized allocation */
+	if (size > ARENA_MAX_CHUNK && surface->arena != NULL) {
+	    chunk->next = surface->arena->next;
+	    surface->arena->next = chunk;
+	} else {
+	    chunk->next = surface->arena;
+	    surface->arena = chunk;
+	}
+    }
 
-    return left <= right;
+    ptr = (char *) chunk + ARENA_HEADER_SIZE + chunk->used;
+    chunk->used += size;
+    return ptr;
 }
 
-#define INVALID_CHAIN ((cairo_command_header_t *)-1)
-
-static struct bbtree *
-bbtree_new (const cairo_box_t *box, cairo_command_header_t *chain)
+static void *
+_cairo_recording_surface_arena_alloc_ab (cairo_recording_surface_t *surface,
+					 size_t n, size_t size)
 {
-    struct bbtree *bbt = malloc (sizeof (*bbt));
-    if (bbt == NULL)
+    if (size != 0 && n > (SIZE_MAX / 2) / size)
 	return NULL;
-    bbt->extents = *box;
-    bbt->left = bbt->right = NULL;
-    bbt->chain = chain;
-    return bbt;
+
+    return _cairo_recording_surface_arena_alloc (surface, n * size);
 }
 
+/* The spatial index is a bounding volume hierarchy over the extents of
+ * the recorded commands, bulk-loaded by recursively splitting the
+ * commands about the median of their centres along the longer axis.
+ * The tree is thus balanced and the cost of a query is proportional to
+ * the number of visible commands rather than the total.
+ *
+ * Commands recorded after the tree was built form an unindexed tail
+ * which is scanned linearly; once the tail grows beyond a fraction of
+ * the indexed commands the tree is rebuilt, so the amortized cost of
+ * keeping the index up to date remains logarithmic per command.
+ */
+#define BBTREE_LEAF_SIZE 8
+#define BBTREE_MAX_TAIL(n) ((n) / 4)
+
 static void
-bbtree_init (struct bbtree *bbt, cairo_command_header_t *header)
+bbtree_extents (cairo_box_t *extents,
+		cairo_command_t **elements,
+		const unsigned int *indices,
+		unsigned int count)
 {
-    _cairo_box_from_rectangle (&bbt->extents, &header->extents);
-    bbt->chain = header;
+    unsigned int i;
+
+    _cairo_box_from_rectangle (extents, &elements[indices[0]]->header.extents);
+    for (i = 1; i < count; i++) {
+	cairo_box_t box;
+
+	_cairo_box_from_rectangle (&box, &elements[indices[i]]->header.extents);
+	extents->p1.x = MIN (extents->p1.x, box.p1.x);
+	extents->p1.y = MIN (extents->p1.y, box.p1.y);
+	extents->p2.x = MAX (extents->p2.x, box.p2.x);
+	extents->p2.y = MAX (extents->p2.y, box.p2.y);
+    }
 }
 
-static cairo_status_t
-bbtree_add (struct bbtree *bbt,
-	    cairo_command_header_t *header,
-	    const cairo_box_t *box)
+static inline int
+bbtree_centre (cairo_command_t **elements, unsigned int index, cairo_bool_t x_axis)
 {
-    if (box->p1.x < bbt->extents.p1.x || box->p1.y < bbt->extents.p1.y ||
-	box->p2.x > bbt->extents.p2.x || box->p2.y > bbt->extents.p2.y)
-    {
-	if (bbt->chain) {
-	    if (bbtree_left_or_right (bbt, &bbt->extents)) {
-		if (bbt->left == NULL) {
-		    bbt->left = bbtree_new (&bbt->extents, bbt->chain);
-		    if (unlikely (bbt->left == NULL))
-			return _cairo_error (CAIRO_STATUS_NO_MEMORY);
-		} else
-		    bbtree_add (bbt->left, bbt->chain, &bbt->extents);
-	    } else {
-		if (bbt->right == NULL) {
-		    bbt->right = bbtree_new (&bbt->extents, bbt->chain);
-		    if (unlikely (bbt->right == NULL))
-			return _cairo_error (CAIRO_STATUS_NO_MEMORY);
-		} else
-		    bbtree_add (bbt->right, bbt->chain, &bbt->extents);
-	    }
+    const cairo_rectangle_int_t *r = &elements[index]->header.extents;
 
-	    bbt->chain = NULL;
-	}
-
-	bbt->extents.p1.x = MIN (bbt->extents.p1.x, box->p1.x);
-	bbt->extents.p1.y = MIN (bbt->extents.p1.y, box->p1.y);
-	bbt->extents.p2.x = MAX (bbt->extents.p2.x, box->p2.x);
-	bbt->extents.p2.y = MAX (bbt->extents.p2.y, box->p2.y);
-    }
+    /* twice the centre, to stay in integers */
+    return x_axis ? 2 * r->x + r->width : 2 * r->y + r->height;
+}
 
-    if (box->p1.x == bbt->extents.p1.x && box->p1.y == bbt->extents.p1.y &&
-	box->p2.x == bbt->extents.p2.x && box->p2.y == bbt->extents.p2.y)
-    {
-	cairo_command_header_t *last = header;
-	while (last->chain) /* expected to be infrequent */
-	    last = last->chain;
-	last->chain = bbt->chain;
-	bbt->chain = header;
-	return CAIRO_STATUS_SUCCESS;
-    }
+/* Partially order @indices such that the k-th has its sorted position,
+ * with no greater centre before it and no lesser one after it.
+ */
+static void
+bbtree_select (unsigned int *indices, int count, int k,
+	       cairo_command_t **elements, cairo_bool_t x_axis)
+{
+    int lo = 0, hi = count - 1;
+
+    while (lo < hi) {
+	int pivot = bbtree_centre (elements, indices[k], x_axis);
+	int i = lo, j = hi;
+
+	do {
+	    while (bbtree_centre (elements, indices[i], x_axis) < pivot)
+		i++;
+	    while (pivot < bbtree_centre (elements, indices[j], x_axis))
+		j--;
+	    if (i <= j) {
+		unsigned int tmp = indices[i];
+		indices[i++] = indices[j];
+		indices[j--] = tmp;
+	    }
+	} while (i <= j);
 
-    if (bbtree_left_or_right (bbt, box)) {
-	if (bbt->left == NULL) {
-	    bbt->left = bbtree_new (box, header);
-	    if (unlikely (bbt->left == NULL))
-		return _cairo_error (CAIRO_STATUS_NO_MEMORY);
-	} else
-	    return bbtree_add (bbt->left, header, box);
-    } else {
-	if (bbt->right == NULL) {
-	    bbt->right = bbtree_new (box, header);
-	    if (unlikely (bbt->right == NULL))
-		return _cairo_error (CAIRO_STATUS_NO_MEMORY);
-	} else
-	    return bbtree_add (bbt->right, header, box);
+	if (j < k)
+	    lo = i;
+	if (k < i)
+	    hi = j;
     }
-
-    return CAIRO_STATUS_SUCCESS;
 }
 
-static void bbtree_del (struct bbtree *bbt)
+static void
+bbtree_build (struct bbtree *bbt,
+	      cairo_command_t **elements,
+	      unsigned int first,
+	      unsigned int count)
 {
-    if (bbt->left)
-	bbtree_del (bbt->left);
-    if (bbt->right)
-	bbtree_del (bbt->right);
+    struct bbtree_node *node = &bbt->nodes[bbt->num_nodes++];
+    cairo_bool_t x_axis;
+    unsigned int mid;
+
+    bbtree_extents (&node->extents, elements, bbt->leaves + first, count);
+    if (count <= BBTREE_LEAF_SIZE) {
+	node->first = first;
+	node->count = count;
+	return;
+    }
 
-    free (bbt);
+    x_axis = node->extents.p2.x - node->extents.p1.x >=
+	     node->extents.p2.y - node->extents.p1.y;
+    mid = count / 2;
+    bbtree_select (bbt->leaves + first, count, mid, elements, x_axis);
+
+    /* the left child immediately follows its parent */
+    node->count = 0;
+    bbtree_build (bbt, elements, first, mid);
+    node->first = bbt->num_nodes;
+    bbtree_build (bbt, elements, first + mid, count - mid);
 }
 
 static cairo_bool_t box_outside (const cairo_box_t *a, const cairo_box_t *b)
@@ -256,19 +324,24 @@ static cairo_bool_t box_outside (const cairo_box_t *a, const cairo_box_t *b)
 }
 
 static void
-bbtree_foreach_mark_visible (struct bbtree *bbt,
+bbtree_foreach_mark_visible (const struct bbtree *bbt,
+			     unsigned int n,
 			     const cairo_box_t *box,
 			     unsigned int **indices)
 {
-    cairo_command_header_t *chain;
+    const struct bbtree_node *node = &bbt->nodes[n];
 
-    for (chain = bbt->chain; chain; chain = chain->chain)
-	*(*indices)++ = chain->index;
+    if (node->count) {
+	memcpy (*indices, bbt->leaves + node->first,
+		node->count * sizeof (unsigned int));
+	*indices += node->count;
+	return;
+    }
 
-    if (bbt->left && ! box_outside (box, &bbt->left->extents))
-	bbtree_foreach_mark_visible (bbt->left, box, indices);
-    if (bbt->right && ! box_outside (box, &bbt->right->extents))
-	bbtree_foreach_mark_visible (bbt->right, box, indices);
+    if (! box_outside (box, &bbt->nodes[n + 1].extents))
+	bbtree_foreach_mark_visible (bbt, n + 1, box, indices);
+    if (! box_outside (box, &bbt->nodes[node->first].extents))
+	bbtree_foreach_mark_visible (bbt, node->first, box, indices);
 }
 
 static inline int intcmp (const unsigned int a, const unsigned int b)
@@ -277,86 +350,54 @@ static inline int intcmp (const unsigned int a, const unsigned int b)
 }
 CAIRO_COMBSORT_DECLARE (sort_indices, unsigned int, intcmp)
 
-static inline int sizecmp (unsigned int a, unsigned int b, cairo_command_header_t **elements)
+static void
+_cairo_recording_surface_init_bbtree (cairo_recording_surface_t *surface)
 {
-    const cairo_rectangle_int_t *r;
-
-    r = &elements[a]->extents;
-    a = r->width * r->height;
-
-    r = &elements[b]->extents;
-    b = r->width * r->height;
-
-    return b - a;
+    surface->bbtree.nodes = NULL;
+    surface->bbtree.leaves = NULL;
+    surface->bbtree.num_nodes = 0;
+    surface->bbtree.num_indexed = 0;
 }
-CAIRO_COMBSORT_DECLARE_WITH_DATA (sort_commands, unsigned int, sizecmp)
 
 static void
 _cairo_recording_surface_destroy_bbtree (cairo_recording_surface_t *surface)
 {
-    cairo_command_t **elements;
-    int i, num_elements;
-
-    if (surface->bbtree.chain == INVALID_CHAIN)
-	return;
-
-    if (surface->bbtree.left) {
-	bbtree_del (surface->bbtree.left);
-	surface->bbtree.left = NULL;
-    }
-    if (surface->bbtree.right) {
-	bbtree_del (surface->bbtree.right);
-	surface->bbtree.right = NULL;
-    }
-
-    elements = _cairo_array_index (&surface->commands, 0);
-    num_elements = surface->commands.num_elements;
-    for (i = 0; i < num_elements; i++)
-	elements[i]->header.chain = NULL;
-
-    surface->bbtree.chain = INVALID_CHAIN;
+    free (surface->bbtree.nodes);
+    free (surface->bbtree.leaves);
+    _cairo_recording_surface_init_bbtree (surface);
 }
 
 static cairo_status_t
 _cairo_recording_surface_create_bbtree (cairo_recording_surface_t *surface)
 {
     cairo_command_t **elements = _cairo_array_index (&surface->commands, 0);
-    unsigned int *indices;
-    cairo_status_t status;
     unsigned int i, count;
 
+    _cairo_recording_surface_destroy_bbtree (surface);
+
     count = surface->commands.num_elements;
-    if (count > surface->num_indices) {
-	free (surface->indices);
-	surface->indices = _cairo_malloc_ab (count, sizeof (int));
-	if (unlikely (surface->indices == NULL))
-	    return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+    if (count == 0)
+	return CAIRO_STATUS_SUCCESS;
 
-	surface->num_indices = count;
+    /* Bar a lone root, every leaf holds at least half a leaf's worth */
+    surface->bbtree.nodes =
+	_cairo_malloc_ab (2 * (count / (BBTREE_LEAF_SIZE / 2)) + 1,
+			  sizeof (struct bbtree_node));
+    surface->bbtree.leaves = _cairo_malloc_ab (count, sizeof (unsigned int));
+    if (unlikely (surface->bbtree.nodes == NULL ||
+		  surface->bbtree.leaves == NULL))
+    {
+	_cairo_recording_surface_destroy_bbtree (surface);
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
     }
 
-    indices = surface->indices;
     for (i = 0; i < count; i++)
-	indices[i] = i;
-
-    sort_commands (indices, count, elements);
-
-    bbtree_init (&surface->bbtree, &elements[indices[0]]->header);
-    for (i = 1; i < count; i++) {
-	cairo_command_header_t *header = &elements[indices[i]]->header;
-	cairo_box_t box;
+	surface->bbtree.leaves[i] = i;
 
-	_cairo_box_from_rectangle (&box, &header->extents);
-	status = bbtree_add (&surface->bbtree, header, &box);
-	if (unlikely (status))
-	    goto cleanup;
-    }
+    bbtree_build (&surface->bbtree, elements, 0, count);
+    surface->bbtree.num_indexed = count;
 
     return CAIRO_STATUS_SUCCESS;
-
-cleanup:
-    bbtree_del (&surface->bbtree);
-    return status;
 }
 
 /**
@@ -413,11 +454,11 @@ cairo_recording_surface_create (cairo_content_t		 content,
     }
 
     _cairo_array_init (&surface->commands, sizeof (cairo_command_t *));
+    _cairo_recording_surface_init_arena (surface);
 
     surface->base.is_clear = TRUE;
 
-    surface->bbtree.left = surface->bbtree.right = NULL;
-    surface->bbtree.chain = INVALID_CHAIN;
+    _cairo_recording_surface_init_bbtree (surface);
 
     surface->indices = NULL;
     surface->num_indices = 0;
@@ -477,9 +518,6 @@ _cairo_recording_surface_finish (void *abstract_surface)
 
 	case CAIRO_COMMAND_SHOW_TEXT_GLYPHS:
 	    _cairo_pattern_fini (&command->show_text_glyphs.source.base);
-	    free (command->show_text_glyphs.utf8);
-	    free (command->show_text_glyphs.glyphs);
-	    free (command->show_text_glyphs.clusters);
 	    cairo_scaled_font_destroy (command->show_text_glyphs.scaled_font);
 	    break;
 
@@ -488,16 +526,12 @@ _cairo_recording_surface_finish (void *abstract_surface)
 	}
 
 	_cairo_clip_destroy (command->header.clip);
-	free (command);
     }
 
     _cairo_array_fini (&surface->commands);
+    _cairo_recording_surface_fini_arena (surface);
 
-    if (surface->bbtree.left)
-	bbtree_del (surface->bbtree.left);
-    if (surface->bbtree.right)
-	bbtree_del (surface->bbtree.right);
-
+    _cairo_recording_surface_destroy_bbtree (surface);
     free (surface->indices);
 
     return CAIRO_STATUS_SUCCESS;
@@ -640,7 +674,6 @@ _command_init (cairo_recording_surface_t *surface,
     command->region = CAIRO_RECORDING_REGION_ALL;
 
     command->extents = composite->unbounded;
-    command->chain = NULL;
     command->index = surface->commands.num_elements;
 
     /* steal the clip */
@@ -675,8 +708,8 @@ _cairo_recording_surface_reset (cairo_recording_surface_t *surface)
     /* Reset the commands and temporaries */
     _cairo_recording_surface_finish (surface);
 
-    surface->bbtree.left = surface->bbtree.right = NULL;
-    surface->bbtree.chain = INVALID_CHAIN;
+    _cairo_recording_surface_init_arena (surface);
+    _cairo_recording_surface_init_bbtree (surface);
 
     surface->indices = NULL;
     surface->num_indices = 0;
@@ -738,7 +771,8 @@ _cairo_recording_surface_paint (void			  *abstract_surface,
     if (unlikely (status))
 	return status;
 
-    command = malloc (sizeof (cairo_command_paint_t));
+    command = _cairo_recording_surface_arena_alloc (surface,
+						     sizeof (cairo_command_paint_t));
     if (unlikely (command == NULL)) {
 	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	goto CLEANUP_COMPOSITE;
@@ -758,8 +792,6 @@ _cairo_recording_surface_paint (void			  *abstract_surface,
     if (unlikely (status))
 	goto CLEANUP_SOURCE;
 
-    _cairo_recording_surface_destroy_bbtree (surface);
-
     _cairo_composite_rectangles_fini (&composite);
     return CAIRO_STATUS_SUCCESS;
 
@@ -767,7 +799,6 @@ _cairo_recording_surface_paint (void			  *abstract_surface,
     _cairo_pattern_fini (&command->source.base);
   CLEANUP_COMMAND:
     _cairo_clip_destroy (command->header.clip);
-    free (command);
 CLEANUP_COMPOSITE:
     _cairo_composite_rectangles_fini (&composite);
     return status;
@@ -794,7 +825,8 @@ _cairo_recording_surface_mask (void			*abstract_surface,
     if (unlikely (status))
 	return status;
 
-    command = malloc (sizeof (cairo_command_mask_t));
+    command = _cairo_recording_surface_arena_alloc (surface,
+						     sizeof (cairo_command_mask_t));
     if (unlikely (command == NULL)) {
 	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	goto CLEANUP_COMPOSITE;
@@ -818,8 +850,6 @@ _cairo_recording_surface_mask (void			*abstract_surface,
     if (unlikely (status))
 	goto CLEANUP_MASK;
 
-    _cairo_recording_surface_destroy_bbtree (surface);
-
     _cairo_composite_rectangles_fini (&composite);
     return CAIRO_STATUS_SUCCESS;
 
@@ -829,7 +859,6 @@ _cairo_recording_surface_mask (void			*abstract_surface,
     _cairo_pattern_fini (&command->source.base);
   CLEANUP_COMMAND:
     _cairo_clip_destroy (command->header.clip);
-    free (command);
 CLEANUP_COMPOSITE:
     _cairo_composite_rectangles_fini (&composite);
     return status;
@@ -862,7 +891,8 @@ _cairo_recording_surface_stroke (void			*abstract_surface,
     if (unlikely (status))
 	return status;
 
-    command = malloc (sizeof (cairo_command_stroke_t));
+    command = _cairo_recording_surface_arena_alloc (surface,
+						     sizeof (cairo_command_stroke_t));
     if (unlikely (command == NULL)) {
 	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	goto CLEANUP_COMPOSITE;
@@ -895,8 +925,6 @@ _cairo_recording_surface_stroke (void			*abstract_surface,
     if (unlikely (status))
 	goto CLEANUP_STYLE;
 
-    _cairo_recording_surface_destroy_bbtree (surface);
-
     _cairo_composite_rectangles_fini (&composite);
     return CAIRO_STATUS_SUCCESS;
 
@@ -908,7 +936,6 @@ _cairo_recording_surface_stroke (void			*abstract_surface,
     _cairo_pattern_fini (&command->source.base);
   CLEANUP_COMMAND:
     _cairo_clip_destroy (command->header.clip);
-    free (command);
 CLEANUP_COMPOSITE:
     _cairo_composite_rectangles_fini (&composite);
     return status;
@@ -938,7 +965,8 @@ _cairo_recording_surface_fill (void			*abstract_surface,
     if (unlikely (status))
 	return status;
 
-    command = malloc (sizeof (cairo_command_fill_t));
+    command = _cairo_recording_surface_arena_alloc (surface,
+						     sizeof (cairo_command_fill_t));
     if (unlikely (command == NULL)) {
 	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	goto CLEANUP_COMPOSITE;
@@ -966,8 +994,6 @@ _cairo_recording_surface_fill (void			*abstract_surface,
     if (unlikely (status))
 	goto CLEANUP_PATH;
 
-    _cairo_recording_surface_destroy_bbtree (surface);
-
     _cairo_composite_rectangles_fini (&composite);
     return CAIRO_STATUS_SUCCESS;
 
@@ -977,7 +1003,6 @@ _cairo_recording_surface_fill (void			*abstract_surface,
     _cairo_pattern_fini (&command->source.base);
   CLEANUP_COMMAND:
     _cairo_clip_destroy (command->header.clip);
-    free (command);
 CLEANUP_COMPOSITE:
     _cairo_composite_rectangles_fini (&composite);
     return status;
@@ -1020,7 +1045,8 @@ _cairo_recording_surface_show_text_glyphs (void				*abstract_surface,
     if (unlikely (status))
 	return status;
 
-    command = malloc (sizeof (cairo_command_show_text_glyphs_t));
+    command = _cairo_recording_surface_arena_alloc (surface,
+						     sizeof (cairo_command_show_text_glyphs_t));
     if (unlikely (command == NULL)) {
 	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	goto CLEANUP_COMPOSITE;
@@ -1044,7 +1070,7 @@ _cairo_recording_surface_show_text_glyphs (void				*abstract_surface,
     command->num_clusters = num_clusters;
 
     if (utf8_len) {
-	command->utf8 = malloc (utf8_len);
+	command->utf8 = _cairo_recording_surface_arena_alloc (surface, utf8_len);
 	if (unlikely (command->utf8 == NULL)) {
 	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	    goto CLEANUP_ARRAYS;
@@ -1052,7 +1078,9 @@ _cairo_recording_surface_show_text_glyphs (void				*abstract_surface,
 	memcpy (command->utf8, utf8, utf8_len);
     }
     if (num_glyphs) {
-	command->glyphs = _cairo_malloc_ab (num_glyphs, sizeof (glyphs[0]));
+	command->glyphs = _cairo_recording_surface_arena_alloc_ab (surface,
+								   num_glyphs,
+								   sizeof (glyphs[0]));
 	if (unlikely (command->glyphs == NULL)) {
 	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	    goto CLEANUP_ARRAYS;
@@ -1060,7 +1088,9 @@ _cairo_recording_surface_show_text_glyphs (void				*abstract_surface,
 	memcpy (command->glyphs, glyphs, sizeof (glyphs[0]) * num_glyphs);
     }
     if (num_clusters) {
-	command->clusters = _cairo_malloc_ab (num_clusters, sizeof (clusters[0]));
+	command->clusters = _cairo_recording_surface_arena_alloc_ab (surface,
+								     num_clusters,
+								     sizeof (clusters[0]));
 	if (unlikely (command->clusters == NULL)) {
 	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	    goto CLEANUP_ARRAYS;
@@ -1082,14 +1112,9 @@ _cairo_recording_surface_show_text_glyphs (void				*abstract_surface,
   CLEANUP_SCALED_FONT:
     cairo_scaled_font_destroy (command->scaled_font);
   CLEANUP_ARRAYS:
-    free (command->utf8);
-    free (command->glyphs);
-    free (command->clusters);
-
     _cairo_pattern_fini (&command->source.base);
   CLEANUP_COMMAND:
     _cairo_clip_destroy (command->header.clip);
-    free (command);
 CLEANUP_COMPOSITE:
     _cairo_composite_rectangles_fini (&composite);
     return status;
@@ -1105,7 +1130,6 @@ _command_init_copy (cairo_recording_surface_t *surface,
     dst->region = CAIRO_RECORDING_REGION_ALL;
 
     dst->extents = src->extents;
-    dst->chain = NULL;
     dst->index = surface->commands.num_elements;
 
     dst->clip = _cairo_clip_copy (src->clip);
@@ -1118,7 +1142,7 @@ _cairo_recording_surface_copy__paint (cairo_recording_surface_t *surface,
     cairo_command_paint_t *command;
     cairo_status_t status;
 
-    command = malloc (sizeof (*command));
+    command = _cairo_recording_surface_arena_alloc (surface, sizeof (*command));
     if (unlikely (command == NULL)) {
 	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	goto err;
@@ -1129,7 +1153,7 @@ _cairo_recording_surface_copy__paint (cairo_recording_surface_t *surface,
     status = _cairo_pattern_init_copy (&command->source.base,
 				       &src->paint.source.base);
     if (unlikely (status))
-	goto err_command;
+	goto err;
 
     status = _cairo_recording_surface_commit (surface, &command->header);
     if (unlikely (status))
@@ -1139,8 +1163,6 @@ _cairo_recording_surface_copy__paint (cairo_recording_surface_t *surface,
 
 err_source:
     _cairo_pattern_fini (&command->source.base);
-err_command:
-    free(command);
 err:
     return status;
 }
@@ -1152,7 +1174,7 @@ _cairo_recording_surface_copy__mask (cairo_recording_surface_t *surface,
     cairo_command_mask_t *command;
     cairo_status_t status;
 
-    command = malloc (sizeof (*command));
+    command = _cairo_recording_surface_arena_alloc (surface, sizeof (*command));
     if (unlikely (command == NULL)) {
 	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	goto err;
@@ -1163,7 +1185,7 @@ _cairo_recording_surface_copy__mask (cairo_recording_surface_t *surface,
     status = _cairo_pattern_init_copy (&command->source.base,
 				       &src->mask.source.base);
     if (unlikely (status))
-	goto err_command;
+	goto err;
 
     status = _cairo_pattern_init_copy (&command->mask.base,
 				       &src->mask.mask.base);
@@ -1180,8 +1202,6 @@ err_mask:
     _cairo_pattern_fini (&command->mask.base);
 err_source:
     _cairo_pattern_fini (&command->source.base);
-err_command:
-    free(command);
 err:
     return status;
 }
@@ -1193,7 +1213,7 @@ _cairo_recording_surface_copy__stroke (cairo_recording_surface_t *surface,
     cairo_command_stroke_t *command;
     cairo_status_t status;
 
-    command = malloc (sizeof (*command));
+    command = _cairo_recording_surface_arena_alloc (surface, sizeof (*command));
     if (unlikely (command == NULL)) {
 	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	goto err;
@@ -1204,7 +1224,7 @@ _cairo_recording_surface_copy__stroke (cairo_recording_surface_t *surface,
     status = _cairo_pattern_init_copy (&command->source.base,
 				       &src->stroke.source.base);
     if (unlikely (status))
-	goto err_command;
+	goto err;
 
     status = _cairo_path_fixed_init_copy (&command->path, &src->stroke.path);
     if (unlikely (status))
@@ -1232,8 +1252,6 @@ err_path:
     _cairo_path_fixed_fini (&command->path);
 err_source:
     _cairo_pattern_fini (&command->source.base);
-err_command:
-    free(command);
 err:
     return status;
 }
@@ -1245,7 +1263,7 @@ _cairo_recording_surface_copy__fill (cairo_recording_surface_t *surface,
     cairo_command_fill_t *command;
     cairo_status_t status;
 
-    command = malloc (sizeof (*command));
+    command = _cairo_recording_surface_arena_alloc (surface, sizeof (*command));
     if (unlikely (command == NULL)) {
 	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	goto err;
@@ -1256,7 +1274,7 @@ _cairo_recording_surface_copy__fill (cairo_recording_surface_t *surface,
     status = _cairo_pattern_init_copy (&command->source.base,
 				       &src->fill.source.base);
     if (unlikely (status))
-	goto err_command;
+	goto err;
 
     status = _cairo_path_fixed_init_copy (&command->path, &src->fill.path);
     if (unlikely (status))
@@ -1276,8 +1294,6 @@ err_path:
     _cairo_path_fixed_fini (&command->path);
 err_source:
     _cairo_pattern_fini (&command->source.base);
-err_command:
-    free(command);
 err:
     return status;
 }
@@ -1289,7 +1305,7 @@ _cairo_recording_surface_copy__glyphs (cairo_recording_surface_t *surface,
     cairo_command_show_text_glyphs_t *command;
     cairo_status_t status;
 
-    command = malloc (sizeof (*command));
+    command = _cairo_recording_surface_arena_alloc (surface, sizeof (*command));
     if (unlikely (command == NULL)) {
 	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	goto err;
@@ -1300,7 +1316,7 @@ _cairo_recording_surface_copy__glyphs (cairo_recording_surface_t *surface,
     status = _cairo_pattern_init_copy (&command->source.base,
 				       &src->show_text_glyphs.source.base);
     if (unlikely (status))
-	goto err_command;
+	goto err;
 
     command->utf8 = NULL;
     command->utf8_len = src->show_text_glyphs.utf8_len;
@@ -1310,7 +1326,8 @@ _cairo_recording_surface_copy__glyphs (cairo_recording_surface_t *surface,
     command->num_clusters = src->show_text_glyphs.num_clusters;
 
     if (command->utf8_len) {
-	command->utf8 = malloc (command->utf8_len);
+	command->utf8 = _cairo_recording_surface_arena_alloc (surface,
+							      command->utf8_len);
 	if (unlikely (command->utf8 == NULL)) {
 	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	    goto err_arrays;
@@ -1318,8 +1335,10 @@ _cairo_recording_surface_copy__glyphs (cairo_recording_surface_t *surface,
 	memcpy (command->utf8, src->show_text_glyphs.utf8, command->utf8_len);
     }
     if (command->num_glyphs) {
-	command->glyphs = _cairo_malloc_ab (command->num_glyphs,
-					    sizeof (command->glyphs[0]));
+	command->glyphs =
+	    _cairo_recording_surface_arena_alloc_ab (surface,
+						     command->num_glyphs,
+						     sizeof (command->glyphs[0]));
 	if (unlikely (command->glyphs == NULL)) {
 	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	    goto err_arrays;
@@ -1328,8 +1347,10 @@ _cairo_recording_surface_copy__glyphs (cairo_recording_surface_t *surface,
 		sizeof (command->glyphs[0]) * command->num_glyphs);
     }
     if (command->num_clusters) {
-	command->clusters = _cairo_malloc_ab (command->num_clusters,
-					      sizeof (command->clusters[0]));
+	command->clusters =
+	    _cairo_recording_surface_arena_alloc_ab (surface,
+						     command->num_clusters,
+						     sizeof (command->clusters[0]));
 	if (unlikely (command->clusters == NULL)) {
 	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
 	    goto err_arrays;
@@ -1350,12 +1371,7 @@ _cairo_recording_surface_copy__glyphs (cairo_recording_surface_t *surface,
     return CAIRO_STATUS_SUCCESS;
 
 err_arrays:
-    free (command->utf8);
-    free (command->glyphs);
-    free (command->clusters);
     _cairo_pattern_fini (&command->source.base);
-err_command:
-    free(command);
 err:
     return status;
 }
@@ -1441,14 +1457,14 @@ _cairo_recording_surface_snapshot (void *abstract_other)
 
     surface->base.is_clear = other->base.is_clear;
 
-    surface->bbtree.left = surface->bbtree.right = NULL;
-    surface->bbtree.chain = INVALID_CHAIN;
+    _cairo_recording_surface_init_bbtree (surface);
 
     surface->indices = NULL;
     surface->num_indices = 0;
     surface->optimize_clears = TRUE;
 
     _cairo_array_init (&surface->commands, sizeof (cairo_command_t *));
+    _cairo_recording_surface_init_arena (surface);
     status = _cairo_recording_surface_copy (surface, other);
     if (unlikely (status)) {
 	cairo_surface_destroy (&surface->base);
@@ -1584,26 +1600,74 @@ _cairo_recording_surface_get_path (cairo_surface_t    *abstract_surface,
     return status;
 }
 
-static int
-_cairo_recording_surface_get_visible_commands (cairo_recording_surface_t *surface,
-					       const cairo_rectangle_int_t *extents)
+/* Bring the index up to date with the recorded commands and ensure the
+ * scratch array is large enough to hold the visible commands.
+ */
+static cairo_status_t
+_cairo_recording_surface_prepare_bbtree (cairo_recording_surface_t *surface)
 {
-    unsigned int num_visible, *indices;
+    unsigned int count = surface->commands.num_elements;
+
+    if (count - surface->bbtree.num_indexed >
+	BBTREE_MAX_TAIL (surface->bbtree.num_indexed))
+    {
+	cairo_status_t status;
+
+	status = _cairo_recording_surface_create_bbtree (surface);
+	if (unlikely (status))
+	    return status;
+    }
+
+    if (count > surface->num_indices) {
+	free (surface->indices);
+	surface->indices = _cairo_malloc_ab (count, sizeof (unsigned int));
+	if (unlikely (surface->indices == NULL)) {
+	    surface->num_indices = 0;
+	    return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	}
+
+	surface->num_indices = count;
+    }
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+/* Fills @indices, which must have room for every command, with the
+ * commands intersecting @extents in recording order. The index must
+ * have been prepared beforehand and is only read, so queries may
+ * proceed concurrently.
+ */
+static unsigned int
+_cairo_recording_surface_get_visible_commands (const cairo_recording_surface_t *surface,
+					       const cairo_rectangle_int_t *extents,
+					       unsigned int *indices)
+{
+    cairo_command_t * const *elements;
+    unsigned int num_visible, count, i, *end;
     cairo_box_t box;
 
-    if (surface->commands.num_elements == 0)
-	    return 0;
+    count = surface->commands.num_elements;
+    if (count == 0)
+	return 0;
 
     _cairo_box_from_rectangle (&box, extents);
 
-    if (surface->bbtree.chain == INVALID_CHAIN)
-	_cairo_recording_surface_create_bbtree (surface);
-
-    indices = surface->indices;
-    bbtree_foreach_mark_visible (&surface->bbtree, &box, &indices);
-    num_visible = indices - surface->indices;
+    end = indices;
+    if (surface->bbtree.num_nodes &&
+	! box_outside (&box, &surface->bbtree.nodes[0].extents))
+    {
+	bbtree_foreach_mark_visible (&surface->bbtree, 0, &box, &end);
+    }
+    num_visible = end - indices;
     if (num_visible > 1)
-	sort_indices (surface->indices, num_visible);
+	sort_indices (indices, num_visible);
+
+    /* The unindexed tail already follows in recording order */
+    elements = _cairo_array_index_const (&surface->commands, 0);
+    for (i = surface->bbtree.num_indexed; i < count; i++) {
+	if (_cairo_rectangle_intersects (extents, &elements[i]->header.extents))
+	    indices[num_visible++] = i;
+    }
 
     return num_visible;
 }
@@ -1677,7 +1741,8 @@ _cairo_recording_surface_replay_internal (cairo_recording_surface_t	*surface,
 					  cairo_surface_t	     *target,
 					  const cairo_clip_t *target_clip,
 					  cairo_recording_replay_type_t type,
-					  cairo_recording_region_type_t region)
+					  cairo_recording_region_type_t region,
+					  unsigned int *indices)
 {
     cairo_surface_wrapper_t wrapper;
     cairo_command_t **elements;
@@ -1719,19 +1784,33 @@ _cairo_recording_surface_replay_internal (cairo_recording_surface_t	*surface,
     if (! _cairo_surface_wrapper_get_target_extents (&wrapper, &extents))
 	goto done;
 
-    surface->has_bilevel_alpha = TRUE;
-    surface->has_only_op_over = TRUE;
+    if (type == CAIRO_RECORDING_CREATE_REGIONS) {
+	surface->has_bilevel_alpha = TRUE;
+	surface->has_only_op_over = TRUE;
+    }
 
     num_elements = surface->commands.num_elements;
     elements = _cairo_array_index (&surface->commands, 0);
     if (extents.width < r->width || extents.height < r->height) {
-	num_elements =
-	    _cairo_recording_surface_get_visible_commands (surface, &extents);
-	use_indices = num_elements != surface->commands.num_elements;
+	/* Without a caller supplied array, use (and update) our own;
+	 * upon failure simply fallback to replaying every command. */
+	if (indices == NULL &&
+	    _cairo_recording_surface_prepare_bbtree (surface) == CAIRO_STATUS_SUCCESS)
+	{
+	    indices = surface->indices;
+	}
+
+	if (indices != NULL) {
+	    num_elements =
+		_cairo_recording_surface_get_visible_commands (surface,
+							       &extents,
+							       indices);
+	    use_indices = num_elements != surface->commands.num_elements;
+	}
     }
 
     for (i = 0; i < num_elements; i++) {
-	cairo_command_t *command = elements[use_indices ? surface->indices[i] : i];
+	cairo_command_t *command = elements[use_indices ? indices[i] : i];
 
 	if (! replay_all && command->header.region != region)
 	    continue;
@@ -1792,8 +1871,12 @@ _cairo_recording_surface_replay_internal (cairo_recording_surface_t	*surface,
 		cairo_command_t *stroke_command;
 
 		stroke_command = NULL;
-		if (type != CAIRO_RECORDING_CREATE_REGIONS && i < num_elements - 1)
-		    stroke_command = elements[i + 1];
+		if (type != CAIRO_RECORDING_CREATE_REGIONS && i < num_elements - 1) {
+		    if (! use_indices)
+			stroke_command = elements[i + 1];
+		    else if (indices[i + 1] == indices[i] + 1)
+			stroke_command = elements[indices[i + 1]];
+		}
 
 		if (stroke_command != NULL &&
 		    type == CAIRO_RECORDING_REPLAY &&
@@ -2003,7 +2086,8 @@ _cairo_recording_surface_replay (cairo_surface_t *surface,
     return _cairo_recording_surface_replay_internal ((cairo_recording_surface_t *) surface, NULL, NULL,
 						     target, NULL,
 						     CAIRO_RECORDING_REPLAY,
-						     CAIRO_RECORDING_REGION_ALL);
+						     CAIRO_RECORDING_REGION_ALL,
+						     NULL);
 }
 
 cairo_status_t
@@ -2015,7 +2099,8 @@ _cairo_recording_surface_replay_with_clip (cairo_surface_t *surface,
     return _cairo_recording_surface_replay_internal ((cairo_recording_surface_t *) surface, NULL, surface_transform,
 						     target, target_clip,
 						     CAIRO_RECORDING_REPLAY,
-						     CAIRO_RECORDING_REGION_ALL);
+						     CAIRO_RECORDING_REGION_ALL,
+						     NULL);
 }
 
 /* Replay recording to surface. When the return status of each operation is
@@ -2031,7 +2116,8 @@ _cairo_recording_surface_replay_and_create_regions (cairo_surface_t *surface,
     return _cairo_recording_surface_replay_internal ((cairo_recording_surface_t *) surface, NULL, NULL,
 						     target, NULL,
 						     CAIRO_RECORDING_CREATE_REGIONS,
-						     CAIRO_RECORDING_REGION_ALL);
+						     CAIRO_RECORDING_REGION_ALL,
+						     NULL);
 }
 
 cairo_status_t
@@ -2044,7 +2130,8 @@ _cairo_recording_surface_replay_region (cairo_surface_t          *surface,
 						     surface_extents, NULL,
 						     target, NULL,
 						     CAIRO_RECORDING_REPLAY,
-						     region);
+						     region,
+						     NULL);
 }
 
 static cairo_status_t
@@ -2177,6 +2264,287 @@ cairo_recording_surface_get_extents (cairo_surface_t *surface,
     return TRUE;
 }
 
+struct tile_replay {
+    cairo_recording_surface_t *recording;
+    cairo_format_t format;
+    cairo_rectangle_int_t extents;
+    int tile_width, tile_height;
+    int tiles_per_row, num_tiles;
+    cairo_recording_tile_func_t tile_func;
+    void *closure;
+
+    cairo_mutex_t mutex;
+    int next_tile;
+    cairo_status_t status;
+};
+
+static cairo_status_t
+_tile_replay_one (struct tile_replay *tr, int n, unsigned int *indices)
+{
+    cairo_surface_t *tile;
+    cairo_status_t status;
+    int x, y, width, height;
+
+    x = tr->extents.x + (n % tr->tiles_per_row) * tr->tile_width;
+    y = tr->extents.y + (n / tr->tiles_per_row) * tr->tile_height;
+    width = MIN (tr->tile_width, tr->extents.x + tr->extents.width - x);
+    height = MIN (tr->tile_height, tr->extents.y + tr->extents.height - y);
+
+    tile = cairo_image_surface_create (tr->format, width, height);
+    cairo_surface_set_device_offset (tile, -x, -y);
+
+    status = tile->status;
+    if (likely (status == CAIRO_STATUS_SUCCESS)) {
+	status = _cairo_recording_surface_replay_internal (tr->recording,
+							   NULL, NULL,
+							   tile, NULL,
+							   CAIRO_RECORDING_REPLAY,
+							   CAIRO_RECORDING_REGION_ALL,
+							   indices);
+    }
+    if (likely (status == CAIRO_STATUS_SUCCESS)) {
+	cairo_surface_flush (tile);
+	status = tr->tile_func (tr->closure, tile, x, y);
+    }
+
+    cairo_surface_destroy (tile);
+    return status;
+}
+
+static void
+_tile_replay_worker (struct tile_replay *tr)
+{
+    unsigned int *indices;
+    cairo_status_t status;
+
+    /* Each worker queries the shared index into its own array */
+    indices = _cairo_malloc_ab (tr->recording->commands.num_elements + 1,
+				sizeof (unsigned int));
+
+    do {
+	int n;
+
+	CAIRO_MUTEX_LOCK (tr->mutex);
+	n = tr->next_tile++;
+	if (tr->status)
+	    n = tr->num_tiles;
+	CAIRO_MUTEX_UNLOCK (tr->mutex);
+	if (n >= tr->num_tiles)
+	    break;
+
+	if (unlikely (indices == NULL))
+	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	else
+	    status = _tile_replay_one (tr, n, indices);
+
+	if (unlikely (status)) {
+	    CAIRO_MUTEX_LOCK (tr->mutex);
+	    if (tr->status == CAIRO_STATUS_SUCCESS)
+		tr->status = status;
+	    CAIRO_MUTEX_UNLOCK (tr->mutex);
+	}
+    } while (TRUE);
+
+    free (indices);
+}
+
+#if CAIRO_HAS_REAL_PTHREAD
+static void *
+_tile_replay_thread (void *closure)
+{
+    _tile_replay_worker (closure);
+    return NULL;
+}
+#endif
+
+/* Nested recording surfaces are replayed through the pattern machinery,
+ * which caches the result upon the source surface and so cannot be used
+ * concurrently.
+ */
+static cairo_bool_t
+_pattern_is_recording (const cairo_pattern_t *pattern)
+{
+    cairo_surface_t *surface, *free_me = NULL;
+    cairo_bool_t is_recording;
+
+    if (pattern->type != CAIRO_PATTERN_TYPE_SURFACE)
+	return FALSE;
+
+    surface = ((const cairo_surface_pattern_t *) pattern)->surface;
+    if (_cairo_surface_is_snapshot (surface))
+	free_me = surface = _cairo_surface_snapshot_get_target (surface);
+    if (surface->type == CAIRO_SURFACE_TYPE_SUBSURFACE)
+	surface = ((cairo_surface_subsurface_t *) surface)->target;
+
+    is_recording = surface->type == CAIRO_SURFACE_TYPE_RECORDING;
+    cairo_surface_destroy (free_me);
+
+    return is_recording;
+}
+
+static cairo_bool_t
+_cairo_recording_surface_has_recording_sources (cairo_recording_surface_t *surface)
+{
+    cairo_command_t **elements;
+    unsigned int i, num_elements;
+
+    num_elements = surface->commands.num_elements;
+    elements = _cairo_array_index (&surface->commands, 0);
+    for (i = 0; i < num_elements; i++) {
+	cairo_command_t *command = elements[i];
+
+	switch (command->header.type) {
+	case CAIRO_COMMAND_MASK:
+	    if (_pattern_is_recording (&command->mask.mask.base))
+		return TRUE;
+	    /* fall through */
+	case CAIRO_COMMAND_PAINT:
+	case CAIRO_COMMAND_STROKE:
+	case CAIRO_COMMAND_FILL:
+	case CAIRO_COMMAND_SHOW_TEXT_GLYPHS:
+	    /* the source is at the same offset within every command */
+	    if (_pattern_is_recording (&command->paint.source.base))
+		return TRUE;
+	    break;
+
+	default:
+	    ASSERT_NOT_REACHED;
+	}
+    }
+
+    return FALSE;
+}
+
+/**
+ * cairo_recording_surface_replay_tiles:
+ * @surface: a #cairo_recording_surface_t
+ * @extents: the area to rasterise in recording coordinates, or %NULL
+ *           for the extents of a bounded @surface or else the ink
+ *           extents of its operations
+ * @format: the format of the tiles
+ * @tile_width: the width of each tile in pixels
+ * @tile_height: the height of each tile in pixels
+ * @num_threads: the maximum number of threads to rasterise with,
+ *               including the calling thread
+ * @tile_func: function called with each completed tile
+ * @closure: data to pass to @tile_func
+ *
+ * Rasterises @extents of the recording surface by dividing it into a
+ * grid of tiles, each of which is replayed into its own image surface
+ * of @format and passed to @tile_func. Tiles along the right and bottom
+ * edges are cropped to @extents, and each tile has a device offset such
+ * that its user space coincides with the recording space.
+ *
+ * Where cairo is built with thread support, the tiles are replayed
+ * concurrently by up to @num_threads threads, sharing the single spatial
+ * index of @surface. @tile_func may then be called concurrently from
+ * several threads and in any order; the tile is only valid until
+ * @tile_func returns, unless it takes a reference. Any other use of
+ * @surface, in particular drawing to it, is not allowed until this
+ * function returns. If @surface uses other recording surfaces as sources,
+ * the tiles are replayed sequentially.
+ *
+ * If @tile_func returns an error, no further tiles are started and
+ * that status is returned.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS, or the first error encountered.
+ *
+ * Since: 1.16
+ **/
+cairo_status_t
+cairo_recording_surface_replay_tiles (cairo_surface_t		    *surface,
+				      const cairo_rectangle_int_t   *extents,
+				      cairo_format_t		     format,
+				      int			     tile_width,
+				      int			     tile_height,
+				      int			     num_threads,
+				      cairo_recording_tile_func_t    tile_func,
+				      void			    *closure)
+{
+    cairo_recording_surface_t *recording;
+    struct tile_replay tr;
+    cairo_status_t status;
+#if CAIRO_HAS_REAL_PTHREAD
+    pthread_t *threads = NULL;
+    int n;
+#endif
+
+    if (unlikely (surface->status))
+	return surface->status;
+    if (unlikely (surface->finished))
+	return _cairo_error (CAIRO_STATUS_SURFACE_FINISHED);
+    if (! _cairo_surface_is_recording (surface))
+	return _cairo_error (CAIRO_STATUS_SURFACE_TYPE_MISMATCH);
+    if (! CAIRO_FORMAT_VALID (format))
+	return _cairo_error (CAIRO_STATUS_INVALID_FORMAT);
+    if (tile_width <= 0 || tile_height <= 0)
+	return _cairo_error (CAIRO_STATUS_INVALID_SIZE);
+
+    recording = (cairo_recording_surface_t *) surface;
+
+    tr.recording = recording;
+    tr.format = format;
+    tr.tile_width = tile_width;
+    tr.tile_height = tile_height;
+    tr.tile_func = tile_func;
+    tr.closure = closure;
+
+    if (extents != NULL) {
+	tr.extents = *extents;
+    } else if (! recording->unbounded) {
+	tr.extents = recording->extents;
+    } else {
+	cairo_box_t bbox;
+
+	status = _recording_surface_get_ink_bbox (recording, &bbox, NULL);
+	if (unlikely (status))
+	    return status;
+
+	_cairo_box_round_to_rectangle (&bbox, &tr.extents);
+    }
+    if (tr.extents.width <= 0 || tr.extents.height <= 0)
+	return CAIRO_STATUS_SUCCESS;
+
+    tr.tiles_per_row = (tr.extents.width + tile_width - 1) / tile_width;
+    tr.num_tiles = tr.tiles_per_row *
+	((tr.extents.height + tile_height - 1) / tile_height);
+
+    /* Build the index upfront, the workers only ever read it */
+    status = _cairo_recording_surface_prepare_bbtree (recording);
+    if (unlikely (status))
+	return status;
+
+    if (num_threads > tr.num_tiles)
+	num_threads = tr.num_tiles;
+    if (num_threads > 1 && _cairo_recording_surface_has_recording_sources (recording))
+	num_threads = 1;
+
+    CAIRO_MUTEX_INIT (tr.mutex);
+    tr.next_tile = 0;
+    tr.status = CAIRO_STATUS_SUCCESS;
+
+#if CAIRO_HAS_REAL_PTHREAD
+    if (num_threads > 1)
+	threads = _cairo_malloc_ab (num_threads - 1, sizeof (pthread_t));
+    for (n = 0; threads != NULL && n < num_threads - 1; n++) {
+	if (pthread_create (&threads[n], NULL, _tile_replay_thread, &tr))
+	    break;
+    }
+#endif
+
+    _tile_replay_worker (&tr);
+
+#if CAIRO_HAS_REAL_PTHREAD
+    while (n--)
+	pthread_join (threads[n], NULL);
+    free (threads);
+#endif
+
+    CAIRO_MUTEX_FINI (tr.mutex);
+
+    return tr.status;
+}
+
 cairo_bool_t
 _cairo_recording_surface_has_only_bilevel_alpha (cairo_recording_surface_t *surface)
 {
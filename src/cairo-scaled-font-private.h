@@ -72,7 +72,8 @@ struct _cairo_scaled_font {
      *    count of a scaled font is intimately related with the font
      *    map itself, (and the magic holdovers array).
      *
-     * 2. The cache of glyphs (scaled_font->glyphs)
+     * 2. The cache of glyphs (scaled_font->glyphs) and of the glyphs
+     *    for characters (scaled_font->glyph_lut)
      * 3. The backend private data (scaled_font->surface_backend,
      *				    scaled_font->surface_private)
      *
@@ -98,6 +99,7 @@ struct _cairo_scaled_font {
     unsigned int placeholder : 1; /*  protected by fontmap mutex */
     unsigned int holdover : 1;
     unsigned int finished : 1;
+    unsigned int subpixel_positions : 1; /* set by the backend at creation */
 
     /* "live" scaled_font members */
     cairo_matrix_t scale;	     /* font space => device space */
@@ -113,6 +115,10 @@ struct _cairo_scaled_font {
     cairo_list_t glyph_pages;
     cairo_bool_t cache_frozen;
     cairo_bool_t global_cache_frozen;
+    cairo_bool_t has_pinned_glyphs;
+
+    /* characters => glyph index and advance, for text_to_glyphs() */
+    struct _cairo_scaled_font_glyph_lut *glyph_lut;
 
     cairo_list_t dev_privates;
 
@@ -138,6 +144,7 @@ struct _cairo_scaled_glyph {
     int16_t                 y_advance;		/* device-space rounded Y advance */
 
     unsigned int	    has_info;
+    cairo_bool_t	    pinned;		/* see cairo_scaled_font_preload_glyphs() */
     cairo_image_surface_t   *surface;		/* device-space image */
     cairo_path_fixed_t	    *path;		/* device-space outline */
     cairo_surface_t         *recording_surface;	/* device-space recording-surface */
@@ -125,6 +125,24 @@ _cairo_scaled_font_subsets_create_composite (void);
 cairo_private void
 _cairo_scaled_font_subsets_destroy (cairo_scaled_font_subsets_t *font_subsets);
 
+/**
+ * _cairo_scaled_font_subsets_close:
+ * @font_subsets: a #cairo_scaled_font_subsets_t
+ *
+ * Closes all the subsets of @font_subsets, once they have been
+ * written out with the _cairo_scaled_font_subsets_foreach_*()
+ * functions. The glyphs mapped afterwards, including those mapped
+ * before, go into new subsets with new subset ids, and only these are
+ * visited by later calls to the foreach functions. The font ids are
+ * kept.
+ *
+ * This allows a document to write out its fonts before it is
+ * complete, at the cost of repeating glyphs used both before and after
+ * the subsets were closed.
+ **/
+cairo_private void
+_cairo_scaled_font_subsets_close (cairo_scaled_font_subsets_t *font_subsets);
+
 /**
  * _cairo_scaled_font_subsets_enable_latin_subset:
  * @font_subsets: a #cairo_scaled_font_subsets_t object to be destroyed
@@ -329,6 +347,60 @@ _cairo_scaled_font_subsets_foreach_user (cairo_scaled_font_subsets_t		  *font_su
 					 cairo_scaled_font_subset_callback_func_t  font_subset_callback,
 					 void					  *closure);
 
+typedef void
+(*cairo_scaled_font_subset_prepare_func_t) (cairo_scaled_font_subset_t	*font_subset,
+					    void			*prepared,
+					    void			*closure);
+
+typedef cairo_int_status_t
+(*cairo_scaled_font_subset_emit_func_t) (cairo_scaled_font_subset_t	*font_subset,
+					 void				*prepared,
+					 void				*closure);
+
+typedef void
+(*cairo_scaled_font_subset_release_func_t) (void *prepared);
+
+/**
+ * _cairo_scaled_font_subsets_foreach_unscaled_parallel:
+ * @font_subsets: a #cairo_scaled_font_subsets_t
+ * @prepared_size: the size of the data produced by @prepare for each subset
+ * @prepare: a function to be called for each font subset to do the work
+ * that does not depend upon the output
+ * @emit: a function to be called for each font subset with the data
+ * from @prepare
+ * @release: a function to be called to free the data from @prepare
+ * @closure: closure data for @prepare and @emit
+ *
+ * Iterate over each unique unscaled font subset in two passes, as
+ * _cairo_scaled_font_subsets_foreach_unscaled() does with a single
+ * callback.
+ *
+ * First @prepare is called for every subset, with a zeroed block of
+ * @prepared_size bytes in which to leave its result, typically the
+ * embeddable subset of the font. Where cairo is built with thread
+ * support and the fonts are all FreeType fonts, the subsets are
+ * prepared concurrently, so @prepare must not touch anything other
+ * than the subset and its block, bar reading @closure; it may also
+ * fill in the glyph names of the subset. Any error should be left in
+ * the block for @emit to report.
+ *
+ * Then @emit is called for each subset, from the calling thread and in
+ * the same order as _cairo_scaled_font_subsets_foreach_unscaled(), so
+ * that the output does not depend upon the number of threads. @release
+ * is called for every prepared block, whether or not it was emitted.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS if successful, or a non-zero
+ * value indicating an error. Possible errors include
+ * %CAIRO_STATUS_NO_MEMORY.
+ **/
+cairo_private cairo_status_t
+_cairo_scaled_font_subsets_foreach_unscaled_parallel (cairo_scaled_font_subsets_t		 *font_subsets,
+						      int					  prepared_size,
+						      cairo_scaled_font_subset_prepare_func_t	  prepare,
+						      cairo_scaled_font_subset_emit_func_t	  emit,
+						      cairo_scaled_font_subset_release_func_t	  release,
+						      void					 *closure);
+
 /**
  * _cairo_scaled_font_subset_create_glyph_names:
  * @font_subsets: a #cairo_scaled_font_subsets_t
@@ -730,6 +802,68 @@ _cairo_truetype_get_style (cairo_scaled_font_t  	 *scaled_font,
 cairo_private cairo_int_status_t
 _cairo_escape_ps_name (char **ps_name);
 
+/**
+ * _cairo_font_table_cache_get:
+ * @scaled_font: the #cairo_scaled_font_t
+ * @tag: the TrueType/OpenType tag of the table
+ * @data: returns the contents of the table
+ * @length: returns the length of the table
+ *
+ * Look up a whole TrueType/OpenType table of the font face of
+ * @scaled_font, reading it through the font backend only if it is not
+ * already cached. The tables are shared by every scaled font, surface
+ * and thread using the same font face, and the least recently used are
+ * dropped once the tables of all font faces grow too large.
+ *
+ * On success, @data must not be modified and has to be handed back to
+ * _cairo_font_table_cache_release() once no longer needed.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS if successful,
+ * %CAIRO_INT_STATUS_UNSUPPORTED if the font backend does not provide
+ * the table for @scaled_font. Possible errors include
+ * %CAIRO_STATUS_NO_MEMORY.
+ **/
+cairo_private cairo_int_status_t
+_cairo_font_table_cache_get (cairo_scaled_font_t	 *scaled_font,
+			     unsigned long		  tag,
+			     const unsigned char	**data,
+			     unsigned long		 *length);
+
+/**
+ * _cairo_font_table_cache_release:
+ * @data: a table returned by _cairo_font_table_cache_get()
+ *
+ * Releases a table returned by _cairo_font_table_cache_get(), freeing
+ * it if it has since been dropped from the cache.
+ **/
+cairo_private void
+_cairo_font_table_cache_release (const unsigned char *data);
+
+/**
+ * _cairo_font_table_cache_load:
+ * @scaled_font: the #cairo_scaled_font_t
+ * @tag: the TrueType/OpenType tag of the table
+ * @offset: the offset within the table to start copying from
+ * @buffer: the buffer to copy into, or %NULL to query the table length
+ * @length: the number of bytes to copy, or returns the table length
+ *
+ * A replacement for the load_truetype_table() method of the font
+ * backend, with the same semantics, that copies out of the tables held
+ * by _cairo_font_table_cache_get(). The length is also answered from
+ * the cache, so it reads the whole table if not yet cached.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS if successful,
+ * %CAIRO_INT_STATUS_UNSUPPORTED if the font backend does not provide
+ * the table for @scaled_font or the range is outside of the table.
+ * Possible errors include %CAIRO_STATUS_NO_MEMORY.
+ **/
+cairo_private cairo_int_status_t
+_cairo_font_table_cache_load (cairo_scaled_font_t	*scaled_font,
+			      unsigned long		 tag,
+			      long			 offset,
+			      unsigned char		*buffer,
+			      unsigned long		*length);
+
 #if DEBUG_SUBSETS
 cairo_private void
 dump_scaled_font_subsets (cairo_scaled_font_subsets_t *font_subsets);
@@ -46,9 +46,18 @@
 
 #if CAIRO_HAS_FONT_SUBSET
 
+#include "cairo-array-private.h"
 #include "cairo-scaled-font-subsets-private.h"
 #include "cairo-user-font-private.h"
 
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#if CAIRO_HAS_REAL_PTHREAD
+#include <pthread.h>
+#endif
+
 #define MAX_GLYPHS_PER_SIMPLE_FONT 256
 #define MAX_GLYPHS_PER_COMPOSITE_FONT 65536
 
@@ -76,6 +85,7 @@ typedef struct _cairo_sub_font {
     cairo_scaled_font_t *scaled_font;
     unsigned int font_id;
 
+    int first_open_subset;
     int current_subset;
     int num_glyphs_in_current_subset;
     int num_glyphs_in_latin_subset;
@@ -305,6 +315,7 @@ _cairo_sub_font_create (cairo_scaled_font_subsets_t	*parent,
     else
 	sub_font->current_subset = 0;
 
+    sub_font->first_open_subset = 0;
     sub_font->num_glyphs_in_current_subset = 0;
     sub_font->num_glyphs_in_latin_subset = 0;
     sub_font->max_glyphs_per_subset = max_glyphs_per_subset;
@@ -332,6 +343,23 @@ _cairo_sub_font_destroy (cairo_sub_font_t *sub_font)
     free (sub_font);
 }
 
+static void
+_cairo_sub_font_close (cairo_sub_font_t *sub_font)
+{
+    _cairo_hash_table_foreach (sub_font->sub_font_glyphs,
+			       _cairo_sub_font_glyph_pluck,
+			       sub_font->sub_font_glyphs);
+
+    /* The latin subset is always subset 0, so once it has been
+     * closed latin glyphs go into the ordinary subsets. */
+    sub_font->use_latin_subset = FALSE;
+    sub_font->num_glyphs_in_latin_subset = 0;
+
+    sub_font->current_subset++;
+    sub_font->num_glyphs_in_current_subset = 0;
+    sub_font->first_open_subset = sub_font->current_subset;
+}
+
 static void
 _cairo_sub_font_pluck (void *entry, void *closure)
 {
@@ -694,7 +722,7 @@ _cairo_sub_font_collect (void *entry, void *closure)
     if (collection->status)
 	return;
 
-    for (i = 0; i <= sub_font->current_subset; i++) {
+    for (i = sub_font->first_open_subset; i <= sub_font->current_subset; i++) {
 	collection->subset_id = i;
 	collection->num_glyphs = 0;
 	collection->max_glyph = 0;
@@ -824,6 +852,26 @@ _cairo_scaled_font_subsets_destroy (cairo_scaled_font_subsets_t *subsets)
     free (subsets);
 }
 
+void
+_cairo_scaled_font_subsets_close (cairo_scaled_font_subsets_t *font_subsets)
+{
+    cairo_sub_font_t *sub_font;
+
+    for (sub_font = font_subsets->unscaled_sub_fonts_list;
+	 sub_font != NULL;
+	 sub_font = sub_font->next)
+    {
+	_cairo_sub_font_close (sub_font);
+    }
+
+    for (sub_font = font_subsets->scaled_sub_fonts_list;
+	 sub_font != NULL;
+	 sub_font = sub_font->next)
+    {
+	_cairo_sub_font_close (sub_font);
+    }
+}
+
 void
 _cairo_scaled_font_subsets_enable_latin_subset (cairo_scaled_font_subsets_t *font_subsets,
 						cairo_bool_t                 use_latin)
@@ -1109,6 +1157,256 @@ _cairo_scaled_font_subsets_foreach_user (cairo_scaled_font_subsets_t		  *font_su
 							CAIRO_SUBSETS_FOREACH_USER);
 }
 
+/* Subsetting a font does not depend upon anything but the font and the
+ * glyphs of the subset, so for documents with many fonts it is done for
+ * all the subsets at once, by a few threads, before they are written
+ * out one at a time. Each subset is copied, as the arrays passed to the
+ * callbacks of the iterators above are reused for the next subset.
+ *
+ * Only font backends whose table loaders and glyph lookups may be used
+ * from several threads at once are subset concurrently; the win32
+ * backend, for one, draws everything through a single shared DC, and
+ * user fonts call back into the application. If any font is of another
+ * type than FreeType, all of the subsets are prepared by the calling
+ * thread. CAIRO_SUBSET_THREADS overrides the number of threads.
+ */
+#define MAX_SUBSET_THREADS 8
+
+typedef struct _cairo_subset_job {
+    cairo_scaled_font_subset_t subset;
+    void *prepared;
+} cairo_subset_job_t;
+
+typedef struct _cairo_subset_jobs {
+    cairo_array_t jobs;
+    int prepared_size;
+    cairo_scaled_font_subset_prepare_func_t prepare;
+    void *closure;
+
+    cairo_bool_t thread_safe;
+
+    cairo_mutex_t mutex;
+    unsigned int next_job;
+} cairo_subset_jobs_t;
+
+static cairo_bool_t
+_cairo_subset_is_thread_safe (cairo_scaled_font_t *scaled_font)
+{
+    switch (scaled_font->backend->type) {
+    case CAIRO_FONT_TYPE_FT:
+	return TRUE;
+    case CAIRO_FONT_TYPE_TOY:
+    case CAIRO_FONT_TYPE_WIN32:
+    case CAIRO_FONT_TYPE_QUARTZ:
+    case CAIRO_FONT_TYPE_USER:
+    default:
+	return FALSE;
+    }
+}
+
+static void
+_cairo_subset_job_fini (cairo_subset_job_t *job)
+{
+    unsigned int i;
+
+    if (job->subset.glyph_names != NULL) {
+	for (i = 0; i < job->subset.num_glyphs; i++)
+	    free (job->subset.glyph_names[i]);
+	free (job->subset.glyph_names);
+    }
+
+    free (job->subset.glyphs);
+    free (job->subset.utf8);
+    free (job->subset.to_latin_char);
+    free (job->subset.latin_to_subset_glyph_index);
+    free (job->prepared);
+}
+
+static cairo_int_status_t
+_cairo_subset_jobs_add (cairo_scaled_font_subset_t	*font_subset,
+			void				*closure)
+{
+    cairo_subset_jobs_t *jobs = closure;
+    cairo_subset_job_t job;
+    unsigned int num_glyphs = font_subset->num_glyphs;
+    cairo_status_t status;
+
+    job.subset = *font_subset;
+    job.subset.glyphs = _cairo_malloc_ab (num_glyphs, sizeof (unsigned long));
+    job.subset.utf8 = _cairo_malloc_ab (num_glyphs, sizeof (char *));
+    job.subset.glyph_names = NULL;
+    job.subset.to_latin_char = NULL;
+    job.subset.latin_to_subset_glyph_index = NULL;
+    if (font_subset->is_latin) {
+	job.subset.to_latin_char = _cairo_malloc_ab (num_glyphs, sizeof (int));
+	job.subset.latin_to_subset_glyph_index =
+	    _cairo_malloc_ab (256, sizeof (unsigned long));
+    }
+    job.prepared = calloc (1, jobs->prepared_size);
+    if (unlikely (job.subset.glyphs == NULL ||
+		  job.subset.utf8 == NULL ||
+		  (font_subset->is_latin &&
+		   (job.subset.to_latin_char == NULL ||
+		    job.subset.latin_to_subset_glyph_index == NULL)) ||
+		  job.prepared == NULL))
+    {
+	_cairo_subset_job_fini (&job);
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+    }
+
+    /* the utf8 strings belong to the sub font and outlive the job */
+    memcpy (job.subset.glyphs, font_subset->glyphs,
+	    num_glyphs * sizeof (unsigned long));
+    memcpy (job.subset.utf8, font_subset->utf8,
+	    num_glyphs * sizeof (char *));
+    if (font_subset->is_latin) {
+	memcpy (job.subset.to_latin_char, font_subset->to_latin_char,
+		num_glyphs * sizeof (int));
+	memcpy (job.subset.latin_to_subset_glyph_index,
+		font_subset->latin_to_subset_glyph_index,
+		256 * sizeof (unsigned long));
+    }
+
+    status = _cairo_array_append (&jobs->jobs, &job);
+    if (unlikely (status)) {
+	_cairo_subset_job_fini (&job);
+	return status;
+    }
+
+    if (! _cairo_subset_is_thread_safe (font_subset->scaled_font))
+	jobs->thread_safe = FALSE;
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+_cairo_subset_jobs_worker (cairo_subset_jobs_t *jobs)
+{
+    cairo_subset_job_t *job;
+    unsigned int n;
+
+    do {
+	CAIRO_MUTEX_LOCK (jobs->mutex);
+	n = jobs->next_job++;
+	CAIRO_MUTEX_UNLOCK (jobs->mutex);
+
+	if (n >= _cairo_array_num_elements (&jobs->jobs))
+	    break;
+
+	job = _cairo_array_index (&jobs->jobs, n);
+	jobs->prepare (&job->subset, job->prepared, jobs->closure);
+    } while (TRUE);
+}
+
+#if CAIRO_HAS_REAL_PTHREAD
+static void *
+_cairo_subset_jobs_thread (void *closure)
+{
+    _cairo_subset_jobs_worker (closure);
+    return NULL;
+}
+#endif
+
+static int
+_cairo_subset_jobs_num_threads (cairo_subset_jobs_t *jobs)
+{
+    unsigned int num_jobs = _cairo_array_num_elements (&jobs->jobs);
+    long num_threads = 1;
+#if CAIRO_HAS_REAL_PTHREAD
+    const char *env;
+
+    env = getenv ("CAIRO_SUBSET_THREADS");
+    if (env != NULL)
+	num_threads = atoi (env);
+#if HAVE_UNISTD_H && defined(_SC_NPROCESSORS_ONLN)
+    else
+	num_threads = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+#endif
+
+    if (! jobs->thread_safe)
+	num_threads = 1;
+
+    if (num_threads > MAX_SUBSET_THREADS)
+	num_threads = MAX_SUBSET_THREADS;
+    if (num_threads > (long) num_jobs)
+	num_threads = num_jobs;
+    if (num_threads < 1)
+	num_threads = 1;
+
+    return num_threads;
+}
+
+cairo_status_t
+_cairo_scaled_font_subsets_foreach_unscaled_parallel (cairo_scaled_font_subsets_t		 *font_subsets,
+						      int					  prepared_size,
+						      cairo_scaled_font_subset_prepare_func_t	  prepare,
+						      cairo_scaled_font_subset_emit_func_t	  emit,
+						      cairo_scaled_font_subset_release_func_t	  release,
+						      void					 *closure)
+{
+    cairo_subset_jobs_t jobs;
+    cairo_subset_job_t *job;
+    cairo_int_status_t status;
+    unsigned int i, num_jobs;
+    int num_threads;
+#if CAIRO_HAS_REAL_PTHREAD
+    pthread_t *threads = NULL;
+    int n = 0;
+#endif
+
+    _cairo_array_init (&jobs.jobs, sizeof (cairo_subset_job_t));
+    jobs.prepared_size = prepared_size;
+    jobs.prepare = prepare;
+    jobs.closure = closure;
+    jobs.thread_safe = TRUE;
+    jobs.next_job = 0;
+
+    status = _cairo_scaled_font_subsets_foreach_unscaled (font_subsets,
+							  _cairo_subset_jobs_add,
+							  &jobs);
+    num_jobs = _cairo_array_num_elements (&jobs.jobs);
+    if (unlikely (status)) {
+	for (i = 0; i < num_jobs; i++)
+	    _cairo_subset_job_fini (_cairo_array_index (&jobs.jobs, i));
+	_cairo_array_fini (&jobs.jobs);
+	return status;
+    }
+
+    CAIRO_MUTEX_INIT (jobs.mutex);
+
+    num_threads = _cairo_subset_jobs_num_threads (&jobs);
+#if CAIRO_HAS_REAL_PTHREAD
+    if (num_threads > 1)
+	threads = _cairo_malloc_ab (num_threads - 1, sizeof (pthread_t));
+    for (n = 0; threads != NULL && n < num_threads - 1; n++) {
+	if (pthread_create (&threads[n], NULL, _cairo_subset_jobs_thread, &jobs))
+	    break;
+    }
+#endif
+
+    _cairo_subset_jobs_worker (&jobs);
+
+#if CAIRO_HAS_REAL_PTHREAD
+    while (n--)
+	pthread_join (threads[n], NULL);
+    free (threads);
+#endif
+
+    CAIRO_MUTEX_FINI (jobs.mutex);
+
+    for (i = 0; i < num_jobs; i++) {
+	job = _cairo_array_index (&jobs.jobs, i);
+	if (status == CAIRO_INT_STATUS_SUCCESS)
+	    status = emit (&job->subset, job->prepared, closure);
+	release (job->prepared);
+	_cairo_subset_job_fini (job);
+    }
+    _cairo_array_fini (&jobs.jobs);
+
+    return status;
+}
+
 static cairo_bool_t
 _cairo_string_equal (const void *key_a, const void *key_b)
 {
@@ -45,6 +45,7 @@
 #include "cairo-pattern-private.h"
 #include "cairo-scaled-font-private.h"
 #include "cairo-surface-backend-private.h"
+#include "cairo-surface-observer-stage-private.h"
 
 #if _XOPEN_SOURCE >= 600 || defined (_ISOC99_SOURCE)
 #define ISFINITE(x) isfinite (x)
@@ -82,12 +83,18 @@ _cairo_scaled_font_compute_hash (cairo_scaled_font_t *scaled_font);
 #define MAX_GLYPH_PAGES_CACHED 512
 static cairo_cache_t cairo_scaled_glyph_page_cache;
 
+/* Pages holding glyphs from cairo_scaled_font_preload_glyphs() are not
+ * evicted; at most this many of them, across all fonts, are kept so. */
+#define MAX_GLYPH_PAGES_PINNED (MAX_GLYPH_PAGES_CACHED / 4)
+static unsigned int cairo_scaled_glyph_pages_pinned;
+
 #define CAIRO_SCALED_GLYPH_PAGE_SIZE 32
 struct _cairo_scaled_glyph_page {
     cairo_cache_entry_t cache_entry;
 
     cairo_list_t link;
 
+    unsigned int num_pinned; /* glyphs from cairo_scaled_font_preload_glyphs() */
     unsigned int num_glyphs;
     cairo_scaled_glyph_t glyphs[CAIRO_SCALED_GLYPH_PAGE_SIZE];
 };
@@ -243,6 +250,7 @@ static const cairo_scaled_font_t _cairo_scaled_font_nil = {
     FALSE,			/* placeholder */
     FALSE,			/* holdover */
     TRUE,			/* finished */
+    FALSE,			/* subpixel_positions */
     { 1., 0., 0., 1., 0, 0},	/* scale */
     { 1., 0., 0., 1., 0, 0},	/* scale_inverse */
     1.,				/* max_scale */
@@ -253,6 +261,8 @@ static const cairo_scaled_font_t _cairo_scaled_font_nil = {
     { NULL, NULL },		/* pages */
     FALSE,			/* cache_frozen */
     FALSE,			/* global_cache_frozen */
+    FALSE,			/* has_pinned_glyphs */
+    NULL,			/* glyph_lut */
     { NULL, NULL },		/* privates */
     NULL			/* backend */
 };
@@ -465,6 +475,9 @@ _cairo_scaled_glyph_page_destroy (cairo_scaled_font_t *scaled_font,
 	_cairo_scaled_glyph_fini (scaled_font, &page->glyphs[n]);
     }
 
+    if (page->num_pinned)
+	cairo_scaled_glyph_pages_pinned--;
+
     cairo_list_del (&page->link);
     free (page);
 }
@@ -768,9 +781,12 @@ _cairo_scaled_font_init (cairo_scaled_font_t               *scaled_font,
     cairo_list_init (&scaled_font->glyph_pages);
     scaled_font->cache_frozen = FALSE;
     scaled_font->global_cache_frozen = FALSE;
+    scaled_font->has_pinned_glyphs = FALSE;
+    scaled_font->glyph_lut = NULL;
 
     scaled_font->holdover = FALSE;
     scaled_font->finished = FALSE;
+    scaled_font->subpixel_positions = FALSE;
 
     CAIRO_REFERENCE_COUNT_INIT (&scaled_font->ref_count, 1);
 
@@ -876,6 +892,7 @@ _cairo_scaled_font_fini_internal (cairo_scaled_font_t *scaled_font)
 
     _cairo_scaled_font_reset_cache (scaled_font);
     _cairo_hash_table_destroy (scaled_font->glyphs);
+    free (scaled_font->glyph_lut);
 
     cairo_font_face_destroy (scaled_font->font_face);
     cairo_font_face_destroy (scaled_font->original_font_face);
@@ -1287,6 +1304,34 @@ cairo_scaled_font_reference (cairo_scaled_font_t *scaled_font)
 }
 slim_hidden_def (cairo_scaled_font_reference);
 
+/* Releases the pins of cairo_scaled_font_preload_glyphs(), so that the
+ * glyphs of a font nobody holds may be evicted like any other. */
+static void
+_cairo_scaled_font_unpin_glyphs (cairo_scaled_font_t *scaled_font)
+{
+    cairo_scaled_glyph_page_t *page;
+    unsigned int n;
+
+    CAIRO_MUTEX_LOCK (scaled_font->mutex);
+    if (scaled_font->has_pinned_glyphs) {
+	CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
+	cairo_list_foreach_entry (page, cairo_scaled_glyph_page_t,
+				  &scaled_font->glyph_pages, link)
+	{
+	    if (page->num_pinned == 0)
+		continue;
+
+	    for (n = 0; n < page->num_glyphs; n++)
+		page->glyphs[n].pinned = FALSE;
+	    page->num_pinned = 0;
+	    cairo_scaled_glyph_pages_pinned--;
+	}
+	CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+	scaled_font->has_pinned_glyphs = FALSE;
+    }
+    CAIRO_MUTEX_UNLOCK (scaled_font->mutex);
+}
+
 /**
  * cairo_scaled_font_destroy:
  * @scaled_font: a #cairo_scaled_font_t
@@ -1317,6 +1362,11 @@ cairo_scaled_font_destroy (cairo_scaled_font_t *scaled_font)
     assert (! scaled_font->cache_frozen);
     assert (! scaled_font->global_cache_frozen);
 
+    /* Not yet among the holdovers, so the font cannot be freed under
+     * us. Should another thread resurrect it meanwhile, it merely
+     * loses its pins. */
+    _cairo_scaled_font_unpin_glyphs (scaled_font);
+
     font_map = _cairo_scaled_font_map_lock ();
     assert (font_map != NULL);
 
@@ -1674,7 +1724,179 @@ ZERO_EXTENTS:
 }
 slim_hidden_def (cairo_scaled_font_glyph_extents);
 
-#define GLYPH_LUT_SIZE 64
+static void
+_cairo_scaled_glyph_pin (cairo_scaled_font_t *scaled_font,
+			 cairo_scaled_glyph_t *scaled_glyph)
+{
+    cairo_scaled_glyph_page_t *page;
+
+    if (scaled_glyph->pinned)
+	return;
+
+    /* the most recently allocated pages are the likeliest */
+    cairo_list_foreach_entry_reverse (page, cairo_scaled_glyph_page_t,
+				      &scaled_font->glyph_pages, link)
+    {
+	if (scaled_glyph >= page->glyphs &&
+	    scaled_glyph < page->glyphs + page->num_glyphs)
+	{
+	    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
+	    if (page->num_pinned == 0) {
+		if (cairo_scaled_glyph_pages_pinned == MAX_GLYPH_PAGES_PINNED) {
+		    /* leave the glyph to the cache like any other */
+		    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+		    return;
+		}
+		cairo_scaled_glyph_pages_pinned++;
+	    }
+	    page->num_pinned++;
+	    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+
+	    scaled_glyph->pinned = TRUE;
+	    scaled_font->has_pinned_glyphs = TRUE;
+	    return;
+	}
+    }
+}
+
+/**
+ * cairo_scaled_font_preload_glyphs:
+ * @scaled_font: a #cairo_scaled_font_t
+ * @glyphs: an array of glyph IDs with X and Y offsets.
+ * @num_glyphs: the number of glyphs in the @glyphs array
+ * @flags: what to prepare for each glyph besides its metrics
+ *
+ * Loads the glyphs in @glyphs ahead of drawing them, so that the
+ * drawing does not have to stop to rasterise glyphs one at a time.
+ * The glyph positions are ignored; if the font renders glyphs at
+ * subpixel positions, every position is prepared.
+ *
+ * The preloaded glyphs are kept until the last reference to
+ * @scaled_font is released rather than being evicted to make room for
+ * the glyphs of other fonts, so only preload the glyphs that are about
+ * to be drawn. Glyphs are cached in small groups, and a group holding
+ * a preloaded glyph is kept as a whole. Only a limited number of
+ * groups, shared by all fonts, is kept this way; once that is reached,
+ * further glyphs are still loaded but may be evicted as usual.
+ *
+ * Different scaled fonts may be preloaded from separate threads
+ * concurrently; the glyphs of a single scaled font are loaded one
+ * after another.
+ *
+ * Glyphs for which the font cannot provide what @flags asks for, such
+ * as the path of a bitmap glyph, are skipped.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS, or the error status of
+ * @scaled_font, which is also set if loading a glyph failed.
+ *
+ * Since: 1.16
+ **/
+cairo_status_t
+cairo_scaled_font_preload_glyphs (cairo_scaled_font_t	      *scaled_font,
+				  const cairo_glyph_t	      *glyphs,
+				  int			       num_glyphs,
+				  cairo_glyph_preload_flags_t  flags)
+{
+    cairo_scaled_glyph_info_t info = CAIRO_SCALED_GLYPH_INFO_METRICS;
+    cairo_int_status_t status = CAIRO_INT_STATUS_SUCCESS;
+    int num_phases = 1;
+    int i, phase;
+
+    if (unlikely (scaled_font->status))
+	return scaled_font->status;
+
+    if (num_glyphs == 0)
+	return CAIRO_STATUS_SUCCESS;
+
+    if (unlikely (num_glyphs < 0))
+	return _cairo_error (CAIRO_STATUS_NEGATIVE_COUNT);
+
+    if (unlikely (glyphs == NULL))
+	return _cairo_error (CAIRO_STATUS_NULL_POINTER);
+
+    if (flags & CAIRO_GLYPH_PRELOAD_SURFACE) {
+	info |= CAIRO_SCALED_GLYPH_INFO_SURFACE;
+	if (scaled_font->subpixel_positions)
+	    num_phases = CAIRO_SCALED_GLYPH_PHASES;
+    }
+    if (flags & CAIRO_GLYPH_PRELOAD_PATH)
+	info |= CAIRO_SCALED_GLYPH_INFO_PATH;
+
+    _cairo_scaled_font_freeze_cache (scaled_font);
+
+    for (i = 0; i < num_glyphs; i++) {
+	for (phase = 0; phase < num_phases; phase++) {
+	    cairo_scaled_glyph_info_t phase_info = info;
+	    cairo_scaled_glyph_t *scaled_glyph;
+	    unsigned long index = glyphs[i].index;
+
+	    /* paths are only used from the unshifted glyph */
+	    if (phase) {
+		index |= (unsigned long) phase << CAIRO_SCALED_GLYPH_PHASE_SHIFT;
+		phase_info &= ~CAIRO_SCALED_GLYPH_INFO_PATH;
+	    }
+
+	    status = _cairo_scaled_glyph_lookup (scaled_font, index, phase_info,
+						 &scaled_glyph);
+	    if (status == CAIRO_INT_STATUS_UNSUPPORTED &&
+		phase_info & CAIRO_SCALED_GLYPH_INFO_PATH)
+	    {
+		/* a bitmap glyph still has a surface worth loading */
+		phase_info &= ~CAIRO_SCALED_GLYPH_INFO_PATH;
+		status = _cairo_scaled_glyph_lookup (scaled_font, index,
+						     phase_info,
+						     &scaled_glyph);
+	    }
+	    if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
+		/* load whatever the font does provide */
+		status = _cairo_scaled_glyph_lookup (scaled_font, index,
+						     CAIRO_SCALED_GLYPH_INFO_METRICS,
+						     &scaled_glyph);
+	    }
+	    if (unlikely (status))
+		goto UNLOCK;
+
+	    _cairo_scaled_glyph_pin (scaled_font, scaled_glyph);
+	}
+    }
+
+ UNLOCK:
+    _cairo_scaled_font_thaw_cache (scaled_font);
+    return status;
+}
+
+/* A direct-mapped cache of the glyph and advance for each character,
+ * kept for the lifetime of the scaled font so that converting more text
+ * with the same font need neither ask the backend for the glyph index
+ * nor look the glyph up again. Latin-1, and so ASCII, maps without
+ * collisions; the rest of Unicode shares the same slots.
+ */
+#define GLYPH_LUT_SIZE 256
+struct _cairo_scaled_font_glyph_lut {
+    uint32_t unicode[GLYPH_LUT_SIZE];
+    struct glyph_lut_elt {
+	unsigned long index;
+	double x_advance;
+	double y_advance;
+    } elt[GLYPH_LUT_SIZE];
+};
+
+static void
+_cairo_scaled_font_create_glyph_lut (cairo_scaled_font_t *scaled_font)
+{
+    struct _cairo_scaled_font_glyph_lut *lut;
+    int i;
+
+    lut = _cairo_malloc (sizeof (struct _cairo_scaled_font_glyph_lut));
+    if (unlikely (lut == NULL))
+	return;
+
+    for (i = 0; i < GLYPH_LUT_SIZE; i++)
+	lut->unicode[i] = ~0U;
+
+    scaled_font->glyph_lut = lut;
+}
+
 static cairo_status_t
 cairo_scaled_font_text_to_glyphs_internal_cached (cairo_scaled_font_t		 *scaled_font,
 						    double			  x,
@@ -1684,19 +1906,11 @@ cairo_scaled_font_text_to_glyphs_internal_cached (cairo_scaled_font_t		 *scaled_
 						    cairo_text_cluster_t	**clusters,
 						    int				  num_chars)
 {
-    struct glyph_lut_elt {
-	unsigned long index;
-	double x_advance;
-	double y_advance;
-    } glyph_lut[GLYPH_LUT_SIZE];
-    uint32_t glyph_lut_unicode[GLYPH_LUT_SIZE];
+    struct _cairo_scaled_font_glyph_lut *lut = scaled_font->glyph_lut;
     cairo_status_t status;
     const char *p;
     int i;
 
-    for (i = 0; i < GLYPH_LUT_SIZE; i++)
-	glyph_lut_unicode[i] = ~0U;
-
     p = utf8;
     for (i = 0; i < num_chars; i++) {
 	int idx, num_bytes;
@@ -1710,9 +1924,9 @@ cairo_scaled_font_text_to_glyphs_internal_cached (cairo_scaled_font_t		 *scaled_
 	glyphs[i].x = x;
 	glyphs[i].y = y;
 
-	idx = unicode % ARRAY_LENGTH (glyph_lut);
-	glyph_slot = &glyph_lut[idx];
-	if (glyph_lut_unicode[idx] == unicode) {
+	idx = unicode % GLYPH_LUT_SIZE;
+	glyph_slot = &lut->elt[idx];
+	if (lut->unicode[idx] == unicode) {
 	    glyphs[i].index = glyph_slot->index;
 	    x += glyph_slot->x_advance;
 	    y += glyph_slot->y_advance;
@@ -1730,7 +1944,7 @@ cairo_scaled_font_text_to_glyphs_internal_cached (cairo_scaled_font_t		 *scaled_
 	    x += scaled_glyph->metrics.x_advance;
 	    y += scaled_glyph->metrics.y_advance;
 
-	    glyph_lut_unicode[idx] = unicode;
+	    lut->unicode[idx] = unicode;
 	    glyph_slot->index = g;
 	    glyph_slot->x_advance = scaled_glyph->metrics.x_advance;
 	    glyph_slot->y_advance = scaled_glyph->metrics.y_advance;
@@ -2091,7 +2305,14 @@ cairo_scaled_font_text_to_glyphs (cairo_scaled_font_t   *scaled_font,
 	*num_clusters = num_chars;
     }
 
-    if (num_chars > CACHING_THRESHOLD)
+    /* Only fonts used for longer runs of text get a cache, but once
+     * they have one it is worth using for any string. If it cannot be
+     * allocated, just do without.
+     */
+    if (scaled_font->glyph_lut == NULL && num_chars > CACHING_THRESHOLD)
+	_cairo_scaled_font_create_glyph_lut (scaled_font);
+
+    if (scaled_font->glyph_lut != NULL && num_chars > 1)
 	status = cairo_scaled_font_text_to_glyphs_internal_cached (scaled_font,
 								     x, y,
 								     utf8,
@@ -2173,12 +2394,20 @@ _cairo_scaled_font_single_glyph_device_extents (cairo_scaled_font_t	 *scaled_fon
 	cairo_box_t box;
 	cairo_fixed_t v;
 
-	if (round_xy)
-	    v = _cairo_fixed_from_int (_cairo_lround (glyph->x));
-	else
+	if (scaled_font->subpixel_positions) {
+	    /* The phase the glyph is rendered at is within a quarter
+	     * pixel of its position, but hinting may widen the coverage. */
 	    v = _cairo_fixed_from_double (glyph->x);
-	box.p1.x = v + scaled_glyph->bbox.p1.x;
-	box.p2.x = v + scaled_glyph->bbox.p2.x;
+	    box.p1.x = v + scaled_glyph->bbox.p1.x - CAIRO_FIXED_ONE;
+	    box.p2.x = v + scaled_glyph->bbox.p2.x + CAIRO_FIXED_ONE;
+	} else {
+	    if (round_xy)
+		v = _cairo_fixed_from_int (_cairo_lround (glyph->x));
+	    else
+		v = _cairo_fixed_from_double (glyph->x);
+	    box.p1.x = v + scaled_glyph->bbox.p1.x;
+	    box.p2.x = v + scaled_glyph->bbox.p2.x;
+	}
 
 	if (round_xy)
 	    v = _cairo_fixed_from_int (_cairo_lround (glyph->y));
@@ -2244,12 +2473,19 @@ _cairo_scaled_font_glyph_device_extents (cairo_scaled_font_t	 *scaled_font,
 	    glyph_cache[cache_index] = scaled_glyph;
 	}
 
-	if (round_glyph_positions == CAIRO_ROUND_GLYPH_POS_ON)
-	    x = _cairo_fixed_from_int (_cairo_lround (glyphs[i].x));
-	else
+	if (scaled_font->subpixel_positions) {
+	    /* see _cairo_scaled_font_single_glyph_device_extents() */
 	    x = _cairo_fixed_from_double (glyphs[i].x);
-	x1 = x + scaled_glyph->bbox.p1.x;
-	x2 = x + scaled_glyph->bbox.p2.x;
+	    x1 = x + scaled_glyph->bbox.p1.x - CAIRO_FIXED_ONE;
+	    x2 = x + scaled_glyph->bbox.p2.x + CAIRO_FIXED_ONE;
+	} else {
+	    if (round_glyph_positions == CAIRO_ROUND_GLYPH_POS_ON)
+		x = _cairo_fixed_from_int (_cairo_lround (glyphs[i].x));
+	    else
+		x = _cairo_fixed_from_double (glyphs[i].x);
+	    x1 = x + scaled_glyph->bbox.p1.x;
+	    x2 = x + scaled_glyph->bbox.p2.x;
+	}
 
 	if (round_glyph_positions == CAIRO_ROUND_GLYPH_POS_ON)
 	    y = _cairo_fixed_from_int (_cairo_lround (glyphs[i].y));
@@ -2825,7 +3061,7 @@ _cairo_scaled_glyph_page_can_remove (const void *closure)
     const cairo_scaled_font_t *scaled_font;
 
     scaled_font = (cairo_scaled_font_t *) page->cache_entry.hash;
-    return scaled_font->cache_frozen == 0;
+    return scaled_font->cache_frozen == 0 && page->num_pinned == 0;
 }
 
 static cairo_status_t
@@ -2854,6 +3090,7 @@ _cairo_scaled_font_allocate_glyph (cairo_scaled_font_t *scaled_font,
 
     page->cache_entry.hash = (unsigned long) scaled_font;
     page->cache_entry.size = 1; /* XXX occupancy weighting? */
+    page->num_pinned = 0;
     page->num_glyphs = 0;
 
     CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
@@ -2951,6 +3188,7 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
     cairo_int_status_t		 status = CAIRO_INT_STATUS_SUCCESS;
     cairo_scaled_glyph_t	*scaled_glyph;
     cairo_scaled_glyph_info_t	 need_info;
+    cairo_observer_stage_t	 stage;
 
     *scaled_glyph_ret = NULL;
 
@@ -2978,10 +3216,12 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
 	cairo_list_init (&scaled_glyph->dev_privates);
 
 	/* ask backend to initialize metrics and shape fields */
+	stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_GLYPHS);
 	status =
 	    scaled_font->backend->scaled_glyph_init (scaled_font,
 						     scaled_glyph,
 						     info | CAIRO_SCALED_GLYPH_INFO_METRICS);
+	_cairo_observer_stage_leave (stage);
 	if (unlikely (status)) {
 	    _cairo_scaled_font_free_last_glyph (scaled_font, scaled_glyph);
 	    goto err;
@@ -3001,9 +3241,11 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
      */
     need_info = info & ~scaled_glyph->has_info;
     if (need_info) {
+	stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_GLYPHS);
 	status = scaled_font->backend->scaled_glyph_init (scaled_font,
 							  scaled_glyph,
 							  need_info);
+	_cairo_observer_stage_leave (stage);
 	if (unlikely (status))
 	    goto err;
 
@@ -737,8 +737,13 @@ composite_boxes (const cairo_spans_compositor_t *compositor,
 
     status = compositor->renderer_init (&renderer, extents,
 					CAIRO_ANTIALIAS_DEFAULT, FALSE);
-    if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+    if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+	cairo_observer_stage_t stage;
+
+	stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_RASTERISE);
 	status = converter.base.generate (&converter.base, &renderer.base);
+	_cairo_observer_stage_leave (stage);
+    }
     compositor->renderer_fini (&renderer, status);
 
 cleanup_converter:
@@ -797,8 +802,13 @@ composite_polygon (const cairo_spans_compositor_t	*compositor,
 
     status = compositor->renderer_init (&renderer, extents,
 					antialias, needs_clip);
-    if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+    if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+	cairo_observer_stage_t stage;
+
+	stage = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_RASTERISE);
 	status = converter->generate (converter, &renderer.base);
+	_cairo_observer_stage_leave (stage);
+    }
     compositor->renderer_fini (&renderer, status);
 
 cleanup_converter:
@@ -43,6 +43,7 @@
 #include "cairo-recording-surface-private.h"
 #include "cairo-surface-private.h"
 #include "cairo-surface-backend-private.h"
+#include "cairo-surface-observer-stage-private.h"
 #include "cairo-time-private.h"
 
 struct stat {
@@ -111,6 +112,8 @@ struct _cairo_observation {
 	struct clip clip;
 	unsigned int noop;
 
+	cairo_time_t stages[CAIRO_OBSERVER_NUM_STAGES];
+
 	cairo_observation_record_t slowest;
     } paint;
 
@@ -124,6 +127,8 @@ struct _cairo_observation {
 	struct clip clip;
 	unsigned int noop;
 
+	cairo_time_t stages[CAIRO_OBSERVER_NUM_STAGES];
+
 	cairo_observation_record_t slowest;
     } mask;
 
@@ -139,6 +144,8 @@ struct _cairo_observation {
 	struct clip clip;
 	unsigned int noop;
 
+	cairo_time_t stages[CAIRO_OBSERVER_NUM_STAGES];
+
 	cairo_observation_record_t slowest;
     } fill;
 
@@ -156,6 +163,8 @@ struct _cairo_observation {
 	struct clip clip;
 	unsigned int noop;
 
+	cairo_time_t stages[CAIRO_OBSERVER_NUM_STAGES];
+
 	cairo_observation_record_t slowest;
     } stroke;
 
@@ -168,6 +177,8 @@ struct _cairo_observation {
 	struct clip clip;
 	unsigned int noop;
 
+	cairo_time_t stages[CAIRO_OBSERVER_NUM_STAGES];
+
 	cairo_observation_record_t slowest;
     } glyphs;
 
@@ -179,6 +190,7 @@ struct _cairo_device_observer {
     cairo_device_t base;
     cairo_device_t *target;
 
+    cairo_bool_t record_stages;
     cairo_observation_t log;
 };
 
@@ -0,0 +1,96 @@
+/* cairo - a vector graphics library with display and print output
+ *
+ * Copyright © 2026 The cairo authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it either under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * (the "LGPL") or, at your option, under the terms of the Mozilla
+ * Public License Version 1.1 (the "MPL"). If you do not alter this
+ * notice, a recipient may use your version of this file under either
+ * the MPL or the LGPL.
+ *
+ * You should have received a copy of the LGPL along with this library
+ * in the file COPYING-LGPL-2.1; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA 02110-1335, USA
+ * You should have received a copy of the MPL along with this library
+ * in the file COPYING-MPL-1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY
+ * OF ANY KIND, either express or implied. See the LGPL or the MPL for
+ * the specific language governing rights and limitations.
+ *
+ * The Original Code is the cairo graphics library.
+ *
+ * The Initial Developer of the Original Code is the cairo authors.
+ */
+
+#ifndef CAIRO_SURFACE_OBSERVER_STAGE_PRIVATE_H
+#define CAIRO_SURFACE_OBSERVER_STAGE_PRIVATE_H
+
+#include "cairoint.h"
+
+#include "cairo-atomic-private.h"
+
+/* The pipeline stages to which an operation's time is attributed when
+ * the observer is created with CAIRO_SURFACE_OBSERVER_RECORD_STAGES.
+ * Each stage only accumulates its own time; time spent in a nested
+ * stage, e.g. acquiring the source whilst compositing, is charged to
+ * the inner stage alone.
+ */
+typedef enum _cairo_observer_stage {
+    CAIRO_OBSERVER_STAGE_INACTIVE = -2,
+    CAIRO_OBSERVER_STAGE_NONE = -1,
+
+    CAIRO_OBSERVER_STAGE_PATH = 0,	/* flattening and stroking */
+    CAIRO_OBSERVER_STAGE_TESSELLATE,	/* Bentley-Ottmann */
+    CAIRO_OBSERVER_STAGE_RASTERISE,	/* scan conversion */
+    CAIRO_OBSERVER_STAGE_SOURCE,	/* pattern acquisition */
+    CAIRO_OBSERVER_STAGE_COMPOSITE,
+    CAIRO_OBSERVER_STAGE_GLYPHS	/* glyph rasterisation */
+} cairo_observer_stage_t;
+
+#define CAIRO_OBSERVER_NUM_STAGES (CAIRO_OBSERVER_STAGE_GLYPHS+1)
+
+/* Non-zero whilst an observed operation is being broken into stages */
+cairo_private extern cairo_atomic_int_t _cairo_observer_stages_active;
+
+cairo_private cairo_observer_stage_t
+_cairo_observer_stage_enter_slow (cairo_observer_stage_t stage);
+
+cairo_private void
+_cairo_observer_stage_leave_slow (cairo_observer_stage_t prev);
+
+/* Bracket a stage of the rendering pipeline:
+ *
+ *	prev = _cairo_observer_stage_enter (CAIRO_OBSERVER_STAGE_...);
+ *	...
+ *	_cairo_observer_stage_leave (prev);
+ *
+ * Both are a single load and test unless a stage-recording observer is
+ * currently running an operation.
+ */
+static inline cairo_observer_stage_t
+_cairo_observer_stage_enter (cairo_observer_stage_t stage)
+{
+    if (likely (! _cairo_atomic_int_get (&_cairo_observer_stages_active)))
+	return CAIRO_OBSERVER_STAGE_INACTIVE;
+
+    return _cairo_observer_stage_enter_slow (stage);
+}
+
+static inline void
+_cairo_observer_stage_leave (cairo_observer_stage_t prev)
+{
+    if (likely (prev == CAIRO_OBSERVER_STAGE_INACTIVE))
+	return;
+
+    _cairo_observer_stage_leave_slow (prev);
+}
+
+#endif /* CAIRO_SURFACE_OBSERVER_STAGE_PRIVATE_H */
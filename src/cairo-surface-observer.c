@@ -284,6 +284,122 @@ add_extents (struct extents *stats,
 
 /* device interface */
 
+/* pipeline stages */
+
+cairo_atomic_int_t _cairo_observer_stages_active;
+
+/* _cairo_observer_stages_active whilst the owner is being set up */
+#define CAIRO_OBSERVER_STAGES_CLAIMED 2
+
+/* Only one operation at a time is broken into stages; the state is
+ * global as the stages are entered deep inside the backends which have
+ * no knowledge of the observer. It belongs to the thread running that
+ * operation, and stages entered by any other thread are ignored.
+ */
+#if CAIRO_MUTEX_IMPL_PTHREAD
+typedef pthread_t cairo_observer_thread_t;
+#define _cairo_observer_thread_self() pthread_self ()
+#define _cairo_observer_thread_equal(a, b) pthread_equal (a, b)
+#elif CAIRO_MUTEX_IMPL_WIN32
+typedef DWORD cairo_observer_thread_t;
+#define _cairo_observer_thread_self() GetCurrentThreadId ()
+#define _cairo_observer_thread_equal(a, b) ((a) == (b))
+#else
+typedef int cairo_observer_thread_t;
+#define _cairo_observer_thread_self() 0
+#define _cairo_observer_thread_equal(a, b) TRUE
+#endif
+
+static struct {
+    cairo_time_t elapsed[CAIRO_OBSERVER_NUM_STAGES];
+    cairo_observer_stage_t current;
+    cairo_time_t start;
+    cairo_observer_thread_t owner;
+} _cairo_observer_stages;
+
+cairo_observer_stage_t
+_cairo_observer_stage_enter_slow (cairo_observer_stage_t stage)
+{
+    cairo_observer_stage_t prev;
+    cairo_time_t now;
+
+    if (_cairo_atomic_int_get (&_cairo_observer_stages_active) != 1 ||
+	! _cairo_observer_thread_equal (_cairo_observer_stages.owner,
+					_cairo_observer_thread_self ()))
+	return CAIRO_OBSERVER_STAGE_INACTIVE;
+
+    now = _cairo_time_get ();
+    prev = _cairo_observer_stages.current;
+    if (prev != CAIRO_OBSERVER_STAGE_NONE) {
+	_cairo_observer_stages.elapsed[prev] =
+	    _cairo_time_add (_cairo_observer_stages.elapsed[prev],
+			     _cairo_time_sub (now, _cairo_observer_stages.start));
+    }
+
+    _cairo_observer_stages.current = stage;
+    _cairo_observer_stages.start = now;
+
+    return prev;
+}
+
+void
+_cairo_observer_stage_leave_slow (cairo_observer_stage_t prev)
+{
+    cairo_observer_stage_t stage;
+    cairo_time_t now;
+
+    now = _cairo_time_get ();
+    stage = _cairo_observer_stages.current;
+    if (stage != CAIRO_OBSERVER_STAGE_NONE) {
+	_cairo_observer_stages.elapsed[stage] =
+	    _cairo_time_add (_cairo_observer_stages.elapsed[stage],
+			     _cairo_time_sub (now, _cairo_observer_stages.start));
+    }
+
+    _cairo_observer_stages.current = prev;
+    _cairo_observer_stages.start = now;
+}
+
+static cairo_bool_t
+stages_begin (cairo_device_observer_t *device)
+{
+    if (! device->record_stages)
+	return FALSE;
+
+    /* A nested or concurrent operation is timed as a whole */
+    if (! _cairo_atomic_int_cmpxchg (&_cairo_observer_stages_active,
+				     0, CAIRO_OBSERVER_STAGES_CLAIMED))
+	return FALSE;
+
+    memset (_cairo_observer_stages.elapsed, 0,
+	    sizeof (_cairo_observer_stages.elapsed));
+    _cairo_observer_stages.current = CAIRO_OBSERVER_STAGE_NONE;
+    _cairo_observer_stages.owner = _cairo_observer_thread_self ();
+    _cairo_observer_stages.start = _cairo_time_get ();
+
+    /* only now may the stages be entered, by the owner */
+    _cairo_atomic_int_cmpxchg (&_cairo_observer_stages_active,
+			       CAIRO_OBSERVER_STAGES_CLAIMED, 1);
+
+    return TRUE;
+}
+
+static void
+stages_end (cairo_time_t *surface_stages,
+	    cairo_time_t *device_stages)
+{
+    int n;
+
+    for (n = 0; n < CAIRO_OBSERVER_NUM_STAGES; n++) {
+	cairo_time_t t = _cairo_observer_stages.elapsed[n];
+
+	surface_stages[n] = _cairo_time_add (surface_stages[n], t);
+	device_stages[n] = _cairo_time_add (device_stages[n], t);
+    }
+
+    _cairo_atomic_int_cmpxchg (&_cairo_observer_stages_active, 1, 0);
+}
+
 static void
 _cairo_device_observer_lock (void *_device)
 {
@@ -343,7 +459,8 @@ static const cairo_device_backend_t _cairo_device_observer_backend = {
 
 static cairo_device_t *
 _cairo_device_create_observer_internal (cairo_device_t *target,
-					cairo_bool_t record)
+					cairo_bool_t record,
+					cairo_bool_t record_stages)
 {
     cairo_device_observer_t *device;
     cairo_status_t status;
@@ -360,6 +477,7 @@ _cairo_device_create_observer_internal (cairo_device_t *target,
     }
 
     device->target = cairo_device_reference (target);
+    device->record_stages = record_stages;
 
     return &device->base;
 }
@@ -715,6 +833,7 @@ _cairo_surface_observer_paint (void *abstract_surface,
     cairo_composite_rectangles_t composite;
     cairo_int_status_t status;
     cairo_time_t t;
+    cairo_bool_t staged;
     int x, y;
 
     /* XXX device locking */
@@ -745,10 +864,13 @@ _cairo_surface_observer_paint (void *abstract_surface,
     add_extents (&device->log.paint.extents, &composite);
     _cairo_composite_rectangles_fini (&composite);
 
+    staged = stages_begin (device);
     t = _cairo_time_get ();
     status = _cairo_surface_paint (surface->target,
 				   op, source,
 				   clip);
+    if (staged)
+	stages_end (surface->log.paint.stages, device->log.paint.stages);
     if (unlikely (status))
 	return status;
 
@@ -801,6 +923,7 @@ _cairo_surface_observer_mask (void *abstract_surface,
     cairo_composite_rectangles_t composite;
     cairo_int_status_t status;
     cairo_time_t t;
+    cairo_bool_t staged;
     int x, y;
 
     surface->log.mask.count++;
@@ -831,10 +954,13 @@ _cairo_surface_observer_mask (void *abstract_surface,
     add_extents (&device->log.mask.extents, &composite);
     _cairo_composite_rectangles_fini (&composite);
 
+    staged = stages_begin (device);
     t = _cairo_time_get ();
     status =  _cairo_surface_mask (surface->target,
 				   op, source, mask,
 				   clip);
+    if (staged)
+	stages_end (surface->log.mask.stages, device->log.mask.stages);
     if (unlikely (status))
 	return status;
 
@@ -903,6 +1029,7 @@ _cairo_surface_observer_fill (void			*abstract_surface,
     cairo_composite_rectangles_t composite;
     cairo_int_status_t status;
     cairo_time_t t;
+    cairo_bool_t staged;
     int x, y;
 
     surface->log.fill.count++;
@@ -937,11 +1064,14 @@ _cairo_surface_observer_fill (void			*abstract_surface,
     add_extents (&device->log.fill.extents, &composite);
     _cairo_composite_rectangles_fini (&composite);
 
+    staged = stages_begin (device);
     t = _cairo_time_get ();
     status = _cairo_surface_fill (surface->target,
 				  op, source, path,
 				  fill_rule, tolerance, antialias,
 				  clip);
+    if (staged)
+	stages_end (surface->log.fill.stages, device->log.fill.stages);
     if (unlikely (status))
 	return status;
 
@@ -1018,6 +1148,7 @@ _cairo_surface_observer_stroke (void				*abstract_surface,
     cairo_composite_rectangles_t composite;
     cairo_int_status_t status;
     cairo_time_t t;
+    cairo_bool_t staged;
     int x, y;
 
     surface->log.stroke.count++;
@@ -1055,12 +1186,15 @@ _cairo_surface_observer_stroke (void				*abstract_surface,
     add_extents (&device->log.stroke.extents, &composite);
     _cairo_composite_rectangles_fini (&composite);
 
+    staged = stages_begin (device);
     t = _cairo_time_get ();
     status = _cairo_surface_stroke (surface->target,
 				  op, source, path,
 				  style, ctm, ctm_inverse,
 				  tolerance, antialias,
 				  clip);
+    if (staged)
+	stages_end (surface->log.stroke.stages, device->log.stroke.stages);
     if (unlikely (status))
 	return status;
 
@@ -1135,6 +1269,7 @@ _cairo_surface_observer_glyphs (void			*abstract_surface,
     cairo_int_status_t status;
     cairo_glyph_t *dev_glyphs;
     cairo_time_t t;
+    cairo_bool_t staged;
     int x, y;
 
     surface->log.glyphs.count++;
@@ -1173,6 +1308,7 @@ _cairo_surface_observer_glyphs (void			*abstract_surface,
 	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
     memcpy (dev_glyphs, glyphs, num_glyphs * sizeof (cairo_glyph_t));
 
+    staged = stages_begin (device);
     t = _cairo_time_get ();
     status = _cairo_surface_show_text_glyphs (surface->target, op, source,
 					      NULL, 0,
@@ -1180,6 +1316,8 @@ _cairo_surface_observer_glyphs (void			*abstract_surface,
 					      NULL, 0, 0,
 					      scaled_font,
 					      clip);
+    if (staged)
+	stages_end (surface->log.glyphs.stages, device->log.glyphs.stages);
     free (dev_glyphs);
     if (unlikely (status))
 	return status;
@@ -1395,7 +1533,7 @@ cairo_surface_create_observer (cairo_surface_t *target,
 {
     cairo_device_t *device;
     cairo_surface_t *surface;
-    cairo_bool_t record;
+    cairo_bool_t record, record_stages;
 
     if (unlikely (target->status))
 	return _cairo_surface_create_in_error (target->status);
@@ -1403,7 +1541,9 @@ cairo_surface_create_observer (cairo_surface_t *target,
 	return _cairo_surface_create_in_error (_cairo_error (CAIRO_STATUS_SURFACE_FINISHED));
 
     record = mode & CAIRO_SURFACE_OBSERVER_RECORD_OPERATIONS;
-    device = _cairo_device_create_observer_internal (target->device, record);
+    record_stages = mode & CAIRO_SURFACE_OBSERVER_RECORD_STAGES;
+    device = _cairo_device_create_observer_internal (target->device,
+						     record, record_stages);
     if (unlikely (device->status))
 	return _cairo_surface_create_in_error (device->status);
 
@@ -1780,6 +1920,68 @@ static double percent (cairo_time_t a, cairo_time_t b)
 			 _cairo_time_to_s (b)) / 10;
 }
 
+static const char *stage_names[] = {
+    "path",		/* CAIRO_OBSERVER_STAGE_PATH */
+    "tessellate",	/* CAIRO_OBSERVER_STAGE_TESSELLATE */
+    "rasterise",	/* CAIRO_OBSERVER_STAGE_RASTERISE */
+    "source",		/* CAIRO_OBSERVER_STAGE_SOURCE */
+    "composite",	/* CAIRO_OBSERVER_STAGE_COMPOSITE */
+    "glyphs",		/* CAIRO_OBSERVER_STAGE_GLYPHS */
+};
+
+static cairo_bool_t
+has_stages (const cairo_time_t *stages)
+{
+    int n;
+
+    for (n = 0; n < CAIRO_OBSERVER_NUM_STAGES; n++) {
+	if (! _cairo_int64_is_zero (stages[n]))
+	    return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* The time of an operation not spent in any of the stages */
+static cairo_time_t
+stages_other (const cairo_time_t *stages, cairo_time_t elapsed)
+{
+    int n;
+
+    for (n = 0; n < CAIRO_OBSERVER_NUM_STAGES; n++)
+	elapsed = _cairo_time_sub (elapsed, stages[n]);
+
+    /* the operation's own timer also covers the sync */
+    if (_cairo_int64_negative (elapsed))
+	elapsed = _cairo_int32_to_int64 (0);
+
+    return elapsed;
+}
+
+static void
+print_stages (cairo_output_stream_t *stream,
+	      const cairo_time_t *stages,
+	      cairo_time_t elapsed)
+{
+    cairo_time_t other;
+    int n;
+
+    if (! has_stages (stages))
+	return;
+
+    _cairo_output_stream_printf (stream, "  stages:");
+    for (n = 0; n < CAIRO_OBSERVER_NUM_STAGES; n++) {
+	_cairo_output_stream_printf (stream, " %s %f [%f%%],",
+				     stage_names[n],
+				     _cairo_time_to_ns (stages[n]),
+				     percent (stages[n], elapsed));
+    }
+    other = stages_other (stages, elapsed);
+    _cairo_output_stream_printf (stream, " other %f [%f%%]\n",
+				 _cairo_time_to_ns (other),
+				 percent (other, elapsed));
+}
+
 static cairo_bool_t
 replay_record (cairo_observation_t *log,
 	       cairo_observation_record_t *r,
@@ -1857,6 +2059,7 @@ _cairo_observation_print (cairo_output_stream_t *stream,
 	print_operators (stream, log->paint.operators);
 	print_pattern (stream, "source", &log->paint.source);
 	print_clip (stream, &log->paint.clip);
+	print_stages (stream, log->paint.stages, log->paint.elapsed);
 
 	_cairo_output_stream_printf (stream, "slowest paint: %f%%\n",
 				     percent (log->paint.slowest.elapsed,
@@ -1878,6 +2081,7 @@ _cairo_observation_print (cairo_output_stream_t *stream,
 	print_pattern (stream, "source", &log->mask.source);
 	print_pattern (stream, "mask", &log->mask.mask);
 	print_clip (stream, &log->mask.clip);
+	print_stages (stream, log->mask.stages, log->mask.elapsed);
 
 	_cairo_output_stream_printf (stream, "slowest mask: %f%%\n",
 				     percent (log->mask.slowest.elapsed,
@@ -1901,6 +2105,7 @@ _cairo_observation_print (cairo_output_stream_t *stream,
 	print_fill_rule (stream, log->fill.fill_rule);
 	print_antialias (stream, log->fill.antialias);
 	print_clip (stream, &log->fill.clip);
+	print_stages (stream, log->fill.stages, log->fill.elapsed);
 
 	_cairo_output_stream_printf (stream, "slowest fill: %f%%\n",
 				     percent (log->fill.slowest.elapsed,
@@ -1925,6 +2130,7 @@ _cairo_observation_print (cairo_output_stream_t *stream,
 	print_line_caps (stream, log->stroke.caps);
 	print_line_joins (stream, log->stroke.joins);
 	print_clip (stream, &log->stroke.clip);
+	print_stages (stream, log->stroke.stages, log->stroke.elapsed);
 
 	_cairo_output_stream_printf (stream, "slowest stroke: %f%%\n",
 				     percent (log->stroke.slowest.elapsed,
@@ -1945,6 +2151,7 @@ _cairo_observation_print (cairo_output_stream_t *stream,
 	print_operators (stream, log->glyphs.operators);
 	print_pattern (stream, "source", &log->glyphs.source);
 	print_clip (stream, &log->glyphs.clip);
+	print_stages (stream, log->glyphs.stages, log->glyphs.elapsed);
 
 	_cairo_output_stream_printf (stream, "slowest glyphs: %f%%\n",
 				     percent (log->glyphs.slowest.elapsed,
@@ -1959,6 +2166,69 @@ _cairo_observation_print (cairo_output_stream_t *stream,
     cairo_device_destroy (script);
 }
 
+static void
+print_json_operation (cairo_output_stream_t *stream,
+		      const char *name,
+		      unsigned int count,
+		      unsigned int noop,
+		      cairo_time_t elapsed,
+		      const cairo_time_t *stages,
+		      cairo_bool_t last)
+{
+    int n;
+
+    _cairo_output_stream_printf (stream,
+				 "    \"%s\": {\"count\": %d, \"noop\": %d, \"elapsed\": %f",
+				 name, count, noop,
+				 _cairo_time_to_ns (elapsed));
+    if (has_stages (stages)) {
+	_cairo_output_stream_printf (stream, ", \"stages\": {");
+	for (n = 0; n < CAIRO_OBSERVER_NUM_STAGES; n++) {
+	    _cairo_output_stream_printf (stream, "\"%s\": %f, ",
+					 stage_names[n],
+					 _cairo_time_to_ns (stages[n]));
+	}
+	_cairo_output_stream_printf (stream, "\"other\": %f}",
+				     _cairo_time_to_ns (stages_other (stages,
+								      elapsed)));
+    }
+    _cairo_output_stream_printf (stream, "}%s\n", last ? "" : ",");
+}
+
+/* All times are in nanoseconds */
+static void
+_cairo_observation_print_json (cairo_output_stream_t *stream,
+			       cairo_observation_t *log)
+{
+    _cairo_output_stream_printf (stream, "{\n");
+    _cairo_output_stream_printf (stream, "  \"elapsed\": %f,\n",
+				 _cairo_time_to_ns (_cairo_observation_total_elapsed (log)));
+    _cairo_output_stream_printf (stream, "  \"surfaces\": %d,\n",
+				 log->num_surfaces);
+    _cairo_output_stream_printf (stream, "  \"contexts\": %d,\n",
+				 log->num_contexts);
+    _cairo_output_stream_printf (stream, "  \"sources_acquired\": %d,\n",
+				 log->num_sources_acquired);
+    _cairo_output_stream_printf (stream, "  \"operations\": {\n");
+    print_json_operation (stream, "paint",
+			  log->paint.count, log->paint.noop,
+			  log->paint.elapsed, log->paint.stages, FALSE);
+    print_json_operation (stream, "mask",
+			  log->mask.count, log->mask.noop,
+			  log->mask.elapsed, log->mask.stages, FALSE);
+    print_json_operation (stream, "fill",
+			  log->fill.count, log->fill.noop,
+			  log->fill.elapsed, log->fill.stages, FALSE);
+    print_json_operation (stream, "stroke",
+			  log->stroke.count, log->stroke.noop,
+			  log->stroke.elapsed, log->stroke.stages, FALSE);
+    print_json_operation (stream, "glyphs",
+			  log->glyphs.count, log->glyphs.noop,
+			  log->glyphs.elapsed, log->glyphs.stages, TRUE);
+    _cairo_output_stream_printf (stream, "  }\n");
+    _cairo_output_stream_printf (stream, "}\n");
+}
+
 cairo_status_t
 cairo_surface_observer_print (cairo_surface_t *abstract_surface,
 			      cairo_write_func_t write_func,
@@ -1980,6 +2250,44 @@ cairo_surface_observer_print (cairo_surface_t *abstract_surface,
     return _cairo_output_stream_destroy (stream);
 }
 
+/**
+ * cairo_surface_observer_print_json:
+ * @surface: a #cairo_surface_t created by cairo_surface_create_observer()
+ * @write_func: a #cairo_write_func_t
+ * @closure: closure data for the write function
+ *
+ * Writes the counts and timings gathered by the observer as a JSON
+ * object, suitable for consumption by other tools. All times are in
+ * nanoseconds. If the observer was created with
+ * %CAIRO_SURFACE_OBSERVER_RECORD_STAGES, each operation also carries
+ * the time spent in each stage of the rendering pipeline.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS, or an error if @surface is not
+ * an observer or writing fails.
+ *
+ * Since: 1.16
+ **/
+cairo_status_t
+cairo_surface_observer_print_json (cairo_surface_t *abstract_surface,
+				   cairo_write_func_t write_func,
+				   void *closure)
+{
+    cairo_output_stream_t *stream;
+    cairo_surface_observer_t *surface;
+
+    if (unlikely (abstract_surface->status))
+	return abstract_surface->status;
+
+    if (unlikely (! _cairo_surface_is_observer (abstract_surface)))
+	return _cairo_error (CAIRO_STATUS_SURFACE_TYPE_MISMATCH);
+
+    surface = (cairo_surface_observer_t *) abstract_surface;
+
+    stream = _cairo_output_stream_create (write_func, NULL, closure);
+    _cairo_observation_print_json (stream, &surface->log);
+    return _cairo_output_stream_destroy (stream);
+}
+
 double
 cairo_surface_observer_elapsed (cairo_surface_t *abstract_surface)
 {
@@ -2016,6 +2324,41 @@ cairo_device_observer_print (cairo_device_t *abstract_device,
     return _cairo_output_stream_destroy (stream);
 }
 
+/**
+ * cairo_device_observer_print_json:
+ * @device: the #cairo_device_t of an observer surface
+ * @write_func: a #cairo_write_func_t
+ * @closure: closure data for the write function
+ *
+ * Like cairo_surface_observer_print_json(), but for all the surfaces
+ * sharing the observer @device.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS, or an error if @device is not
+ * an observer or writing fails.
+ *
+ * Since: 1.16
+ **/
+cairo_status_t
+cairo_device_observer_print_json (cairo_device_t *abstract_device,
+				  cairo_write_func_t write_func,
+				  void *closure)
+{
+    cairo_output_stream_t *stream;
+    cairo_device_observer_t *device;
+
+    if (unlikely (abstract_device->status))
+	return abstract_device->status;
+
+    if (unlikely (! _cairo_device_is_observer (abstract_device)))
+	return _cairo_error (CAIRO_STATUS_DEVICE_TYPE_MISMATCH);
+
+    device = (cairo_device_observer_t *) abstract_device;
+
+    stream = _cairo_output_stream_create (write_func, NULL, closure);
+    _cairo_observation_print_json (stream, &device->log);
+    return _cairo_output_stream_destroy (stream);
+}
+
 double
 cairo_device_observer_elapsed (cairo_device_t *abstract_device)
 {
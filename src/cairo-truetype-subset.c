@@ -163,24 +163,24 @@ _cairo_truetype_font_create (cairo_scaled_font_subset_t  *scaled_font_subset,
        return CAIRO_INT_STATUS_UNSUPPORTED;
 
     size = sizeof (tt_head_t);
-    status = backend->load_truetype_table (scaled_font_subset->scaled_font,
-                                          TT_TAG_head, 0,
+    status = _cairo_font_table_cache_load (scaled_font_subset->scaled_font,
+					  TT_TAG_head, 0,
 					  (unsigned char *) &head,
-                                          &size);
+					  &size);
     if (unlikely (status))
 	return status;
 
     size = sizeof (tt_maxp_t);
-    status = backend->load_truetype_table (scaled_font_subset->scaled_font,
-                                           TT_TAG_maxp, 0,
+    status = _cairo_font_table_cache_load (scaled_font_subset->scaled_font,
+					   TT_TAG_maxp, 0,
 					   (unsigned char *) &maxp,
 					   &size);
     if (unlikely (status))
 	return status;
 
     size = sizeof (tt_hhea_t);
-    status = backend->load_truetype_table (scaled_font_subset->scaled_font,
-                                           TT_TAG_hhea, 0,
+    status = _cairo_font_table_cache_load (scaled_font_subset->scaled_font,
+					   TT_TAG_hhea, 0,
 					   (unsigned char *) &hhea,
 					   &size);
     if (unlikely (status))
@@ -509,8 +509,8 @@ cairo_truetype_font_write_generic_table (cairo_truetype_font_t *font,
 	return font->status;
 
     size = 0;
-    status = font->backend->load_truetype_table(font->scaled_font_subset->scaled_font,
-					        tag, 0, NULL, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   tag, 0, NULL, &size);
     if (unlikely (status))
         return _cairo_truetype_font_set_error (font, status);
 
@@ -518,8 +518,8 @@ cairo_truetype_font_write_generic_table (cairo_truetype_font_t *font,
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-						 tag, 0, buffer, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   tag, 0, buffer, &size);
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
@@ -587,11 +587,13 @@ cairo_truetype_font_write_glyf_table (cairo_truetype_font_t *font,
     tt_head_t header;
     unsigned long begin, end;
     unsigned char *buffer;
+    const unsigned char *glyf;
+    unsigned long glyf_size, loca_size;
     unsigned int i;
     union {
-	unsigned char *bytes;
-	uint16_t      *short_offsets;
-	uint32_t      *long_offsets;
+	const unsigned char *bytes;
+	const uint16_t      *short_offsets;
+	const uint32_t      *long_offsets;
     } u;
     cairo_status_t status;
 
@@ -599,9 +601,9 @@ cairo_truetype_font_write_glyf_table (cairo_truetype_font_t *font,
 	return font->status;
 
     size = sizeof (tt_head_t);
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-						 TT_TAG_head, 0,
-						 (unsigned char*) &header, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   TT_TAG_head, 0,
+					   (unsigned char*) &header, &size);
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
@@ -610,15 +612,22 @@ cairo_truetype_font_write_glyf_table (cairo_truetype_font_t *font,
     else
 	size = sizeof (int32_t) * (font->num_glyphs_in_face + 1);
 
-    u.bytes = malloc (size);
-    if (unlikely (u.bytes == NULL))
-	return _cairo_truetype_font_set_error (font, CAIRO_STATUS_NO_MEMORY);
-
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                                 TT_TAG_loca, 0, u.bytes, &size);
+    /* The loca and glyf tables are read in place from the cache */
+    status = _cairo_font_table_cache_get (font->scaled_font_subset->scaled_font,
+					  TT_TAG_loca, &u.bytes, &loca_size);
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
+    status = _cairo_font_table_cache_get (font->scaled_font_subset->scaled_font,
+					  TT_TAG_glyf, &glyf, &glyf_size);
+    if (unlikely (status))
+	goto FAIL_LOCA;
+
+    if (loca_size < size) {
+	status = CAIRO_INT_STATUS_UNSUPPORTED;
+	goto FAIL;
+    }
+
     start_offset = _cairo_array_num_elements (&font->output);
     for (i = 0; i < font->base.num_glyphs; i++) {
 	index = font->glyphs[i].parent_index;
@@ -632,7 +641,7 @@ cairo_truetype_font_write_glyf_table (cairo_truetype_font_t *font,
 	}
 
 	/* quick sanity check... */
-	if (end < begin) {
+	if (end < begin || end > glyf_size) {
 	    status = CAIRO_INT_STATUS_UNSUPPORTED;
 	    goto FAIL;
 	}
@@ -653,10 +662,7 @@ cairo_truetype_font_write_glyf_table (cairo_truetype_font_t *font,
 	    goto FAIL;
 
         if (size != 0) {
-            status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-							 TT_TAG_glyf, begin, buffer, &size);
-	    if (unlikely (status))
-		goto FAIL;
+	    memcpy (buffer, glyf + begin, size);
 
             status = cairo_truetype_font_remap_composite_glyph (font, buffer, size);
 	    if (unlikely (status))
@@ -670,11 +676,15 @@ cairo_truetype_font_write_glyf_table (cairo_truetype_font_t *font,
 
     font->glyphs[i].location = next - start_offset;
 
-    status = font->status;
-FAIL:
-    free (u.bytes);
+ FAIL:
+    _cairo_font_table_cache_release (glyf);
+ FAIL_LOCA:
+    _cairo_font_table_cache_release (u.bytes);
+
+    if (unlikely (status))
+	return _cairo_truetype_font_set_error (font, status);
 
-    return _cairo_truetype_font_set_error (font, status);
+    return font->status;
 }
 
 static cairo_status_t
@@ -689,8 +699,8 @@ cairo_truetype_font_write_head_table (cairo_truetype_font_t *font,
 	return font->status;
 
     size = 0;
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-						 tag, 0, NULL, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   tag, 0, NULL, &size);
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
@@ -699,8 +709,8 @@ cairo_truetype_font_write_head_table (cairo_truetype_font_t *font,
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-						 tag, 0, buffer, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   tag, 0, buffer, &size);
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
@@ -725,8 +735,8 @@ cairo_truetype_font_write_hhea_table (cairo_truetype_font_t *font, unsigned long
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-						 tag, 0, (unsigned char *) hhea, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   tag, 0, (unsigned char *) hhea, &size);
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
@@ -752,9 +762,9 @@ cairo_truetype_font_write_hmtx_table (cairo_truetype_font_t *font,
 	return font->status;
 
     size = sizeof (tt_hhea_t);
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-						 TT_TAG_hhea, 0,
-						 (unsigned char*) &hhea, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   TT_TAG_hhea, 0,
+					   (unsigned char*) &hhea, &size);
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
@@ -770,27 +780,27 @@ cairo_truetype_font_write_hmtx_table (cairo_truetype_font_t *font,
 	    return _cairo_truetype_font_set_error (font, status);
 
         if (font->glyphs[i].parent_index < num_hmetrics) {
-            status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                                         TT_TAG_hmtx,
-                                                         font->glyphs[i].parent_index * long_entry_size,
-                                                         (unsigned char *) p, &long_entry_size);
+            status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+						   TT_TAG_hmtx,
+						   font->glyphs[i].parent_index * long_entry_size,
+						   (unsigned char *) p, &long_entry_size);
 	    if (unlikely (status))
 		return _cairo_truetype_font_set_error (font, status);
         }
         else
         {
-            status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                                         TT_TAG_hmtx,
-							 (num_hmetrics - 1) * long_entry_size,
-							 (unsigned char *) p, &short_entry_size);
+            status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+						   TT_TAG_hmtx,
+						   (num_hmetrics - 1) * long_entry_size,
+						   (unsigned char *) p, &short_entry_size);
 	    if (unlikely (status))
 		return _cairo_truetype_font_set_error (font, status);
 
-            status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-							 TT_TAG_hmtx,
-							 num_hmetrics * long_entry_size +
-							 (font->glyphs[i].parent_index - num_hmetrics) * short_entry_size,
-							 (unsigned char *) (p + 1), &short_entry_size);
+            status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+						   TT_TAG_hmtx,
+						   num_hmetrics * long_entry_size +
+						   (font->glyphs[i].parent_index - num_hmetrics) * short_entry_size,
+						   (unsigned char *) (p + 1), &short_entry_size);
 	    if (unlikely (status))
 		return _cairo_truetype_font_set_error (font, status);
         }
@@ -813,9 +823,9 @@ cairo_truetype_font_write_loca_table (cairo_truetype_font_t *font,
 	return font->status;
 
     size = sizeof(tt_head_t);
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-						 TT_TAG_head, 0,
-						 (unsigned char*) &header, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   TT_TAG_head, 0,
+					   (unsigned char*) &header, &size);
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
@@ -847,8 +857,8 @@ cairo_truetype_font_write_maxp_table (cairo_truetype_font_t *font,
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
-    status = font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-						 tag, 0, (unsigned char *) maxp, &size);
+    status = _cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+					   tag, 0, (unsigned char *) maxp, &size);
     if (unlikely (status))
 	return _cairo_truetype_font_set_error (font, status);
 
@@ -1054,21 +1064,21 @@ cairo_truetype_font_create_truetype_table_list (cairo_truetype_font_t *font)
     int pos;
 
     size = 0;
-    if (font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                      TT_TAG_cvt, 0, NULL,
-                                      &size) == CAIRO_INT_STATUS_SUCCESS)
+    if (_cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+				TT_TAG_cvt, 0, NULL,
+				&size) == CAIRO_INT_STATUS_SUCCESS)
         has_cvt = TRUE;
 
     size = 0;
-    if (font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                      TT_TAG_fpgm, 0, NULL,
-                                      &size) == CAIRO_INT_STATUS_SUCCESS)
+    if (_cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+				TT_TAG_fpgm, 0, NULL,
+				&size) == CAIRO_INT_STATUS_SUCCESS)
         has_fpgm = TRUE;
 
     size = 0;
-    if (font->backend->load_truetype_table (font->scaled_font_subset->scaled_font,
-                                      TT_TAG_prep, 0, NULL,
-                                      &size) == CAIRO_INT_STATUS_SUCCESS)
+    if (_cairo_font_table_cache_load (font->scaled_font_subset->scaled_font,
+				TT_TAG_prep, 0, NULL,
+				&size) == CAIRO_INT_STATUS_SUCCESS)
         has_prep = TRUE;
 
     font->num_tables = 0;
@@ -1240,7 +1250,6 @@ _cairo_truetype_reverse_cmap (cairo_scaled_font_t *scaled_font,
 			      uint32_t            *ucs4)
 {
     cairo_status_t status;
-    const cairo_scaled_font_backend_t *backend;
     tt_segment_map_t *map;
     char buf[4];
     unsigned int num_segments, i;
@@ -1251,10 +1260,9 @@ _cairo_truetype_reverse_cmap (cairo_scaled_font_t *scaled_font,
     uint16_t *range_offset;
     uint16_t  c;
 
-    backend = scaled_font->backend;
     size = 4;
-    status = backend->load_truetype_table (scaled_font,
-                                           TT_TAG_cmap, table_offset,
+    status = _cairo_font_table_cache_load (scaled_font,
+					   TT_TAG_cmap, table_offset,
 					   (unsigned char *) &buf,
 					   &size);
     if (unlikely (status))
@@ -1270,10 +1278,10 @@ _cairo_truetype_reverse_cmap (cairo_scaled_font_t *scaled_font,
     if (unlikely (map == NULL))
 	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
 
-    status = backend->load_truetype_table (scaled_font,
-                                           TT_TAG_cmap, table_offset,
-                                           (unsigned char *) map,
-                                           &size);
+    status = _cairo_font_table_cache_load (scaled_font,
+					   TT_TAG_cmap, table_offset,
+					   (unsigned char *) map,
+					   &size);
     if (unlikely (status))
 	goto fail;
 
@@ -1352,8 +1360,8 @@ _cairo_truetype_index_to_ucs4 (cairo_scaled_font_t *scaled_font,
 	return CAIRO_INT_STATUS_UNSUPPORTED;
 
     size = 4;
-    status = backend->load_truetype_table (scaled_font,
-                                           TT_TAG_cmap, 0,
+    status = _cairo_font_table_cache_load (scaled_font,
+					   TT_TAG_cmap, 0,
 					   (unsigned char *) &buf,
 					   &size);
     if (unlikely (status))
@@ -1366,8 +1374,8 @@ _cairo_truetype_index_to_ucs4 (cairo_scaled_font_t *scaled_font,
     if (unlikely (cmap == NULL))
 	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
 
-    status = backend->load_truetype_table (scaled_font,
-	                                   TT_TAG_cmap, 0,
+    status = _cairo_font_table_cache_load (scaled_font,
+					   TT_TAG_cmap, 0,
 					   (unsigned char *) cmap,
 					   &size);
     if (unlikely (status))
@@ -1510,8 +1518,8 @@ _cairo_truetype_read_font_name (cairo_scaled_font_t  	 *scaled_font,
 	return CAIRO_INT_STATUS_UNSUPPORTED;
 
     size = 0;
-    status = backend->load_truetype_table (scaled_font,
-	                                   TT_TAG_name, 0,
+    status = _cairo_font_table_cache_load (scaled_font,
+					   TT_TAG_name, 0,
 					   NULL,
 					   &size);
     if (status)
@@ -1521,7 +1529,7 @@ _cairo_truetype_read_font_name (cairo_scaled_font_t  	 *scaled_font,
     if (name == NULL)
         return _cairo_error (CAIRO_STATUS_NO_MEMORY);
 
-    status = backend->load_truetype_table (scaled_font,
+    status = _cairo_font_table_cache_load (scaled_font,
 					   TT_TAG_name, 0,
 					   (unsigned char *) name,
 					   &size);
@@ -1601,7 +1609,7 @@ _cairo_truetype_get_style (cairo_scaled_font_t  	 *scaled_font,
 	return CAIRO_INT_STATUS_UNSUPPORTED;
 
     size = 0;
-    status = backend->load_truetype_table (scaled_font,
+    status = _cairo_font_table_cache_load (scaled_font,
 					   TT_TAG_OS2, 0,
 					   NULL,
 					   &size);
@@ -1612,7 +1620,7 @@ _cairo_truetype_get_style (cairo_scaled_font_t  	 *scaled_font,
 	return CAIRO_INT_STATUS_UNSUPPORTED;
 
     size = sizeof (os2);
-    status = backend->load_truetype_table (scaled_font,
+    status = _cairo_font_table_cache_load (scaled_font,
 					   TT_TAG_OS2, 0,
 					   (unsigned char *) &os2,
 					   &size);
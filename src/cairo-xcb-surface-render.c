@@ -4011,6 +4011,8 @@ _can_composite_glyphs (cairo_xcb_surface_t *dst,
 	y1 = _cairo_fixed_to_double (bbox->p1.y);
 	y2 = _cairo_fixed_to_double (bbox->p2.y);
 	x2 = _cairo_fixed_to_double (bbox->p2.x);
+	if (scaled_font->subpixel_positions)
+	    x2 += 1; /* the phase shifts the rendering by up to a pixel */
 	if (unlikely (glyphs->x + x2 <= extents->x ||
 		      glyphs->y + y2 <= extents->y ||
 		      glyphs->x + x1 >= extents->x + extents->width ||
@@ -4683,11 +4685,23 @@ _composite_glyphs (void				*closure,
 
     for (i = 0; i < info->num_glyphs; i++) {
 	cairo_scaled_glyph_t *glyph;
-	unsigned long glyph_index = info->glyphs[i].index;
-	int cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
+	unsigned long glyph_index;
+	int cache_index;
 	int old_width = width;
 	int this_x, this_y;
 
+	/* With subpixel positions the glyph is sent to the server once
+	 * per phase, under the phase-tagged index.
+	 */
+	glyph_index = _cairo_scaled_glyph_position (info->font,
+						    info->glyphs[i].index,
+						    info->glyphs[i].d.x,
+						    &this_x);
+	this_x -= dst_x;
+	this_y = _cairo_lround (info->glyphs[i].d.y) - dst_y;
+	info->glyphs[i].index = glyph_index;
+
+	cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
 	glyph = glyph_cache[cache_index];
 	if (glyph == NULL ||
 	    _cairo_scaled_glyph_index (glyph) != glyph_index)
@@ -4715,9 +4729,6 @@ _composite_glyphs (void				*closure,
 	    glyph_cache[cache_index] = glyph;
 	}
 
-	this_x = _cairo_lround (info->glyphs[i].d.x) - dst_x;
-	this_y = _cairo_lround (info->glyphs[i].d.y) - dst_y;
-
 	this_glyphset_info = glyph->dev_private;
 	if (glyphset_info == NULL)
 	    glyphset_info = this_glyphset_info;
@@ -1608,6 +1608,15 @@ composite_glyphs (void				*surface,
 	int this_x, this_y;
 	int old_width;
 
+	/* With subpixel positions the glyph is sent to the server once
+	 * per phase, under the phase-tagged index.
+	 */
+	glyphs[i].index = _cairo_scaled_glyph_position (info->font,
+							 glyphs[i].index,
+							 glyphs[i].d.x,
+							 &this_x);
+	this_y = _cairo_lround (glyphs[i].d.y);
+
 	status = _cairo_scaled_glyph_lookup (info->font,
 					     glyphs[i].index,
 					     CAIRO_SCALED_GLYPH_INFO_METRICS,
@@ -1615,9 +1624,6 @@ composite_glyphs (void				*surface,
 	if (unlikely (status))
 	    return status;
 
-	this_x = _cairo_lround (glyphs[i].d.x);
-	this_y = _cairo_lround (glyphs[i].d.y);
-
 	/* Send unsent glyphs to the server */
 	if (glyph->dev_private_key != display) {
 	    status = _cairo_xlib_surface_add_glyph (display, info->font, &glyph);
@@ -1333,6 +1333,11 @@ typedef enum _cairo_hint_style {
  * letter and line spacing, however it also means that text
  * will be laid out differently at different zoom factors.
  *
+ * Without hinted metrics, antialiased text from scalable FreeType fonts
+ * can also be rendered at the nearest quarter pixel horizontally,
+ * rather than at the nearest whole pixel; see
+ * cairo_ft_font_face_set_subpixel_positions().
+ *
  * Since: 1.0
  **/
 typedef enum _cairo_hint_metrics {
@@ -1612,6 +1617,29 @@ cairo_scaled_font_glyph_extents (cairo_scaled_font_t   *scaled_font,
 				 int                   num_glyphs,
 				 cairo_text_extents_t  *extents);
 
+/**
+ * cairo_glyph_preload_flags_t:
+ * @CAIRO_GLYPH_PRELOAD_SURFACE: Rasterise the glyphs, as needed to draw
+ * them to image, xlib and xcb surfaces. (Since 1.16)
+ * @CAIRO_GLYPH_PRELOAD_PATH: Convert the glyph outlines to paths, as
+ * needed by cairo_glyph_path() and vector surfaces. (Since 1.16)
+ *
+ * Specifies what cairo_scaled_font_preload_glyphs() should prepare
+ * besides the glyph metrics, which are always loaded.
+ *
+ * Since: 1.16
+ **/
+typedef enum _cairo_glyph_preload_flags {
+    CAIRO_GLYPH_PRELOAD_SURFACE = 0x00000001,
+    CAIRO_GLYPH_PRELOAD_PATH = 0x00000002
+} cairo_glyph_preload_flags_t;
+
+cairo_public cairo_status_t
+cairo_scaled_font_preload_glyphs (cairo_scaled_font_t	      *scaled_font,
+				  const cairo_glyph_t	      *glyphs,
+				  int			       num_glyphs,
+				  cairo_glyph_preload_flags_t  flags);
+
 cairo_public cairo_status_t
 cairo_scaled_font_text_to_glyphs (cairo_scaled_font_t        *scaled_font,
 				  double		      x,
@@ -2215,6 +2243,8 @@ cairo_surface_create_for_rectangle (cairo_surface_t	*target,
  * cairo_surface_observer_mode_t:
  * @CAIRO_SURFACE_OBSERVER_NORMAL: no recording is done
  * @CAIRO_SURFACE_OBSERVER_RECORD_OPERATIONS: operations are recorded
+ * @CAIRO_SURFACE_OBSERVER_RECORD_STAGES: the time of each operation is
+ * broken down into the stages of the rendering pipeline (Since 1.16)
  *
  * Whether operations should be recorded.
  *
@@ -2222,7 +2252,8 @@ cairo_surface_create_for_rectangle (cairo_surface_t	*target,
  **/
 typedef enum {
 	CAIRO_SURFACE_OBSERVER_NORMAL = 0,
-	CAIRO_SURFACE_OBSERVER_RECORD_OPERATIONS = 0x1
+	CAIRO_SURFACE_OBSERVER_RECORD_OPERATIONS = 0x1,
+	CAIRO_SURFACE_OBSERVER_RECORD_STAGES = 0x2
 } cairo_surface_observer_mode_t;
 
 cairo_public cairo_surface_t *
@@ -2272,6 +2303,10 @@ cairo_public cairo_status_t
 cairo_surface_observer_print (cairo_surface_t *surface,
 			      cairo_write_func_t write_func,
 			      void *closure);
+cairo_public cairo_status_t
+cairo_surface_observer_print_json (cairo_surface_t *surface,
+				   cairo_write_func_t write_func,
+				   void *closure);
 cairo_public double
 cairo_surface_observer_elapsed (cairo_surface_t *surface);
 
@@ -2280,6 +2315,11 @@ cairo_device_observer_print (cairo_device_t *device,
 			     cairo_write_func_t write_func,
 			     void *closure);
 
+cairo_public cairo_status_t
+cairo_device_observer_print_json (cairo_device_t *device,
+				  cairo_write_func_t write_func,
+				  void *closure);
+
 cairo_public double
 cairo_device_observer_elapsed (cairo_device_t *device);
 
@@ -2551,6 +2591,19 @@ cairo_public cairo_surface_t *
 cairo_image_surface_create_from_png_stream (cairo_read_func_t	read_func,
 					    void		*closure);
 
+cairo_public cairo_status_t
+cairo_image_surface_load_png (cairo_surface_t	*surface,
+			      int		 x,
+			      int		 y,
+			      const char	*filename);
+
+cairo_public cairo_status_t
+cairo_image_surface_load_png_stream (cairo_surface_t	*surface,
+				     int		 x,
+				     int		 y,
+				     cairo_read_func_t	 read_func,
+				     void		*closure);
+
 #endif
 
 /* Recording-surface functions */
@@ -2570,6 +2623,51 @@ cairo_public cairo_bool_t
 cairo_recording_surface_get_extents (cairo_surface_t *surface,
 				     cairo_rectangle_t *extents);
 
+cairo_public cairo_status_t
+cairo_recording_surface_write_to_stream (cairo_surface_t	*surface,
+					 cairo_write_func_t	 write_func,
+					 void			*closure);
+
+cairo_public cairo_surface_t *
+cairo_recording_surface_create_from_data (const unsigned char	*data,
+					  unsigned long		 length);
+
+cairo_public cairo_status_t
+cairo_recording_surface_replay_data (const unsigned char	*data,
+				     unsigned long		 length,
+				     cairo_surface_t		*target);
+
+/**
+ * cairo_recording_tile_func_t:
+ * @closure: the closure passed to cairo_recording_surface_replay_tiles()
+ * @tile: the image surface holding the rasterised tile
+ * @x: the X coordinate of the tile in recording space
+ * @y: the Y coordinate of the tile in recording space
+ *
+ * #cairo_recording_tile_func_t is the type of function which is called
+ * by cairo_recording_surface_replay_tiles() for every completed tile.
+ * It may be called concurrently from several threads.
+ *
+ * Returns: %CAIRO_STATUS_SUCCESS to continue, or an error status to stop
+ * rasterising further tiles.
+ *
+ * Since: 1.16
+ **/
+typedef cairo_status_t (*cairo_recording_tile_func_t) (void		*closure,
+						       cairo_surface_t	*tile,
+						       int		 x,
+						       int		 y);
+
+cairo_public cairo_status_t
+cairo_recording_surface_replay_tiles (cairo_surface_t		    *surface,
+				      const cairo_rectangle_int_t   *extents,
+				      cairo_format_t		     format,
+				      int			     tile_width,
+				      int			     tile_height,
+				      int			     num_threads,
+				      cairo_recording_tile_func_t    tile_func,
+				      void			    *closure);
+
 /* raster-source pattern (callback) functions */
 
 /**
@@ -3147,6 +3245,13 @@ cairo_region_xor_rectangle (cairo_region_t *dst,
 cairo_public void
 cairo_debug_reset_static_data (void);
 
+cairo_public void
+cairo_debug_mutex_stats_reset (void);
+
+cairo_public cairo_status_t
+cairo_debug_mutex_stats_write (cairo_write_func_t	 write_func,
+			       void			*closure);
+
 
 CAIRO_END_DECLS
 
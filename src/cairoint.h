@@ -419,6 +419,17 @@ _cairo_hash_bytes (unsigned long hash,
 #define _cairo_scaled_glyph_index(g) ((g)->hash_entry.hash)
 #define _cairo_scaled_glyph_set_index(g, i)  ((g)->hash_entry.hash = (i))
 
+/* Scaled fonts with subpixel_positions render each glyph at one of
+ * CAIRO_SCALED_GLYPH_PHASES horizontal offsets within a pixel, and
+ * cache every rendering separately with the phase stored above the
+ * glyph index in the key.
+ */
+#define CAIRO_SCALED_GLYPH_PHASES 4
+#define CAIRO_SCALED_GLYPH_PHASE_SHIFT 24
+#define CAIRO_SCALED_GLYPH_INDEX_MASK ((1UL << CAIRO_SCALED_GLYPH_PHASE_SHIFT) - 1)
+#define _cairo_scaled_glyph_phase(g) \
+    (_cairo_scaled_glyph_index (g) >> CAIRO_SCALED_GLYPH_PHASE_SHIFT)
+
 #include "cairo-scaled-font-private.h"
 
 struct _cairo_font_face {
@@ -1251,6 +1262,30 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
 			    cairo_scaled_glyph_info_t info,
 			    cairo_scaled_glyph_t **scaled_glyph_ret);
 
+/* Returns the key under which to look up glyph @index for drawing at
+ * the horizontal device position @x, and stores in @x_out the integer
+ * position at which to composite the surface of that glyph.
+ */
+static inline unsigned long
+_cairo_scaled_glyph_position (const cairo_scaled_font_t *scaled_font,
+			      unsigned long index,
+			      double x,
+			      int *x_out)
+{
+    double p, ix;
+
+    if (! scaled_font->subpixel_positions) {
+	*x_out = _cairo_lround (x);
+	return index;
+    }
+
+    p = floor (x * CAIRO_SCALED_GLYPH_PHASES + .5);
+    ix = floor (p / CAIRO_SCALED_GLYPH_PHASES);
+    *x_out = ix;
+    return index |
+	(unsigned long) (p - ix * CAIRO_SCALED_GLYPH_PHASES) << CAIRO_SCALED_GLYPH_PHASE_SHIFT;
+}
+
 cairo_private double
 _cairo_scaled_font_get_max_scale (cairo_scaled_font_t *scaled_font);
 
@@ -0,0 +1,241 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if CAIRO_HAS_PS_SURFACE
+#include <cairo-ps.h>
+#endif
+
+#if CAIRO_HAS_PDF_SURFACE
+#include <cairo-pdf.h>
+#endif
+
+#ifdef _WIN32
+#define setenv(name, value, overwrite) _putenv_s (name, value)
+#define unsetenv(name) _putenv_s (name, "")
+#endif
+
+/* Check that the font subsets of a PDF or PostScript document with
+ * many fonts are written out identically whether they were prepared
+ * by several threads or by one.
+ *
+ * CAIRO_SUBSET_THREADS sets the number of threads. PostScript output
+ * carries the time it was written, so that line is skipped.
+ */
+
+#define SIZE 400
+
+struct buffer {
+    unsigned char *data;
+    unsigned long length;
+    unsigned long size;
+};
+
+typedef cairo_surface_t *
+(*create_for_stream_t) (cairo_write_func_t write_func,
+			void *closure,
+			double width, double height);
+
+static cairo_status_t
+write_buffer (void *closure, const unsigned char *data, unsigned int length)
+{
+    struct buffer *buffer = closure;
+
+    if (buffer->length + length > buffer->size) {
+	unsigned long size = 2 * buffer->size + length;
+	unsigned char *ptr = realloc (buffer->data, size);
+
+	if (ptr == NULL)
+	    return CAIRO_STATUS_WRITE_ERROR;
+
+	buffer->data = ptr;
+	buffer->size = size;
+    }
+
+    memcpy (buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+write_document (create_for_stream_t create_for_stream,
+		const char *threads,
+		struct buffer *buffer)
+{
+    static const char *families[] = { "Sans", "Serif", "Mono" };
+    cairo_surface_t *surface;
+    cairo_status_t status;
+    cairo_t *cr;
+    char family[256];
+    int i, weight, slant;
+
+    setenv ("CAIRO_SUBSET_THREADS", threads, 1);
+
+    surface = create_for_stream (write_buffer, buffer, SIZE, SIZE);
+    cr = cairo_create (surface);
+    cairo_set_font_size (cr, 12);
+    for (i = 0; i < 3; i++) {
+	snprintf (family, sizeof (family), "%s %s",
+		  CAIRO_TEST_FONT_FAMILY, families[i]);
+	for (weight = 0; weight < 2; weight++) {
+	    for (slant = 0; slant < 2; slant++) {
+		cairo_select_font_face (cr, family,
+					slant ? CAIRO_FONT_SLANT_ITALIC :
+					CAIRO_FONT_SLANT_NORMAL,
+					weight ? CAIRO_FONT_WEIGHT_BOLD :
+					CAIRO_FONT_WEIGHT_NORMAL);
+		cairo_move_to (cr, 10, 20 + 30 * (4 * i + 2 * weight + slant));
+		cairo_show_text (cr, "Sphinx of black quartz, judge my vow!");
+	    }
+	}
+    }
+    cairo_destroy (cr);
+
+    cairo_surface_finish (surface);
+    status = cairo_surface_status (surface);
+    cairo_surface_destroy (surface);
+
+    return status;
+}
+
+/* the length of the document up to its creation date, if any */
+static unsigned long
+dated_length (const struct buffer *buffer, unsigned long *line_length)
+{
+    const char *pattern = "%%CreationDate:";
+    unsigned long len = strlen (pattern);
+    unsigned long n, end;
+
+    *line_length = 0;
+    for (n = 0; n + len <= buffer->length; n++) {
+	if (memcmp (buffer->data + n, pattern, len) == 0) {
+	    for (end = n; end < buffer->length; end++) {
+		if (buffer->data[end] == '\n')
+		    break;
+	    }
+	    *line_length = end - n;
+	    return n;
+	}
+    }
+
+    return buffer->length;
+}
+
+static cairo_bool_t
+documents_equal (const struct buffer *a, const struct buffer *b)
+{
+    unsigned long date_a, date_b, line_a, line_b;
+
+    date_a = dated_length (a, &line_a);
+    date_b = dated_length (b, &line_b);
+    if (date_a != date_b || a->length - line_a != b->length - line_b)
+	return FALSE;
+
+    return memcmp (a->data, b->data, date_a) == 0 &&
+	   memcmp (a->data + date_a + line_a,
+		   b->data + date_b + line_b,
+		   a->length - date_a - line_a) == 0;
+}
+
+static cairo_test_status_t
+check_threads (cairo_test_context_t *ctx,
+	       const char *name,
+	       create_for_stream_t create_for_stream)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    struct buffer sequential = { NULL, 0, 0 };
+    struct buffer threaded = { NULL, 0, 0 };
+    cairo_status_t status;
+
+    status = write_document (create_for_stream, "1", &sequential);
+    if (status == CAIRO_STATUS_SUCCESS)
+	status = write_document (create_for_stream, "4", &threaded);
+    if (status) {
+	cairo_test_log (ctx, "Error: writing the %s document: %s\n",
+			name, cairo_status_to_string (status));
+	result = cairo_test_status_from_status (ctx, status);
+    } else if (! documents_equal (&sequential, &threaded)) {
+	cairo_test_log (ctx,
+			"Error: the %s document differs when its fonts are subset by several threads\n",
+			name);
+	result = CAIRO_TEST_FAILURE;
+    }
+
+    free (threaded.data);
+    free (sequential.data);
+
+    return result;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_UNTESTED;
+    cairo_test_status_t status;
+    char *threads;
+
+    threads = getenv ("CAIRO_SUBSET_THREADS");
+    if (threads != NULL)
+	threads = strdup (threads);
+
+#if CAIRO_HAS_PDF_SURFACE
+    if (cairo_test_is_target_enabled (ctx, "pdf")) {
+	status = check_threads (ctx, "PDF",
+				cairo_pdf_surface_create_for_stream);
+	if (result == CAIRO_TEST_UNTESTED || status != CAIRO_TEST_SUCCESS)
+	    result = status;
+    }
+#endif
+
+#if CAIRO_HAS_PS_SURFACE
+    if (cairo_test_is_target_enabled (ctx, "ps2") ||
+	cairo_test_is_target_enabled (ctx, "ps3"))
+    {
+	status = check_threads (ctx, "PostScript",
+				cairo_ps_surface_create_for_stream);
+	if (result == CAIRO_TEST_UNTESTED || status != CAIRO_TEST_SUCCESS)
+	    result = status;
+    }
+#endif
+
+    if (threads != NULL) {
+	setenv ("CAIRO_SUBSET_THREADS", threads, 1);
+	free (threads);
+    } else {
+	unsetenv ("CAIRO_SUBSET_THREADS");
+    }
+
+    return result;
+}
+
+CAIRO_TEST (font_subset_threads,
+	    "Check that fonts subset by several threads are written out identically",
+	    "pdf, ps, font", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
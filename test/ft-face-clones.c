@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-test.h"
+#include <cairo-ft.h>
+
+#if CAIRO_HAS_REAL_PTHREAD
+#include <pthread.h>
+#include <time.h>
+#endif
+
+/* Check that glyphs are loaded through a cloned FT_Face (see
+ * cairo_ft_set_max_face_clones()) rather than the shared one.
+ *
+ * The shared face of the font file is held locked with
+ * cairo_ft_scaled_font_lock_face() while another thread draws
+ * uncached glyphs of a second size of the same font. Without a clone
+ * that thread would wait for the lock to be released, so it has to
+ * finish while the face is still locked.
+ */
+
+#define TEXT "Hamburgefonstiv"
+#define TIMEOUT 10 /* seconds */
+
+#if CAIRO_HAS_REAL_PTHREAD
+
+typedef struct {
+    cairo_scaled_font_t *scaled_font;
+    cairo_glyph_t *glyphs;
+    int num_glyphs;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    cairo_bool_t done;
+} thread_data_t;
+
+static cairo_scaled_font_t *
+create_scaled_font (cairo_font_face_t *font_face, double size)
+{
+    cairo_font_options_t *options;
+    cairo_scaled_font_t *scaled_font;
+    cairo_matrix_t font_matrix, ctm;
+
+    cairo_matrix_init_scale (&font_matrix, size, size);
+    cairo_matrix_init_identity (&ctm);
+
+    /* subpixel glyphs are never loaded through a clone */
+    options = cairo_font_options_create ();
+    cairo_font_options_set_antialias (options, CAIRO_ANTIALIAS_GRAY);
+    scaled_font = cairo_scaled_font_create (font_face,
+					    &font_matrix, &ctm, options);
+    cairo_font_options_destroy (options);
+
+    return scaled_font;
+}
+
+static void *
+draw_thread (void *arg)
+{
+    thread_data_t *data = arg;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_A8, 400, 40);
+    cr = cairo_create (surface);
+    cairo_set_scaled_font (cr, data->scaled_font);
+    cairo_show_glyphs (cr, data->glyphs, data->num_glyphs);
+    cairo_destroy (cr);
+    cairo_surface_destroy (surface);
+
+    pthread_mutex_lock (&data->mutex);
+    data->done = TRUE;
+    pthread_cond_signal (&data->cond);
+    pthread_mutex_unlock (&data->mutex);
+
+    return NULL;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    cairo_font_face_t *font_face;
+    cairo_scaled_font_t *locked;
+    thread_data_t data;
+    pthread_t thread;
+    struct timespec deadline;
+    cairo_status_t status;
+    int max_clones;
+
+    font_face = cairo_toy_font_face_create (CAIRO_TEST_FONT_FAMILY " Sans",
+					    CAIRO_FONT_SLANT_NORMAL,
+					    CAIRO_FONT_WEIGHT_NORMAL);
+    locked = create_scaled_font (font_face, 12);
+    data.scaled_font = create_scaled_font (font_face, 31);
+    cairo_font_face_destroy (font_face);
+
+    if (cairo_scaled_font_get_type (locked) != CAIRO_FONT_TYPE_FT) {
+	cairo_scaled_font_destroy (data.scaled_font);
+	cairo_scaled_font_destroy (locked);
+	return CAIRO_TEST_UNTESTED;
+    }
+
+    /* converting the text uses the shared face, so do it up front */
+    data.glyphs = NULL;
+    status = cairo_scaled_font_text_to_glyphs (data.scaled_font, 2, 30,
+					       TEXT, -1,
+					       &data.glyphs, &data.num_glyphs,
+					       NULL, NULL, NULL);
+    if (status) {
+	cairo_scaled_font_destroy (data.scaled_font);
+	cairo_scaled_font_destroy (locked);
+	return cairo_test_status_from_status (ctx, status);
+    }
+
+    max_clones = cairo_ft_get_max_face_clones ();
+    cairo_ft_set_max_face_clones (1);
+    if (cairo_ft_get_max_face_clones () != 1) {
+	cairo_test_log (ctx, "Error: the clone limit was not set\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+
+    pthread_mutex_init (&data.mutex, NULL);
+    pthread_cond_init (&data.cond, NULL);
+    data.done = FALSE;
+
+    if (cairo_ft_scaled_font_lock_face (locked) == NULL) {
+	cairo_test_log (ctx, "Error: failed to lock the face\n");
+	result = CAIRO_TEST_FAILURE;
+	goto CLEANUP;
+    }
+
+    if (pthread_create (&thread, NULL, draw_thread, &data)) {
+	cairo_ft_scaled_font_unlock_face (locked);
+	cairo_test_log (ctx, "Error: failed to start the thread\n");
+	result = CAIRO_TEST_FAILURE;
+	goto CLEANUP;
+    }
+
+    clock_gettime (CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += TIMEOUT;
+
+    pthread_mutex_lock (&data.mutex);
+    while (! data.done) {
+	if (pthread_cond_timedwait (&data.cond, &data.mutex, &deadline))
+	    break;
+    }
+    if (! data.done) {
+	cairo_test_log (ctx,
+			"Error: loading glyphs waited for the locked shared face\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+    pthread_mutex_unlock (&data.mutex);
+
+    /* let a blocked thread finish before cleaning up */
+    cairo_ft_scaled_font_unlock_face (locked);
+    pthread_join (thread, NULL);
+
+CLEANUP:
+    pthread_cond_destroy (&data.cond);
+    pthread_mutex_destroy (&data.mutex);
+
+    cairo_ft_set_max_face_clones (max_clones);
+
+    cairo_glyph_free (data.glyphs);
+    cairo_scaled_font_destroy (data.scaled_font);
+    cairo_scaled_font_destroy (locked);
+
+    return result;
+}
+
+#else
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    return CAIRO_TEST_UNTESTED;
+}
+
+#endif
+
+CAIRO_TEST (ft_face_clones,
+	    "Check that glyphs are loaded through cloned FT_Faces",
+	    "ft, text, thread", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
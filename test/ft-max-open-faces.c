@@ -0,0 +1,207 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-test.h"
+#include <cairo-ft.h>
+
+#include <string.h>
+
+/* Check that the least recently used FT_Face is the one closed when
+ * the limit of open faces is reached.
+ *
+ * Three fonts are locked in a known order, and a finalizer on each
+ * FT_Face records when cairo closes it. With two faces allowed open,
+ * reopening a closed font has to close whichever of the other two was
+ * locked longest ago. The font files are mapped, so the reopened faces
+ * are also loaded from memory.
+ */
+
+#define NUM_FONTS 3
+
+static const char *families[NUM_FONTS] = {
+    CAIRO_TEST_FONT_FAMILY " Sans",
+    CAIRO_TEST_FONT_FAMILY " Serif",
+    CAIRO_TEST_FONT_FAMILY " Sans Mono",
+};
+
+static cairo_bool_t closed[NUM_FONTS];
+
+static void
+face_closed (void *object)
+{
+    FT_Face face = object;
+
+    *(cairo_bool_t *) face->generic.data = TRUE;
+}
+
+/* Locks and unlocks the face of font n, making it the most recently
+ * used, and starts watching the face if it has just been opened. */
+static cairo_bool_t
+touch (cairo_scaled_font_t **scaled_fonts, int n)
+{
+    FT_Face face;
+
+    face = cairo_ft_scaled_font_lock_face (scaled_fonts[n]);
+    if (face == NULL)
+	return FALSE;
+
+    if (face->generic.finalizer == NULL) {
+	closed[n] = FALSE;
+	face->generic.data = &closed[n];
+	face->generic.finalizer = face_closed;
+    }
+
+    cairo_ft_scaled_font_unlock_face (scaled_fonts[n]);
+
+    return TRUE;
+}
+
+static cairo_bool_t
+check_closed (cairo_test_context_t *ctx,
+	      const char *step,
+	      cairo_bool_t a, cairo_bool_t b, cairo_bool_t c)
+{
+    if (closed[0] == a && closed[1] == b && closed[2] == c)
+	return TRUE;
+
+    cairo_test_log (ctx,
+		    "Error: %s, faces closed: %d %d %d, expected: %d %d %d\n",
+		    step, closed[0], closed[1], closed[2], a, b, c);
+    return FALSE;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    cairo_scaled_font_t *scaled_fonts[NUM_FONTS];
+    char *names[NUM_FONTS];
+    cairo_font_options_t *options;
+    cairo_matrix_t font_matrix, ctm;
+    cairo_text_extents_t extents;
+    cairo_bool_t map_files;
+    int max_faces, i;
+
+    max_faces = cairo_ft_get_max_open_faces ();
+    map_files = cairo_ft_get_map_font_files ();
+
+    cairo_ft_set_map_font_files (TRUE);
+
+    cairo_matrix_init_scale (&font_matrix, 18, 18);
+    cairo_matrix_init_identity (&ctm);
+    options = cairo_font_options_create ();
+    for (i = 0; i < NUM_FONTS; i++) {
+	cairo_font_face_t *font_face;
+
+	font_face = cairo_toy_font_face_create (families[i],
+						CAIRO_FONT_SLANT_NORMAL,
+						CAIRO_FONT_WEIGHT_NORMAL);
+	scaled_fonts[i] = cairo_scaled_font_create (font_face,
+						    &font_matrix, &ctm,
+						    options);
+	cairo_font_face_destroy (font_face);
+	names[i] = NULL;
+    }
+    cairo_font_options_destroy (options);
+
+    for (i = 0; i < NUM_FONTS; i++) {
+	FT_Face face;
+
+	if (cairo_scaled_font_get_type (scaled_fonts[i]) != CAIRO_FONT_TYPE_FT) {
+	    result = CAIRO_TEST_UNTESTED;
+	    goto CLEANUP;
+	}
+
+	face = cairo_ft_scaled_font_lock_face (scaled_fonts[i]);
+	if (face == NULL) {
+	    result = CAIRO_TEST_FAILURE;
+	    goto CLEANUP;
+	}
+	xasprintf (&names[i], "%s %s", face->family_name, face->style_name);
+	cairo_ft_scaled_font_unlock_face (scaled_fonts[i]);
+    }
+
+    /* the fonts have to come from separate files */
+    if (strcmp (names[0], names[1]) == 0 ||
+	strcmp (names[0], names[2]) == 0 ||
+	strcmp (names[1], names[2]) == 0)
+    {
+	cairo_test_log (ctx, "Only found %s, %s and %s\n",
+			names[0], names[1], names[2]);
+	result = CAIRO_TEST_UNTESTED;
+	goto CLEANUP;
+    }
+
+    /* used in the order 0, 1, 2 */
+    for (i = 0; i < NUM_FONTS; i++) {
+	if (! touch (scaled_fonts, i))
+	    result = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_ft_set_max_open_faces (2);
+    if (cairo_ft_get_max_open_faces () != 2) {
+	cairo_test_log (ctx, "Error: the face limit was not set\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+    if (! check_closed (ctx, "lowering the limit", TRUE, FALSE, FALSE))
+	result = CAIRO_TEST_FAILURE;
+
+    /* 2 is now older than 1, so reopening 0 closes 2 */
+    if (! touch (scaled_fonts, 1) || ! touch (scaled_fonts, 0))
+	result = CAIRO_TEST_FAILURE;
+    if (! check_closed (ctx, "reopening the first font", FALSE, FALSE, TRUE))
+	result = CAIRO_TEST_FAILURE;
+
+    /* and reopening 2 closes 1 */
+    if (! touch (scaled_fonts, 2))
+	result = CAIRO_TEST_FAILURE;
+    if (! check_closed (ctx, "reopening the third font", FALSE, TRUE, FALSE))
+	result = CAIRO_TEST_FAILURE;
+
+    /* the reopened face is usable */
+    cairo_scaled_font_text_extents (scaled_fonts[2], "Hamburgefonstiv",
+				    &extents);
+    if (cairo_scaled_font_status (scaled_fonts[2]) || extents.width <= 0) {
+	cairo_test_log (ctx, "Error: no glyphs from a reopened face\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+
+CLEANUP:
+    cairo_ft_set_max_open_faces (max_faces);
+    cairo_ft_set_map_font_files (map_files);
+
+    for (i = 0; i < NUM_FONTS; i++) {
+	free (names[i]);
+	cairo_scaled_font_destroy (scaled_fonts[i]);
+    }
+
+    return result;
+}
+
+CAIRO_TEST (ft_max_open_faces,
+	    "Check that the least recently used FT_Face is closed first",
+	    "ft, text", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -0,0 +1,178 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-test.h"
+#include <cairo-ft.h>
+
+#include <string.h>
+
+/* Check cairo_ft_font_face_set_subpixel_positions(): with metric
+ * hinting off, text drawn at a fractional position is rendered at that
+ * phase rather than rounded to the whole pixel, and moving it by a
+ * whole pixel only moves the rendering. Without it, the position is
+ * rounded as before.
+ */
+
+#define WIDTH 40
+#define HEIGHT 40
+
+static cairo_font_face_t *
+create_font_face (void)
+{
+    FcPattern *pattern, *resolved;
+    cairo_font_face_t *font_face;
+    FcResult result;
+
+    pattern = FcPatternCreate ();
+    if (pattern == NULL)
+	return NULL;
+
+    FcPatternAddString (pattern, FC_FAMILY, (FcChar8 *) CAIRO_TEST_FONT_FAMILY " Sans");
+    FcConfigSubstitute (NULL, pattern, FcMatchPattern);
+    FcDefaultSubstitute (pattern);
+    resolved = FcFontMatch (NULL, pattern, &result);
+    FcPatternDestroy (pattern);
+    if (resolved == NULL)
+	return NULL;
+
+    font_face = cairo_ft_font_face_create_for_pattern (resolved);
+    FcPatternDestroy (resolved);
+
+    return font_face;
+}
+
+static cairo_surface_t *
+draw_text (cairo_font_face_t *font_face, double size, double x)
+{
+    cairo_font_options_t *options;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_A8, WIDTH, HEIGHT);
+    cr = cairo_create (surface);
+
+    cairo_set_font_face (cr, font_face);
+    cairo_set_font_size (cr, size);
+
+    options = cairo_font_options_create ();
+    cairo_font_options_set_antialias (options, CAIRO_ANTIALIAS_GRAY);
+    cairo_font_options_set_hint_metrics (options, CAIRO_HINT_METRICS_OFF);
+    cairo_set_font_options (cr, options);
+    cairo_font_options_destroy (options);
+
+    cairo_move_to (cr, x, HEIGHT - 10);
+    cairo_show_text (cr, "l");
+
+    cairo_destroy (cr);
+    cairo_surface_flush (surface);
+
+    return surface;
+}
+
+/* Compares @b against @a moved right by @dx pixels. */
+static cairo_bool_t
+images_equal (cairo_surface_t *a, cairo_surface_t *b, int dx)
+{
+    const unsigned char *da, *db;
+    int stride, y;
+
+    da = cairo_image_surface_get_data (a);
+    db = cairo_image_surface_get_data (b);
+    stride = cairo_image_surface_get_stride (a);
+    for (y = 0; y < HEIGHT; y++) {
+	if (memcmp (da + y * stride, db + y * stride + dx, WIDTH - dx))
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    cairo_surface_t *whole, *quarter, *next;
+    cairo_font_face_t *font_face;
+    cairo_status_t status;
+
+    font_face = create_font_face ();
+    if (font_face == NULL)
+	return CAIRO_TEST_NO_MEMORY;
+    status = cairo_font_face_status (font_face);
+    if (status) {
+	cairo_font_face_destroy (font_face);
+	return cairo_test_status_from_status (ctx, status);
+    }
+
+    if (cairo_ft_font_face_get_subpixel_positions (font_face)) {
+	cairo_test_log (ctx, "Error: subpixel positions are on by default\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+
+    whole = draw_text (font_face, 23, 10);
+    quarter = draw_text (font_face, 23, 10.25);
+    if (! images_equal (whole, quarter, 0)) {
+	cairo_test_log (ctx, "Error: text at a quarter pixel was not rounded by default\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+    cairo_surface_destroy (quarter);
+    cairo_surface_destroy (whole);
+
+    /* Only the scaled fonts created from now on are affected, so the
+     * text is drawn at another size. */
+    cairo_ft_font_face_set_subpixel_positions (font_face, TRUE);
+    if (! cairo_ft_font_face_get_subpixel_positions (font_face)) {
+	cairo_test_log (ctx, "Error: subpixel positions were not enabled\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+
+    whole = draw_text (font_face, 24, 10);
+    quarter = draw_text (font_face, 24, 10.25);
+    next = draw_text (font_face, 24, 11);
+
+    if (images_equal (whole, quarter, 0)) {
+	cairo_test_log (ctx, "Error: text at a quarter pixel was rounded\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+
+    if (! images_equal (whole, next, 1)) {
+	cairo_test_log (ctx, "Error: text moved by a pixel renders differently\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_surface_destroy (next);
+    cairo_surface_destroy (quarter);
+    cairo_surface_destroy (whole);
+
+    cairo_font_face_destroy (font_face);
+
+    return result;
+}
+
+CAIRO_TEST (ft_subpixel_positions,
+	    "Check glyphs are rendered at subpixel phases when asked to",
+	    "ft, text", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
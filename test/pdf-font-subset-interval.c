@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-test.h"
+#include <cairo-pdf.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Check cairo_pdf_surface_set_font_subset_interval().
+ *
+ * The same text is shown on every page, so by default its glyphs are
+ * written out once, in a single set of fonts, when the surface is
+ * finished. Writing the fonts out after every page instead has to
+ * repeat them, and should have written some of them before the
+ * document is finished.
+ */
+
+#define NUM_PAGES 4
+#define SIZE 200
+
+struct buffer {
+    unsigned char *data;
+    unsigned long length;
+    unsigned long size;
+};
+
+static cairo_status_t
+write_buffer (void *closure, const unsigned char *data, unsigned int length)
+{
+    struct buffer *buffer = closure;
+
+    if (buffer->length + length > buffer->size) {
+	unsigned long size = 2 * buffer->size + length;
+	unsigned char *ptr = realloc (buffer->data, size);
+
+	if (ptr == NULL)
+	    return CAIRO_STATUS_WRITE_ERROR;
+
+	buffer->data = ptr;
+	buffer->size = size;
+    }
+
+    memcpy (buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static int
+count_fonts (const struct buffer *buffer)
+{
+    const char *pattern = "/Type /Font\n";
+    unsigned long len = strlen (pattern);
+    unsigned long n;
+    int count = 0;
+
+    for (n = 0; n + len <= buffer->length; n++) {
+	if (memcmp (buffer->data + n, pattern, len) == 0)
+	    count++;
+    }
+
+    return count;
+}
+
+static cairo_status_t
+write_document (int interval,
+		struct buffer *buffer,
+		int *fonts_before_finish)
+{
+    cairo_surface_t *surface;
+    cairo_status_t status;
+    cairo_t *cr;
+    int page;
+
+    surface = cairo_pdf_surface_create_for_stream (write_buffer, buffer,
+						   SIZE, SIZE);
+    cairo_pdf_surface_set_font_subset_interval (surface, interval);
+
+    cr = cairo_create (surface);
+    cairo_select_font_face (cr, CAIRO_TEST_FONT_FAMILY " Sans",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cr, 16);
+    for (page = 0; page < NUM_PAGES; page++) {
+	cairo_move_to (cr, 10, 100);
+	cairo_show_text (cr, "Hamburgefonstiv");
+	cairo_show_page (cr);
+    }
+
+    cairo_surface_flush (surface);
+    *fonts_before_finish = count_fonts (buffer);
+
+    cairo_destroy (cr);
+    cairo_surface_finish (surface);
+    status = cairo_surface_status (surface);
+    cairo_surface_destroy (surface);
+
+    return status;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    struct buffer whole = { NULL, 0, 0 };
+    struct buffer chunked = { NULL, 0, 0 };
+    int whole_early, chunked_early;
+    cairo_status_t status;
+
+    if (! cairo_test_is_target_enabled (ctx, "pdf"))
+	return CAIRO_TEST_UNTESTED;
+
+    status = write_document (0, &whole, &whole_early);
+    if (status == CAIRO_STATUS_SUCCESS)
+	status = write_document (1, &chunked, &chunked_early);
+    if (status) {
+	cairo_test_log (ctx, "Error: writing the document: %s\n",
+			cairo_status_to_string (status));
+	result = cairo_test_status_from_status (ctx, status);
+	goto CLEANUP;
+    }
+
+    if (whole_early != 0) {
+	cairo_test_log (ctx, "Error: fonts were written before the surface was finished\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+
+    if (chunked_early == 0) {
+	cairo_test_log (ctx, "Error: no fonts were written after the pages\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+
+    if (count_fonts (&chunked) <= count_fonts (&whole)) {
+	cairo_test_log (ctx,
+			"Error: expected the fonts to be repeated, found %d fonts, %d by default\n",
+			count_fonts (&chunked), count_fonts (&whole));
+	result = CAIRO_TEST_FAILURE;
+    }
+
+CLEANUP:
+    free (chunked.data);
+    free (whole.data);
+
+    return result;
+}
+
+CAIRO_TEST (pdf_font_subset_interval,
+	    "Check writing PDF font subsets every few pages",
+	    "pdf, font", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-test.h"
+
+/* Check that decoding a PNG into an existing image surface places the
+ * pixels at the requested offset and leaves the remainder untouched.
+ */
+
+#define BASENAME "png-load.out"
+
+#define BACKGROUND 0xff102030
+
+static cairo_surface_t *
+create_source (void)
+{
+    cairo_surface_t *surface;
+    uint32_t *data;
+    int stride, x, y;
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 3, 2);
+    cairo_surface_flush (surface);
+    data = (uint32_t *) cairo_image_surface_get_data (surface);
+    stride = cairo_image_surface_get_stride (surface) / 4;
+    for (y = 0; y < 2; y++)
+	for (x = 0; x < 3; x++)
+	    data[y * stride + x] = 0xff000000 | (y << 16) | (x << 8) | 0x80;
+    cairo_surface_mark_dirty (surface);
+
+    return surface;
+}
+
+static cairo_test_status_t
+check_pixels (const cairo_test_context_t *ctx,
+	      cairo_surface_t *src,
+	      cairo_surface_t *dst,
+	      int dx, int dy)
+{
+    uint32_t *s, *d;
+    int s_stride, d_stride;
+    int x, y;
+
+    cairo_surface_flush (dst);
+    s = (uint32_t *) cairo_image_surface_get_data (src);
+    d = (uint32_t *) cairo_image_surface_get_data (dst);
+    s_stride = cairo_image_surface_get_stride (src) / 4;
+    d_stride = cairo_image_surface_get_stride (dst) / 4;
+
+    for (y = 0; y < cairo_image_surface_get_height (dst); y++) {
+	for (x = 0; x < cairo_image_surface_get_width (dst); x++) {
+	    uint32_t expected = BACKGROUND;
+
+	    if (x >= dx && x < dx + cairo_image_surface_get_width (src) &&
+		y >= dy && y < dy + cairo_image_surface_get_height (src))
+		expected = s[(y - dy) * s_stride + (x - dx)];
+
+	    if (d[y * d_stride + x] != expected) {
+		cairo_test_log (ctx,
+				"Error: pixel (%d, %d) is %08x, expected %08x\n",
+				x, y, d[y * d_stride + x], expected);
+		return CAIRO_TEST_FAILURE;
+	    }
+	}
+    }
+
+    return CAIRO_TEST_SUCCESS;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_surface_t *src, *dst, *a8;
+    cairo_test_status_t result;
+    cairo_status_t status;
+    char *filename;
+    const char *path = cairo_test_mkdir (CAIRO_TEST_OUTPUT_DIR) ? CAIRO_TEST_OUTPUT_DIR : ".";
+    cairo_t *cr;
+
+    xasprintf (&filename, "%s/%s.png", path, BASENAME);
+
+    src = create_source ();
+    status = cairo_surface_write_to_png (src, filename);
+    if (status) {
+	cairo_test_log (ctx, "Error writing '%s': %s\n",
+			filename, cairo_status_to_string (status));
+	cairo_surface_destroy (src);
+	free (filename);
+	return cairo_test_status_from_status (ctx, status);
+    }
+
+    dst = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 8, 5);
+    cr = cairo_create (dst);
+    cairo_set_source_rgb (cr,
+			  ((BACKGROUND >> 16) & 0xff) / 255.,
+			  ((BACKGROUND >> 8) & 0xff) / 255.,
+			  ((BACKGROUND >> 0) & 0xff) / 255.);
+    cairo_paint (cr);
+    cairo_destroy (cr);
+
+    result = CAIRO_TEST_SUCCESS;
+
+    status = cairo_image_surface_load_png (dst, 4, 2, filename);
+    if (status) {
+	cairo_test_log (ctx, "Error loading '%s': %s\n",
+			filename, cairo_status_to_string (status));
+	result = cairo_test_status_from_status (ctx, status);
+    }
+
+    if (result == CAIRO_TEST_SUCCESS)
+	result = check_pixels (ctx, src, dst, 4, 2);
+
+    /* The image does not fit, the destination must be left untouched */
+    if (result == CAIRO_TEST_SUCCESS &&
+	cairo_image_surface_load_png (dst, 6, 0, filename) != CAIRO_STATUS_INVALID_SIZE)
+    {
+	cairo_test_log (ctx, "Error: expected INVALID_SIZE for out-of-bounds load\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+    if (result == CAIRO_TEST_SUCCESS)
+	result = check_pixels (ctx, src, dst, 4, 2);
+
+    a8 = cairo_image_surface_create (CAIRO_FORMAT_A8, 8, 8);
+    if (result == CAIRO_TEST_SUCCESS &&
+	cairo_image_surface_load_png (a8, 0, 0, filename) != CAIRO_STATUS_INVALID_FORMAT)
+    {
+	cairo_test_log (ctx, "Error: expected INVALID_FORMAT for an A8 destination\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+    cairo_surface_destroy (a8);
+
+    cairo_surface_destroy (dst);
+    cairo_surface_destroy (src);
+    free (filename);
+
+    return result;
+}
+
+CAIRO_TEST (png_load,
+	    "Check decoding a PNG into an existing image surface",
+	    "png, api", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
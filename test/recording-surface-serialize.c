@@ -0,0 +1,261 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Check that a recording surface written with
+ * cairo_recording_surface_write_to_stream() and loaded back with
+ * cairo_recording_surface_create_from_data() or replayed with
+ * cairo_recording_surface_replay_data() renders identically, and that
+ * truncated data is rejected.
+ */
+
+#define WIDTH 120
+#define HEIGHT 80
+
+struct buffer {
+    unsigned char *data;
+    unsigned long length;
+    unsigned long size;
+};
+
+static cairo_status_t
+write_buffer (void *closure, const unsigned char *data, unsigned int length)
+{
+    struct buffer *buffer = closure;
+
+    if (buffer->length + length > buffer->size) {
+	unsigned long size = 2 * buffer->size + length;
+	unsigned char *ptr = realloc (buffer->data, size);
+
+	if (ptr == NULL)
+	    return CAIRO_STATUS_WRITE_ERROR;
+
+	buffer->data = ptr;
+	buffer->size = size;
+    }
+
+    memcpy (buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_surface_t *
+record (void)
+{
+    cairo_rectangle_t extents = { 0, 0, WIDTH, HEIGHT };
+    cairo_surface_t *recording, *nested, *image;
+    cairo_pattern_t *pattern;
+    double dash[] = { 4, 2 };
+    cairo_t *cr;
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_RGB24, 4, 4);
+    cr = cairo_create (image);
+    cairo_set_source_rgb (cr, 0, 0, 1);
+    cairo_paint (cr);
+    cairo_rectangle (cr, 0, 0, 2, 2);
+    cairo_set_source_rgb (cr, 1, 1, 0);
+    cairo_fill (cr);
+    cairo_destroy (cr);
+
+    nested = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+    cr = cairo_create (nested);
+    cairo_set_source_rgba (cr, 1, 0, 0, .5);
+    cairo_arc (cr, 20, 20, 15, 0, 2 * M_PI);
+    cairo_fill (cr);
+    cairo_destroy (cr);
+
+    recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA,
+						&extents);
+    cr = cairo_create (recording);
+
+    pattern = cairo_pattern_create_linear (0, 0, WIDTH, HEIGHT);
+    cairo_pattern_add_color_stop_rgb (pattern, 0, 1, 1, 1);
+    cairo_pattern_add_color_stop_rgb (pattern, 1, 0, .5, 0);
+    cairo_set_source (cr, pattern);
+    cairo_pattern_destroy (pattern);
+    cairo_paint (cr);
+
+    cairo_save (cr);
+    cairo_arc (cr, WIDTH / 2, HEIGHT / 2, 30, 0, 2 * M_PI);
+    cairo_clip (cr);
+    cairo_set_source_surface (cr, image, 10, 10);
+    cairo_pattern_set_extend (cairo_get_source (cr), CAIRO_EXTEND_REPEAT);
+    cairo_pattern_set_filter (cairo_get_source (cr), CAIRO_FILTER_NEAREST);
+    cairo_rectangle (cr, 0, 0, WIDTH, HEIGHT / 2);
+    cairo_fill (cr);
+    cairo_restore (cr);
+
+    cairo_set_source_surface (cr, nested, 60, 30);
+    cairo_paint_with_alpha (cr, .75);
+
+    cairo_set_source_rgb (cr, 0, 0, 0);
+    cairo_set_line_width (cr, 3);
+    cairo_set_dash (cr, dash, 2, 1);
+    cairo_move_to (cr, 5, 70);
+    cairo_curve_to (cr, 30, 40, 90, 100, 115, 70);
+    cairo_stroke (cr);
+
+    cairo_select_font_face (cr, CAIRO_TEST_FONT_FAMILY " Sans",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cr, 16);
+    cairo_move_to (cr, 10, 30);
+    cairo_show_text (cr, "cairo");
+
+    cairo_destroy (cr);
+
+    cairo_surface_destroy (nested);
+    cairo_surface_destroy (image);
+
+    return recording;
+}
+
+static cairo_surface_t *
+replay (const struct buffer *buffer, unsigned long length,
+	cairo_status_t *status)
+{
+    cairo_surface_t *image;
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, WIDTH, HEIGHT);
+    *status = cairo_recording_surface_replay_data (buffer->data, length,
+						   image);
+    cairo_surface_flush (image);
+
+    return image;
+}
+
+static cairo_surface_t *
+render (cairo_surface_t *recording)
+{
+    cairo_surface_t *image;
+    cairo_t *cr;
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, WIDTH, HEIGHT);
+    cr = cairo_create (image);
+    cairo_set_source_surface (cr, recording, 0, 0);
+    cairo_paint (cr);
+    cairo_destroy (cr);
+    cairo_surface_flush (image);
+
+    return image;
+}
+
+static cairo_bool_t
+images_equal (cairo_surface_t *a, cairo_surface_t *b)
+{
+    const unsigned char *da, *db;
+    int stride, y;
+
+    da = cairo_image_surface_get_data (a);
+    db = cairo_image_surface_get_data (b);
+    stride = cairo_image_surface_get_stride (a);
+    for (y = 0; y < HEIGHT; y++) {
+	if (memcmp (da + y * stride, db + y * stride, 4 * WIDTH))
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    struct buffer buffer = { NULL, 0, 0 };
+    cairo_surface_t *recording, *loaded;
+    cairo_surface_t *expected, *actual;
+    cairo_status_t status;
+
+    recording = record ();
+    status = cairo_recording_surface_write_to_stream (recording,
+						      write_buffer, &buffer);
+    if (status) {
+	cairo_test_log (ctx, "Error: writing the recording: %s\n",
+			cairo_status_to_string (status));
+	cairo_surface_destroy (recording);
+	free (buffer.data);
+	return cairo_test_status_from_status (ctx, status);
+    }
+
+    loaded = cairo_recording_surface_create_from_data (buffer.data,
+						       buffer.length);
+    status = cairo_surface_status (loaded);
+    if (status) {
+	cairo_test_log (ctx, "Error: loading the recording: %s\n",
+			cairo_status_to_string (status));
+	result = cairo_test_status_from_status (ctx, status);
+    } else {
+	expected = render (recording);
+	actual = render (loaded);
+	if (! images_equal (expected, actual)) {
+	    cairo_test_log (ctx, "Error: loaded recording renders differently\n");
+	    result = CAIRO_TEST_FAILURE;
+	}
+	cairo_surface_destroy (actual);
+
+	actual = replay (&buffer, buffer.length, &status);
+	if (status) {
+	    cairo_test_log (ctx, "Error: replaying the recording: %s\n",
+			    cairo_status_to_string (status));
+	    result = cairo_test_status_from_status (ctx, status);
+	} else if (! images_equal (expected, actual)) {
+	    cairo_test_log (ctx, "Error: replayed recording renders differently\n");
+	    result = CAIRO_TEST_FAILURE;
+	}
+	cairo_surface_destroy (actual);
+	cairo_surface_destroy (expected);
+    }
+    cairo_surface_destroy (loaded);
+
+    loaded = cairo_recording_surface_create_from_data (buffer.data,
+						       buffer.length / 2);
+    if (cairo_surface_status (loaded) != CAIRO_STATUS_READ_ERROR) {
+	cairo_test_log (ctx, "Error: truncated data was not rejected\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+    cairo_surface_destroy (loaded);
+
+    actual = replay (&buffer, buffer.length / 2, &status);
+    if (status != CAIRO_STATUS_READ_ERROR) {
+	cairo_test_log (ctx, "Error: truncated data was replayed\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+    cairo_surface_destroy (actual);
+
+    cairo_surface_destroy (recording);
+    free (buffer.data);
+
+    return result;
+}
+
+CAIRO_TEST (recording_surface_serialize,
+	    "Check writing a recording surface and loading or replaying it back",
+	    "recording, api", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-test.h"
+
+#include <string.h>
+
+/* Check that replaying a recording surface tile by tile, possibly on
+ * several threads, reproduces the image obtained by painting it whole.
+ */
+
+#define WIDTH 300
+#define HEIGHT 200
+#define TILE 64
+
+struct closure {
+    cairo_surface_t *reference;
+    int num_tiles;
+    int mismatch;
+};
+
+static cairo_status_t
+check_tile (void *closure, cairo_surface_t *tile, int x, int y)
+{
+    struct closure *c = closure;
+    const unsigned char *ref, *data;
+    int ref_stride, stride;
+    int width, height, row;
+
+    ref = cairo_image_surface_get_data (c->reference);
+    ref_stride = cairo_image_surface_get_stride (c->reference);
+    data = cairo_image_surface_get_data (tile);
+    stride = cairo_image_surface_get_stride (tile);
+    width = cairo_image_surface_get_width (tile);
+    height = cairo_image_surface_get_height (tile);
+
+    for (row = 0; row < height; row++) {
+	if (memcmp (data + row * stride,
+		    ref + (y + row) * ref_stride + 4 * x,
+		    4 * width))
+	{
+	    c->mismatch = 1;
+	    return CAIRO_STATUS_INVALID_STATUS;
+	}
+    }
+
+    /* only a hint for the log, as we may be called concurrently */
+    c->num_tiles++;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_surface_t *
+record (void)
+{
+    cairo_rectangle_t extents = { 0, 0, WIDTH, HEIGHT };
+    cairo_surface_t *recording;
+    cairo_t *cr;
+    int i;
+
+    recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA,
+						&extents);
+    cr = cairo_create (recording);
+    for (i = 0; i < 200; i++) {
+	cairo_set_source_rgba (cr,
+			       (i % 3) / 2., (i % 5) / 4., (i % 7) / 6., .75);
+	cairo_arc (cr,
+		   (i * 37) % WIDTH, (i * 53) % HEIGHT,
+		   5 + i % 23,
+		   0, 2 * M_PI);
+	cairo_fill (cr);
+    }
+    cairo_destroy (cr);
+
+    return recording;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    struct closure c;
+    cairo_surface_t *recording;
+    cairo_status_t status;
+    cairo_t *cr;
+    int threads;
+
+    recording = record ();
+
+    c.reference = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+					      WIDTH, HEIGHT);
+    cr = cairo_create (c.reference);
+    cairo_set_source_surface (cr, recording, 0, 0);
+    cairo_paint (cr);
+    cairo_destroy (cr);
+    cairo_surface_flush (c.reference);
+
+    status = CAIRO_STATUS_SUCCESS;
+    for (threads = 1; threads <= 4 && status == CAIRO_STATUS_SUCCESS; threads *= 2) {
+	c.num_tiles = 0;
+	c.mismatch = 0;
+	status = cairo_recording_surface_replay_tiles (recording, NULL,
+						       CAIRO_FORMAT_ARGB32,
+						       TILE, TILE,
+						       threads,
+						       check_tile, &c);
+	if (c.mismatch) {
+	    cairo_test_log (ctx,
+			    "Error: tile mismatch replaying on %d threads\n",
+			    threads);
+	} else if (status) {
+	    cairo_test_log (ctx,
+			    "Error: replaying tiles on %d threads: %s\n",
+			    threads, cairo_status_to_string (status));
+	}
+    }
+
+    cairo_surface_destroy (c.reference);
+    cairo_surface_destroy (recording);
+
+    if (c.mismatch)
+	return CAIRO_TEST_FAILURE;
+
+    return cairo_test_status_from_status (ctx, status);
+}
+
+CAIRO_TEST (recording_surface_tiles,
+	    "Check replaying a recording surface by tiles",
+	    "recording, api", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -0,0 +1,257 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cairo-test.h"
+
+/* Check that cairo_scaled_font_preload_glyphs() loads every glyph
+ * once, that the preloaded glyphs stay cached while the glyphs of
+ * another font overflow the glyph cache, and that they are released
+ * along with the last reference to their font.
+ *
+ * A user font renders a glyph whenever it is (re)loaded into the
+ * cache, so counting the calls to render_glyph tells which glyphs
+ * were evicted. The other font looks up more glyphs in a single call
+ * than the cache holds, so once it is done every glyph that may be
+ * evicted has been.
+ */
+
+#define NUM_PRELOADED 16
+#define FIRST_UNPINNED 128
+#define NUM_UNPINNED 64
+#define NUM_PRESSURE (1024 * 32)
+
+static int render_count[FIRST_UNPINNED + NUM_UNPINNED];
+
+static cairo_status_t
+counted_render_glyph (cairo_scaled_font_t  *scaled_font,
+		      unsigned long         glyph,
+		      cairo_t              *cr,
+		      cairo_text_extents_t *extents)
+{
+    if (glyph < FIRST_UNPINNED + NUM_UNPINNED)
+	render_count[glyph]++;
+
+    cairo_rectangle (cr, 0.1, -0.8, 0.6, 0.8);
+    cairo_fill (cr);
+    extents->x_advance = 0.8;
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+pressure_render_glyph (cairo_scaled_font_t  *scaled_font,
+		       unsigned long         glyph,
+		       cairo_t              *cr,
+		       cairo_text_extents_t *extents)
+{
+    extents->x_advance = 0.8;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_scaled_font_t *
+create_scaled_font (cairo_user_scaled_font_render_glyph_func_t render_glyph)
+{
+    cairo_font_face_t *font_face;
+    cairo_font_options_t *options;
+    cairo_scaled_font_t *scaled_font;
+    cairo_matrix_t font_matrix, ctm;
+
+    font_face = cairo_user_font_face_create ();
+    cairo_user_font_face_set_render_glyph_func (font_face, render_glyph);
+
+    cairo_matrix_init_scale (&font_matrix, 16, 16);
+    cairo_matrix_init_identity (&ctm);
+    options = cairo_font_options_create ();
+    scaled_font = cairo_scaled_font_create (font_face,
+					    &font_matrix, &ctm, options);
+    cairo_font_options_destroy (options);
+    cairo_font_face_destroy (font_face);
+
+    return scaled_font;
+}
+
+static void
+draw_glyphs (cairo_scaled_font_t *scaled_font,
+	     unsigned long first, int num_glyphs)
+{
+    cairo_surface_t *surface;
+    cairo_glyph_t glyphs[NUM_UNPINNED];
+    cairo_t *cr;
+    int i;
+
+    for (i = 0; i < num_glyphs; i++) {
+	glyphs[i].index = first + i;
+	glyphs[i].x = 2 + 13 * i;
+	glyphs[i].y = 16;
+    }
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_A8, 1024, 20);
+    cr = cairo_create (surface);
+    cairo_set_scaled_font (cr, scaled_font);
+    cairo_show_glyphs (cr, glyphs, num_glyphs);
+    cairo_destroy (cr);
+    cairo_surface_destroy (surface);
+}
+
+static cairo_status_t
+apply_cache_pressure (void)
+{
+    cairo_scaled_font_t *scaled_font;
+    cairo_text_extents_t extents;
+    cairo_glyph_t *glyphs;
+    cairo_status_t status;
+    int i;
+
+    glyphs = xmalloc (NUM_PRESSURE * sizeof (cairo_glyph_t));
+    for (i = 0; i < NUM_PRESSURE; i++) {
+	glyphs[i].index = i;
+	glyphs[i].x = glyphs[i].y = 0;
+    }
+
+    scaled_font = create_scaled_font (pressure_render_glyph);
+    cairo_scaled_font_glyph_extents (scaled_font,
+				     glyphs, NUM_PRESSURE, &extents);
+    status = cairo_scaled_font_status (scaled_font);
+    cairo_scaled_font_destroy (scaled_font);
+    free (glyphs);
+
+    return status;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    cairo_scaled_font_t *scaled_font;
+    cairo_font_face_t *font_face;
+    cairo_font_options_t *options;
+    cairo_matrix_t font_matrix, ctm;
+    cairo_glyph_t glyphs[NUM_PRELOADED];
+    cairo_status_t status;
+    int i;
+
+    scaled_font = create_scaled_font (counted_render_glyph);
+
+    for (i = 0; i < NUM_PRELOADED; i++) {
+	glyphs[i].index = i;
+	glyphs[i].x = glyphs[i].y = 0;
+    }
+    status = cairo_scaled_font_preload_glyphs (scaled_font,
+					       glyphs, NUM_PRELOADED,
+					       CAIRO_GLYPH_PRELOAD_SURFACE);
+    if (status) {
+	cairo_test_log (ctx, "Error: preloading the glyphs: %s\n",
+			cairo_status_to_string (status));
+	cairo_scaled_font_destroy (scaled_font);
+	return cairo_test_status_from_status (ctx, status);
+    }
+
+    for (i = 0; i < NUM_PRELOADED; i++) {
+	if (render_count[i] != 1) {
+	    cairo_test_log (ctx, "Error: glyph %d was rendered %d times by preloading\n",
+			    i, render_count[i]);
+	    result = CAIRO_TEST_FAILURE;
+	}
+    }
+
+    /* fill pages of the same font that nothing pins */
+    draw_glyphs (scaled_font, FIRST_UNPINNED, NUM_UNPINNED);
+
+    status = apply_cache_pressure ();
+    if (status) {
+	cairo_test_log (ctx, "Error: filling the glyph cache: %s\n",
+			cairo_status_to_string (status));
+	cairo_scaled_font_destroy (scaled_font);
+	return cairo_test_status_from_status (ctx, status);
+    }
+
+    draw_glyphs (scaled_font, 0, NUM_PRELOADED);
+    draw_glyphs (scaled_font, FIRST_UNPINNED, NUM_UNPINNED);
+
+    for (i = 0; i < NUM_PRELOADED; i++) {
+	if (render_count[i] != 1) {
+	    cairo_test_log (ctx, "Error: preloaded glyph %d was evicted\n", i);
+	    result = CAIRO_TEST_FAILURE;
+	}
+    }
+
+    /* the last glyph drawn lies beyond the pinned pages */
+    if (render_count[FIRST_UNPINNED + NUM_UNPINNED - 1] != 2) {
+	cairo_test_log (ctx, "Error: the glyph cache was not put under pressure\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+
+    if (cairo_scaled_font_preload_glyphs (scaled_font, glyphs, -1,
+					  CAIRO_GLYPH_PRELOAD_SURFACE) !=
+	CAIRO_STATUS_NEGATIVE_COUNT ||
+	cairo_scaled_font_preload_glyphs (scaled_font, NULL, 1,
+					  CAIRO_GLYPH_PRELOAD_SURFACE) !=
+	CAIRO_STATUS_NULL_POINTER)
+    {
+	cairo_test_log (ctx, "Error: bad arguments were not rejected\n");
+	result = CAIRO_TEST_FAILURE;
+    }
+
+    /* the font is kept among the holdovers, without its pins */
+    font_face = cairo_font_face_reference (cairo_scaled_font_get_font_face (scaled_font));
+    cairo_scaled_font_get_font_matrix (scaled_font, &font_matrix);
+    cairo_scaled_font_get_ctm (scaled_font, &ctm);
+    options = cairo_font_options_create ();
+    cairo_scaled_font_get_font_options (scaled_font, options);
+    cairo_scaled_font_destroy (scaled_font);
+
+    status = apply_cache_pressure ();
+    if (status) {
+	cairo_test_log (ctx, "Error: filling the glyph cache: %s\n",
+			cairo_status_to_string (status));
+	cairo_font_options_destroy (options);
+	cairo_font_face_destroy (font_face);
+	return cairo_test_status_from_status (ctx, status);
+    }
+
+    scaled_font = cairo_scaled_font_create (font_face,
+					    &font_matrix, &ctm, options);
+    cairo_font_options_destroy (options);
+    cairo_font_face_destroy (font_face);
+
+    draw_glyphs (scaled_font, 0, NUM_PRELOADED);
+
+    for (i = 0; i < NUM_PRELOADED; i++) {
+	if (render_count[i] != 2) {
+	    cairo_test_log (ctx, "Error: glyph %d stayed pinned after its font was destroyed\n", i);
+	    result = CAIRO_TEST_FAILURE;
+	}
+    }
+
+    cairo_scaled_font_destroy (scaled_font);
+
+    return result;
+}
+
+CAIRO_TEST (scaled_font_preload_glyphs,
+	    "Check that glyphs loaded with cairo_scaled_font_preload_glyphs() stay cached",
+	    "font, api", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
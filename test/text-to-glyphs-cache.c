@@ -0,0 +1,157 @@
+/*
+ * Copyright © 2026 The cairo authors
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "cairo-test.h"
+
+#include <math.h>
+#include <string.h>
+
+/* Check that cairo_scaled_font_text_to_glyphs() gives the same glyphs
+ * and positions when a scaled font has converted text before, and so
+ * answers from its cache of characters, as when each character is
+ * looked up on its own.
+ *
+ * The text includes characters beyond Latin-1 which share cache slots
+ * with ASCII ones (U+0141 with 'A', U+0161 with 'a'), and is longer than
+ * the threshold for the cache to be created.
+ */
+
+static const char *chars[] = {
+    "A", "\xc5\x81", "a", "\xc5\xa1", "H", "a", "m", "b", "u", "r", "g",
+    "e", "f", "o", "n", "s", "t", "i", "v", " ", "0", "1", "2", "A",
+    "\xc5\x81", "a",
+};
+
+static cairo_bool_t
+check_conversion (cairo_test_context_t *ctx,
+		  cairo_scaled_font_t *scaled_font,
+		  const char *utf8,
+		  const cairo_glyph_t *expected,
+		  int num_expected)
+{
+    cairo_glyph_t *glyphs = NULL;
+    cairo_status_t status;
+    cairo_bool_t ret = TRUE;
+    int num_glyphs, i;
+
+    status = cairo_scaled_font_text_to_glyphs (scaled_font, 0, 0, utf8, -1,
+					       &glyphs, &num_glyphs,
+					       NULL, NULL, NULL);
+    if (status) {
+	cairo_test_log (ctx, "Error: converting the text: %s\n",
+			cairo_status_to_string (status));
+	return FALSE;
+    }
+
+    if (num_glyphs != num_expected) {
+	cairo_test_log (ctx, "Error: expected %d glyphs, got %d\n",
+			num_expected, num_glyphs);
+	ret = FALSE;
+    } else {
+	for (i = 0; i < num_glyphs; i++) {
+	    if (glyphs[i].index != expected[i].index ||
+		fabs (glyphs[i].x - (expected[i].x - expected[0].x)) > 1e-6 ||
+		fabs (glyphs[i].y - (expected[i].y - expected[0].y)) > 1e-6)
+	    {
+		cairo_test_log (ctx, "Error: glyph %d differs\n", i);
+		ret = FALSE;
+		break;
+	    }
+	}
+    }
+
+    cairo_glyph_free (glyphs);
+    return ret;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t result = CAIRO_TEST_SUCCESS;
+    cairo_glyph_t expected[ARRAY_LENGTH (chars)];
+    cairo_scaled_font_t *scaled_font;
+    cairo_surface_t *surface;
+    char text[256] = "";
+    double x = 0, y = 0;
+    cairo_t *cr;
+    int i;
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_RGB24, 1, 1);
+    cr = cairo_create (surface);
+    cairo_select_font_face (cr, CAIRO_TEST_FONT_FAMILY " Sans",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cr, 13);
+    scaled_font = cairo_get_scaled_font (cr);
+
+    /* A single character is converted without consulting the cache. */
+    for (i = 0; i < ARRAY_LENGTH (chars); i++) {
+	cairo_glyph_t *glyph = &expected[i];
+	cairo_text_extents_t extents;
+	int num_glyphs = 1;
+
+	if (cairo_scaled_font_text_to_glyphs (scaled_font, x, y,
+					      chars[i], -1,
+					      &glyph, &num_glyphs,
+					      NULL, NULL, NULL) ||
+	    num_glyphs != 1)
+	{
+	    cairo_test_log (ctx, "Error: converting '%s'\n", chars[i]);
+	    result = CAIRO_TEST_FAILURE;
+	    goto CLEANUP;
+	}
+
+	cairo_scaled_font_glyph_extents (scaled_font, glyph, 1, &extents);
+	x += extents.x_advance;
+	y += extents.y_advance;
+
+	strcat (text, chars[i]);
+    }
+
+    /* The first conversion fills the cache, the second reads it back. */
+    for (i = 0; i < 2; i++) {
+	if (! check_conversion (ctx, scaled_font, text,
+				expected, ARRAY_LENGTH (chars)))
+	    result = CAIRO_TEST_FAILURE;
+    }
+
+    /* Short strings use the cache once the font has one. */
+    if (! check_conversion (ctx, scaled_font, "a\xc5\xa1H",
+			    expected + 2, 3))
+	result = CAIRO_TEST_FAILURE;
+
+CLEANUP:
+    cairo_destroy (cr);
+    cairo_surface_destroy (surface);
+
+    return result;
+}
+
+CAIRO_TEST (text_to_glyphs_cache,
+	    "Check converting text with a scaled font's cache of characters",
+	    "text, font, api", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -26,8 +26,11 @@
 #include <cairo-script.h>
 #include <cairo-tee.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <assert.h>
 #include <signal.h>
+#include <time.h>
+#include <unistd.h>
 
 #include <dlfcn.h>
 
@@ -52,6 +55,45 @@ static int fdr_dump;
 
 static const cairo_user_data_key_t fdr_key;
 
+/* Latency recording.
+ *
+ * Every drawing operation is timed. Each surface remembers the last
+ * FDR_OPS operations together with their start times and durations,
+ * and keeps the operations themselves in two recording segments of up
+ * to FDR_OPS operations each. When an operation takes longer than
+ * FDR_LATENCY_MS milliseconds, the operation table and both segments
+ * are written to FDR_DIR/fdr-<pid>-<n>.trace, at most FDR_MAX_DUMPS
+ * times. The slice replays with cairo-script like any other trace.
+ */
+#define FDR_OPS_DEFAULT 64
+#define FDR_MAX_DUMPS_DEFAULT 16
+
+struct fdr_op {
+    const char *name;
+    double start; /* ms */
+    double duration; /* ms */
+};
+
+struct fdr_surface {
+    cairo_surface_t *previous; /* the last full recording segment */
+    int segment_ops;
+
+    struct fdr_op *ops;
+    int num_ops;
+    int next_op;
+};
+
+static const cairo_user_data_key_t fdr_state_key;
+
+static struct {
+    int initialized;
+    double threshold; /* ms, or 0 for no dumps */
+    int max_ops;
+    int max_dumps;
+    int num_dumps;
+    const char *dir;
+} fdr_latency;
+
 static void
 fdr_replay_to_script (cairo_surface_t *recording, cairo_device_t *ctx)
 {
@@ -118,6 +160,203 @@ fdr_pending_signals (void)
     }
 }
 
+static void
+fdr_latency_init (void)
+{
+    const char *env;
+
+    fdr_latency.initialized = 1;
+
+    env = getenv ("FDR_LATENCY_MS");
+    if (env != NULL)
+	fdr_latency.threshold = atof (env);
+
+    fdr_latency.max_ops = FDR_OPS_DEFAULT;
+    env = getenv ("FDR_OPS");
+    if (env != NULL && atoi (env) > 0)
+	fdr_latency.max_ops = atoi (env);
+
+    fdr_latency.max_dumps = FDR_MAX_DUMPS_DEFAULT;
+    env = getenv ("FDR_MAX_DUMPS");
+    if (env != NULL)
+	fdr_latency.max_dumps = atoi (env);
+
+    fdr_latency.dir = getenv ("FDR_DIR");
+    if (fdr_latency.dir == NULL)
+	fdr_latency.dir = "/tmp";
+}
+
+static double
+fdr_now (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+static void
+fdr_state_destroy (void *closure)
+{
+    struct fdr_surface *state = closure;
+
+    if (state->previous != NULL)
+	DLCALL (cairo_surface_destroy, state->previous);
+    free (state->ops);
+    free (state);
+}
+
+static struct fdr_surface *
+fdr_surface_get_state (cairo_surface_t *tee)
+{
+    struct fdr_surface *state;
+
+    state = DLCALL (cairo_surface_get_user_data, tee, &fdr_state_key);
+    if (state != NULL)
+	return state;
+
+    state = calloc (1, sizeof (struct fdr_surface));
+    if (state == NULL)
+	return NULL;
+
+    state->ops = calloc (fdr_latency.max_ops, sizeof (struct fdr_op));
+    if (state->ops == NULL ||
+	DLCALL (cairo_surface_set_user_data, tee,
+		&fdr_state_key, state, fdr_state_destroy))
+    {
+	free (state->ops);
+	free (state);
+	return NULL;
+    }
+
+    return state;
+}
+
+/* Start a new recording segment, keeping the full one for dumps */
+static void
+fdr_surface_rotate (cairo_surface_t *tee, struct fdr_surface *state)
+{
+    cairo_surface_t *record, *fresh;
+    cairo_rectangle_t extents;
+    cairo_rectangle_t *r = NULL;
+    int n;
+
+    record = DLCALL (cairo_tee_surface_index, tee, 1);
+    if (DLCALL (cairo_surface_status, record))
+	return;
+
+    if (DLCALL (cairo_recording_surface_get_extents, record, &extents))
+	r = &extents;
+    fresh = DLCALL (cairo_recording_surface_create,
+		    DLCALL (cairo_surface_get_content, record), r);
+
+    DLCALL (cairo_surface_reference, record);
+    if (state->previous != NULL)
+	DLCALL (cairo_surface_destroy, state->previous);
+    state->previous = record;
+
+    DLCALL (cairo_tee_surface_remove, tee, record);
+    DLCALL (cairo_tee_surface_add, tee, fresh);
+
+    for (n = 0; n < RINGBUFFER_SIZE; n++) {
+	if (fdr_ringbuffer[n] == record) {
+	    DLCALL (cairo_surface_destroy, record);
+	    fdr_ringbuffer[n] = DLCALL (cairo_surface_reference, fresh);
+	}
+    }
+    DLCALL (cairo_surface_destroy, fresh);
+
+    state->segment_ops = 0;
+}
+
+static void
+fdr_dump_slice (cairo_surface_t *tee,
+		struct fdr_surface *state,
+		const struct fdr_op *slow)
+{
+    char filename[4096], comment[256];
+    cairo_device_t *ctx;
+    int n, i;
+
+    snprintf (filename, sizeof (filename), "%s/fdr-%d-%d.trace",
+	      fdr_latency.dir, getpid (), fdr_latency.num_dumps++);
+
+    ctx = DLCALL (cairo_script_create, filename);
+    if (DLCALL (cairo_device_status, ctx)) {
+	DLCALL (cairo_device_destroy, ctx);
+	return;
+    }
+
+    snprintf (comment, sizeof (comment),
+	      "--- fdr: %s took %.3fms (threshold %.3fms) ---",
+	      slow->name, slow->duration, fdr_latency.threshold);
+    DLCALL (cairo_script_write_comment, ctx, comment, -1);
+
+    /* the timings of the preceding operations, oldest first */
+    for (n = 0; n < state->num_ops; n++) {
+	const struct fdr_op *op;
+
+	i = state->next_op - state->num_ops + n;
+	if (i < 0)
+	    i += fdr_latency.max_ops;
+	op = &state->ops[i];
+
+	snprintf (comment, sizeof (comment),
+		  "fdr: %+.3fms %s %.3fms",
+		  op->start - slow->start, op->name, op->duration);
+	DLCALL (cairo_script_write_comment, ctx, comment, -1);
+    }
+
+    fdr_replay_to_script (state->previous, ctx);
+    fdr_replay_to_script (DLCALL (cairo_tee_surface_index, tee, 1), ctx);
+
+    DLCALL (cairo_device_destroy, ctx);
+}
+
+static void
+fdr_record_op (cairo_t *cr, const char *name, double start)
+{
+    struct fdr_surface *state;
+    cairo_surface_t *tee;
+    struct fdr_op *op;
+
+    tee = DLCALL (cairo_get_target, cr);
+    if (DLCALL (cairo_surface_get_type, tee) != CAIRO_SURFACE_TYPE_TEE)
+	return;
+
+    state = fdr_surface_get_state (tee);
+    if (state == NULL)
+	return;
+
+    op = &state->ops[state->next_op];
+    op->name = name;
+    op->start = start;
+    op->duration = fdr_now () - start;
+    if (++state->next_op == fdr_latency.max_ops)
+	state->next_op = 0;
+    if (state->num_ops < fdr_latency.max_ops)
+	state->num_ops++;
+
+    if (fdr_latency.threshold > 0 &&
+	op->duration > fdr_latency.threshold &&
+	fdr_latency.num_dumps < fdr_latency.max_dumps)
+    {
+	fdr_dump_slice (tee, state, op);
+    }
+
+    if (++state->segment_ops == fdr_latency.max_ops)
+	fdr_surface_rotate (tee, state);
+}
+
+#define FDR_TIMED(cr, name, call) do { \
+    double start__; \
+    if (! fdr_latency.initialized) \
+	fdr_latency_init (); \
+    start__ = fdr_now (); \
+    call; \
+    fdr_record_op (cr, name, start__); \
+} while (0)
+
 static void
 fdr_get_extents (cairo_surface_t *surface,
 		 cairo_rectangle_t *extents)
@@ -329,3 +568,92 @@ cairo_surface_create_for_rectangle (cairo_surface_t *surface,
     return DLCALL (cairo_surface_create_for_rectangle,
 		   surface, x, y, width, height);
 }
+
+void
+cairo_paint (cairo_t *cr)
+{
+    FDR_TIMED (cr, "paint", DLCALL (cairo_paint, cr));
+}
+
+void
+cairo_paint_with_alpha (cairo_t *cr, double alpha)
+{
+    FDR_TIMED (cr, "paint-with-alpha",
+	       DLCALL (cairo_paint_with_alpha, cr, alpha));
+}
+
+void
+cairo_mask (cairo_t *cr, cairo_pattern_t *pattern)
+{
+    FDR_TIMED (cr, "mask", DLCALL (cairo_mask, cr, pattern));
+}
+
+void
+cairo_mask_surface (cairo_t *cr,
+		    cairo_surface_t *surface,
+		    double x, double y)
+{
+    cairo_surface_t *tee;
+
+    tee = fdr_surface_get_tee (surface);
+    if (tee != NULL)
+	surface = tee;
+
+    FDR_TIMED (cr, "mask-surface",
+	       DLCALL (cairo_mask_surface, cr, surface, x, y));
+}
+
+void
+cairo_stroke (cairo_t *cr)
+{
+    FDR_TIMED (cr, "stroke", DLCALL (cairo_stroke, cr));
+}
+
+void
+cairo_stroke_preserve (cairo_t *cr)
+{
+    FDR_TIMED (cr, "stroke+", DLCALL (cairo_stroke_preserve, cr));
+}
+
+void
+cairo_fill (cairo_t *cr)
+{
+    FDR_TIMED (cr, "fill", DLCALL (cairo_fill, cr));
+}
+
+void
+cairo_fill_preserve (cairo_t *cr)
+{
+    FDR_TIMED (cr, "fill+", DLCALL (cairo_fill_preserve, cr));
+}
+
+void
+cairo_show_glyphs (cairo_t *cr, const cairo_glyph_t *glyphs, int num_glyphs)
+{
+    FDR_TIMED (cr, "show-glyphs",
+	       DLCALL (cairo_show_glyphs, cr, glyphs, num_glyphs));
+}
+
+void
+cairo_show_text (cairo_t *cr, const char *utf8)
+{
+    FDR_TIMED (cr, "show-text", DLCALL (cairo_show_text, cr, utf8));
+}
+
+void
+cairo_show_text_glyphs (cairo_t			   *cr,
+			const char		   *utf8,
+			int			    utf8_len,
+			const cairo_glyph_t	   *glyphs,
+			int			    num_glyphs,
+			const cairo_text_cluster_t *clusters,
+			int			    num_clusters,
+			cairo_text_cluster_flags_t  cluster_flags)
+{
+    FDR_TIMED (cr, "show-text-glyphs",
+	       DLCALL (cairo_show_text_glyphs, cr,
+		       utf8, utf8_len,
+		       glyphs, num_glyphs,
+		       clusters, num_clusters,
+		       cluster_flags));
+}
@@ -257,6 +257,27 @@ _add_real_constant (csi_t *ctx,
     return csi_dictionary_put (ctx, dict, name.datum.name, &constant);
 }
 
+static csi_status_t
+_init_user_dictionaries (csi_t *ctx)
+{
+    csi_status_t status;
+    csi_object_t obj;
+
+    /* globaldict */
+    status = csi_dictionary_new (ctx, &obj);
+    if (_csi_unlikely (status))
+	return status;
+    status = _csi_stack_push (ctx, &ctx->dstack, &obj);
+    if (_csi_unlikely (status))
+	return status;
+
+    /* userdict */
+    status = csi_dictionary_new (ctx, &obj);
+    if (_csi_unlikely (status))
+	return status;
+    return _csi_stack_push (ctx, &ctx->dstack, &obj);
+}
+
 static csi_status_t
 _init_dictionaries (csi_t *ctx)
 {
@@ -333,24 +354,17 @@ _init_dictionaries (csi_t *ctx)
     /* and seal */
     //dict.type &= ~CSI_OBJECT_ATTR_WRITABLE;
 
+    return _init_user_dictionaries (ctx);
+}
 
-    /* globaldict */
-    status = csi_dictionary_new (ctx, &obj);
-    if (_csi_unlikely (status))
-	return status;
-    status = _csi_stack_push (ctx, stack, &obj);
-    if (_csi_unlikely (status))
-	return status;
-
-    /* userdict */
-    status = csi_dictionary_new (ctx, &obj);
-    if (_csi_unlikely (status))
-	return status;
-    status = _csi_stack_push (ctx, stack, &obj);
-    if (_csi_unlikely (status))
-	return status;
+/* Drop everything the script created, leaving only systemdict. */
+static csi_status_t
+_csi_reset (csi_t *ctx)
+{
+    _csi_stack_pop (ctx, &ctx->ostack, ctx->ostack.len);
+    _csi_stack_pop (ctx, &ctx->dstack, ctx->dstack.len - 1);
 
-    return CSI_STATUS_SUCCESS;
+    return _init_user_dictionaries (ctx);
 }
 
 /* intern string */
@@ -424,6 +438,8 @@ FAIL:
 static void
 _csi_finish (csi_t *ctx)
 {
+    if (ctx->program.type != CSI_OBJECT_TYPE_NULL)
+	csi_object_free (ctx, &ctx->program);
     _csi_stack_fini (ctx, &ctx->ostack);
     _csi_stack_fini (ctx, &ctx->dstack);
     _csi_scanner_fini (ctx, &ctx->scanner);
@@ -566,6 +582,54 @@ cairo_script_interpreter_run (csi_t *ctx, const char *filename)
     return ctx->status;
 }
 
+cairo_status_t
+cairo_script_interpreter_compile (csi_t *ctx, const char *filename)
+{
+    csi_object_t file;
+
+    if (ctx->status)
+	return ctx->status;
+    if (ctx->finished)
+	return ctx->status = CSI_STATUS_INTERPRETER_FINISHED;
+
+    if (ctx->program.type != CSI_OBJECT_TYPE_NULL) {
+	csi_object_free (ctx, &ctx->program);
+	ctx->program.type = CSI_OBJECT_TYPE_NULL;
+    }
+
+    ctx->status = csi_file_new (ctx, &file, filename, "r");
+    if (ctx->status)
+	return ctx->status;
+
+    ctx->status = _csi_compile_file (ctx, file.datum.file, &ctx->program);
+    csi_object_free (ctx, &file);
+
+    return ctx->status;
+}
+
+cairo_status_t
+cairo_script_interpreter_run_compiled (csi_t *ctx)
+{
+    if (ctx->status)
+	return ctx->status;
+    if (ctx->finished)
+	return ctx->status = CSI_STATUS_INTERPRETER_FINISHED;
+    if (ctx->program.type == CSI_OBJECT_TYPE_NULL)
+	return ctx->status = _csi_error (CSI_STATUS_INVALID_SCRIPT);
+
+    ctx->status = _csi_reset (ctx);
+    if (ctx->status)
+	return ctx->status;
+
+    ctx->status = _csi_array_execute (ctx, ctx->program.datum.array);
+    if (ctx->status)
+	return ctx->status;
+
+    /* Release the surfaces and contexts the script created, as
+     * cairo_script_interpreter_finish() would. */
+    return ctx->status = _csi_reset (ctx);
+}
+
 cairo_status_t
 cairo_script_interpreter_feed_stream (csi_t *ctx, FILE *stream)
 {
@@ -93,6 +93,13 @@ cairo_public cairo_status_t
 cairo_script_interpreter_run (cairo_script_interpreter_t *ctx,
 			      const char *filename);
 
+cairo_public cairo_status_t
+cairo_script_interpreter_compile (cairo_script_interpreter_t *ctx,
+				  const char *filename);
+
+cairo_public cairo_status_t
+cairo_script_interpreter_run_compiled (cairo_script_interpreter_t *ctx);
+
 cairo_public cairo_status_t
 cairo_script_interpreter_feed_stream (cairo_script_interpreter_t *ctx,
 				      FILE *stream);
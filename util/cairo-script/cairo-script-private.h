@@ -476,6 +476,9 @@ struct _cairo_script_interpreter {
 
     csi_scanner_t scanner;
 
+    /* a script compiled for repeated execution */
+    csi_object_t program;
+
     csi_chunk_t *perm_chunk;
     struct {
 	csi_chunk_t *chunk;
@@ -832,6 +835,11 @@ _csi_translate_file (csi_t *ctx,
 		     cairo_write_func_t write_func,
 		     void *closure);
 
+csi_private csi_status_t
+_csi_compile_file (csi_t *ctx,
+		   csi_file_t *file,
+		   csi_object_t *program);
+
 csi_private void
 _csi_scanner_fini (csi_t *ctx, csi_scanner_t *scanner);
 
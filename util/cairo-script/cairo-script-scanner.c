@@ -1902,3 +1902,91 @@ _csi_translate_file (csi_t *ctx,
 
     return CSI_STATUS_SUCCESS;
 }
+
+/* Lower a script into a single executable array that can be run many
+ * times without rescanning. Names of system operators are replaced by
+ * the operators themselves (as 'bind' would), so that executing the
+ * program skips the dictionary lookups. This assumes the script does
+ * not redefine any of the system operators.
+ */
+static void
+_compile_bind (csi_t *ctx, csi_object_t *obj)
+{
+    csi_dictionary_t *systemdict;
+    csi_dictionary_entry_t *entry;
+    csi_array_t *array;
+    csi_integer_t n;
+
+    switch ((int) obj->type) {
+    case CSI_OBJECT_TYPE_NAME | CSI_OBJECT_ATTR_EXECUTABLE:
+	systemdict = ctx->dstack.objects[0].datum.dictionary;
+	entry = _csi_hash_table_lookup (&systemdict->hash_table,
+					(csi_hash_entry_t *) &obj->datum.name);
+	if (entry != NULL &&
+	    csi_object_get_type (&entry->value) == CSI_OBJECT_TYPE_OPERATOR)
+	{
+	    csi_operator_new (obj, entry->value.datum.op);
+	}
+	break;
+
+    case CSI_OBJECT_TYPE_ARRAY | CSI_OBJECT_ATTR_EXECUTABLE:
+	array = obj->datum.array;
+	for (n = 0; n < array->stack.len; n++)
+	    _compile_bind (ctx, &array->stack.objects[n]);
+	break;
+    }
+}
+
+static csi_status_t
+_compile_push (csi_t *ctx, csi_object_t *obj)
+{
+    csi_array_t *program = ctx->scanner.closure;
+    csi_status_t status;
+
+    _compile_bind (ctx, obj);
+    status = csi_array_append (ctx, program, obj);
+    csi_object_free (ctx, obj);
+
+    return status;
+}
+
+static csi_status_t
+_compile_execute (csi_t *ctx, csi_object_t *obj)
+{
+    csi_array_t *program = ctx->scanner.closure;
+
+    _compile_bind (ctx, obj);
+    return csi_array_append (ctx, program, obj);
+}
+
+csi_status_t
+_csi_compile_file (csi_t *ctx,
+		   csi_file_t *file,
+		   csi_object_t *program)
+{
+    csi_status_t status;
+
+    status = csi_array_new (ctx, 0, program);
+    if (_csi_unlikely (status))
+	return status;
+
+    if ((status = setjmp (ctx->scanner.jump_buffer))) {
+	ctx->scanner.push = _scan_push;
+	ctx->scanner.execute = _scan_execute;
+	csi_object_free (ctx, program);
+	program->type = CSI_OBJECT_TYPE_NULL;
+	return status;
+    }
+
+    ctx->scanner.closure = program->datum.array;
+    ctx->scanner.push = _compile_push;
+    ctx->scanner.execute = _compile_execute;
+
+    _scan_file (ctx, file);
+
+    ctx->scanner.push = _scan_push;
+    ctx->scanner.execute = _scan_execute;
+
+    program->type |= CSI_OBJECT_ATTR_EXECUTABLE;
+    return CSI_STATUS_SUCCESS;
+}
@@ -209,9 +209,13 @@ static cairo_bool_t _flush;
 static cairo_bool_t _error;
 static cairo_bool_t _line_info;
 static cairo_bool_t _mark_dirty;
+static cairo_bool_t _binary;
 static const cairo_user_data_key_t destroy_key;
 static pthread_once_t once_control = PTHREAD_ONCE_INIT;
 static pthread_key_t counter_key;
+#if ! (HAVE_FLOCKFILE && HAVE_FUNLOCKFILE)
+static pthread_mutex_t write_mutex;
+#endif
 
 static void _init_trace (void);
 
@@ -483,6 +487,18 @@ _init_trace (void)
     pthread_mutex_init (&Types.mutex, NULL);
     pthread_key_create (&counter_key, free);
 
+#if ! (HAVE_FLOCKFILE && HAVE_FUNLOCKFILE)
+    {
+	pthread_mutexattr_t attr;
+
+	/* recursive, as flockfile() is */
+	pthread_mutexattr_init (&attr);
+	pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init (&write_mutex, &attr);
+	pthread_mutexattr_destroy (&attr);
+    }
+#endif
+
     _type_create ("unclassed", NONE, "");
     _type_create ("cairo_t", CONTEXT, "c");
     _type_create ("cairo_font_face_t", FONT_FACE, "f");
@@ -491,10 +507,129 @@ _init_trace (void)
     _type_create ("cairo_surface_t", SURFACE, "s");
 }
 
+/* Output for a call is assembled here whilst the write lock is held
+ * and handed over to stdio in one piece, instead of as a dribble of
+ * fwrite()s for every conversion. The blob table below is likewise
+ * only touched under the write lock.
+ */
+static struct _trace_buffer {
+    unsigned char data[65536];
+    unsigned int length;
+    int last;
+} _buffer;
+
+static void
+_trace_buffer_flush (void)
+{
+    int ret_ignored;
+
+    if (_buffer.length == 0 || logfile == NULL)
+	return;
+
+    ret_ignored = fwrite (_buffer.data, 1, _buffer.length, logfile);
+    (void) ret_ignored;
+    _buffer.length = 0;
+}
+
+static void
+_trace_write (const void *data, size_t length)
+{
+    int ret_ignored;
+
+    if (length == 0)
+	return;
+
+    _buffer.last = ((const unsigned char *) data)[length - 1];
+
+    if (length > sizeof (_buffer.data) - _buffer.length) {
+	_trace_buffer_flush ();
+	if (length >= sizeof (_buffer.data)) {
+	    ret_ignored = fwrite (data, 1, length, logfile);
+	    (void) ret_ignored;
+	    return;
+	}
+    }
+
+    memcpy (_buffer.data + _buffer.length, data, length);
+    _buffer.length += length;
+}
+
+/* Binary tokens, see cairo-script-scanner.c. They are written in
+ * native byte order.
+ */
+#define BINARY_INT8 128
+#if WORDS_BIGENDIAN
+#define BINARY_INT16 130
+#define BINARY_INT32 132
+#define BINARY_FLOAT32 140
+#define BINARY_STRING_4_DEFLATE 149
+#else
+#define BINARY_INT16 133
+#define BINARY_INT32 135
+#define BINARY_FLOAT32 141
+#define BINARY_STRING_4_DEFLATE 151
+#endif
+
+static void
+_trace_write_token (const unsigned char *token, size_t length)
+{
+    /* A binary token only terminates the text token before it if
+     * there is a delimiter in between. */
+    switch (_buffer.last) {
+    case 0:
+    case ' ': case '\t': case '\n': case '\r': case '\f':
+    case '[': case ']': case '{': case '}': case '(': case ')':
+	break;
+    default:
+	_trace_write (" ", 1);
+	break;
+    }
+
+    _trace_write (token, length);
+    _buffer.last = ' ';
+}
+
+static void
+_trace_write_number (double d)
+{
+    unsigned char token[5];
+    int length;
+
+    if (d >= INT32_MIN && d <= INT32_MAX && d == floor (d)) {
+	int32_t v = d;
+
+	if (v >= INT8_MIN && v <= INT8_MAX) {
+	    token[0] = BINARY_INT8;
+	    token[1] = (int8_t) v;
+	    length = 2;
+	} else if (v >= INT16_MIN && v <= INT16_MAX) {
+	    int16_t v16 = v;
+
+	    token[0] = BINARY_INT16;
+	    memcpy (token + 1, &v16, 2);
+	    length = 3;
+	} else {
+	    token[0] = BINARY_INT32;
+	    memcpy (token + 1, &v, 4);
+	    length = 5;
+	}
+    } else {
+	/* The interpreter only keeps single precision reals. */
+	float f = d;
+
+	token[0] = BINARY_FLOAT32;
+	memcpy (token + 1, &f, 4);
+	length = 5;
+    }
+
+    _trace_write_token (token, length);
+}
+
 static void
 _close_trace (void)
 {
     if (logfile != NULL) {
+	_trace_buffer_flush ();
 	fclose (logfile);
 	logfile = NULL;
     }
@@ -624,7 +759,6 @@ _trace_vprintf (const char *fmt, va_list ap)
     const char *f, *start;
     int length_modifier, width;
     cairo_bool_t var_width;
-    int ret_ignored;
 
     assert (_should_trace ());
 
@@ -667,7 +801,7 @@ _trace_vprintf (const char *fmt, va_list ap)
 	single_fmt[single_fmt_length] = '\0';
 
 	/* Flush contents of buffer before snprintf()'ing into it. */
-	ret_ignored = fwrite (buffer, 1, p-buffer, logfile);
+	_trace_write (buffer, p-buffer);
 
 	/* We group signed and unsigned together in this switch, the
 	 * only thing that matters here is the size of the arguments,
@@ -710,7 +844,12 @@ _trace_vprintf (const char *fmt, va_list ap)
 	    break;
 	case 'f':
 	case 'g':
-	    _trace_dtostr (buffer, sizeof buffer, va_arg (ap, double));
+	    if (_binary) {
+		_trace_write_number (va_arg (ap, double));
+		buffer[0] = 0;
+	    } else {
+		_trace_dtostr (buffer, sizeof buffer, va_arg (ap, double));
+	    }
 	    break;
 	case 'c':
 	    buffer[0] = va_arg (ap, int);
@@ -723,8 +862,7 @@ _trace_vprintf (const char *fmt, va_list ap)
 	f++;
     }
 
-    ret_ignored = fwrite (buffer, 1, p-buffer, logfile);
-    (void)ret_ignored;
+    _trace_write (buffer, p-buffer);
 }
 
 static void CAIRO_PRINTF_FORMAT(1, 2)
@@ -775,7 +913,8 @@ _emit_header (void)
 
     get_prog_name (name, sizeof (name));
 
-    _trace_printf ("%%!CairoScript - %s\n", name);
+    /* before the write lock is taken, so not through _buffer */
+    fprintf (logfile, "%%!CairoScript - %s\n", name);
 }
 
 static cairo_bool_t
@@ -805,6 +944,10 @@ _init_logfile (void)
     if (env != NULL)
 	_mark_dirty = atoi (env);
 
+    env = getenv ("CAIRO_TRACE_BINARY");
+    if (env != NULL)
+	_binary = atoi (env);
+
     filename = getenv ("CAIRO_TRACE_FD");
     if (filename != NULL) {
 	int fd = atoi (filename);
@@ -872,6 +1015,8 @@ _write_lock (void)
 
 #if HAVE_FLOCKFILE && HAVE_FUNLOCKFILE
     flockfile (logfile);
+#else
+    pthread_mutex_lock (&write_mutex);
 #endif
     return TRUE;
 }
@@ -882,8 +1027,12 @@ _write_unlock (void)
     if (logfile == NULL)
 	return;
 
+    _trace_buffer_flush ();
+
 #if HAVE_FLOCKFILE && HAVE_FUNLOCKFILE
     funlockfile (logfile);
+#else
+    pthread_mutex_unlock (&write_mutex);
 #endif
 
     if (_flush)
@@ -1331,8 +1480,36 @@ struct _data_stream {
     unsigned char zout_buf[BUFFER_SIZE];
     unsigned char four_tuple[4];
     int base85_pending;
+
+    /* binary traces collect the compressed data to prefix its length */
+    unsigned char *binary;
+    unsigned long binary_length;
+    unsigned long binary_size;
+    uint32_t length;
 };
 
+static void
+_write_binary_data (struct _data_stream *stream,
+		    const unsigned char *data,
+		    unsigned long length)
+{
+    if (stream->binary_length + length > stream->binary_size) {
+	unsigned long size = 2 * stream->binary_size + length;
+	unsigned char *binary = realloc (stream->binary, size);
+
+	if (binary == NULL) {
+	    _error = TRUE;
+	    return;
+	}
+
+	stream->binary = binary;
+	stream->binary_size = size;
+    }
+
+    memcpy (stream->binary + stream->binary_length, data, length);
+    stream->binary_length += length;
+}
+
 static void
 _write_zlib_data_start (struct _data_stream *stream)
 {
@@ -1383,7 +1560,6 @@ _write_base85_data (struct _data_stream *stream,
 		    unsigned long	   length)
 {
     unsigned char five_tuple[5];
-    int ret;
 
     assert (_should_trace ());
 
@@ -1391,10 +1567,9 @@ _write_base85_data (struct _data_stream *stream,
 	stream->four_tuple[stream->base85_pending++] = *data++;
 	if (stream->base85_pending == 4) {
 	    if (_expand_four_tuple_to_five (stream->four_tuple, five_tuple))
-		ret = fwrite ("z", 1, 1, logfile);
+		_trace_write ("z", 1);
 	    else
-		ret = fwrite (five_tuple, 5, 1, logfile);
-	    (void)ret;
+		_trace_write (five_tuple, 5);
 	    stream->base85_pending = 0;
 	}
     }
@@ -1408,9 +1583,14 @@ _write_zlib_data (struct _data_stream *stream, cairo_bool_t flush)
     do {
 	int ret = deflate (&stream->zlib_stream, flush ? Z_FINISH : Z_NO_FLUSH);
 	if (flush || stream->zlib_stream.avail_out == 0) {
-	    _write_base85_data (stream,
-				stream->zout_buf,
-				BUFFER_SIZE - stream->zlib_stream.avail_out);
+	    if (_binary)
+		_write_binary_data (stream,
+				    stream->zout_buf,
+				    BUFFER_SIZE - stream->zlib_stream.avail_out);
+	    else
+		_write_base85_data (stream,
+				    stream->zout_buf,
+				    BUFFER_SIZE - stream->zlib_stream.avail_out);
 	    stream->zlib_stream.next_out = stream->zout_buf;
 	    stream->zlib_stream.avail_out = BUFFER_SIZE;
 	}
@@ -1429,6 +1609,14 @@ static void
 _write_data_start (struct _data_stream *stream, uint32_t len)
 {
     _write_zlib_data_start (stream);
+
+    if (_binary) {
+	stream->binary = NULL;
+	stream->binary_length = stream->binary_size = 0;
+	stream->length = len;
+	return;
+    }
+
     _write_base85_data_start (stream);
 
     _trace_printf ("<|");
@@ -1470,7 +1658,6 @@ static void
 _write_base85_data_end (struct _data_stream *stream)
 {
     unsigned char five_tuple[5];
-    int ret;
 
     assert (_should_trace ());
 
@@ -1478,15 +1665,134 @@ _write_base85_data_end (struct _data_stream *stream)
 	memset (stream->four_tuple + stream->base85_pending,
 		0, 4 - stream->base85_pending);
 	_expand_four_tuple_to_five (stream->four_tuple, five_tuple);
-	ret = fwrite (five_tuple, stream->base85_pending+1, 1, logfile);
-	(void) ret;
+	_trace_write (five_tuple, stream->base85_pending+1);
+    }
+}
+
+/* Binary traces define each distinct blob of surface or font data
+ * once, as /d<n>, and name it again wherever it is repeated. The
+ * compressed bytes are kept, so that a repeat is only named once its
+ * bytes compare equal. Small blobs cost less to write out again than
+ * to keep.
+ */
+#define BLOB_MIN_LENGTH 256
+
+struct _blob {
+    uint64_t hash;
+    unsigned char *data;
+    unsigned long length;
+    uint32_t size;
+    unsigned long token;
+    struct _blob *next;
+};
+
+static struct _blob *_blobs[607];
+static unsigned long _blob_token;
+
+static uint64_t
+_blob_hash (const unsigned char *data, unsigned long length)
+{
+    uint64_t hash = 14695981039346656037ULL; /* FNV-1a */
+
+    while (length--) {
+	hash ^= *data++;
+	hash *= 1099511628211ULL;
     }
+
+    return hash;
+}
+
+static struct _blob *
+_blob_find (uint64_t hash,
+	    const unsigned char *data, unsigned long length,
+	    uint32_t size)
+{
+    struct _blob *blob;
+
+    for (blob = _blobs[hash % ARRAY_LENGTH (_blobs)];
+	 blob != NULL;
+	 blob = blob->next)
+    {
+	if (blob->hash == hash &&
+	    blob->length == length &&
+	    blob->size == size &&
+	    memcmp (blob->data, data, length) == 0)
+	{
+	    return blob;
+	}
+    }
+
+    return NULL;
+}
+
+/* Takes ownership of data, which is kept to compare against. */
+static struct _blob *
+_blob_add (uint64_t hash,
+	   unsigned char *data, unsigned long length,
+	   uint32_t size)
+{
+    struct _blob *blob;
+    int bucket;
+
+    blob = malloc (sizeof (struct _blob));
+    if (blob == NULL)
+	return NULL;
+
+    bucket = hash % ARRAY_LENGTH (_blobs);
+    blob->hash = hash;
+    blob->data = data;
+    blob->length = length;
+    blob->size = size;
+    blob->token = ++_blob_token;
+    blob->next = _blobs[bucket];
+    _blobs[bucket] = blob;
+
+    return blob;
 }
 
 static void
 _write_data_end (struct _data_stream *stream)
 {
     _write_zlib_data_end (stream);
+
+    if (_binary) {
+	unsigned char token[9];
+	struct _blob *blob = NULL;
+	uint64_t hash = 0;
+	uint32_t len;
+
+	if (stream->binary_length >= BLOB_MIN_LENGTH) {
+	    hash = _blob_hash (stream->binary, stream->binary_length);
+	    blob = _blob_find (hash, stream->binary, stream->binary_length,
+			       stream->length);
+	    if (blob != NULL) {
+		_trace_printf (" d%lu", blob->token);
+		free (stream->binary);
+		return;
+	    }
+	}
+
+	/* length of the compressed string, then the inflated size */
+	token[0] = BINARY_STRING_4_DEFLATE;
+	len = stream->binary_length;
+	memcpy (token + 1, &len, 4);
+	len = to_be32 (stream->length);
+	memcpy (token + 5, &len, 4);
+
+	_trace_write_token (token, sizeof (token));
+	_trace_write (stream->binary, stream->binary_length);
+	_buffer.last = ' ';
+
+	if (stream->binary_length >= BLOB_MIN_LENGTH)
+	    blob = _blob_add (hash, stream->binary, stream->binary_length,
+			      stream->length);
+	if (blob != NULL)
+	    _trace_printf (" dup /d%lu exch def", blob->token);
+	else
+	    free (stream->binary);
+	return;
+    }
+
     _write_base85_data_end (stream);
 
     _trace_printf ("~>");
@@ -1916,11 +2222,9 @@ ESCAPED_CHAR:
 		_trace_printf ("%c", c);
 	    } else {
 		char buf[4] = { '\\' };
-		int ret_ignored;
 
 		to_octal (c, buf+1, 3);
-		ret_ignored = fwrite (buf, 4, 1, logfile);
-		(void)ret_ignored;
+		_trace_write (buf, 4);
 	    }
 	    break;
 	}